@@ -0,0 +1,103 @@
+#ifndef JMTucker_Formats_GenDecayGraph_h
+#define JMTucker_Formats_GenDecayGraph_h
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "DataFormats/Common/interface/Handle.h"
+#include "DataFormats/HepMCCandidate/interface/GenParticleFwd.h"
+#include "DataFormats/Provenance/interface/ProductID.h"
+
+namespace reco { class Candidate; }
+
+namespace jmt {
+  // Index-based view of the mother/daughter links in a
+  // GenParticleCollection, built in one pass per event so that the
+  // usual PYTHIA8 record walking (ancestry, first/last copies, who has
+  // this pdgId) doesn't have to chase pointers recursively every time
+  // it's asked. Everything is in terms of the index into the source
+  // collection; -1 means none. Ancestors are stored as one bitset per
+  // particle, so is_ancestor is a single bit test and
+  // has_any_ancestor_in is a handful of word ANDs.
+  class GenDecayGraph {
+  public:
+    typedef std::vector<uint64_t> mask_t;
+
+    struct index_range {
+      const int* b;
+      const int* e;
+      const int* begin() const { return b; }
+      const int* end() const { return e; }
+      size_t size() const { return e - b; }
+      bool empty() const { return b == e; }
+    };
+
+    GenDecayGraph() : n_(0), nwords_(0) {}
+    GenDecayGraph(const edm::Handle<reco::GenParticleCollection>& gens) : GenDecayGraph(*gens, gens.id()) {}
+    GenDecayGraph(const reco::GenParticleCollection&, edm::ProductID=edm::ProductID());
+
+    // Throws if this graph wasn't made from gens.
+    void check(const edm::Handle<reco::GenParticleCollection>& gens) const;
+
+    // Position of c in gens without the linear scan, or -1 if it isn't there.
+    static int index(const reco::Candidate* c, const reco::GenParticleCollection& gens);
+
+    int size() const { return n_; }
+    edm::ProductID source() const { return source_; }
+    int pdgId(int i) const { return pdgid_[i]; }
+
+    int nmothers(int i) const { return mom_begin_[i+1] - mom_begin_[i]; }
+    int mother(int i, int j) const { return moms_[mom_begin_[i] + j]; }
+    index_range mothers(int i) const { return range(moms_, mom_begin_, i); }
+    int ndaughters(int i) const { return dau_begin_[i+1] - dau_begin_[i]; }
+    int daughter(int i, int j) const { return daus_[dau_begin_[i] + j]; }
+    index_range daughters(int i) const { return range(daus_, dau_begin_, i); }
+
+    // Indices with exactly this pdgId, in increasing order.
+    index_range with_id(int id) const;
+    // Same for id and -id, merged in increasing order.
+    std::vector<int> with_abs_id(int id) const;
+
+    // Strict ancestry: a particle is not its own ancestor.
+    bool is_ancestor(int i, int a) const { return i >= 0 && a >= 0 && (ancestors_[size_t(i)*nwords_ + a/64] >> (a%64)) & 1; }
+    bool has_any_ancestor_in(int i, const mask_t& m) const;
+    bool has_any_ancestor_with_id(int i, int id) const;
+    mask_t mask(std::function<bool(int)> such_that) const;
+
+    // Follow the single-mother same-pdgId chain up, cf. first_candidate.
+    int first_copy(int i) const { return i < 0 ? -1 : first_copy_[i]; }
+    // Follow the same-pdgId daughter down, allowing anything else to
+    // come along, cf. final_candidate(c, -1).
+    int last_copy(int i) const { return i < 0 ? -1 : last_copy_[i]; }
+    // Same as final_candidate(c, allowed_others).
+    int final_copy(int i, int allowed_others) const;
+
+    // Same as daughter_with_id: -1 if none or more than one.
+    int daughter_with_id(int i, int id, bool take_abs=false) const;
+
+  private:
+    static index_range range(const std::vector<int>& v, const std::vector<int>& b, int i) {
+      const int* p = v.data();
+      return index_range{p + b[i], p + b[i+1]};
+    }
+
+    void fill_ancestors(int i, std::vector<char>& state);
+
+    edm::ProductID source_;
+    int n_;
+    int nwords_;
+    std::vector<int> pdgid_;
+    std::vector<int> mom_begin_;
+    std::vector<int> moms_;
+    std::vector<int> dau_begin_;
+    std::vector<int> daus_;
+    std::vector<uint64_t> ancestors_;
+    std::vector<int> first_copy_;
+    std::vector<int> last_copy_;
+    std::vector<int> ids_;
+    std::vector<int> id_begin_;
+    std::vector<int> id_indices_;
+  };
+}
+
+#endif
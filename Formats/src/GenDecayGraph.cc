@@ -0,0 +1,232 @@
+#include <algorithm>
+#include <cstdlib>
+#include "DataFormats/HepMCCandidate/interface/GenParticle.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include "JMTucker/Formats/interface/GenDecayGraph.h"
+
+namespace jmt {
+  GenDecayGraph::GenDecayGraph(const reco::GenParticleCollection& gens, edm::ProductID source)
+    : source_(source),
+      n_(int(gens.size())),
+      nwords_((n_ + 63) / 64)
+  {
+    pdgid_.resize(n_);
+    mom_begin_.reserve(n_+1);
+    dau_begin_.reserve(n_+1);
+
+    for (int i = 0; i < n_; ++i) {
+      const reco::GenParticle& g = gens[i];
+      pdgid_[i] = g.pdgId();
+
+      mom_begin_.push_back(moms_.size());
+      for (size_t j = 0, je = g.numberOfMothers(); j < je; ++j) {
+        const int m = index(g.mother(j), gens);
+        if (m >= 0 && m != i)
+          moms_.push_back(m);
+      }
+
+      dau_begin_.push_back(daus_.size());
+      for (size_t j = 0, je = g.numberOfDaughters(); j < je; ++j) {
+        const int d = index(g.daughter(j), gens);
+        if (d >= 0 && d != i)
+          daus_.push_back(d);
+      }
+    }
+    mom_begin_.push_back(moms_.size());
+    dau_begin_.push_back(daus_.size());
+
+    ancestors_.assign(size_t(n_) * nwords_, 0);
+    std::vector<char> state(n_, 0);
+    for (int i = 0; i < n_; ++i)
+      if (state[i] == 0)
+        fill_ancestors(i, state);
+
+    // Copy chains: walk from each unresolved particle until we hit the
+    // end of the chain or something already resolved, then assign the
+    // answer to everything on the way, so each particle is visited
+    // once per direction.
+    auto resolve = [this](std::vector<int>& out, std::function<int(int)> next) {
+      out.assign(n_, -2);
+      std::vector<int> path;
+      std::vector<char> on_path(n_, 0);
+      for (int i = 0; i < n_; ++i) {
+        if (out[i] != -2)
+          continue;
+        int c = i;
+        int end = -1;
+        while (1) {
+          if (out[c] != -2) { end = out[c]; break; }
+          path.push_back(c);
+          on_path[c] = 1;
+          const int nx = next(c);
+          if (nx < 0 || on_path[nx]) { end = c; break; }
+          c = nx;
+        }
+        for (int p : path) {
+          out[p] = end;
+          on_path[p] = 0;
+        }
+        path.clear();
+      }
+    };
+
+    resolve(first_copy_, [this](int c) {
+        return nmothers(c) == 1 && pdgid_[mother(c,0)] == pdgid_[c] ? mother(c,0) : -1;
+      });
+
+    resolve(last_copy_, [this](int c) {
+        const int nd = ndaughters(c);
+        if (nd == 1)
+          return pdgid_[daughter(c,0)] == pdgid_[c] ? daughter(c,0) : -1;
+        int the = -1;
+        for (int j = 0; j < nd; ++j)
+          if (pdgid_[daughter(c,j)] == pdgid_[c])
+            the = daughter(c,j);
+        return the;
+      });
+
+    std::vector<std::pair<int,int>> by_id(n_);
+    for (int i = 0; i < n_; ++i)
+      by_id[i] = std::make_pair(pdgid_[i], i);
+    std::sort(by_id.begin(), by_id.end());
+    id_indices_.reserve(n_);
+    for (int i = 0; i < n_; ++i) {
+      if (i == 0 || by_id[i].first != by_id[i-1].first) {
+        ids_.push_back(by_id[i].first);
+        id_begin_.push_back(i);
+      }
+      id_indices_.push_back(by_id[i].second);
+    }
+    id_begin_.push_back(n_);
+  }
+
+  void GenDecayGraph::fill_ancestors(int i, std::vector<char>& state) {
+    state[i] = 1;
+    uint64_t* row = &ancestors_[size_t(i) * nwords_];
+    for (int m : mothers(i)) {
+      if (state[m] == 0)
+        fill_ancestors(m, state);
+      row[m/64] |= uint64_t(1) << (m%64);
+      if (state[m] == 2) { // if 1, there's a loop in the record; don't go around it
+        const uint64_t* mrow = &ancestors_[size_t(m) * nwords_];
+        for (int w = 0; w < nwords_; ++w)
+          row[w] |= mrow[w];
+      }
+    }
+    state[i] = 2;
+  }
+
+  void GenDecayGraph::check(const edm::Handle<reco::GenParticleCollection>& gens) const {
+    if (gens.id() != source_ || int(gens->size()) != n_)
+      throw cms::Exception("GenDecayGraph") << "graph made from product " << source_ << " with " << n_ << " particles used with " << gens.id() << " with " << gens->size();
+  }
+
+  int GenDecayGraph::index(const reco::Candidate* c, const reco::GenParticleCollection& gens) {
+    if (c == 0 || gens.empty())
+      return -1;
+    const reco::GenParticle* g = dynamic_cast<const reco::GenParticle*>(c);
+    if (g == 0)
+      return -1;
+    const reco::GenParticle* b = &gens.front();
+    const std::less<const reco::GenParticle*> lt;
+    if (lt(g, b) || !lt(g, b + gens.size()))
+      return -1;
+    return int(g - b);
+  }
+
+  GenDecayGraph::index_range GenDecayGraph::with_id(int id) const {
+    auto it = std::lower_bound(ids_.begin(), ids_.end(), id);
+    if (it == ids_.end() || *it != id)
+      return index_range{0,0};
+    return range(id_indices_, id_begin_, it - ids_.begin());
+  }
+
+  std::vector<int> GenDecayGraph::with_abs_id(int id) const {
+    const index_range a = with_id(id), b = with_id(-id);
+    std::vector<int> r(a.size() + (id != 0 ? b.size() : 0));
+    if (id != 0)
+      std::merge(a.begin(), a.end(), b.begin(), b.end(), r.begin());
+    else
+      std::copy(a.begin(), a.end(), r.begin());
+    return r;
+  }
+
+  bool GenDecayGraph::has_any_ancestor_in(int i, const mask_t& m) const {
+    if (i < 0)
+      return false;
+    const uint64_t* row = &ancestors_[size_t(i) * nwords_];
+    for (int w = 0, we = std::min(nwords_, int(m.size())); w < we; ++w)
+      if (row[w] & m[w])
+        return true;
+    return false;
+  }
+
+  bool GenDecayGraph::has_any_ancestor_with_id(int i, int id) const {
+    for (int a : with_id(id))
+      if (is_ancestor(i, a))
+        return true;
+    return false;
+  }
+
+  GenDecayGraph::mask_t GenDecayGraph::mask(std::function<bool(int)> such_that) const {
+    mask_t m(nwords_, 0);
+    for (int i = 0; i < n_; ++i)
+      if (such_that(i))
+        m[i/64] |= uint64_t(1) << (i%64);
+    return m;
+  }
+
+  int GenDecayGraph::final_copy(int i, int allowed_others) const {
+    if (allowed_others == -1)
+      return last_copy(i);
+    if (i < 0)
+      return -1;
+
+    const bool allow_gluons = allowed_others & 1;
+    const bool allow_photons = allowed_others & 2;
+    const bool allow_electrons = allowed_others & 4;
+
+    for (int steps = 0; steps < n_; ++steps) {
+      const int nd = ndaughters(i);
+      int next = -1;
+      if (nd == 1) {
+        if (pdgid_[daughter(i,0)] == pdgid_[i])
+          next = daughter(i,0);
+      }
+      else if (nd > 1 && allowed_others != 0) {
+        for (int j = 0; j < nd; ++j) {
+          const int d = daughter(i,j);
+          const int id = pdgid_[d];
+          const int aid = abs(id);
+          if (id == pdgid_[i])
+            next = d;
+          else if ((aid != 11 && id != 21 && id != 22) || (id == 21 && !allow_gluons) || (id == 22 && !allow_photons) || (aid == 11 && !allow_electrons)) {
+            next = -1;
+            break;
+          }
+        }
+      }
+      if (next < 0)
+        break;
+      i = next;
+    }
+    return i;
+  }
+
+  int GenDecayGraph::daughter_with_id(int i, int id, bool take_abs) const {
+    if (i < 0)
+      return -1;
+    if (take_abs)
+      id = abs(id);
+    int d = -1;
+    for (int j : daughters(i)) {
+      const int this_id = take_abs ? abs(pdgid_[j]) : pdgid_[j];
+      if (id == 0 || this_id == id) {
+        if (d != -1)
+          return -1;
+        d = j;
+      }
+    }
+    return d;
+  }
+}
@@ -1,4 +1,5 @@
 #include "DataFormats/Common/interface/Wrapper.h"
+#include "JMTucker/Formats/interface/GenDecayGraph.h"
 #include "JMTucker/Formats/interface/MergeablePOD.h"
 
 namespace JMTucker_Formats {
@@ -7,5 +8,8 @@ namespace JMTucker_Formats {
     jmt::MergeablePOD<float> mf;
     edm::Wrapper<jmt::MergeablePOD<int> > wmi;
     edm::Wrapper<jmt::MergeablePOD<float> > wmf;
+
+    jmt::GenDecayGraph gdg;
+    edm::Wrapper<jmt::GenDecayGraph> wgdg;
   };
 }
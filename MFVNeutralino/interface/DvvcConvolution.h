@@ -0,0 +1,267 @@
+#ifndef JMTucker_MFVNeutralino_DvvcConvolution_h
+#define JMTucker_MFVNeutralino_DvvcConvolution_h
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+namespace mfv {
+  // The dVVC template by numerical integration instead of by sampling.
+  //
+  // The sampled construction draws dBV0 and dBV1 from 1v histograms
+  // (TH1::GetRandom: a bin by its content, then uniform in the bin),
+  // |dphi| from a pdf on [0, pi], and fills
+  //   dvvc = sqrt(dBV0^2 + dBV1^2 - 2 dBV0 dBV1 cos(dphi))
+  // with the weight eff(dvvc), a histogram lookup. This computes what
+  // that converges to. Each pair of dBV bins is integrated on an
+  // nsub x nsub midpoint grid. At each grid point dvvc is monotonic in
+  // |dphi|, so the dphi integral is done exactly: the dvv and efficiency
+  // bin edges are mapped to dphi values with acos, and the dphi CDF is
+  // evaluated between them. The CDF is tabulated from the pdf at npx
+  // points and is piecewise quadratic.
+  //
+  // The output dVVC bins are the dvv_edges. Anything past the last edge
+  // goes in the last bin, and anything before the first edge in the
+  // first bin, as the sampled constructions do with their clamping or
+  // deoverflow. Bins are 0-based here. Efficiency values, like
+  // TH1::GetBinContent, are indexed 0 (underflow) to n+1 (overflow).
+  class DvvcConvolution {
+  public:
+    DvvcConvolution(const std::vector<double>& rho_edges, const std::vector<double>& dvv_edges, int nsub=4)
+      : rho_edges_(rho_edges), dvv_edges_(dvv_edges), nsub_(std::max(nsub, 1))
+    {
+      assert(rho_edges_.size() >= 2 && dvv_edges_.size() >= 2);
+      set_dphi_pdf([](double) { return 1.; });
+      update_intervals();
+    }
+
+    int nrho() const { return int(rho_edges_.size()) - 1; }
+    int ndvv() const { return int(dvv_edges_.size()) - 1; }
+    int ndphi() const { return dphi_edges_.size() ? int(dphi_edges_.size()) - 1 : 0; }
+
+    // The |dphi| pdf on [0, pi], need not be normalized.
+    template <typename F>
+    void set_dphi_pdf(F pdf, int npx=2000) {
+      npx = std::max(npx, 2);
+      cdf_h_ = M_PI / (npx - 1);
+      cdf_p_.resize(npx);
+      cdf_c_.assign(npx, 0.);
+      for (int i = 0; i < npx; ++i)
+        cdf_p_[i] = pdf(i * cdf_h_);
+      for (int i = 1; i < npx; ++i)
+        cdf_c_[i] = cdf_c_[i-1] + cdf_h_ * (cdf_p_[i-1] + cdf_p_[i]) / 2;
+      const double norm = cdf_c_.back();
+      for (int i = 0; i < npx; ++i) {
+        cdf_p_[i] /= norm;
+        cdf_c_[i] /= norm;
+      }
+    }
+
+    // Optional |dphi| binning, for the |dphi| distribution of the
+    // construction; outside it the bin passed to the visitor is -1.
+    void set_dphi_edges(const std::vector<double>& edges) {
+      dphi_edges_ = edges;
+    }
+
+    // values has the efficiency in bins 0..n+1 of edges, underflow and
+    // overflow included. With no efficiency set, it is 1.
+    void set_eff(const std::vector<double>& edges, const std::vector<double>& values) {
+      assert(values.size() == edges.size() + 1);
+      eff_edges_ = edges;
+      eff_values_ = values;
+      update_intervals();
+    }
+
+    double dphi_cdf(double x) const {
+      if (x <= 0) return 0;
+      if (x >= M_PI) return 1;
+      const int i = std::min(int(x / cdf_h_), int(cdf_c_.size()) - 2);
+      const double t = x - i * cdf_h_;
+      return cdf_c_[i] + t * (cdf_p_[i] + t * (cdf_p_[i+1] - cdf_p_[i]) / cdf_h_ / 2);
+    }
+
+    // For rho bins i and j (0-based) of the two vertices, call
+    //   f(kdvv, kdphi, p, eff)
+    // for each piece of the integral, where p is the probability of the
+    // piece given the two bins, eff is the efficiency for it, and kdvv
+    // and kdphi are the output dVVC and |dphi| bins. The p sum to 1.
+    template <typename F>
+    void convolve_bin_pair(int i, int j, F f) const {
+      const double w = 1. / (nsub_ * nsub_);
+      const double wi = (rho_edges_[i+1] - rho_edges_[i]) / nsub_;
+      const double wj = (rho_edges_[j+1] - rho_edges_[j]) / nsub_;
+      for (int si = 0; si < nsub_; ++si) {
+        const double r0 = rho_edges_[i] + (si + 0.5) * wi;
+        for (int sj = 0; sj < nsub_; ++sj) {
+          const double r1 = rho_edges_[j] + (sj + 0.5) * wj;
+          convolve_point(r0, r1, w, f);
+        }
+      }
+    }
+
+    // The dVVC distribution, and the sum of the squares of the weights,
+    // for one draw from c0 and c1, the rho-bin contents of the two 1v
+    // histograms (negative contents are taken as zero, as GetRandom
+    // does).
+    struct Result {
+      std::vector<double> dvv, dvv_w2;
+      double sum() const { double s = 0; for (double x : dvv) s += x; return s; }
+    };
+
+    Result convolve(const std::vector<double>& c0, const std::vector<double>& c1) const {
+      const std::vector<double> p0 = normalized(c0), p1 = normalized(c1);
+      Result r{std::vector<double>(ndvv(), 0.), std::vector<double>(ndvv(), 0.)};
+      for (int i = 0; i < nrho(); ++i) {
+        if (p0[i] == 0) continue;
+        for (int j = 0; j < nrho(); ++j) {
+          if (p1[j] == 0) continue;
+          const double pij = p0[i] * p1[j];
+          convolve_bin_pair(i, j, [&](int k, int, double p, double eff) {
+              r.dvv[k] += pij * p * eff;
+              r.dvv_w2[k] += pij * p * eff * eff;
+            });
+        }
+      }
+      return r;
+    }
+
+    // The convolution for every pair of rho bins, computed once, for
+    // applying to many pairs of 1v histograms with the same binning,
+    // e.g. the statmodel toys.
+    class Kernel {
+    public:
+      Result apply(const std::vector<double>& c0, const std::vector<double>& c1) const {
+        const std::vector<double> p0 = normalized(c0), p1 = normalized(c1);
+        Result r{std::vector<double>(ndvv_, 0.), std::vector<double>(ndvv_, 0.)};
+        std::vector<int> nz1;
+        for (int j = 0; j < nrho_; ++j)
+          if (p1[j] != 0)
+            nz1.push_back(j);
+        for (int i = 0; i < nrho_; ++i) {
+          if (p0[i] == 0) continue;
+          for (int j : nz1) {
+            const double pij = p0[i] * p1[j];
+            const double* k = &k_[size_t(i * nrho_ + j) * 2 * ndvv_];
+            for (int l = 0; l < ndvv_; ++l) {
+              r.dvv[l]    += pij * k[l];
+              r.dvv_w2[l] += pij * k[ndvv_ + l];
+            }
+          }
+        }
+        return r;
+      }
+
+    private:
+      friend class DvvcConvolution;
+      int nrho_, ndvv_;
+      std::vector<double> k_;
+    };
+
+    Kernel kernel() const {
+      Kernel K;
+      K.nrho_ = nrho();
+      K.ndvv_ = ndvv();
+      K.k_.assign(size_t(nrho()) * nrho() * 2 * ndvv(), 0.);
+      for (int i = 0; i < nrho(); ++i)
+        for (int j = 0; j < nrho(); ++j) {
+          double* k = &K.k_[size_t(i * nrho() + j) * 2 * ndvv()];
+          convolve_bin_pair(i, j, [&](int l, int, double p, double eff) {
+              k[l] += p * eff;
+              k[ndvv() + l] += p * eff * eff;
+            });
+        }
+      return K;
+    }
+
+  private:
+    // A piece of the dvvc axis between consecutive dvv and efficiency
+    // edges, starting at lo.
+    struct Interval {
+      double lo;
+      int kdvv;
+      double eff;
+    };
+
+    static std::vector<double> normalized(const std::vector<double>& c) {
+      std::vector<double> p(c.size());
+      double s = 0;
+      for (size_t i = 0; i < c.size(); ++i)
+        s += p[i] = std::max(c[i], 0.);
+      if (s > 0)
+        for (double& x : p)
+          x /= s;
+      return p;
+    }
+
+    int dvv_bin(double x) const {
+      const int k = int(std::upper_bound(dvv_edges_.begin(), dvv_edges_.end(), x) - dvv_edges_.begin()) - 1;
+      return std::min(std::max(k, 0), ndvv() - 1);
+    }
+
+    double eff(double x) const {
+      if (eff_edges_.empty())
+        return 1;
+      return eff_values_[std::upper_bound(eff_edges_.begin(), eff_edges_.end(), x) - eff_edges_.begin()];
+    }
+
+    void update_intervals() {
+      std::vector<double> edges(dvv_edges_);
+      edges.insert(edges.end(), eff_edges_.begin(), eff_edges_.end());
+      std::sort(edges.begin(), edges.end());
+      edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+      intervals_.clear();
+      intervals_.push_back(Interval{-HUGE_VAL, dvv_bin(edges[0] - 1), eff(edges[0] - 1)});
+      for (size_t i = 0; i < edges.size(); ++i) {
+        const double mid = i+1 < edges.size() ? (edges[i] + edges[i+1]) / 2 : edges[i] + 1;
+        intervals_.push_back(Interval{edges[i], dvv_bin(mid), eff(mid)});
+      }
+    }
+
+    template <typename F>
+    void convolve_point(double r0, double r1, double w, F& f) const {
+      const double a = r0*r0 + r1*r1, b = 2*r0*r1;
+      const double dmin = std::fabs(r0 - r1), dmax = r0 + r1;
+      auto dphi_at = [&](double d) { return b > 0 ? std::acos(std::min(std::max((a - d*d) / b, -1.), 1.)) : 0.; };
+
+      // First interval containing dmin, then walk up the intervals to
+      // dmax, cutting each at the |dphi| edges inside it.
+      size_t s = std::upper_bound(intervals_.begin() + 1, intervals_.end(), dmin, [](double x, const Interval& v) { return x < v.lo; }) - intervals_.begin() - 1;
+      double cdf0 = 0;
+      size_t iphi = std::upper_bound(dphi_edges_.begin(), dphi_edges_.end(), 0.) - dphi_edges_.begin();
+      while (true) {
+        const bool last = s+1 >= intervals_.size() || !(intervals_[s+1].lo < dmax) || b == 0;
+        const double phi1 = last ? M_PI : dphi_at(intervals_[s+1].lo);
+
+        while (true) {
+          const bool cut = iphi < dphi_edges_.size() && dphi_edges_[iphi] < phi1;
+          const double phi = cut ? dphi_edges_[iphi] : phi1;
+          const double cdf = dphi_cdf(phi);
+          if (cdf > cdf0) {
+            const int kdphi = iphi == 0 || iphi >= dphi_edges_.size() ? -1 : int(iphi) - 1;
+            f(intervals_[s].kdvv, kdphi, w * (cdf - cdf0), intervals_[s].eff);
+          }
+          cdf0 = cdf;
+          if (!cut) break;
+          ++iphi;
+        }
+
+        if (last) break;
+        ++s;
+      }
+    }
+
+    std::vector<double> rho_edges_;
+    std::vector<double> dvv_edges_;
+    std::vector<double> dphi_edges_;
+    std::vector<double> eff_edges_;
+    std::vector<double> eff_values_;
+    std::vector<Interval> intervals_;
+    int nsub_;
+    double cdf_h_;
+    std::vector<double> cdf_p_, cdf_c_;
+  };
+}
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef JMTucker_MFVNeutralino_interface_MiniNtuple_h
 #define JMTucker_MFVNeutralino_interface_MiniNtuple_h
 
+#include <iosfwd>
 #include "Math/SMatrix.h"
 #include "TLorentzVector.h"
 #include "TTree.h"
@@ -119,10 +120,29 @@ namespace mfv {
     float geo2ddist1;
   };
 
+  // How write_to_tree sets up the branches. compression is ROOT's
+  // 100*algorithm + level (e.g. 101 zlib-1, 404 lz4-4, 505 zstd-5), set
+  // on every branch; the basket sizes are in bytes, the track one for
+  // the tk0_* and tk1_* branches; auto_flush is passed to
+  // TTree::SetAutoFlush. Anything < 0 (0 for auto_flush) leaves the
+  // ROOT/file default. MiniTree/iobench.exe scans these on an existing
+  // tree.
+  struct MiniNtupleWriteSettings {
+    int compression = -1;
+    int basket_size = -1;
+    int track_basket_size = -1;
+    long long auto_flush = 0;
+  };
+
   void write_to_tree(TTree* tree, MiniNtuple& nt);
+  void write_to_tree(TTree* tree, MiniNtuple& nt, const MiniNtupleWriteSettings& settings);
   void read_from_tree(TTree* tree, MiniNtuple& nt);
   MiniNtuple* clone(const MiniNtuple& nt);
   long long loop(const char* fn, const char* tree_path, bool (*)(long long, long long, const mfv::MiniNtuple&));
+
+  // Human-readable dump of everything in nt, e.g. for the event looked
+  // up by MFVNeutralino/test/EventIndex/evidx.exe.
+  void print(std::ostream& o, const MiniNtuple& nt);
 }
 
 #endif
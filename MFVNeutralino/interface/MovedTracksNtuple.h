@@ -12,6 +12,17 @@ namespace mfv {
     typedef unsigned char uchar;
     typedef unsigned short ushort;
 
+    // A contiguous list of track indices, e.g. the tracks of one jet or vertex.
+    struct track_range {
+      const ushort* b;
+      const ushort* e;
+      const ushort* begin() const { return b; }
+      const ushort* end() const { return e; }
+      size_t size() const { return e - b; }
+      bool empty() const { return b == e; }
+      int operator[](size_t i) const { return b[i]; }
+    };
+
     unsigned run;
     unsigned lumi;
     unsigned long long event;
@@ -61,7 +72,10 @@ namespace mfv {
     std::vector<uchar> alljets_hadronflavor;
     std::vector<bool>  alljets_moved;
     size_t nalljets() const { return p_alljets_pt ? p_alljets_pt->size() : alljets_pt.size(); }
-    std::vector<int> alljets_tracks(int i, double dRmax=0.4) const;
+    // The tracks within alljets_tracks_dR of jet i, from the stored association.
+    track_range alljets_tracks(int i) const;
+    // Same for any dRmax, computed on the spot.
+    std::vector<int> alljets_tracks(int i, double dRmax) const;
 
     // JMTBAD "presel" on these two really doesn't mean anything other than they have pt > 20 and pass the jet id
     uchar npreseljets; // JMTBAD this is actually # of jets with bdisc < veto
@@ -83,7 +97,7 @@ namespace mfv {
     std::vector<float> vtxs_tkonlymass;
     std::vector<uchar> vtxs_ntracks;
     std::vector<float> vtxs_bs2derr;
-    std::vector<int> vtxs_tracks(int i) const;
+    track_range vtxs_tracks(int i) const;
     size_t nvtxs() const { return p_vtxs_x ? p_vtxs_x->size() : vtxs_x.size(); }
 
     std::vector<float> tks_qpt;
@@ -113,6 +127,22 @@ namespace mfv {
     float tks_nsigmadxy(int i) const { return fabs(p_tks_dxy ? (*p_tks_dxy)[i] : tks_dxy[i]) / (p_tks_err_dxy ? (*p_tks_err_dxy)[i] : tks_err_dxy[i]); }
     bool tks_sel(int i) const;
 
+    // Jet -> track and vertex -> track associations, in compressed
+    // sparse row form: the tracks of jet i are alljets_tks_idx[k] for k
+    // in [alljets_tks_offsets[i], alljets_tks_offsets[i+1]), and likewise
+    // for the vertices using tks_vtx. The treer calls
+    // fill_track_association() before filling. Reading a tree from
+    // before these branches existed, they are built from the tracks the
+    // first time they're asked for in each entry. The offsets are
+    // unsigned since the jet cones overlap, so a track can be counted
+    // many times; the indices fit in a ushort.
+    static constexpr double alljets_tracks_dR = 0.4;
+    std::vector<unsigned> alljets_tks_offsets;
+    std::vector<ushort> alljets_tks_idx;
+    std::vector<unsigned> vtxs_tks_offsets;
+    std::vector<ushort> vtxs_tks_idx;
+    void fill_track_association();
+
     ////
 
     MovedTracksNtuple();
@@ -157,6 +187,21 @@ namespace mfv {
     std::vector<mfv::HitPattern::value_t>* p_tks_hp_;
     std::vector<bool>* p_tks_moved;
     std::vector<uchar>* p_tks_vtx;
+    std::vector<unsigned>* p_alljets_tks_offsets;
+    std::vector<ushort>* p_alljets_tks_idx;
+    std::vector<unsigned>* p_vtxs_tks_offsets;
+    std::vector<ushort>* p_vtxs_tks_idx;
+
+  private:
+    void build_track_association(std::vector<unsigned>& jets_offsets, std::vector<ushort>& jets_idx, std::vector<unsigned>& vtxs_offsets, std::vector<ushort>& vtxs_idx) const;
+    void update_track_association() const;
+
+    // For trees without the association branches.
+    TTree* read_tree;
+    bool build_association;
+    mutable Long64_t association_entry;
+    mutable std::vector<unsigned> built_alljets_tks_offsets, built_vtxs_tks_offsets;
+    mutable std::vector<ushort> built_alljets_tks_idx, built_vtxs_tks_idx;
   };
 }
 
@@ -0,0 +1,280 @@
+#ifndef JMTucker_MFVNeutralino_PairDistanceHist_h
+#define JMTucker_MFVNeutralino_PairDistanceHist_h
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+namespace mfv {
+  // Histogram of the distance between every pair of a set of points in
+  // the plane, e.g. the dVVc from all pairs of 1-vertex (x0,y0), without
+  // evaluating all N(N-1)/2 distances.
+  //
+  // The points are put in a polar grid that is refined where there are
+  // points: a cell in (r, phi) is split in half along whichever of its
+  // radial and arc lengths is longer until it has no more than
+  // leaf_size points and is small compared to the bins. Each cell keeps
+  // the centroid of its points and the largest distance from it, which
+  // bounds the distance between any two points of two cells. If the
+  // bounds for a pair of cells land in one histogram bin, all nA*nB
+  // pairs go in that bin at once; if not, the bigger cell is split. Two
+  // leaf cells are done point against cell, and pair by pair for the
+  // points for which that doesn't land in one bin either.
+  //
+  // The bin counts are exactly what filling the distances one by one
+  // into a TH1 with the same fixed binning would give: the per-pair
+  // distance is computed as sqrt(dx*dx + dy*dy) and binned as
+  // TAxis::FindFixBin does, and the bounds are widened by more than
+  // their rounding error before they are binned (binning is monotonic,
+  // so anything in between lands in the same bin). The points must be
+  // finite.
+  //
+  // The cell pairs are split into tasks run by nthreads threads (0 for
+  // as many as the hardware has), each with its own counts, which are
+  // summed at the end, so the result doesn't depend on the number of
+  // threads.
+  class PairDistanceHist {
+  public:
+    PairDistanceHist(int nbins, double xmin, double xmax, int nthreads=0, int leaf_size=16)
+      : nbins_(nbins), xmin_(xmin), xmax_(xmax), nthreads_(nthreads), leaf_size_(std::max(leaf_size, 1)) {}
+
+    // Same as TAxis::FindFixBin: 0 is the underflow and nbins+1 the overflow.
+    int bin(double d) const {
+      if (d < xmin_) return 0;
+      if (!(d < xmax_)) return nbins_ + 1;
+      return 1 + int(nbins_*(d-xmin_)/(xmax_-xmin_));
+    }
+
+    // Number of unordered pairs i < j in each bin 0..nbins+1. The
+    // ordered-pair (i != j) counts are twice these.
+    std::vector<unsigned long long> count(const std::vector<double>& x, const std::vector<double>& y) const {
+      std::vector<unsigned long long> counts(nbins_ + 2, 0);
+      const size_t n = std::min(x.size(), y.size());
+      if (n < 2)
+        return counts;
+
+      Tree t;
+      build(t, x, y, n);
+
+      // Expand the pairs breadth-first until there are enough tasks to
+      // keep the threads busy, resolving the ones that can be on the way.
+      const int nthreads = nthreads_ > 0 ? nthreads_ : std::max(1U, std::thread::hardware_concurrency());
+      std::vector<Task> tasks(1, Task{0, 0});
+      const size_t min_tasks = nthreads > 1 ? 64 * size_t(nthreads) : 1;
+      while (tasks.size() < min_tasks) {
+        std::vector<Task> next;
+        for (const Task& k : tasks)
+          step(t, k, counts, next);
+        if (next.empty())
+          return counts;
+        tasks.swap(next);
+      }
+
+      std::vector<std::vector<unsigned long long>> thread_counts(nthreads, std::vector<unsigned long long>(nbins_ + 2, 0));
+      std::atomic<size_t> next_task(0);
+      auto work = [&](int ithread) {
+        std::vector<unsigned long long>& c = thread_counts[ithread];
+        std::vector<Task> stack;
+        for (size_t i; (i = next_task++) < tasks.size(); ) {
+          stack.push_back(tasks[i]);
+          while (!stack.empty()) {
+            const Task k = stack.back();
+            stack.pop_back();
+            step(t, k, c, stack);
+          }
+        }
+      };
+
+      if (nthreads == 1)
+        work(0);
+      else {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < nthreads; ++i)
+          threads.emplace_back(work, i);
+        for (std::thread& th : threads)
+          th.join();
+      }
+
+      for (const auto& c : thread_counts)
+        for (int i = 0; i < nbins_ + 2; ++i)
+          counts[i] += c[i];
+
+      return counts;
+    }
+
+    // The plain double loop, for checking.
+    std::vector<unsigned long long> count_brute(const std::vector<double>& x, const std::vector<double>& y) const {
+      std::vector<unsigned long long> counts(nbins_ + 2, 0);
+      const size_t n = std::min(x.size(), y.size());
+      for (size_t i = 0; i < n; ++i)
+        for (size_t j = i+1; j < n; ++j)
+          ++counts[bin(dist(x[i], y[i], x[j], y[j]))];
+      return counts;
+    }
+
+  private:
+    struct Cell {
+      size_t begin, end;
+      double cx, cy, rho;
+      int child[2];
+      bool leaf() const { return child[0] < 0; }
+      unsigned long long n() const { return end - begin; }
+    };
+
+    struct Tree {
+      std::vector<double> x, y;
+      std::vector<Cell> cells;
+      double eps;
+    };
+
+    // The pair of cells a and b, or the pairs within a if a == b.
+    struct Task {
+      int a, b;
+    };
+
+    static double dist(double ax, double ay, double bx, double by) {
+      const double dx = ax - bx, dy = ay - by;
+      return std::sqrt(dx*dx + dy*dy);
+    }
+
+    void build(Tree& t, const std::vector<double>& x, const std::vector<double>& y, const size_t n) const {
+      struct P { double x, y, r, phi; };
+      std::vector<P> ps(n);
+      double rmax = 0;
+      for (size_t i = 0; i < n; ++i) {
+        ps[i] = P{x[i], y[i], std::hypot(x[i], y[i]), std::atan2(y[i], x[i])};
+        rmax = std::max(rmax, ps[i].r);
+      }
+
+      // Far more than the rounding error in the bounds for coordinates
+      // of size rmax, and far less than any sensible bin width.
+      t.eps = 1e-9 * (1 + rmax + std::fabs(xmin_) + std::fabs(xmax_));
+
+      struct Pending { int cell; double r0, r1, phi0, phi1; int depth; };
+      std::vector<Pending> todo;
+      t.cells.push_back(Cell{0, n, 0, 0, 0, {-1, -1}});
+      todo.push_back(Pending{0, 0, rmax, -M_PI, M_PI, 0});
+
+      while (!todo.empty()) {
+        Pending p = todo.back();
+        todo.pop_back();
+        const size_t b = t.cells[p.cell].begin, e = t.cells[p.cell].end;
+
+        double cx = 0, cy = 0;
+        for (size_t i = b; i < e; ++i) {
+          cx += ps[i].x;
+          cy += ps[i].y;
+        }
+        cx /= (e - b);
+        cy /= (e - b);
+        double rho = 0;
+        for (size_t i = b; i < e; ++i)
+          rho = std::max(rho, dist(ps[i].x, ps[i].y, cx, cy));
+        t.cells[p.cell].cx = cx;
+        t.cells[p.cell].cy = cy;
+        t.cells[p.cell].rho = rho;
+
+        // Small cells that are still wide compared to the bins would
+        // mostly be done pair by pair, so keep splitting those.
+        if (e - b == 1 || rho == 0 || (e - b <= size_t(leaf_size_) && rho < 0.1 * (xmax_ - xmin_) / nbins_))
+          continue;
+
+        // Halve the longer side, narrowing the bounds instead of making
+        // an empty child, until the points are split.
+        size_t m = b;
+        double lo[4], hi[4];
+        while (p.depth < max_depth) {
+          ++p.depth;
+          const bool split_phi = p.r1 * (p.phi1 - p.phi0) > p.r1 - p.r0;
+          const double mid = split_phi ? (p.phi0 + p.phi1) / 2 : (p.r0 + p.r1) / 2;
+          m = std::partition(ps.begin() + b, ps.begin() + e, [&](const P& q) { return (split_phi ? q.phi : q.r) < mid; }) - ps.begin();
+          lo[0] = p.r0; hi[0] = p.r1; lo[1] = p.phi0; hi[1] = p.phi1; // lower child
+          lo[2] = p.r0; hi[2] = p.r1; lo[3] = p.phi0; hi[3] = p.phi1; // upper child
+          if (split_phi) { hi[1] = mid; lo[3] = mid; }
+          else           { hi[0] = mid; lo[2] = mid; }
+          if (m == b)      { p.r0 = lo[2]; p.r1 = hi[2]; p.phi0 = lo[3]; p.phi1 = hi[3]; }
+          else if (m == e) { p.r0 = lo[0]; p.r1 = hi[0]; p.phi0 = lo[1]; p.phi1 = hi[1]; }
+          else break;
+        }
+        if (m == b || m == e)
+          continue;
+
+        const int c0 = t.cells.size();
+        t.cells[p.cell].child[0] = c0;
+        t.cells[p.cell].child[1] = c0 + 1;
+        t.cells.push_back(Cell{b, m, 0, 0, 0, {-1, -1}});
+        t.cells.push_back(Cell{m, e, 0, 0, 0, {-1, -1}});
+        todo.push_back(Pending{c0,     lo[0], hi[0], lo[1], hi[1], p.depth});
+        todo.push_back(Pending{c0 + 1, lo[2], hi[2], lo[3], hi[3], p.depth});
+      }
+
+      t.x.resize(n);
+      t.y.resize(n);
+      for (size_t i = 0; i < n; ++i) {
+        t.x[i] = ps[i].x;
+        t.y[i] = ps[i].y;
+      }
+    }
+
+    // Resolve task k into counts, or push the tasks it splits into onto out.
+    void step(const Tree& t, const Task& k, std::vector<unsigned long long>& counts, std::vector<Task>& out) const {
+      const Cell& a = t.cells[k.a];
+
+      if (k.a == k.b) {
+        const int ilo = bin(0), ihi = bin(2*a.rho + t.eps);
+        if (ilo == ihi)
+          counts[ilo] += a.n() * (a.n() - 1) / 2;
+        else if (a.leaf()) {
+          for (size_t i = a.begin; i < a.end; ++i)
+            for (size_t j = i+1; j < a.end; ++j)
+              ++counts[bin(dist(t.x[i], t.y[i], t.x[j], t.y[j]))];
+        }
+        else {
+          out.push_back(Task{a.child[0], a.child[0]});
+          out.push_back(Task{a.child[1], a.child[1]});
+          out.push_back(Task{a.child[0], a.child[1]});
+        }
+        return;
+      }
+
+      const Cell& b = t.cells[k.b];
+      const double d = dist(a.cx, a.cy, b.cx, b.cy);
+      const double s = a.rho + b.rho + t.eps;
+      const int ilo = bin(std::max(d - s, 0.)), ihi = bin(d + s);
+      if (ilo == ihi)
+        counts[ilo] += a.n() * b.n();
+      else if (a.leaf() && b.leaf()) {
+        // Try each point of a against all of b before going pair by pair.
+        for (size_t i = a.begin; i < a.end; ++i) {
+          const double di = dist(t.x[i], t.y[i], b.cx, b.cy);
+          const double si = b.rho + t.eps;
+          const int jlo = bin(std::max(di - si, 0.)), jhi = bin(di + si);
+          if (jlo == jhi)
+            counts[jlo] += b.n();
+          else
+            for (size_t j = b.begin; j < b.end; ++j)
+              ++counts[bin(dist(t.x[i], t.y[i], t.x[j], t.y[j]))];
+        }
+      }
+      else if (b.leaf() || (!a.leaf() && a.rho >= b.rho)) {
+        out.push_back(Task{a.child[0], k.b});
+        out.push_back(Task{a.child[1], k.b});
+      }
+      else {
+        out.push_back(Task{k.a, b.child[0]});
+        out.push_back(Task{k.a, b.child[1]});
+      }
+    }
+
+    static const int max_depth = 100;
+
+    const int nbins_;
+    const double xmin_, xmax_;
+    const int nthreads_;
+    const int leaf_size_;
+  };
+}
+
+#endif
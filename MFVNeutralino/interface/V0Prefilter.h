@@ -0,0 +1,136 @@
+#ifndef JMTucker_MFVNeutralino_V0Prefilter_h
+#define JMTucker_MFVNeutralino_V0Prefilter_h
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "JMTucker/MFVNeutralino/interface/V0Hypotheses.h"
+
+namespace mfv {
+  // A track as its circle in the transverse plane, for the cheap checks
+  // MFVV0Vertexer does on a track combination before it bothers with a
+  // vertex fit. b is the field in 1/(GeV cm), i.e.
+  // MagneticField::inInverseGeV(...).z(), so the radius is pt/b.
+  struct V0PrefilterTrack {
+    double x, y;   // reference point
+    double cx, cy; // circle center
+    double r;
+    double pz;
+    int q;
+    double b;
+
+    V0PrefilterTrack() : x(0), y(0), cx(0), cy(0), r(0), pz(0), q(0), b(0) {}
+    V0PrefilterTrack(double x_, double y_, double px, double py, double pz_, int q_, double b_)
+      : x(x_), y(y_),
+        cx(x_ + q_ * py / b_),
+        cy(y_ - q_ * px / b_),
+        r(std::hypot(px, py) / b_),
+        pz(pz_), q(q_), b(b_)
+    {}
+
+    // Point on the circle closest to (px,py).
+    void closest_point(double px, double py, double& ox, double& oy) const {
+      const double dx = px - cx, dy = py - cy;
+      const double d = std::hypot(dx, dy);
+      if (d == 0) { ox = x; oy = y; return; }
+      ox = cx + r * dx / d;
+      oy = cy + r * dy / d;
+    }
+
+    // Momentum at the point on the circle closest to (px,py).
+    void momentum_at(double px, double py, double p[3]) const {
+      double ox, oy;
+      closest_point(px, py, ox, oy);
+      p[0] =  q * b * (oy - cy);
+      p[1] = -q * b * (ox - cx);
+      p[2] = pz;
+    }
+  };
+
+  // Closest approach of two of them in the transverse plane, like
+  // ClosestApproachInRPhi: zero if the circles cross, in which case
+  // (x,y) is the crossing nearer the tracks' reference points, else
+  // the midpoint of the two closest points.
+  struct V0PrefilterDCA {
+    double dca, x, y;
+  };
+
+  inline V0PrefilterDCA v0_prefilter_dca(const V0PrefilterTrack& a, const V0PrefilterTrack& b) {
+    const double dx = b.cx - a.cx, dy = b.cy - a.cy;
+    const double d = std::hypot(dx, dy);
+    if (d == 0)
+      return V0PrefilterDCA{std::fabs(a.r - b.r), (a.x + b.x) / 2, (a.y + b.y) / 2};
+
+    const double ux = dx / d, uy = dy / d;
+
+    if (d > a.r + b.r) {
+      const double ax = a.cx + a.r * ux, ay = a.cy + a.r * uy;
+      const double bx = b.cx - b.r * ux, by = b.cy - b.r * uy;
+      return V0PrefilterDCA{d - a.r - b.r, (ax + bx) / 2, (ay + by) / 2};
+    }
+
+    if (d < std::fabs(a.r - b.r)) {
+      // one inside the other: closest points are on the same side of both
+      const double s = a.r > b.r ? 1 : -1;
+      const double ax = a.cx + s * a.r * ux, ay = a.cy + s * a.r * uy;
+      const double bx = b.cx + s * b.r * ux, by = b.cy + s * b.r * uy;
+      return V0PrefilterDCA{std::fabs(a.r - b.r) - d, (ax + bx) / 2, (ay + by) / 2};
+    }
+
+    const double l = (a.r * a.r - b.r * b.r + d * d) / (2 * d);
+    const double h = std::sqrt(std::max(a.r * a.r - l * l, 0.));
+    const double mx = a.cx + l * ux, my = a.cy + l * uy;
+    const double x1 = mx - h * uy, y1 = my + h * ux;
+    const double x2 = mx + h * uy, y2 = my - h * ux;
+    auto dist2 = [&](double x, double y) { return std::pow(x - a.x, 2) + std::pow(y - a.y, 2) + std::pow(x - b.x, 2) + std::pow(y - b.y, 2); };
+    if (dist2(x1, y1) <= dist2(x2, y2))
+      return V0PrefilterDCA{0, x1, y1};
+    else
+      return V0PrefilterDCA{0, x2, y2};
+  }
+
+  // Whether any assignment of hyp's daughter masses to the tracks that
+  // agrees with their charges (all the same or all opposite, as in
+  // MFVV0Efficiency) gives an invariant mass within window of
+  // hyp.mass, using the momenta at the point on each circle closest to
+  // (x,y).
+  inline bool v0_prefilter_mass_ok(const std::vector<const V0PrefilterTrack*>& tks, double x, double y, const V0Hypothesis& hyp, double window) {
+    const size_t n = tks.size();
+    if (n != hyp.ndaughters())
+      return false;
+
+    std::vector<double> p(3*n);
+    double sum_p[3] = {0};
+    for (size_t i = 0; i < n; ++i) {
+      tks[i]->momentum_at(x, y, &p[3*i]);
+      for (int j = 0; j < 3; ++j)
+        sum_p[j] += p[3*i+j];
+    }
+    const double sum_p2 = sum_p[0]*sum_p[0] + sum_p[1]*sum_p[1] + sum_p[2]*sum_p[2];
+
+    std::vector<double> test(hyp.charges_and_masses);
+    std::sort(test.begin(), test.end());
+    do {
+      bool all_same = true, all_opp = true;
+      for (size_t i = 0; i < n; ++i) {
+        const int s = tks[i]->q * (test[i] > 0 ? 1 : -1);
+        if (s > 0) all_opp = false;
+        if (s < 0) all_same = false;
+      }
+      if (!all_same && !all_opp)
+        continue;
+
+      double e = 0;
+      for (size_t i = 0; i < n; ++i)
+        e += std::sqrt(p[3*i]*p[3*i] + p[3*i+1]*p[3*i+1] + p[3*i+2]*p[3*i+2] + test[i]*test[i]);
+      const double m = std::sqrt(std::max(e*e - sum_p2, 0.));
+      if (std::fabs(m - hyp.mass) < window)
+        return true;
+    }
+    while (std::next_permutation(test.begin(), test.end()));
+
+    return false;
+  }
+}
+
+#endif
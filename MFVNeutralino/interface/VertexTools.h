@@ -1,6 +1,8 @@
 #ifndef JMTucker_MFVNeutralino_VertexTools_h
 #define JMTucker_MFVNeutralino_VertexTools_h
 
+#include <map>
+#include <string>
 #include "fastjet/ClusterSequence.hh"
 #include "DataFormats/GeometryCommonDetAlgo/interface/Measurement1D.h"
 #include "DataFormats/VertexReco/interface/VertexFwd.h"
@@ -17,6 +19,8 @@ namespace mfv {
 
   Measurement1D miss_dist(const reco::Vertex& v0, const reco::Vertex& v1, const math::XYZTLorentzVector& mom);
 
+  struct sv_distances_batch;
+
   struct vertex_distances {
     std::pair<bool,float> bs2dcompat, pv2dcompat, pv3dcompat;
     Measurement1D gen2ddist, gen3ddist, bs2ddist;
@@ -27,6 +31,66 @@ namespace mfv {
     std::vector<Measurement1D> missdistpv;
 
     vertex_distances(const reco::Vertex& sv, const std::vector<double>& gen_vertices, const reco::BeamSpot& beamspot, const reco::Vertex* primary_vertex, const std::vector<math::XYZTLorentzVector>& momenta);
+
+    // The same, with the beamspot and PV distances of sv taken from
+    // entry isv of b and the miss distances done in one batch.
+    vertex_distances(const sv_distances_batch& b, size_t isv, const reco::Vertex& sv, const std::vector<double>& gen_vertices, const reco::BeamSpot& beamspot, const reco::Vertex* primary_vertex, const std::vector<math::XYZTLorentzVector>& momenta);
+
+    // Empty if every value agrees with o's to within the float
+    // precision of the scalar path, else a description of the first
+    // one that doesn't.
+    std::string mismatch(const vertex_distances& o) const;
+
+  private:
+    void set_momenta(const reco::Vertex& sv, const reco::BeamSpot& beamspot, const reco::Vertex* primary_vertex, const std::vector<math::XYZTLorentzVector>& momenta, bool batch);
+  };
+
+  // Structure-of-arrays vertex positions and covariances for the
+  // batch distance kernels below. The covariance is packed as the
+  // upper triangle: xx, xy, xz, yy, yz, zz.
+  struct vertex_soa {
+    std::vector<double> x, y, z;
+    std::vector<double> cxx, cxy, cxz, cyy, cyz, czz;
+
+    size_t size() const { return x.size(); }
+    void clear();
+    void reserve(size_t n);
+    void push_back(double x_, double y_, double z_, const double* cov);
+    void push_back(const reco::Vertex& v);
+    void push_back(const MFVVertexAux& v);
+  };
+
+  // Results for N pairs at once. sig follows
+  // Measurement1D::significance(). For vertex distances, ok is the
+  // success flag of compatibility() and compat its value; for miss
+  // distances, ok is 0 where the error is undefined (zero miss
+  // distance) and compat is unused.
+  struct distance_batch {
+    std::vector<double> val, err, sig;
+    std::vector<float> compat;
+    std::vector<unsigned char> ok;
+
+    size_t size() const { return val.size(); }
+    void resize(size_t n);
+  };
+
+  // Distance a[i]-b[i] for each i, with the same value, error and
+  // significance as VertexDistanceXY/3D::distance and chi2 as their
+  // compatibility() (see compatibility() above), but no exceptions.
+  // If b has size 1, it is broadcast against every entry of a.
+  void vertex_distances_batch(const vertex_soa& a, const vertex_soa& b, bool use3d, distance_batch& out);
+
+  // miss_dist(v0[i], v1[i], p[i]) for each i, with p given by its
+  // components. v0 or v1 of size 1 is broadcast.
+  void miss_dist_batch(const vertex_soa& v0, const vertex_soa& v1, const std::vector<double>& px, const std::vector<double>& py, const std::vector<double>& pz, distance_batch& out);
+
+  // The beamspot and PV distances of all the vertices in svs, three
+  // batches in all instead of five scalar calls per vertex; see
+  // vertex_distances' batch constructor.
+  struct sv_distances_batch {
+    distance_batch bs2d, pv2d, pv3d;
+
+    sv_distances_batch(const reco::VertexCollection& svs, const reco::BeamSpot& beamspot, const reco::Vertex* primary_vertex);
   };
 
   struct track_cluster {
@@ -35,6 +99,69 @@ namespace mfv {
     size_t size() const { return tracks.size(); }
   };
 
+  // Clustering of a vertex's tracks done once and kept around, so that
+  // clusters for several radii or dcuts don't redo everything through
+  // fastjet. Only the generalized-kt algorithms (kt, Cambridge/Aachen,
+  // anti-kt) with E-scheme recombination are implemented; the
+  // clustering is the usual nearest-neighbour-cached one, which for
+  // the < 50 tracks we have beats any fancier bookkeeping.
+  //
+  // For kt and anti-kt the beam distance makes the sequence depend on
+  // R, so clusters(R) runs the clustering once per R and caches it.
+  // The pairwise merge history (no beam distance, R = 1) is only built
+  // the first time it is needed: for C/A, where inclusive clustering
+  // at R is exactly that history stopped at the first Delta R > R, so
+  // any number of radii cost one clustering, and for
+  // clusters_min_dist.
+  class track_cluster_history {
+  public:
+    track_cluster_history(const MFVVertexAux& v,
+                          fastjet::JetAlgorithm algo_ = fastjet::antikt_algorithm,
+                          double track_mass_ = 0.14);
+
+    const fastjet::JetAlgorithm algo;
+    const double track_mass;
+
+    size_t ntracks() const { return tracks.size(); }
+
+    // as fastjet::sorted_by_pt(ClusterSequence::inclusive_jets())
+    const std::vector<track_cluster>& clusters(double R) const;
+
+    // The clusters left when every pair closer than min_dist has been
+    // merged, sorted by pt, where the distance is the algorithm's d_ij
+    // with R = 1: Delta R^2 scaled by the min of pt^2 (kt) or of
+    // 1/pt^2 (anti-kt), or plain Delta R^2 (C/A, where this is
+    // clusters(sqrt(min_dist))). There is no beam distance, so it is
+    // not ClusterSequence::exclusive_jets(dcut).
+    std::vector<track_cluster> clusters_min_dist(double min_dist) const;
+
+    struct particle {
+      double px, py, pz, E, rap, phi, mom_factor;
+      void set(double px_, double py_, double pz_, double E_, fastjet::JetAlgorithm a);
+    };
+
+    struct merge {
+      size_t a, b; // b merged into a's slot
+      double d;
+    };
+
+  private:
+    std::vector<particle> tracks;
+    mutable bool have_history;
+    mutable std::vector<merge> history_;
+    mutable std::map<double, std::vector<track_cluster>> cache;
+
+    const std::vector<merge>& history() const;
+    std::vector<track_cluster> replay(const std::vector<merge>& merges, size_t nmerges) const;
+    std::vector<track_cluster> replay_below(double d) const;
+  };
+
+  // Empty if track_cluster_history gives the same clusters (by track
+  // membership) as fastjet via track_clusters for v, for each of kt,
+  // C/A and anti-kt at each of Rs, and C/A's clusters_min_dist(R^2)
+  // the same as clusters(R); else which one differs.
+  std::string check_track_cluster_history(const MFVVertexAux& v, const std::vector<double>& Rs);
+
   struct track_clusters {
     track_clusters(const MFVVertexAux& v,
                    double R_ = 0.4,
@@ -42,6 +169,8 @@ namespace mfv {
                    fastjet::RecombinationScheme recomb_scheme_ = fastjet::E_scheme,
                    double track_mass_ = 0.14);
 
+    track_clusters(const track_cluster_history& h, double R_ = 0.4);
+
     const double R;
     const fastjet::JetAlgorithm algo;
     const fastjet::RecombinationScheme recomb_scheme;
@@ -63,41 +192,77 @@ namespace mfv {
 
 // JMTBAD mfv::
 struct MFVVertexAuxSorter {
-  enum sort_by_this { sort_by_mass, sort_by_ntracks, sort_by_ntracks_then_mass };
-  sort_by_this sort_by;
+  // sort_by is one or more keys joined by "_then_", e.g.
+  // "ntracks_then_mass"; later keys break ties in earlier ones, and
+  // what is still tied keeps its input order. Everything sorts
+  // largest first except bs2derr.
+  enum sort_key { key_mass, key_ntracks, key_ntracksptgt3, key_sumpt, key_bs2derr };
+  std::vector<sort_key> keys;
 
   MFVVertexAuxSorter(const std::string& x) {
-    if (x == "mass")
-      sort_by = sort_by_mass;
-    else if (x == "ntracks")
-      sort_by = sort_by_ntracks;
-    else if (x == "ntracks_then_mass")
-      sort_by = sort_by_ntracks_then_mass;
-    else
-      throw cms::Exception("MFVVertexTools") << "invalid sort_by";
+    size_t pos = 0;
+    while (1) {
+      const size_t next = x.find("_then_", pos);
+      const std::string k = x.substr(pos, next == std::string::npos ? std::string::npos : next - pos);
+      if (k == "mass")
+        keys.push_back(key_mass);
+      else if (k == "ntracks")
+        keys.push_back(key_ntracks);
+      else if (k == "ntracksptgt3")
+        keys.push_back(key_ntracksptgt3);
+      else if (k == "sumpt")
+        keys.push_back(key_sumpt);
+      else if (k == "bs2derr")
+        keys.push_back(key_bs2derr);
+      else
+        throw cms::Exception("MFVVertexTools") << "invalid sort_by " << x;
+      if (next == std::string::npos)
+        break;
+      pos = next + 6;
+    }
   }
 
-  static bool by_mass(const MFVVertexAux& a, const MFVVertexAux& b) {
-    return a.mass[0] > b.mass[0];
+  static double key(sort_key k, const MFVVertexAux& v) {
+    switch (k) {
+    case key_mass:         return v.mass[0];
+    case key_ntracks:      return v.ntracks();
+    case key_ntracksptgt3: return v.ntracksptgt(3);
+    case key_sumpt:        return v.sumpt();
+    case key_bs2derr:      return -v.bs2derr;
+    }
+    return 0;
   }
 
-  static bool by_ntracks(const MFVVertexAux& a, const MFVVertexAux& b) {
-    return a.ntracks() > b.ntracks();
-  }
+  // Compute the keys once per vertex, sort indices, then move the
+  // vertices into place in one pass, rather than std::sort comparing
+  // (and recomputing keys for) and swapping whole MFVVertexAux.
+  void sort(MFVVertexAuxCollection& v) const {
+    const size_t n = v.size();
+    const size_t nk = keys.size();
+    if (n < 2)
+      return;
 
-  static bool by_ntracks_then_mass(const MFVVertexAux& a, const MFVVertexAux& b) {
-    if (a.ntracks() == b.ntracks())
-      return a.mass[0] > b.mass[0];
-    return a.ntracks() > b.ntracks();
-  }
+    std::vector<double> k(n * nk);
+    for (size_t i = 0; i < n; ++i)
+      for (size_t j = 0; j < nk; ++j)
+        k[i*nk + j] = key(keys[j], v[i]);
 
-  void sort(MFVVertexAuxCollection& v) const {
-    if (sort_by == sort_by_mass)
-      std::sort(v.begin(), v.end(), by_mass);
-    else if (sort_by == sort_by_ntracks)
-      std::sort(v.begin(), v.end(), by_ntracks);
-    else if (sort_by == sort_by_ntracks_then_mass)
-      std::sort(v.begin(), v.end(), by_ntracks_then_mass);
+    std::vector<size_t> perm(n);
+    for (size_t i = 0; i < n; ++i)
+      perm[i] = i;
+
+    std::sort(perm.begin(), perm.end(), [&](size_t a, size_t b) {
+        for (size_t j = 0; j < nk; ++j)
+          if (k[a*nk + j] != k[b*nk + j])
+            return k[a*nk + j] > k[b*nk + j];
+        return a < b;
+      });
+
+    MFVVertexAuxCollection sorted;
+    sorted.reserve(n);
+    for (size_t i : perm)
+      sorted.push_back(std::move(v[i]));
+    v.swap(sorted);
   }
 };    
 
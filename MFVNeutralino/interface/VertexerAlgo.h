@@ -0,0 +1,489 @@
+#ifndef JMTucker_MFVNeutralino_VertexerAlgo_h
+#define JMTucker_MFVNeutralino_VertexerAlgo_h
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace mfv {
+  struct VertexerParams {
+    int n_tracks_per_seed_vertex = 2;
+    double max_seed_vertex_chi2 = 5;
+    double merge_anyway_dist = -1;
+    double merge_anyway_sig = 3;
+    double merge_shared_dist = -1;
+    double merge_shared_sig = 4;
+    double max_track_vertex_dist = -1;
+    double max_track_vertex_sig = 5;
+    double min_track_vertex_sig_to_remove = 1.5;
+    bool remove_one_track_at_a_time = true;
+    bool verbose = false;
+  };
+
+  // The seeding, track-sharing arbitration and close-merge steps of
+  // MFVVertexer, with everything that needs CMSSW (tracks, fits,
+  // distances) behind Backend so the same code runs in the producer
+  // and in a standalone job, cf. MFVNeutralino/test/VertexerBench.
+  // Backend provides:
+  //
+  //   track_t, vertex_t, pair_eff_t   track_t must be ordered; pair_eff_t looks like VertexerPairEff
+  //   dist_t                          has value() and significance()
+  //   size_t n_seed_tracks()
+  //   track_t seed_track(size_t)
+  //   bool fit(const std::vector<track_t>&, vertex_t&)   true if the fit is valid
+  //   double normalized_chi2(const vertex_t&)
+  //   std::set<track_t> tracks(const vertex_t&, double min_weight)
+  //   dist_t vertex_dist(const vertex_t&, const vertex_t&)
+  //   void vertex_dists(const std::vector<vertex_t>& v, size_t i, std::vector<dist_t>& d)
+  //                                   d[j] = vertex_dist(v[i], v[i+1+j]) for all j, in one go
+  //   std::pair<bool, M> track_dist(track_t, const vertex_t&)
+  //   void set_vertices(pair_eff_t&, const vertex_t&, const vertex_t&)
+  //   unsigned key(track_t)                              just for printouts
+  //
+  // The three steps are separate calls so the caller can look at (or
+  // time) the vertices in between.
+  template <typename Backend>
+  class VertexerAlgo {
+  public:
+    typedef typename Backend::track_t track_t;
+    typedef typename Backend::vertex_t vertex_t;
+    typedef typename Backend::pair_eff_t pair_eff_t;
+    typedef typename Backend::dist_t dist_t;
+    typedef std::set<track_t> track_set;
+    typedef std::vector<vertex_t> vertex_collection;
+    typedef std::vector<std::pair<track_set, track_set>> pair_tracks_t;
+
+    enum { pair_merge=1, pair_erase=2, pair_share=4 }; // same as VertexerPairEff::kind_t
+
+    VertexerAlgo(const VertexerParams& p, Backend& b) : p_(p), b_(b), n_resets_(0), n_onetracks_(0) {}
+
+    int n_resets() const { return n_resets_; }
+    int n_onetracks() const { return n_onetracks_; }
+
+    //////////////////////////////////////////////////////////////////////
+    // Form seed vertices from all pairs of tracks whose vertex fit
+    // passes cuts.
+    //////////////////////////////////////////////////////////////////////
+
+    void seed(vertex_collection& vertices) {
+      const size_t ntk = b_.n_seed_tracks();
+      const int n = p_.n_tracks_per_seed_vertex;
+      if (ntk == 0)
+        return;
+
+      std::vector<size_t> itks(n, 0);
+      std::vector<track_t> tks(n);
+      vertex_t v;
+
+      auto try_seed_vertex = [&]() {
+        for (int i = 0; i < n; ++i)
+          tks[i] = b_.seed_track(itks[i]);
+        if (b_.fit(tks, v) && b_.normalized_chi2(v) < p_.max_seed_vertex_chi2)
+          vertices.push_back(v);
+      };
+
+      // ha
+      for (size_t itk = 0; itk < ntk; ++itk) {
+        itks[0] = itk;
+        for (size_t jtk = itk+1; jtk < ntk; ++jtk) {
+          itks[1] = jtk;
+          if (n == 2) { try_seed_vertex(); continue; }
+          for (size_t ktk = jtk+1; ktk < ntk; ++ktk) {
+            itks[2] = ktk;
+            if (n == 3) { try_seed_vertex(); continue; }
+            for (size_t ltk = ktk+1; ltk < ntk; ++ltk) {
+              itks[3] = ltk;
+              if (n == 4) { try_seed_vertex(); continue; }
+              for (size_t mtk = ltk+1; mtk < ntk; ++mtk) {
+                itks[4] = mtk;
+                try_seed_vertex();
+              }
+            }
+          }
+        }
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////
+    // Take care of track sharing. If a track is in two vertices, and
+    // the vertices are "close", refit the tracks from the two together
+    // as one vertex. If the vertices are not close, keep the track in
+    // the vertex to which it is "closer".
+    //////////////////////////////////////////////////////////////////////
+
+    void arbitrate(vertex_collection& vertices, std::vector<pair_eff_t>& vpeffs, pair_tracks_t& vpeffs_tracks) {
+      const bool verbose = p_.verbose;
+      if (verbose)
+        printf("fun time!\n");
+
+      n_resets_ = 0;
+      n_onetracks_ = 0;
+      typename vertex_collection::iterator v[2];
+      size_t ivtx[2];
+      for (v[0] = vertices.begin(); v[0] != vertices.end(); ++v[0]) {
+        track_set tracks[2];
+        ivtx[0] = v[0] - vertices.begin();
+        tracks[0] = b_.tracks(*v[0], 0.5);
+
+        if (tracks[0].size() < 2) {
+          if (verbose)
+            printf("track-sharing: vertex-0 #%lu is down to one track, junking it\n", ivtx[0]);
+          v[0] = vertices.erase(v[0]) - 1;
+          ++n_onetracks_;
+          continue;
+        }
+
+        bool duplicate = false;
+        bool merge = false;
+        bool refit = false;
+        track_set tracks_to_remove_in_refit[2];
+        pair_eff_t* vpeff = 0;
+        const size_t max_vpeffs_size = 20000; // enough for 200 vertices to share tracks
+
+        for (v[1] = v[0] + 1; v[1] != vertices.end(); ++v[1]) {
+          ivtx[1] = v[1] - vertices.begin();
+          tracks[1] = b_.tracks(*v[1], 0.5);
+
+          if (tracks[1].size() < 2) {
+            if (verbose)
+              printf("track-sharing: vertex-1 #%lu is down to one track, junking it\n", ivtx[1]);
+            v[1] = vertices.erase(v[1]) - 1;
+            ++n_onetracks_;
+            continue;
+          }
+
+          if (verbose) {
+            printf("track-sharing: # vertices = %lu. considering vertices #%lu (chi2/dof %.3f, track set", vertices.size(), ivtx[0], b_.normalized_chi2(*v[0]));
+            print_track_set(tracks[0]);
+            printf(") and #%lu (chi2/dof %.3f, track set", ivtx[1], b_.normalized_chi2(*v[1]));
+            print_track_set(tracks[1]);
+            printf("):\n");
+          }
+
+          if (is_track_subset(tracks[0], tracks[1])) {
+            if (verbose)
+              printf("   subset/duplicate vertices %lu and %lu, erasing second and starting over\n", ivtx[0], ivtx[1]);
+            duplicate = true;
+            break;
+          }
+
+          if (vpeffs.size() < max_vpeffs_size) {
+            std::pair<track_set, track_set> vpeff_tracks(tracks[0], tracks[1]);
+            auto it = std::find(vpeffs_tracks.begin(), vpeffs_tracks.end(), vpeff_tracks);
+            if (it != vpeffs_tracks.end()) {
+              vpeffs.at(it - vpeffs_tracks.begin()).inc_weight();
+              vpeff = 0;
+            }
+            else {
+              vpeffs.push_back(pair_eff_t());
+              vpeff = &vpeffs.back();
+              b_.set_vertices(*vpeff, *v[0], *v[1]);
+              vpeffs_tracks.push_back(vpeff_tracks);
+            }
+          }
+          else
+            vpeff = 0;
+
+          std::vector<track_t> shared_tracks;
+          for (auto tk : tracks[0])
+            if (tracks[1].count(tk) > 0)
+              shared_tracks.push_back(tk);
+
+          if (verbose) {
+            if (shared_tracks.size()) {
+              printf("   shared tracks are: ");
+              print_track_set(shared_tracks);
+              printf("\n");
+            }
+            else
+              printf("   no shared tracks\n");
+          }
+
+          if (shared_tracks.size() > 0) {
+            if (vpeff)
+              vpeff->kind(pair_share);
+
+            auto v_dist = b_.vertex_dist(*v[0], *v[1]);
+            if (verbose)
+              printf("   vertex dist %7.3f  sig %7.3f\n", v_dist.value(), v_dist.significance());
+
+            if (v_dist.value() < p_.merge_shared_dist || v_dist.significance() < p_.merge_shared_sig) {
+              if (verbose) printf("          dist < %7.3f || sig < %7.3f, will try using merge result first before arbitration\n", p_.merge_shared_dist, p_.merge_shared_sig);
+              merge = true;
+            }
+            else
+              refit = true;
+
+            if (verbose) printf("   checking for arbitration refit:\n");
+            for (auto tk : shared_tracks) {
+              auto t_dist_0 = b_.track_dist(tk, *v[0]);
+              auto t_dist_1 = b_.track_dist(tk, *v[1]);
+              if (verbose) {
+                printf("      track-vertex0 dist calc success? %i  dist %7.3f  sig %7.3f\n", t_dist_0.first, t_dist_0.second.value(), t_dist_0.second.significance());
+                printf("      track-vertex1 dist calc success? %i  dist %7.3f  sig %7.3f\n", t_dist_1.first, t_dist_1.second.value(), t_dist_1.second.significance());
+              }
+
+              t_dist_0.first = t_dist_0.first && (t_dist_0.second.value() < p_.max_track_vertex_dist || t_dist_0.second.significance() < p_.max_track_vertex_sig);
+              t_dist_1.first = t_dist_1.first && (t_dist_1.second.value() < p_.max_track_vertex_dist || t_dist_1.second.significance() < p_.max_track_vertex_sig);
+              bool remove_from_0 = !t_dist_0.first;
+              bool remove_from_1 = !t_dist_1.first;
+              if (t_dist_0.second.significance() < p_.min_track_vertex_sig_to_remove && t_dist_1.second.significance() < p_.min_track_vertex_sig_to_remove) {
+                if (tracks[0].size() > tracks[1].size())
+                  remove_from_1 = true;
+                else
+                  remove_from_0 = true;
+              }
+              else if (t_dist_0.second.significance() < t_dist_1.second.significance())
+                remove_from_1 = true;
+              else
+                remove_from_0 = true;
+
+              if (verbose) {
+                printf("   for tk %u:\n", b_.key(tk));
+                printf("      track-vertex0 dist < %7.3f || sig < %7.3f ? %i  remove? %i\n", p_.max_track_vertex_dist, p_.max_track_vertex_sig, t_dist_0.first, remove_from_0);
+                printf("      track-vertex1 dist < %7.3f || sig < %7.3f ? %i  remove? %i\n", p_.max_track_vertex_dist, p_.max_track_vertex_sig, t_dist_1.first, remove_from_1);
+              }
+
+              if (remove_from_0) tracks_to_remove_in_refit[0].insert(tk);
+              if (remove_from_1) tracks_to_remove_in_refit[1].insert(tk);
+
+              if (p_.remove_one_track_at_a_time) {
+                if (verbose)
+                  printf("   arbitrate only one track at a time\n");
+                break;
+              }
+            }
+
+            if (verbose)
+              printf("   breaking to refit\n");
+
+            break;
+          }
+
+          if (verbose) printf("   moving on to next vertex pair.\n");
+        }
+
+        if (duplicate) {
+          vertices.erase(v[1]);
+        }
+        else if (merge) {
+          if (verbose)
+            printf("      before merge, # total vertices = %lu\n", vertices.size());
+
+          track_set tracks_to_fit;
+          for (int i = 0; i < 2; ++i)
+            for (auto tk : tracks[i])
+              tracks_to_fit.insert(tk);
+
+          if (verbose) {
+            printf("   merging vertices %lu and %lu with these tracks:", ivtx[0], ivtx[1]);
+            print_track_set(tracks_to_fit);
+            printf("\n");
+          }
+
+          std::vector<track_t> tks(tracks_to_fit.begin(), tracks_to_fit.end());
+          vertex_collection new_vertices = refit_dropin(tks);
+
+          if (verbose) {
+            printf("      got %lu new vertices out of the av fit\n", new_vertices.size());
+            printf("      these (chi2/dof | track sets):");
+            for (const auto& nv : new_vertices) {
+              printf(" (%.3f | ", b_.normalized_chi2(nv));
+              print_track_set(b_.tracks(nv, 0));
+              printf(" ),");
+            }
+            printf("\n");
+          }
+
+          // If we got two new vertices, maybe it took A B and A C D and made a better one from B C D, and left a broken one A B! C! D!.
+          // If we get one that is truly the merger of the track lists, great. If it is just something like A B , A C -> A B C!, or we get nothing, then default to arbitration.
+          if (new_vertices.size() > 1) {
+            if (verbose)
+              printf("   jiggled again?\n");
+            assert(new_vertices.size() == 2);
+            *v[1] = new_vertices[1];
+            *v[0] = new_vertices[0];
+          }
+          else if (new_vertices.size() == 1 && b_.tracks(new_vertices[0], 0) == tracks_to_fit) {
+            if (verbose)
+              printf("   merge worked!\n");
+
+            if (vpeff)
+              vpeff->kind(pair_merge);
+
+            vertices.erase(v[1]);
+            *v[0] = new_vertices[0]; // ok to use v[0] after the erase(v[1]) because v[0] is by construction before v[1]
+          }
+          else {
+            if (verbose)
+              printf("   merge didn't work, trying arbitration refits\n");
+            refit = true;
+          }
+
+          if (verbose)
+            printf("   vertices size is now %lu\n", vertices.size());
+        }
+
+        if (refit) {
+          bool erase[2] = { false };
+
+          for (int i = 0; i < 2; ++i) {
+            if (tracks_to_remove_in_refit[i].empty())
+              continue;
+
+            if (verbose) {
+              printf("   refit vertex%i %lu with these tracks:", i, ivtx[i]);
+              print_track_set(tracks[i]);
+              printf("   but skip these:");
+              print_track_set(tracks_to_remove_in_refit[i]);
+              printf("\n");
+            }
+
+            std::vector<track_t> tks;
+            for (auto tk : tracks[i])
+              if (tracks_to_remove_in_refit[i].count(tk) == 0)
+                tks.push_back(tk);
+
+            vertex_collection new_vertices = refit_dropin(tks);
+            if (verbose) {
+              printf("      got %lu new vertices out of the av fit for v%i\n", new_vertices.size(), i);
+              printf("      these track sets:");
+              for (const auto& nv : new_vertices) {
+                printf(" (");
+                print_track_set(b_.tracks(nv, 0));
+                printf(" ),");
+              }
+              printf("\n");
+            }
+            if (new_vertices.size() == 1)
+              *v[i] = new_vertices[0];
+            else
+              erase[i] = true;
+          }
+
+          if (vpeff && (erase[0] || erase[1]))
+            vpeff->kind(pair_erase);
+
+          if (erase[1]) vertices.erase(v[1]);
+          if (erase[0]) vertices.erase(v[0]);
+
+          if (verbose)
+            printf("      vertices size is now %lu\n", vertices.size());
+        }
+
+        // If we changed the vertices at all, start loop over completely.
+        if (duplicate || merge || refit) {
+          v[0] = vertices.begin() - 1;  // -1 because about to ++sv
+          ++n_resets_;
+          if (verbose) printf("   resetting from vertices %lu and %lu. # of resets: %i\n", ivtx[0], ivtx[1], n_resets_);
+        }
+      }
+
+      if (verbose)
+        printf("n_resets: %i  n_onetracks: %i  n_noshare_vertices: %lu\n", n_resets_, n_onetracks_, vertices.size());
+    }
+
+    //////////////////////////////////////////////////////////////////////
+    // Merge vertices that are still "close". JMTBAD this doesn't do anything currently.
+    //////////////////////////////////////////////////////////////////////
+
+    void merge(vertex_collection& vertices) {
+      const bool verbose = p_.verbose;
+      if (verbose)
+        printf("fun2!\n");
+
+      typename vertex_collection::iterator v[2];
+      size_t ivtx[2];
+      std::vector<dist_t> dists;
+      for (v[0] = vertices.begin(); v[0] != vertices.end(); ++v[0]) {
+        ivtx[0] = v[0] - vertices.begin();
+        b_.vertex_dists(vertices, ivtx[0], dists);
+
+        bool merge = false;
+        for (v[1] = v[0] + 1; v[1] != vertices.end(); ++v[1]) {
+          ivtx[1] = v[1] - vertices.begin();
+
+          if (verbose)
+            printf("close-merge: # vertices = %lu. considering vertices #%lu (ntk = %lu) and #%lu (ntk = %lu):", vertices.size(), ivtx[0], b_.tracks(*v[0], 0).size(), ivtx[1], b_.tracks(*v[1], 0).size());
+
+          const dist_t& v_dist = dists[ivtx[1] - ivtx[0] - 1];
+          if (verbose)
+            printf("   vertex dist %7.3f  sig %7.3f\n", v_dist.value(), v_dist.significance());
+
+          if (v_dist.value() < p_.merge_anyway_dist || v_dist.significance() < p_.merge_anyway_sig) {
+            if (verbose)
+              printf("          dist < %7.3f || sig < %7.3f, breaking to merge\n", p_.merge_anyway_dist, p_.merge_anyway_sig);
+            merge = true;
+            break;
+          }
+        }
+
+        if (merge) {
+          std::vector<track_t> tks;
+          for (int i = 0; i < 2; ++i)
+            for (auto tk : b_.tracks(*v[i], 0.5))
+              tks.push_back(tk);
+
+          vertex_collection new_vertices = refit_dropin(tks);
+
+          if (verbose) {
+            printf("      got %lu new vertices out of the av fit\n", new_vertices.size());
+            printf("      these track sets:");
+            for (const auto& nv : new_vertices) {
+              printf(" (");
+              print_track_set(b_.tracks(nv, 0));
+              printf(" ),");
+            }
+            printf("\n");
+          }
+        }
+      }
+    }
+
+    // Convenience for the steps in order.
+    void run(vertex_collection& vertices, std::vector<pair_eff_t>& vpeffs, pair_tracks_t& vpeffs_tracks) {
+      seed(vertices);
+      arbitrate(vertices, vpeffs, vpeffs_tracks);
+      merge(vertices);
+    }
+
+  private:
+    // Stand-in for the adaptive vertex reconstructor: one Kalman fit,
+    // dropped if it's bad.
+    vertex_collection refit_dropin(const std::vector<track_t>& tks) {
+      vertex_collection r;
+      if (tks.size() < 2)
+        return r;
+      r.resize(1);
+      b_.fit(tks, r[0]);
+      if (b_.normalized_chi2(r[0]) > 5)
+        r.clear();
+      return r;
+    }
+
+    static bool is_track_subset(const track_set& a, const track_set& b) {
+      const track_set& smaller = a.size() <= b.size() ? a : b;
+      const track_set& bigger  = a.size() <= b.size() ? b : a;
+      for (auto t : smaller)
+        if (bigger.count(t) < 1)
+          return false;
+      return true;
+    }
+
+    template <typename T>
+    void print_track_set(const T& ts) const {
+      for (auto t : ts)
+        printf(" %u", b_.key(t));
+    }
+
+    const VertexerParams p_;
+    Backend& b_;
+    int n_resets_;
+    int n_onetracks_;
+  };
+}
+
+#endif
@@ -19,6 +19,7 @@ class MFVClusterTracksHistos : public edm::EDAnalyzer {
   const edm::EDGetTokenT<MFVVertexAuxCollection> vertex_token;
 
   const double min_dbv;
+  const std::vector<double> check_history_Rs;
 
   TH1F* h_w;
   TH1F* h_nsv;
@@ -44,7 +45,8 @@ MFVClusterTracksHistos::MFVClusterTracksHistos(const edm::ParameterSet& cfg)
   : event_token(consumes<MFVEvent>(cfg.getParameter<edm::InputTag>("event_src"))),
     weight_token(consumes<double>(cfg.getParameter<edm::InputTag>("weight_src"))),
     vertex_token(consumes<MFVVertexAuxCollection>(cfg.getParameter<edm::InputTag>("vertex_src"))),
-    min_dbv(cfg.getParameter<double>("min_dbv"))
+    min_dbv(cfg.getParameter<double>("min_dbv")),
+    check_history_Rs(cfg.getUntrackedParameter<std::vector<double>>("check_history_Rs", std::vector<double>()))
 {
   edm::Service<TFileService> fs;
 
@@ -92,8 +94,15 @@ void MFVClusterTracksHistos::analyze(const edm::Event& event, const edm::EventSe
     h_ntracks->Fill(ntracks, w);
     h_dbv->Fill(dbv, w);
 
+    if (!check_history_Rs.empty()) {
+      const std::string m = mfv::check_track_cluster_history(v, check_history_Rs);
+      if (!m.empty())
+        throw cms::Exception("MFVClusterTracksHistos") << "run " << event.id().run() << " lumi " << event.luminosityBlock() << " event " << event.id().event() << " vertex " << ivtx << ": " << m;
+    }
+
     if (dbv > min_dbv) {
-      const mfv::track_clusters clusters(v);
+      const mfv::track_cluster_history history(v);
+      const mfv::track_clusters clusters(history);
       const size_t nclusters = clusters.size();
       const size_t nsingle = clusters.nsingle();
       const size_t nconstle2 = nsingle + clusters.ndouble();
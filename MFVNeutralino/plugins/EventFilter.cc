@@ -1,10 +1,10 @@
-#include "CommonTools/Utils/interface/StringCutObjectSelector.h"
 #include "DataFormats/PatCandidates/interface/Jet.h"
 #include "DataFormats/PatCandidates/interface/Muon.h"
 #include "DataFormats/PatCandidates/interface/Electron.h"
 #include "FWCore/Framework/interface/EDFilter.h"
 #include "FWCore/Framework/interface/Event.h"
 #include "FWCore/Framework/interface/MakerMacros.h"
+#include "JMTucker/Tools/interface/PatCompiledCuts.h"
 
 class MFVEventFilter : public edm::EDFilter {
 public:
@@ -21,15 +21,15 @@ private:
   const Mode mode;
 
   const edm::EDGetTokenT<pat::JetCollection> jets_token;
-  const StringCutObjectSelector<pat::Jet> jet_selector;
+  const jmt::CutSelector<pat::Jet> jet_selector;
   const int min_njets;
   const double min_pt_for_ht;
   const double min_ht;
   const edm::EDGetTokenT<pat::MuonCollection> muons_token;
-  const StringCutObjectSelector<pat::Muon> muon_selector;
+  const jmt::CutSelector<pat::Muon> muon_selector;
   const double min_muon_pt;
   const edm::EDGetTokenT<pat::ElectronCollection> electrons_token;
-  const StringCutObjectSelector<pat::Electron> electron_selector;
+  const jmt::CutSelector<pat::Electron> electron_selector;
   const double min_electron_pt;
   const int min_nleptons;
   const bool debug;
@@ -1,4 +1,3 @@
-#include "CommonTools/Utils/interface/StringCutObjectSelector.h"
 #include "DataFormats/Common/interface/TriggerResults.h"
 #include "DataFormats/JetReco/interface/PFJetCollection.h"
 #include "DataFormats/BeamSpot/interface/BeamSpot.h"
@@ -14,6 +13,7 @@
 #include "FWCore/Framework/interface/EDProducer.h"
 #include "FWCore/Framework/interface/Event.h"
 #include "FWCore/Framework/interface/MakerMacros.h"
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
 #include "PhysicsTools/SelectorUtils/interface/JetIDSelectionFunctor.h"
 #include "RecoEgamma/EgammaTools/interface/EffectiveAreas.h"
 #include "SimDataFormats/GeneratorProducts/interface/GenEventInfoProduct.h"
@@ -23,6 +23,7 @@
 #include "JMTucker/MFVNeutralinoFormats/interface/TriggerFloats.h"
 #include "JMTucker/MFVNeutralino/interface/EventTools.h"
 #include "JMTucker/Tools/interface/GenUtilities.h"
+#include "JMTucker/Tools/interface/PatCompiledCuts.h"
 #include "JMTucker/Tools/interface/TriggerHelper.h"
 #include "JMTucker/Tools/interface/Utilities.h"
 
@@ -30,6 +31,7 @@ class MFVEventProducer : public edm::EDProducer {
 public:
   explicit MFVEventProducer(const edm::ParameterSet&);
   void produce(edm::Event&, const edm::EventSetup&);
+  void endJob();
 
 private:
   const bool input_is_miniaod;
@@ -54,9 +56,10 @@ private:
   const edm::EDGetTokenT<reco::TrackCollection> vertex_seed_tracks_token;
   const std::string b_discriminator;
   const std::vector<double> b_discriminator_mins;
-  std::vector<StringCutObjectSelector<pat::Muon>> muon_selectors;
-  std::vector<StringCutObjectSelector<pat::Electron>> electron_EB_selectors;
-  std::vector<StringCutObjectSelector<pat::Electron>> electron_EE_selectors;
+  const bool check_selectors;
+  std::vector<jmt::CutSelector<pat::Muon>> muon_selectors;
+  std::vector<jmt::CutSelector<pat::Electron>> electron_EB_selectors;
+  std::vector<jmt::CutSelector<pat::Electron>> electron_EE_selectors;
   EffectiveAreas electron_effective_areas;
   std::vector<edm::EDGetTokenT<double>> misc_tokens;
   const bool lightweight;
@@ -64,9 +67,10 @@ private:
 
 namespace {
   template <typename T>
-  std::vector<StringCutObjectSelector<T>> cuts2selectors(const std::vector<std::string>& cuts) {
-    std::vector<StringCutObjectSelector<T>> ret;
-    for (auto cut : cuts) ret.push_back(StringCutObjectSelector<T>(cut));
+  std::vector<jmt::CutSelector<T>> cuts2selectors(const std::vector<std::string>& cuts, const bool check) {
+    std::vector<jmt::CutSelector<T>> ret;
+    for (auto cut : cuts)
+      ret.push_back(jmt::CutSelector<T>(cut, check));
     return ret;
   }
 }
@@ -94,9 +98,10 @@ MFVEventProducer::MFVEventProducer(const edm::ParameterSet& cfg)
     vertex_seed_tracks_token(consumes<reco::TrackCollection>(cfg.getParameter<edm::InputTag>("vertex_seed_tracks_src"))),
     b_discriminator(cfg.getParameter<std::string>("b_discriminator")),
     b_discriminator_mins(cfg.getParameter<std::vector<double> >("b_discriminator_mins")),
-    muon_selectors(cuts2selectors<pat::Muon>(cfg.getParameter<std::vector<std::string>>("muon_cuts"))),
-    electron_EB_selectors(cuts2selectors<pat::Electron>(cfg.getParameter<std::vector<std::string>>("electron_EB_cuts"))),
-    electron_EE_selectors(cuts2selectors<pat::Electron>(cfg.getParameter<std::vector<std::string>>("electron_EE_cuts"))),
+    check_selectors(cfg.getUntrackedParameter<bool>("check_selectors", false)),
+    muon_selectors(cuts2selectors<pat::Muon>(cfg.getParameter<std::vector<std::string>>("muon_cuts"), check_selectors)),
+    electron_EB_selectors(cuts2selectors<pat::Electron>(cfg.getParameter<std::vector<std::string>>("electron_EB_cuts"), check_selectors)),
+    electron_EE_selectors(cuts2selectors<pat::Electron>(cfg.getParameter<std::vector<std::string>>("electron_EE_cuts"), check_selectors)),
     electron_effective_areas(cfg.getParameter<edm::FileInPath>("electron_effective_areas").fullPath()),
     lightweight(cfg.getParameter<bool>("lightweight"))
 {
@@ -401,7 +406,7 @@ void MFVEventProducer::produce(edm::Event& event, const edm::EventSetup& setup)
   
   for (const pat::Electron& electron : *electrons) {
     if (!electron.isEB() && !electron.isEE()) continue;
-    auto electron_selectors = electron.isEB() ? electron_EB_selectors : electron_EE_selectors;
+    const auto& electron_selectors = electron.isEB() ? electron_EB_selectors : electron_EE_selectors;
 
     MFVEvent::lep_id_t id = 0;
     for (int i = 0, ie = electron_selectors.size(); i < ie; ++i) {
@@ -543,4 +548,16 @@ void MFVEventProducer::produce(edm::Event& event, const edm::EventSetup& setup)
   event.put(std::move(mevent));
 }
 
+void MFVEventProducer::endJob() {
+  if (!check_selectors)
+    return;
+
+  std::ostringstream out;
+  out << "MFVEventProducer selector timing:\n";
+  for (const auto& s : muon_selectors)        { out << "muon "; s.report(out); }
+  for (const auto& s : electron_EB_selectors) { out << "EB electron "; s.report(out); }
+  for (const auto& s : electron_EE_selectors) { out << "EE electron "; s.report(out); }
+  edm::LogVerbatim("MFVEventProducer") << out.str();
+}
+
 DEFINE_FWK_MODULE(MFVEventProducer);
@@ -11,6 +11,7 @@
 #include "FWCore/Framework/interface/MakerMacros.h"
 #include "FWCore/ServiceRegistry/interface/Service.h"
 #include "SimGeneral/HepPDTRecord/interface/ParticleDataTable.h"
+#include "JMTucker/Formats/interface/GenDecayGraph.h"
 #include "JMTucker/MFVNeutralinoFormats/interface/MCInteractions.h"
 #include "JMTucker/Tools/interface/BasicKinematicHists.h"
 #include "JMTucker/Tools/interface/GenUtilities.h"
@@ -26,6 +27,7 @@ private:
   const edm::EDGetTokenT<reco::GenJetCollection> gen_jet_token;
   const edm::EDGetTokenT<std::vector<double>> gen_vertex_token;
   const edm::EDGetTokenT<mfv::MCInteraction> mci_token;
+  const edm::EDGetTokenT<jmt::GenDecayGraph> gen_decay_graph_token;
   bool mci_warned;
 
   edm::ESHandle<ParticleDataTable> pdt;
@@ -141,6 +143,7 @@ MFVGenHistos::MFVGenHistos(const edm::ParameterSet& cfg)
     gen_jet_token(consumes<reco::GenJetCollection>(cfg.getParameter<edm::InputTag>("gen_jet_src"))),
     gen_vertex_token(consumes<std::vector<double>>(cfg.getParameter<edm::InputTag>("gen_vertex_src"))),
     mci_token(consumes<mfv::MCInteraction>(cfg.getParameter<edm::InputTag>("mci_src"))),
+    gen_decay_graph_token(consumes<jmt::GenDecayGraph>(cfg.getParameter<edm::InputTag>("gen_decay_graph_src"))),
 
     mci_warned(false)
 {
@@ -468,6 +471,10 @@ void MFVGenHistos::analyze(const edm::Event& event, const edm::EventSetup& setup
   edm::Handle<mfv::MCInteraction> mci;
   event.getByToken(mci_token, mci);
 
+  edm::Handle<jmt::GenDecayGraph> graph;
+  event.getByToken(gen_decay_graph_token, graph);
+  graph->check(gen_particles);
+
   edm::Handle<std::vector<double>> gen_vertex;
   event.getByToken(gen_vertex_token, gen_vertex);
   const double x0 = (*gen_vertex)[0];
@@ -665,39 +672,44 @@ void MFVGenHistos::analyze(const edm::Event& event, const edm::EventSetup& setup
   std::vector<int> bquarks_ids;
   std::vector<double> bquarks_eta;
   std::vector<double> bquarks_phi;
-  for (const reco::GenParticle& gen : *gen_particles) {
-    if (abs(gen.pdgId()) == 5) {
-      bool has_b_dau = false;
-      for (size_t i = 0, ie = gen.numberOfDaughters(); i < ie; ++i) {
-        if (abs(gen.daughter(i)->pdgId()) == 5) {
-          has_b_dau = true;
-          break;
-        }
+  for (int ib : graph->with_abs_id(5)) {
+    bool has_b_dau = false;
+    for (int d : graph->daughters(ib)) {
+      if (abs(graph->pdgId(d)) == 5) {
+        has_b_dau = true;
+        break;
       }
-      if (!has_b_dau) {
-        ++nbquarks;
-        h_bquarks_pt->Fill(gen.pt());
-        h_bquarks_eta->Fill(gen.eta());
-        h_bquarks_phi->Fill(gen.phi());
-        h_bquarks_energy->Fill(gen.energy());
-        bquarks_ids.push_back(gen.pdgId());
-        bquarks_eta.push_back(gen.eta());
-        bquarks_phi.push_back(gen.phi());
-        if (gen.pt() > min_b_pt && fabs(gen.eta()) < max_b_eta) {
-          ++nbquarks_wcuts;
-        }
+    }
+    if (!has_b_dau) {
+      const reco::GenParticle& gen = gen_particles->at(ib);
+      ++nbquarks;
+      h_bquarks_pt->Fill(gen.pt());
+      h_bquarks_eta->Fill(gen.eta());
+      h_bquarks_phi->Fill(gen.phi());
+      h_bquarks_energy->Fill(gen.energy());
+      bquarks_ids.push_back(gen.pdgId());
+      bquarks_eta.push_back(gen.eta());
+      bquarks_phi.push_back(gen.phi());
+      if (gen.pt() > min_b_pt && fabs(gen.eta()) < max_b_eta) {
+        ++nbquarks_wcuts;
       }
     }
+  }
+
+  const jmt::GenDecayGraph::mask_t bhadrons = graph->mask([&](int i) { return is_bhadron(graph->pdgId(i)); });
+  const jmt::GenDecayGraph::mask_t chadrons = graph->mask([&](int i) { return is_chadron(graph->pdgId(i)); });
 
-    if (is_bhadron(&gen)) {
+  for (int i = 0, ie = graph->size(); i < ie; ++i) {
+    if (is_bhadron(graph->pdgId(i))) {
       bool has_b_mom = false;
-      for (size_t i = 0, ie = gen.numberOfMothers(); i < ie; ++i) {
-        if (is_bhadron(gen.mother(i))) {
+      for (int m : graph->mothers(i)) {
+        if (is_bhadron(graph->pdgId(m))) {
           has_b_mom = true;
           break;
         }
       }
       if (!has_b_mom) {
+        const reco::GenParticle& gen = gen_particles->at(i);
         ++nbhadrons;
         if (gen.pt() > min_b_pt && fabs(gen.eta()) < max_b_eta) {
           ++nbhadrons_wcuts;
@@ -741,7 +753,7 @@ void MFVGenHistos::analyze(const edm::Event& event, const edm::EventSetup& setup
       ++njets60;
 
     int nchg = 0;
-    int id = gen_jet_id(jet);
+    int id = gen_jet_id(jet, *graph, *gen_particles, bhadrons, chadrons);
     int ntracksptgt3 = 0;
     for (const reco::GenParticle* g : jet.getGenConstituents()) {
       if (g->charge())
@@ -1,5 +1,6 @@
 // JMTBAD unify try_XX4j/MFVdijet/MFVlq and try_MFVtbs/uds
 
+#include <algorithm>
 #include "CommonTools/UtilAlgos/interface/TFileService.h"
 #include "DataFormats/BeamSpot/interface/BeamSpot.h"
 #include "DataFormats/HepMCCandidate/interface/GenParticle.h"
@@ -10,6 +11,7 @@
 #include "FWCore/Framework/interface/Frameworkfwd.h"
 #include "FWCore/Framework/interface/MakerMacros.h"
 #include "FWCore/ServiceRegistry/interface/Service.h"
+#include "JMTucker/Formats/interface/GenDecayGraph.h"
 #include "JMTucker/Tools/interface/GenUtilities.h"
 #include "JMTucker/Tools/interface/Utilities.h"
 #include "JMTucker/MFVNeutralinoFormats/interface/MCInteractions.h"
@@ -28,15 +30,15 @@ private:
   const bool histos;
   int lsp_id;
 
-  void set_Ttbar_decay(mfv::MCInteractionHolderTtbar&, const edm::Handle<reco::GenParticleCollection>&) const;
+  void set_Ttbar_decay(mfv::MCInteractionHolderTtbar&, const edm::Handle<reco::GenParticleCollection>&, const jmt::GenDecayGraph&) const;
 
-  bool try_MFVtbs      (mfv::MCInteraction&, const edm::Handle<reco::GenParticleCollection>&, int t1, int t2) const;
-  bool try_Ttbar       (mfv::MCInteraction&, const edm::Handle<reco::GenParticleCollection>&) const;
-  bool try_MFVthree    (mfv::MCInteraction&, const edm::Handle<reco::GenParticleCollection>&, int t1, int t2, int t3) const;
-  bool try_XX4j        (mfv::MCInteraction&, const edm::Handle<reco::GenParticleCollection>&) const;
-  bool try_MFVdijet    (mfv::MCInteraction&, const edm::Handle<reco::GenParticleCollection>&, int quark) const;
-  bool try_stopdbardbar(mfv::MCInteraction&, const edm::Handle<reco::GenParticleCollection>&, int quark) const;
-  bool try_MFVlq       (mfv::MCInteraction&, const edm::Handle<reco::GenParticleCollection>&) const;
+  bool try_MFVtbs      (mfv::MCInteraction&, const edm::Handle<reco::GenParticleCollection>&, const jmt::GenDecayGraph&, int t1, int t2) const;
+  bool try_Ttbar       (mfv::MCInteraction&, const edm::Handle<reco::GenParticleCollection>&, const jmt::GenDecayGraph&) const;
+  bool try_MFVthree    (mfv::MCInteraction&, const edm::Handle<reco::GenParticleCollection>&, const jmt::GenDecayGraph&, int t1, int t2, int t3) const;
+  bool try_XX4j        (mfv::MCInteraction&, const edm::Handle<reco::GenParticleCollection>&, const jmt::GenDecayGraph&) const;
+  bool try_MFVdijet    (mfv::MCInteraction&, const edm::Handle<reco::GenParticleCollection>&, const jmt::GenDecayGraph&, int quark) const;
+  bool try_stopdbardbar(mfv::MCInteraction&, const edm::Handle<reco::GenParticleCollection>&, const jmt::GenDecayGraph&, int quark) const;
+  bool try_MFVlq       (mfv::MCInteraction&, const edm::Handle<reco::GenParticleCollection>&, const jmt::GenDecayGraph&) const;
 
   TH1F* h_valid;
   TH1F* h_pos_check;
@@ -53,6 +55,7 @@ MFVGenParticles::MFVGenParticles(const edm::ParameterSet& cfg)
   produces<mfv::MCInteraction>();
   produces<std::vector<double>>("genVertex"); // generated primary vertex
   produces<std::vector<double>>("decays"); // decay positions
+  produces<jmt::GenDecayGraph>("decayGraph"); // index of the gen_particles mother/daughter links, for downstream ancestry queries
 
   // these for event display
   produces<reco::GenParticleCollection>("primaries");
@@ -66,7 +69,7 @@ MFVGenParticles::MFVGenParticles(const edm::ParameterSet& cfg)
   }
 }
 
-void MFVGenParticles::set_Ttbar_decay(mfv::MCInteractionHolderTtbar& mc, const edm::Handle<reco::GenParticleCollection>& gen_particles) const {
+void MFVGenParticles::set_Ttbar_decay(mfv::MCInteractionHolderTtbar& mc, const edm::Handle<reco::GenParticleCollection>& gen_particles, const jmt::GenDecayGraph& graph) const {
   if (debug) printf("MFVGenParticles::set_Ttbar_decay\n");
 
   if (mc.tops[0].isNull() || mc.tops[1].isNull() ||
@@ -83,8 +86,8 @@ void MFVGenParticles::set_Ttbar_decay(mfv::MCInteractionHolderTtbar& mc, const e
   for (int which = 0; which < 2; ++which) {
     // Find the Ws and bs from top decay. Bottom or bottombar might
     // not be there, since |Vtb| isn't exactly 1.
-    mc.Ws     [which] = gen_ref(daughter_with_id(mc.tops[which], sgn(mc.tops[which]->pdgId()) * 24), gen_particles);
-    mc.bottoms[which] = gen_ref(daughter_with_id(mc.tops[which], sgn(mc.tops[which]->pdgId()) *  5), gen_particles);
+    mc.Ws     [which] = gen_ref(graph.daughter_with_id(mc.tops[which].key(), sgn(mc.tops[which]->pdgId()) * 24), gen_particles);
+    mc.bottoms[which] = gen_ref(graph.daughter_with_id(mc.tops[which].key(), sgn(mc.tops[which]->pdgId()) *  5), gen_particles);
 
     if (mc.Ws[which].isNull())
       throw cms::Exception("BadAssumption") << "W #" << which << " not found";
@@ -92,7 +95,7 @@ void MFVGenParticles::set_Ttbar_decay(mfv::MCInteractionHolderTtbar& mc, const e
     // The W may have a lot of copies, but the copies should always
     // have just one daughter until we reach the actual W decay (qq'
     // or lnu). Find the last one.
-    mc.Ws[which] = gen_ref(final_candidate(mc.Ws[which], -1), gen_particles);
+    mc.Ws[which] = gen_ref(graph.final_copy(mc.Ws[which].key(), -1), gen_particles);
     if (mc.Ws[which]->numberOfDaughters() < 2)
       throw cms::Exception("BadAssumption") << "W #" << which << " did not have at least two daughters: id " << mc.Ws[which]->pdgId() << " numDau " << mc.Ws[which]->numberOfDaughters();
 
@@ -101,9 +104,9 @@ void MFVGenParticles::set_Ttbar_decay(mfv::MCInteractionHolderTtbar& mc, const e
     // grab it, trying strange and down in turn. Client code has to
     // check if "bottoms[which]" was actually a bottom if needed.
     if (mc.bottoms[which].isNull()) {
-      mc.bottoms[which]   = gen_ref(daughter_with_id(mc.tops[which], sgn(mc.tops[which]->pdgId()) * 3), gen_particles);
+      mc.bottoms[which]   = gen_ref(graph.daughter_with_id(mc.tops[which].key(), sgn(mc.tops[which]->pdgId()) * 3), gen_particles);
       if (mc.bottoms[which].isNull()) {
-	mc.bottoms[which] = gen_ref(daughter_with_id(mc.tops[which], sgn(mc.tops[which]->pdgId()) * 1), gen_particles);
+	mc.bottoms[which] = gen_ref(graph.daughter_with_id(mc.tops[which].key(), sgn(mc.tops[which]->pdgId()) * 1), gen_particles);
 	if (mc.bottoms[which].isNull())
           throw cms::Exception("BadAssumption", "could not find down-type quark from top #") << which;
       }
@@ -112,7 +115,7 @@ void MFVGenParticles::set_Ttbar_decay(mfv::MCInteractionHolderTtbar& mc, const e
     // Get the final copy for the bottom. -1 means anything goes (seen
     // hadronization products instead of just gluons and photons in
     // one event).
-    mc.bottoms[which] = gen_ref(final_candidate(mc.bottoms[which], -1), gen_particles);
+    mc.bottoms[which] = gen_ref(graph.final_copy(mc.bottoms[which].key(), -1), gen_particles);
 
     // Find the W daughters, and store them in the order (down-type
     // quark, up-type quark) or (charged lepton, neutrino).
@@ -131,8 +134,8 @@ void MFVGenParticles::set_Ttbar_decay(mfv::MCInteractionHolderTtbar& mc, const e
       throw cms::Exception("BadAssumption") << "W #" << which << " daughter refs not found";
 
     // Finalize the W daughters.
-    mc.W_daughters[which][0] = gen_ref(final_candidate(mc.W_daughters[which][0], -1), gen_particles);
-    mc.W_daughters[which][1] = gen_ref(final_candidate(mc.W_daughters[which][1], -1), gen_particles);
+    mc.W_daughters[which][0] = gen_ref(graph.final_copy(mc.W_daughters[which][0].key(), -1), gen_particles);
+    mc.W_daughters[which][1] = gen_ref(graph.final_copy(mc.W_daughters[which][1].key(), -1), gen_particles);
 
     if (is_quark(mc.W_daughters[which][0])) {
       if (!is_quark(mc.W_daughters[which][1]))
@@ -155,7 +158,7 @@ void MFVGenParticles::set_Ttbar_decay(mfv::MCInteractionHolderTtbar& mc, const e
   }
 }
 
-bool MFVGenParticles::try_MFVtbs(mfv::MCInteraction& mc, const edm::Handle<reco::GenParticleCollection>& gen_particles, int t1, int t2) const {
+bool MFVGenParticles::try_MFVtbs(mfv::MCInteraction& mc, const edm::Handle<reco::GenParticleCollection>& gen_particles, const jmt::GenDecayGraph& graph, int t1, int t2) const {
   if (debug) printf("MFVGenParticles::try_MFVtbs\n");
 
   assert(t1 == 5 || t1 == 1);
@@ -173,9 +176,9 @@ bool MFVGenParticles::try_MFVtbs(mfv::MCInteraction& mc, const edm::Handle<reco:
   // Find the LSPs (e.g. gluinos or neutralinos). Since this is
   // PYTHIA8 there are lots of copies -- try to get the ones that
   // decay to the three quarks.
-  for (int i = 0, ie = int(gen_particles->size()); i < ie; ++i) {
+  for (int i : graph.with_id(lsp_id)) {
     const reco::GenParticle& gen = gen_particles->at(i);
-    if (gen.pdgId() != lsp_id || gen.numberOfDaughters() != 3)
+    if (gen.numberOfDaughters() != 3)
       continue;
     reco::GenParticleRef lsp(gen_particles, i);
 
@@ -209,13 +212,13 @@ bool MFVGenParticles::try_MFVtbs(mfv::MCInteraction& mc, const edm::Handle<reco:
               }
       }
 
-      h.tops           [which] = gen_ref(daughter_with_id(&*lsp, 6,  true), gen_particles);
+      h.tops           [which] = gen_ref(graph.daughter_with_id(i, 6,  true), gen_particles);
     }
     else {
       // The last true param of daughter_with_id means take absolute value, so that e.g. strange or antistrange is OK.
-      h.stranges       [which] = gen_ref(daughter_with_id(&*lsp, t1, true), gen_particles);
-      h.primary_bottoms[which] = gen_ref(daughter_with_id(&*lsp, t2, true), gen_particles);
-      h.tops           [which] = gen_ref(daughter_with_id(&*lsp, 6,  true), gen_particles);
+      h.stranges       [which] = gen_ref(graph.daughter_with_id(i, t1, true), gen_particles);
+      h.primary_bottoms[which] = gen_ref(graph.daughter_with_id(i, t2, true), gen_particles);
+      h.tops           [which] = gen_ref(graph.daughter_with_id(i, 6,  true), gen_particles);
     }
 
     if (debug) {
@@ -235,9 +238,9 @@ bool MFVGenParticles::try_MFVtbs(mfv::MCInteraction& mc, const edm::Handle<reco:
     // The -1 in final_candidate for the tops used to be 3 for
     // allowing radiated gluons or photons but with official sample
     // pythia got a top that had protons and pions and kaons oh my 42/-6 111/21 112/21 113/21 121/2212 122/2212 123/2212 124/2212 157/310 158/310
-    h.stranges       [which] = gen_ref(final_candidate(h.stranges       [which], -1), gen_particles);
-    h.primary_bottoms[which] = gen_ref(final_candidate(h.primary_bottoms[which], -1), gen_particles);
-    h.tops           [which] = gen_ref(final_candidate(h.tops           [which], -1), gen_particles);
+    h.stranges       [which] = gen_ref(graph.final_copy(h.stranges       [which].key(), -1), gen_particles);
+    h.primary_bottoms[which] = gen_ref(graph.final_copy(h.primary_bottoms[which].key(), -1), gen_particles);
+    h.tops           [which] = gen_ref(graph.final_copy(h.tops           [which].key(), -1), gen_particles);
 
     if (debug) {
       gpp.Print(h.stranges[which], "strange");
@@ -257,7 +260,7 @@ bool MFVGenParticles::try_MFVtbs(mfv::MCInteraction& mc, const edm::Handle<reco:
       h.lsps[1].isNull() || h.stranges[1].isNull() || h.primary_bottoms[1].isNull() || h.tops[1].isNull())
     return false;
 
-  set_Ttbar_decay(h, gen_particles);
+  set_Ttbar_decay(h, gen_particles, graph);
   
   if (h.valid()) {
     mc.set(h, type);
@@ -267,28 +270,27 @@ bool MFVGenParticles::try_MFVtbs(mfv::MCInteraction& mc, const edm::Handle<reco:
     return false;
 }
 
-bool MFVGenParticles::try_Ttbar(mfv::MCInteraction& mc, const edm::Handle<reco::GenParticleCollection>& gen_particles) const {
+bool MFVGenParticles::try_Ttbar(mfv::MCInteraction& mc, const edm::Handle<reco::GenParticleCollection>& gen_particles, const jmt::GenDecayGraph& graph) const {
   if (debug) printf("MFVGenParticles::try_Ttbar\n");
 
   mfv::MCInteractionHolderTtbar h;
 
-  for (size_t i = 0, ie = gen_particles->size(); i < ie; ++i) {    
-    reco::GenParticleRef r(gen_particles, i);
-    const int id = r->pdgId();
-    if      (id ==  6) h.tops[0] = r;
-    else if (id == -6) h.tops[1] = r;
+  for (int which = 0; which < 2; ++which) {
+    const jmt::GenDecayGraph::index_range tops = graph.with_id(which == 0 ? 6 : -6);
+    if (!tops.empty())
+      h.tops[which] = reco::GenParticleRef(gen_particles, *(tops.end() - 1));
   }
 
   if (h.tops[0].isNonnull() && h.tops[1].isNonnull()) {
-    h.tops[0] = gen_ref(final_candidate(h.tops[0], -1), gen_particles);
-    h.tops[1] = gen_ref(final_candidate(h.tops[1], -1), gen_particles);
+    h.tops[0] = gen_ref(graph.final_copy(h.tops[0].key(), -1), gen_particles);
+    h.tops[1] = gen_ref(graph.final_copy(h.tops[1].key(), -1), gen_particles);
 
     if (last_flag_check) {
       assert(h.tops[0]->statusFlags().isLastCopy());
       assert(h.tops[1]->statusFlags().isLastCopy());
     }
 
-    set_Ttbar_decay(h, gen_particles);
+    set_Ttbar_decay(h, gen_particles, graph);
   }
 
   if (h.valid()) {
@@ -299,7 +301,7 @@ bool MFVGenParticles::try_Ttbar(mfv::MCInteraction& mc, const edm::Handle<reco::
     return false;
 }
 
-bool MFVGenParticles::try_MFVthree(mfv::MCInteraction& mc, const edm::Handle<reco::GenParticleCollection>& gen_particles, int t1, int t2, int t3) const {
+bool MFVGenParticles::try_MFVthree(mfv::MCInteraction& mc, const edm::Handle<reco::GenParticleCollection>& gen_particles, const jmt::GenDecayGraph& graph, int t1, int t2, int t3) const {
   if (debug) printf("MFVGenParticles::try_MFVthree %i %i %i\n", t1, t2, t3);
 
   mfv::MCInteractions_t type = mfv::mci_invalid;
@@ -349,9 +351,9 @@ bool MFVGenParticles::try_MFVthree(mfv::MCInteraction& mc, const edm::Handle<rec
   // Find the LSPs (e.g. gluinos or neutralinos). Since this is
   // PYTHIA8 there are lots of copies -- try to get the ones that
   // decay to the three quarks.
-  for (int i = 0, ie = int(gen_particles->size()); i < ie; ++i) {
+  for (int i : graph.with_id(lsp_id)) {
     const reco::GenParticle& gen = gen_particles->at(i);
-    if (gen.pdgId() != lsp_id || gen.numberOfDaughters() != 3)
+    if (gen.numberOfDaughters() != 3)
       continue;
     reco::GenParticleRef lsp(gen_particles, i);
 
@@ -396,9 +398,9 @@ bool MFVGenParticles::try_MFVthree(mfv::MCInteraction& mc, const edm::Handle<rec
     }
     else {
       // The last true param of daughter_with_id means take absolute value, so that e.g. strange or antistrange is OK.
-      h.s[which][0] = gen_ref(daughter_with_id(&*lsp, t1, true), gen_particles);
-      h.s[which][1] = gen_ref(daughter_with_id(&*lsp, t2, true), gen_particles);
-      h.s[which][2] = gen_ref(daughter_with_id(&*lsp, t3, true), gen_particles);
+      h.s[which][0] = gen_ref(graph.daughter_with_id(i, t1, true), gen_particles);
+      h.s[which][1] = gen_ref(graph.daughter_with_id(i, t2, true), gen_particles);
+      h.s[which][2] = gen_ref(graph.daughter_with_id(i, t3, true), gen_particles);
     }
 
     if (debug) {
@@ -416,7 +418,7 @@ bool MFVGenParticles::try_MFVthree(mfv::MCInteraction& mc, const edm::Handle<rec
     // allowing radiated gluons or photons but with official sample
     // pythia got a top that had protons and pions and kaons oh my 42/-6 111/21 112/21 113/21 121/2212 122/2212 123/2212 124/2212 157/310 158/310
     for (int j = 0; j < 3; ++j)
-      h.s[which][j] = gen_ref(final_candidate(h.s[which][j], -1), gen_particles);
+      h.s[which][j] = gen_ref(graph.final_copy(h.s[which][j].key(), -1), gen_particles);
 
     if (debug) {
       gpp.Print(&*h.s[which][0], "s0");
@@ -439,17 +441,21 @@ bool MFVGenParticles::try_MFVthree(mfv::MCInteraction& mc, const edm::Handle<rec
     return false;
 }
 
-bool MFVGenParticles::try_XX4j(mfv::MCInteraction& mc, const edm::Handle<reco::GenParticleCollection>& gen_particles) const {
+bool MFVGenParticles::try_XX4j(mfv::MCInteraction& mc, const edm::Handle<reco::GenParticleCollection>& gen_particles, const jmt::GenDecayGraph& graph) const {
   if (debug) printf("MFVGenParticles::try_XX4j\n");
 
   mfv::MCInteractionHolderXX4j h;
 
   // Find the H and the A. Start from the end and get the last ones,
   // they should be the ones that go to the pairs of quarks.
-  for (int i = int(gen_particles->size()) - 1; i >= 0; --i) {
+  const jmt::GenDecayGraph::index_range Hs = graph.with_id(35), As = graph.with_id(36);
+  std::vector<int> cands(Hs.size() + As.size());
+  std::merge(Hs.begin(), Hs.end(), As.begin(), As.end(), cands.begin());
+  for (auto it = cands.rbegin(); it != cands.rend(); ++it) {
+    const int i = *it;
     const reco::GenParticle& gen = gen_particles->at(i);
     const int id = gen.pdgId();
-    if ((id != 35 && id != 36) || gen.numberOfDaughters() != 2)
+    if (gen.numberOfDaughters() != 2)
       continue;
     const int aid0 = abs(gen.daughter(0)->pdgId());
     const int aid1 = abs(gen.daughter(1)->pdgId());
@@ -464,8 +470,8 @@ bool MFVGenParticles::try_XX4j(mfv::MCInteraction& mc, const edm::Handle<reco::G
     h.decay_id[which] = aid0;
 
     const int which2(h.p[which]->daughter(0)->pdgId() > 0);
-    h.s[which][0] = gen_ref(final_candidate(h.p[which]->daughter(!which2), 3), gen_particles);
-    h.s[which][1] = gen_ref(final_candidate(h.p[which]->daughter( which2), 3), gen_particles);
+    h.s[which][0] = gen_ref(graph.final_copy(graph.index(h.p[which]->daughter(!which2), *gen_particles), 3), gen_particles);
+    h.s[which][1] = gen_ref(graph.final_copy(graph.index(h.p[which]->daughter( which2), *gen_particles), 3), gen_particles);
 
 //    if (last_flag_check) {
 //      assert(h.p[which]   ->statusFlags().isLastCopy());
@@ -482,7 +488,7 @@ bool MFVGenParticles::try_XX4j(mfv::MCInteraction& mc, const edm::Handle<reco::G
     return false;
 }
 
-bool MFVGenParticles::try_MFVdijet(mfv::MCInteraction& mc, const edm::Handle<reco::GenParticleCollection>& gen_particles, int quark) const {
+bool MFVGenParticles::try_MFVdijet(mfv::MCInteraction& mc, const edm::Handle<reco::GenParticleCollection>& gen_particles, const jmt::GenDecayGraph& graph, int quark) const {
   if (debug) printf("MFVGenParticles::try_MFVdijet quark=%i\n", quark);
   assert(quark == 1 || quark == 4 || quark == 5);
 
@@ -494,11 +500,13 @@ bool MFVGenParticles::try_MFVdijet(mfv::MCInteraction& mc, const edm::Handle<rec
   // Find the LSPs (e.g. gluinos or neutralinos). Since this is
   // PYTHIA8 there are lots of copies -- try to get the ones that
   // decay to the three quarks.
+  const jmt::GenDecayGraph::index_range lsps = graph.with_id(lsp_id);
   int found = 0;
-  for (int i = int(gen_particles->size()) - 1; i >= 0 && found < 2; --i) {
+  for (auto it = lsps.end(); it != lsps.begin() && found < 2; ) {
+    const int i = *--it;
     const reco::GenParticle& gen = gen_particles->at(i);
     reco::GenParticleRef ref(gen_particles, i);
-    if (gen.pdgId() != lsp_id || gen.numberOfDaughters() != 2)
+    if (gen.numberOfDaughters() != 2)
       continue;
     ++found;
 
@@ -517,15 +525,15 @@ bool MFVGenParticles::try_MFVdijet(mfv::MCInteraction& mc, const edm::Handle<rec
     //gpp.Print(&*h.p[which], lspname);
 
     // Get the immediate daughters. 
-    if ((h.s[which][0] = gen_ref(daughter_with_id(&gen,  quark, false), gen_particles)).isNull() ||
-        (h.s[which][1] = gen_ref(daughter_with_id(&gen, -quark, false), gen_particles)).isNull()) {
+    if ((h.s[which][0] = gen_ref(graph.daughter_with_id(i,  quark, false), gen_particles)).isNull() ||
+        (h.s[which][1] = gen_ref(graph.daughter_with_id(i, -quark, false), gen_particles)).isNull()) {
       printf("WEIRD GLUBALL CRAP??? %i %i\n", h.s[which][0].isNull(), h.s[which][1].isNull());
       return false;
     }
 
     h.decay_id[which] = 1;
-    h.s[which][0] = gen_ref(final_candidate(h.s[which][0], 3), gen_particles);
-    h.s[which][1] = gen_ref(final_candidate(h.s[which][1], 3), gen_particles);
+    h.s[which][0] = gen_ref(graph.final_copy(h.s[which][0].key(), 3), gen_particles);
+    h.s[which][1] = gen_ref(graph.final_copy(h.s[which][1].key(), 3), gen_particles);
 
     if (last_flag_check) {
       assert(h.p[which]   ->statusFlags().isLastCopy());
@@ -545,7 +553,7 @@ bool MFVGenParticles::try_MFVdijet(mfv::MCInteraction& mc, const edm::Handle<rec
     return false;
 }
 
-bool MFVGenParticles::try_stopdbardbar(mfv::MCInteraction& mc, const edm::Handle<reco::GenParticleCollection>& gen_particles, int quark) const {
+bool MFVGenParticles::try_stopdbardbar(mfv::MCInteraction& mc, const edm::Handle<reco::GenParticleCollection>& gen_particles, const jmt::GenDecayGraph& graph, int quark) const {
   if (debug) printf("MFVGenParticles::try_stopdbardbar quark=%i\n", quark);
   assert(quark == -1 || quark == -5);
 
@@ -555,11 +563,13 @@ bool MFVGenParticles::try_stopdbardbar(mfv::MCInteraction& mc, const edm::Handle
   if (debug)
     gpp.PrintHeader();
 
+  const std::vector<int> lsps = graph.with_abs_id(lsp_id);
   int found = 0;
-  for (int i = int(gen_particles->size()) - 1; i >= 0 && found < 2; --i) {
+  for (auto it = lsps.rbegin(); it != lsps.rend() && found < 2; ++it) {
+    const int i = *it;
     const reco::GenParticle& gen = gen_particles->at(i);
     reco::GenParticleRef ref(gen_particles, i);
-    if (abs(gen.pdgId()) == lsp_id && gen.numberOfDaughters() == 2) {
+    if (gen.numberOfDaughters() == 2) {
       const int anti = lsp_id * gen.pdgId() > 0 ? -1 : 1;
       if (gen.daughter(0)->pdgId() == anti * quark &&
           gen.daughter(1)->pdgId() == anti * quark) {
@@ -594,8 +604,8 @@ bool MFVGenParticles::try_stopdbardbar(mfv::MCInteraction& mc, const edm::Handle
         }
 
         h.decay_id[which] = 1;
-        h.s[which][0] = gen_ref(final_candidate(h.s[which][0], 3), gen_particles);
-        h.s[which][1] = gen_ref(final_candidate(h.s[which][1], 3), gen_particles);
+        h.s[which][0] = gen_ref(graph.final_copy(h.s[which][0].key(), 3), gen_particles);
+        h.s[which][1] = gen_ref(graph.final_copy(h.s[which][1].key(), 3), gen_particles);
 
         if (debug) {
           gpp.Print(h.s[which][0], "s0");
@@ -626,18 +636,20 @@ bool MFVGenParticles::try_stopdbardbar(mfv::MCInteraction& mc, const edm::Handle
     return false;
 }
 
-bool MFVGenParticles::try_MFVlq(mfv::MCInteraction& mc, const edm::Handle<reco::GenParticleCollection>& gen_particles) const {
+bool MFVGenParticles::try_MFVlq(mfv::MCInteraction& mc, const edm::Handle<reco::GenParticleCollection>& gen_particles, const jmt::GenDecayGraph& graph) const {
   if (debug) printf("MFVGenParticles::try_MFVlq\n");
 
   mfv::MCInteractionHolderMFVlq h;
 
   // Find the LQ and the LQbar. Start from the end and get the last ones,
   // they should be the ones that go to the pairs of quarks.
-  for (int i = int(gen_particles->size()) - 1; i >= 0; --i) {
+  const std::vector<int> lqs = graph.with_abs_id(42);
+  for (auto it = lqs.rbegin(); it != lqs.rend(); ++it) {
+    const int i = *it;
     const reco::GenParticle& lq = gen_particles->at(i);
     reco::GenParticleRef ref(gen_particles, i);
     const int id = lq.pdgId();
-    if (abs(id) != 42 || lq.numberOfDaughters() != 2)
+    if (lq.numberOfDaughters() != 2)
       continue;
 
     const int aid[2] = {abs(lq.daughter(0)->pdgId()),
@@ -659,8 +671,8 @@ bool MFVGenParticles::try_MFVlq(mfv::MCInteraction& mc, const edm::Handle<reco::
 
     const int whichq = !is_q[0];
     h.decay_id[which] = (aid[!whichq] - 11) / 2 + 1;
-    h.s[which][0] = gen_ref(final_candidate(lq.daughter( whichq), 3), gen_particles);
-    h.s[which][1] = gen_ref(final_candidate(lq.daughter(!whichq), 3), gen_particles);
+    h.s[which][0] = gen_ref(graph.final_copy(graph.index(lq.daughter( whichq), *gen_particles), 3), gen_particles);
+    h.s[which][1] = gen_ref(graph.final_copy(graph.index(lq.daughter(!whichq), *gen_particles), 3), gen_particles);
 
     if (last_flag_check) {
       assert(h.p[which]   ->statusFlags().isLastCopy());
@@ -684,10 +696,12 @@ void MFVGenParticles::produce(edm::Event& event, const edm::EventSetup&) {
   std::unique_ptr<reco::GenParticleCollection> primaries  (new reco::GenParticleCollection);
   std::unique_ptr<reco::GenParticleCollection> secondaries(new reco::GenParticleCollection);
   std::unique_ptr<reco::GenParticleCollection> visible    (new reco::GenParticleCollection);
+  std::unique_ptr<jmt::GenDecayGraph> graph(new jmt::GenDecayGraph);
 
   if (!event.isRealData()) {
     edm::Handle<reco::GenParticleCollection> gen_particles;
     event.getByToken(gen_particles_token, gen_particles);
+    *graph = jmt::GenDecayGraph(gen_particles);
 
     const reco::GenParticle& for_vtx = gen_particles->at(2);
     const int for_vtx_id = abs(for_vtx.pdgId());
@@ -702,34 +716,37 @@ void MFVGenParticles::produce(edm::Event& event, const edm::EventSetup&) {
       // If there is a neutralino or stop in the first event, assume that's the
       // LSP id wanted. Otherwise, default to looking for gluino. This
       // isn't relevant for some signals.
-      lsp_id = 1000021;
-      for (int i = 0, ie = int(gen_particles->size()); i < ie; ++i)
-        if      (gen_particles->at(i).pdgId() == 1000022) { lsp_id = 1000022; break; }
-        else if (gen_particles->at(i).pdgId() == 1000006) { lsp_id = 1000006; break; }
+      const jmt::GenDecayGraph::index_range neus = graph->with_id(1000022), stops = graph->with_id(1000006);
+      if (neus.empty() && stops.empty())
+        lsp_id = 1000021;
+      else if (stops.empty() || (!neus.empty() && *neus.begin() < *stops.begin()))
+        lsp_id = 1000022;
+      else
+        lsp_id = 1000006;
     }
 
     if (debug) printf("MFVGenParticles::analyze: lsp_id %i\n", lsp_id);
 
     // the order of these tries is important, at least that MFVtbses come before Ttbar
-    try_MFVtbs  (*mc, gen_particles, 5, 3) || // tbs
-    try_MFVtbs  (*mc, gen_particles, 1, 3) || // tds
-    try_MFVtbs  (*mc, gen_particles, 5, 5) || // tbb
-    try_Ttbar   (*mc, gen_particles) || 
-    try_MFVthree(*mc, gen_particles,  3, 2,  1) ||
-    try_MFVthree(*mc, gen_particles, 11, 2, -1) ||
-    try_MFVthree(*mc, gen_particles, 13, 2, -1) ||
-    try_MFVthree(*mc, gen_particles, 15, 2, -1) ||
-    try_MFVthree(*mc, gen_particles,  5, 2,  1) || // udb
-    try_MFVthree(*mc, gen_particles,  3, 1,  4) || // cds
-    try_MFVthree(*mc, gen_particles,  5, 1,  4) || // cdb
-    try_MFVthree(*mc, gen_particles,  5, 5,  2) || // ubb
-    try_XX4j    (*mc, gen_particles) ||
-    try_stopdbardbar(*mc, gen_particles, -1) || // stop -> dbar dbar + c.c.
-    try_stopdbardbar(*mc, gen_particles, -5) || // stop -> bbar bbar + c.c.
-    try_MFVdijet(*mc, gen_particles, 1) || //ddbar
-    try_MFVdijet(*mc, gen_particles, 4) || //ccbar
-    try_MFVdijet(*mc, gen_particles, 5) || //bbbar
-    try_MFVlq   (*mc, gen_particles);
+    try_MFVtbs  (*mc, gen_particles, *graph, 5, 3) || // tbs
+    try_MFVtbs  (*mc, gen_particles, *graph, 1, 3) || // tds
+    try_MFVtbs  (*mc, gen_particles, *graph, 5, 5) || // tbb
+    try_Ttbar   (*mc, gen_particles, *graph) || 
+    try_MFVthree(*mc, gen_particles, *graph,  3, 2,  1) ||
+    try_MFVthree(*mc, gen_particles, *graph, 11, 2, -1) ||
+    try_MFVthree(*mc, gen_particles, *graph, 13, 2, -1) ||
+    try_MFVthree(*mc, gen_particles, *graph, 15, 2, -1) ||
+    try_MFVthree(*mc, gen_particles, *graph,  5, 2,  1) || // udb
+    try_MFVthree(*mc, gen_particles, *graph,  3, 1,  4) || // cds
+    try_MFVthree(*mc, gen_particles, *graph,  5, 1,  4) || // cdb
+    try_MFVthree(*mc, gen_particles, *graph,  5, 5,  2) || // ubb
+    try_XX4j    (*mc, gen_particles, *graph) ||
+    try_stopdbardbar(*mc, gen_particles, *graph, -1) || // stop -> dbar dbar + c.c.
+    try_stopdbardbar(*mc, gen_particles, *graph, -5) || // stop -> bbar bbar + c.c.
+    try_MFVdijet(*mc, gen_particles, *graph, 1) || //ddbar
+    try_MFVdijet(*mc, gen_particles, *graph, 4) || //ccbar
+    try_MFVdijet(*mc, gen_particles, *graph, 5) || //bbbar
+    try_MFVlq   (*mc, gen_particles, *graph);
 
     if (mc->valid()) {
       for (auto r : mc->primaries())   primaries  ->push_back(*r);
@@ -807,6 +824,7 @@ void MFVGenParticles::produce(edm::Event& event, const edm::EventSetup&) {
   event.put(std::move(primaries),   "primaries");
   event.put(std::move(secondaries), "secondaries");
   event.put(std::move(visible),     "visible");
+  event.put(std::move(graph),       "decayGraph");
 }
 
 DEFINE_FWK_MODULE(MFVGenParticles);
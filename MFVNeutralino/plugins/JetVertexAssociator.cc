@@ -13,6 +13,7 @@
 #include "FWCore/ServiceRegistry/interface/Service.h"
 #include "JMTucker/MFVNeutralinoFormats/interface/JetVertexAssociation.h"
 #include "JMTucker/MFVNeutralino/interface/JetTrackRefGetter.h"
+#include "JMTucker/MFVNeutralino/interface/VertexTools.h"
 
 class MFVJetVertexAssociator : public edm::EDProducer {
 public:
@@ -39,6 +40,7 @@ private:
   const double max_cos_angle_diff;
   const double max_miss_dist;
   const double max_miss_sig;
+  const bool check_batch;
   const bool histos;
   const bool verbose;
 
@@ -95,6 +97,7 @@ MFVJetVertexAssociator::MFVJetVertexAssociator(const edm::ParameterSet& cfg)
     max_cos_angle_diff(cfg.getParameter<double>("max_cos_angle_diff")),
     max_miss_dist(cfg.getParameter<double>("max_miss_dist")),
     max_miss_sig(cfg.getParameter<double>("max_miss_sig")),
+    check_batch(cfg.getUntrackedParameter<bool>("check_batch", false)),
     histos(cfg.getUntrackedParameter<bool>("histos", false)),
     verbose(cfg.getUntrackedParameter<bool>("verbose", false))
 {
@@ -217,7 +220,51 @@ void MFVJetVertexAssociator::produce(edm::Event& event, const edm::EventSetup&)
   std::vector<Measurement1D> best_miss_dist(n_jets, Measurement1D(1e9, 1));
   std::vector<Measurement1D> second_best_miss_dist(n_jets, Measurement1D(1e9, 1));
 
+  // Miss distances for all (jet, vertex) pairs where the jet has a
+  // tag-info vertex, computed in one batch up front.
+  std::vector<int> miss_dist_index(n_jets * n_vertices, -1);
+  mfv::distance_batch miss_dists;
+
   if (enable) {
+    mfv::vertex_soa miss_sv, miss_tv;
+    std::vector<double> miss_px, miss_py, miss_pz;
+    miss_sv.reserve(n_jets * n_vertices);
+    miss_tv.reserve(n_jets * n_vertices);
+
+    for (size_t ijet = 0; ijet < n_jets; ++ijet) {
+      const pat::Jet& jet = jets->at(ijet);
+      const reco::SecondaryVertexTagInfo* jet_tag = jet.tagInfoSecondaryVertex(tag_info_name);
+      if (!jet_tag || jet_tag->nVertices() == 0)
+        continue;
+
+      for (size_t ivtx = 0; ivtx < n_vertices; ++ivtx) {
+        miss_dist_index[ijet * n_vertices + ivtx] = miss_px.size();
+        miss_sv.push_back(*vertices.at(ivtx));
+        miss_tv.push_back(jet_tag->secondaryVertex(0));
+        miss_px.push_back(jet.px());
+        miss_py.push_back(jet.py());
+        miss_pz.push_back(jet.pz());
+      }
+    }
+
+    mfv::miss_dist_batch(miss_sv, miss_tv, miss_px, miss_py, miss_pz, miss_dists);
+
+    if (check_batch) {
+      for (size_t ijet = 0; ijet < n_jets; ++ijet) {
+        const pat::Jet& jet = jets->at(ijet);
+        for (size_t ivtx = 0; ivtx < n_vertices; ++ivtx) {
+          const int i = miss_dist_index[ijet * n_vertices + ivtx];
+          if (i < 0) continue;
+          const Measurement1D m = mfv::miss_dist(*vertices.at(ivtx), jet.tagInfoSecondaryVertex(tag_info_name)->secondaryVertex(0), jet.p4());
+          if (fabs(m.value() - miss_dists.val[i]) > 1e-9 + 1e-6 * fabs(m.value()) ||
+              fabs(m.error() - miss_dists.err[i]) > 1e-9 + 1e-6 * fabs(m.error()))
+            throw cms::Exception("MFVJetVertexAssociator") << "batch miss dist mismatch for jet " << ijet << " vertex " << ivtx
+                                                           << ": scalar " << m.value() << " +- " << m.error()
+                                                           << " batch " << miss_dists.val[i] << " +- " << miss_dists.err[i];
+        }
+      }
+    }
+
     for (size_t ijet = 0; ijet < n_jets; ++ijet) {
       const pat::Jet& jet = jets->at(ijet);
       std::set<reco::TrackRef> jet_tracks;
@@ -262,23 +309,9 @@ void MFVJetVertexAssociator::produce(edm::Event& event, const edm::EventSetup&)
           const TVector3 sv_to_tv = jet_tag_vtx_pos - TVector3(vtx.x(), vtx.y(), vtx.z());
           cos_angle = sv_to_tv.Dot(jet_mom_dir) / sv_to_tv.Mag();
 
-          // JMTBAD use mfv::miss_dist()
-          // miss distance is magnitude of (jet direction cross (tv - sv))
-          // to calculate uncertainty, use |n X d|^2 = (|n||d|)^2 - (n . d)^2
-          const TVector3& n = jet_mom_dir;
-          const TVector3& d = sv_to_tv;
-          const double n_dot_d = n.Dot(d);
-          const TVector3 n_cross_d = n.Cross(d);
-          typedef math::VectorD<3>::type vec_t;
-          typedef math::ErrorD<3>::type mat_t;
-          vec_t jacobian(2*d.x() - 2*n_dot_d*n.x(),
-                         2*d.y() - 2*n_dot_d*n.y(),
-                         2*d.z() - 2*n_dot_d*n.z());
-          mat_t sv_to_tv_cov_matrix = vtx.covariance() + jet_tag_vtx->covariance();
-          double sigma_f2 = sqrt(ROOT::Math::Similarity(jacobian, sv_to_tv_cov_matrix));
-          double miss_dist_value = n_cross_d.Mag();
-          double miss_dist_err = sigma_f2 / 2 / miss_dist_value;
-          miss_dist = Measurement1D(miss_dist_value, miss_dist_err);
+          // miss distance of the jet line (tv + jet direction) to the sv, from the batch above
+          const int imiss = miss_dist_index[ijet * n_vertices + ivtx];
+          miss_dist = Measurement1D(miss_dists.val[imiss], miss_dists.err[imiss]);
         }
 
         if (ntracks >= min_tracks_shared && ntracks > best_ntracks[ijet]) {
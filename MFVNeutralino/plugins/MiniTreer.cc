@@ -22,6 +22,7 @@ public:
   const edm::EDGetTokenT<double> weight_token;
 
   const bool save_tracks;
+  mfv::MiniNtupleWriteSettings write_settings;
 
   TH1F* h_nsv;
   TH1F* h_nsvsel;
@@ -36,13 +37,18 @@ MFVMiniTreer::MFVMiniTreer(const edm::ParameterSet& cfg)
     weight_token(consumes<double>(cfg.getParameter<edm::InputTag>("weight_src"))),
     save_tracks(cfg.getParameter<bool>("save_tracks"))
 {
+  write_settings.compression = cfg.getUntrackedParameter<int>("compression", -1);
+  write_settings.basket_size = cfg.getUntrackedParameter<int>("basket_size", -1);
+  write_settings.track_basket_size = cfg.getUntrackedParameter<int>("track_basket_size", -1);
+  write_settings.auto_flush = cfg.getUntrackedParameter<long long>("auto_flush", 0);
+
   edm::Service<TFileService> fs;
 
   h_nsv = fs->make<TH1F>("h_nsv", "", 10, 0, 10);
   h_nsvsel = fs->make<TH1F>("h_nsvsel", "", 10, 0, 10);
 
   tree = fs->make<TTree>("t", "");
-  mfv::write_to_tree(tree, nt);
+  mfv::write_to_tree(tree, nt, write_settings);
 }
 
 MFVVertexAux MFVMiniTreer::xform_vertex(const MFVEvent& mevent, const MFVVertexAux& v) const {
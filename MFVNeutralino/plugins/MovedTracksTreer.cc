@@ -283,6 +283,8 @@ void MFVMovedTracksTreer::analyze(const edm::Event& event, const edm::EventSetup
       }
   }
 
+  nt.fill_track_association();
+
   if (apply_presel) {
     if ((!for_mctruth && (nt.npreseljets < njets_req || nt.npreselbjets < nbjets_req)) ||
         nt.jetht < 1000)
@@ -8,6 +8,7 @@
 #include "FWCore/Framework/interface/Frameworkfwd.h"
 #include "FWCore/Framework/interface/MakerMacros.h"
 #include "JMTucker/MFVNeutralinoFormats/interface/TracksMap.h"
+#include "JMTucker/Tools/interface/RecoTrackCuts.h"
 
 class MFVSkimmedTracks : public edm::EDFilter {
 public:
@@ -23,6 +24,8 @@ private:
   const double min_pt;
   const double min_dxybs;
   const double min_nsigmadxybs;
+  jmt::TrackCuts track_cuts;
+  unsigned track_cut_bits;
   const bool input_is_miniaod;
   const bool cut;
   const bool debug;
@@ -42,15 +45,29 @@ MFVSkimmedTracks::MFVSkimmedTracks(const edm::ParameterSet& cfg)
 {
   produces<reco::TrackCollection>();
   produces<std::vector<int>>(); // which PV if any, -1 if none
+
+  track_cuts.min_pt = min_pt;
+  track_cuts.min_dxybs = min_dxybs;
+  track_cuts.min_nsigmadxybs = min_nsigmadxybs;
+  track_cut_bits = jmt::tkcut_finite | jmt::tkcuts_sel;
+  if (min_dxybs > 0) track_cut_bits |= jmt::tkcut_dxybs;
+  if (min_nsigmadxybs > 0) track_cut_bits |= jmt::tkcut_nsigmadxybs;
 }
 
 bool MFVSkimmedTracks::filter(edm::Event& event, const edm::EventSetup& setup) {
   edm::Handle<reco::TrackCollection> tracks;
   event.getByToken(tracks_token, tracks);
 
+  // Only the dxy cuts need the beamspot; without them dxybs is wrt the
+  // origin but isn't cut on.
   edm::Handle<reco::BeamSpot> beamspot;
-  if (min_dxybs > 0 || min_nsigmadxybs > 0)
+  const reco::BeamSpot* bs = 0;
+  if (min_dxybs > 0 || min_nsigmadxybs > 0) {
     event.getByToken(beamspot_token, beamspot);
+    if (!beamspot.isValid())
+      throw cms::Exception("MFVSkimmedTracks", "dxy cuts are on but there is no beamspot");
+    bs = &*beamspot;
+  }
 
   edm::Handle<reco::VertexCollection> primary_vertices;
   event.getByToken(primary_vertices_token, primary_vertices);
@@ -61,35 +78,30 @@ bool MFVSkimmedTracks::filter(edm::Event& event, const edm::EventSetup& setup) {
 
   if (debug) std::cout << "MFVSkimmedTracks::filter: run " << event.id().run() << " lumi " << event.luminosityBlock() << " event " << event.id().event() << " has " << tracks->size() << " input tracks, " << primary_vertices->size() << " primary vertices\n";
 
-  std::map<reco::TrackRef, std::vector<int>> tracks_in_pvs;
+  std::vector<int> tracks_first_pv, tracks_npvs;
   if (!input_is_miniaod)
-    for (size_t i = 0, ie = primary_vertices->size(); i < ie; ++i) {
-      const reco::Vertex& pv = (*primary_vertices)[i];
-      for (auto it = pv.tracks_begin(), ite = pv.tracks_end(); it != ite; ++it)
-        tracks_in_pvs[it->castTo<reco::TrackRef>()].push_back(i);
-    }
-  
+    jmt::tracks_in_pvs(*primary_vertices, tracks, tracks_first_pv, tracks_npvs);
+
+  // Get the cut variables of all the tracks first, then apply the cuts
+  // to them all at once.
+  jmt::TrackCutVars vars;
+  vars.reserve(tracks->size());
+  for (const reco::Track& tk : *tracks)
+    vars.push_back(jmt::track_cut_values(tk, bs, 0));
+  std::vector<unsigned> fails;
+  track_cuts.apply(vars, fails);
+
   std::unique_ptr<reco::TrackCollection> output_tracks(new reco::TrackCollection);
   std::unique_ptr<std::vector<int>> output_pvindex(new std::vector<int>);
 
   for (size_t itk = 0, itke = tracks->size(); itk < itke; ++itk) {
     reco::TrackRef tk(tracks, itk);
+    const bool pass = jmt::tkcuts_pass(fails[itk], track_cut_bits);
 
-    const bool min_r = tk->hitPattern().hasValidHitInPixelLayer(PixelSubdetector::PixelBarrel,1);
-    const int npxlayers = tk->hitPattern().pixelLayersWithMeasurement();
-    const int nstlayers = tk->hitPattern().stripLayersWithMeasurement();
-
-    bool pass = !std::isinf(tk->pt()) && !std::isnan(tk->eta()) && tk->pt() > min_pt && min_r && npxlayers >= 2 && nstlayers >= 6;
-
-    if (debug) std::cout << "track #" << itk << " pt " << tk->pt() << " eta " << tk->eta() << " min_r " << min_r << " npxlayers " << npxlayers << " nstlayers " << nstlayers << " pass so far? " << pass;
-
-    if (pass && (min_dxybs > 0 || min_nsigmadxybs > 0)) {
-      const double dxybs = tk->dxy(*beamspot);
-      const double dxyerr = tk->dxyError();
-      const double nsigmadxybs = dxybs / dxyerr;
-      if (fabs(dxybs) < min_dxybs || fabs(nsigmadxybs) < min_nsigmadxybs)
-        pass = false;
-      if (debug) std::cout << " dxybs " << dxybs << " dxyerr " << dxyerr << " sigmadxybs " << nsigmadxybs;
+    if (debug) {
+      std::cout << "track #" << itk << " pt " << vars.pt[itk] << " eta " << vars.eta[itk] << " min_r " << int(vars.min_r[itk]) << " npxlayers " << int(vars.npxlayers[itk]) << " nstlayers " << int(vars.nstlayers[itk]);
+      if (bs) std::cout << " dxybs " << vars.dxybs[itk] << " dxyerr " << vars.dxyerr[itk] << " sigmadxybs " << vars.nsigmadxybs(itk);
+      std::cout << " failed cuts 0x" << std::hex << (fails[itk] & track_cut_bits) << std::dec;
     }
 
     if (pass) {
@@ -101,10 +113,9 @@ bool MFVSkimmedTracks::filter(edm::Event& event, const edm::EventSetup& setup) {
         output_pvindex->push_back(pc->vertexRef().key());
       }
       else {
-        const std::vector<int>& pv_for_track = tracks_in_pvs[tk];
-        if (pv_for_track.size() > 1)
+        if (tracks_npvs[itk] > 1)
           throw cms::Exception("BadAssumption", "multiple PV for a track");
-        output_pvindex->push_back(pv_for_track.size() ? pv_for_track[0] : -1);
+        output_pvindex->push_back(tracks_first_pv[itk]);
       }
 
       if (debug) std::cout << " selected! now " << output_tracks->size() << " output tracks";
@@ -5,6 +5,7 @@
 #include "FWCore/Framework/interface/Event.h"
 #include "FWCore/Framework/interface/MakerMacros.h"
 #include "FWCore/ServiceRegistry/interface/Service.h"
+#include "JMTucker/Formats/interface/GenDecayGraph.h"
 #include "JMTucker/MFVNeutralinoFormats/interface/MCInteractions.h"
 #include "JMTucker/MFVNeutralinoFormats/interface/Event.h"
 #include "JMTucker/MFVNeutralinoFormats/interface/VertexAux.h"
@@ -20,6 +21,7 @@ private:
   const edm::EDGetTokenT<reco::GenJetCollection> gen_jets_token;
   const edm::EDGetTokenT<std::vector<double>> gen_vertex_token;
   const edm::EDGetTokenT<mfv::MCInteraction> mci_token;
+  const edm::EDGetTokenT<jmt::GenDecayGraph> gen_decay_graph_token;
   const edm::EDGetTokenT<MFVEvent> mevent_token;
   const edm::EDGetTokenT<MFVVertexAuxCollection> vertex_token;
 
@@ -84,6 +86,7 @@ MFVTheoristRecipe::MFVTheoristRecipe(const edm::ParameterSet& cfg)
   : gen_jets_token(consumes<reco::GenJetCollection>(cfg.getParameter<edm::InputTag>("gen_jets_src"))),
     gen_vertex_token(consumes<std::vector<double>>(cfg.getParameter<edm::InputTag>("gen_vertex_src"))),
     mci_token(consumes<mfv::MCInteraction>(cfg.getParameter<edm::InputTag>("mci_src"))),
+    gen_decay_graph_token(consumes<jmt::GenDecayGraph>(cfg.getParameter<edm::InputTag>("gen_decay_graph_src"))),
     mevent_token(consumes<MFVEvent>(cfg.getParameter<edm::InputTag>("mevent_src"))),
     vertex_token(consumes<MFVVertexAuxCollection>(cfg.getParameter<edm::InputTag>("vertex_src"))),
     max_dist(cfg.getParameter<double>("max_dist")),
@@ -155,6 +158,9 @@ void MFVTheoristRecipe::analyze(const edm::Event& event, const edm::EventSetup&)
     return;
   }
 
+  edm::Handle<jmt::GenDecayGraph> graph;
+  event.getByToken(gen_decay_graph_token, graph);
+
   edm::Handle<MFVEvent> mevent;
   event.getByToken(mevent_token, mevent);
 
@@ -176,8 +182,11 @@ void MFVTheoristRecipe::analyze(const edm::Event& event, const edm::EventSetup&)
   TLorentzVector lsp_p4s[2];
  
   for (int i : {0,1}) {
-    for (auto ref : mci->visible(i))
-      partons[i].push_back((reco::GenParticle*)first_candidate(&*ref));
+    for (auto ref : mci->visible(i)) {
+      if (ref.id() != graph->source())
+        throw cms::Exception("MFVTheoristRecipe", "MCInteraction and GenDecayGraph made from different gen particles");
+      partons[i].push_back(&ref.product()->at(graph->first_copy(ref.key())));
+    }
     auto x = mci->decay_point(i);
     v[i][0] = x.x - x0;
     v[i][1] = x.y - y0;
@@ -1,5 +1,4 @@
 #include "TTree.h"
-#include "CommonTools/Utils/interface/StringCutObjectSelector.h"
 #include "CondFormats/DataRecord/interface/L1TUtmTriggerMenuRcd.h"
 #include "CondFormats/L1TObjects/interface/L1TUtmTriggerMenu.h"
 #include "DataFormats/L1TGlobal/interface/GlobalAlgBlk.h"
@@ -14,6 +13,7 @@
 #include "FWCore/Framework/interface/Event.h"
 #include "FWCore/Framework/interface/EventSetup.h"
 #include "FWCore/Framework/interface/MakerMacros.h"
+#include "JMTucker/Tools/interface/PatCompiledCuts.h"
 #include "JMTucker/Tools/interface/TriggerHelper.h"
 #include "JMTucker/MFVNeutralinoFormats/interface/Event.h"
 #include "JMTucker/MFVNeutralinoFormats/interface/TriggerFloats.h"
@@ -32,7 +32,7 @@ private:
   const edm::EDGetTokenT<pat::TriggerObjectStandAloneCollection> trigger_objects_token;
 
   const edm::EDGetTokenT<pat::JetCollection> jets_token;
-  const StringCutObjectSelector<pat::Jet> jet_selector;
+  const jmt::CutSelector<pat::Jet> jet_selector;
 
   const int prints;
 };
@@ -6,6 +6,7 @@
 #include "FWCore/Framework/interface/Frameworkfwd.h"
 #include "FWCore/Framework/interface/MakerMacros.h"
 #include "JMTucker/MFVNeutralinoFormats/interface/TracksMap.h"
+#include "JMTucker/Tools/interface/RecoTrackCuts.h"
 
 class MFVUnpackedCandidateTracks : public edm::EDProducer {
 public:
@@ -22,9 +23,13 @@ private:
     std::cout << tag << " cand #" << i << " id " << cand.pdgId() << " pt " << cand.pt() << " eta " << cand.eta() << " charge " << cand.charge() << " hasTrackDetails? " << cand.hasTrackDetails() << " ";
   }
 
-  void debug_tk(const reco::Track& tk, const char* tag, const size_t i) const {
-    std::cout << "-> " << tag << " track #" << i << " pt " << tk.pt() << " eta " << tk.eta() << " min_r? " << tk.hitPattern().hasValidHitInPixelLayer(PixelSubdetector::PixelBarrel,1)
-              << " npxlayers " << tk.hitPattern().pixelLayersWithMeasurement() << " nstlayers " << tk.hitPattern().stripLayersWithMeasurement() << " dxy " << tk.dxy() << " +- " << tk.dxyError() << " pass? " << pass_tk(tk);
+  // Returns the failed cut bits for pass_tk.
+  unsigned debug_tk(const reco::Track& tk, const char* tag, const size_t i) const {
+    const jmt::TrackCutValues v = jmt::track_cut_values(tk, 0, 0);
+    const unsigned fail = track_cuts.fail(v);
+    std::cout << "-> " << tag << " track #" << i << " pt " << v.pt << " eta " << v.eta << " min_r " << v.min_r
+              << " npxlayers " << v.npxlayers << " nstlayers " << v.nstlayers << " dxy " << v.dxybs << " +- " << v.dxyerr << " pass? " << pass_tk(fail);
+    return fail;
   };
 
   bool pass_cand(const pat::PackedCandidate& cand) const {
@@ -39,7 +44,10 @@ private:
           u.i == 0x3cd24697 ||  // 0.0256684255
           u.i == 0x3dfc7c28 ||  // 0.1232836843
           u.i == 0x3e948f67;    // 0.2901565731
-        if (debug) printf("(weirdo check %i %i %i %i 0x%08x %.10g) ", weirdo, pass_tk(tk,false,false), pass_tk(tk,true,false), pass_tk(tk,true,true), u.i, u.f);
+        if (debug) {
+          const unsigned fail = track_cuts.fail(jmt::track_cut_values(tk, 0, 0));
+          printf("(weirdo check %i %i %i %i 0x%08x %.10g) ", weirdo, pass_tk(fail,false,false), pass_tk(fail,true,false), pass_tk(fail,true,true), u.i, u.f);
+        }
         if (skip_weirdos && weirdo) return false;
       }
       return true;
@@ -47,13 +55,17 @@ private:
     return false;
   }
 
-  bool pass_tk(const reco::Track& tk, bool req_min_r=true, bool req_nsigmadxy=true) const {
-    return
-      tk.pt() > 1 &&
-      tk.hitPattern().pixelLayersWithMeasurement() >= 2 &&
-      tk.hitPattern().stripLayersWithMeasurement() >= 6 &&
-      (!req_min_r || tk.hitPattern().hasValidHitInPixelLayer(PixelSubdetector::PixelBarrel,1)) &&
-      (!req_nsigmadxy || fabs(tk.dxy() / tk.dxyError()) > 4);
+  // The seed track selection, dxy wrt the origin since there is no
+  // beamspot handy.
+  const jmt::TrackCuts track_cuts;
+
+  // Whether a track with failed cut bits fail passes, so the cut values
+  // are computed once per track however many variations are asked for.
+  bool pass_tk(unsigned fail, bool req_min_r=true, bool req_nsigmadxy=true) const {
+    unsigned cuts = jmt::tkcuts_seed;
+    if (!req_min_r) cuts &= ~jmt::tkcut_min_r;
+    if (!req_nsigmadxy) cuts &= ~jmt::tkcut_nsigmadxybs;
+    return jmt::tkcuts_pass(fail, cuts);
   }
 };
 
@@ -91,8 +103,7 @@ void MFVUnpackedCandidateTracks::produce(edm::Event& event, const edm::EventSetu
       const reco::Track& tk = cand.pseudoTrack();
 
       if (debug) {
-        debug_tk(tk, "", tracks->size());
-        if (pass_tk(tk)) ++ntkpass;
+        if (pass_tk(debug_tk(tk, "", tracks->size()))) ++ntkpass;
       }
 
       tracks->push_back(tk);
@@ -113,8 +124,7 @@ void MFVUnpackedCandidateTracks::produce(edm::Event& event, const edm::EventSetu
       const reco::Track& tk = cand.pseudoTrack();
 
       if (debug) {
-        debug_tk(tk, "lost", lost_tracks->size());
-        if (pass_tk(tk)) ++nlosttkpass;
+        if (pass_tk(debug_tk(tk, "lost", lost_tracks->size()))) ++nlosttkpass;
       }
 
       if (add_lost_candidates) {
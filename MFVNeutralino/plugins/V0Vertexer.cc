@@ -6,11 +6,13 @@
 #include "FWCore/Framework/interface/EDFilter.h"
 #include "FWCore/Framework/interface/Event.h"
 #include "FWCore/Framework/interface/MakerMacros.h"
+#include "MagneticField/Engine/interface/MagneticField.h"
 #include "RecoVertex/KalmanVertexFit/interface/KalmanVertexFitter.h"
 #include "TrackingTools/Records/interface/TransientTrackRecord.h"
 #include "TrackingTools/TransientTrack/interface/TransientTrack.h"
 #include "TrackingTools/TransientTrack/interface/TransientTrackBuilder.h"
 #include "JMTucker/MFVNeutralino/interface/V0Hypotheses.h"
+#include "JMTucker/MFVNeutralino/interface/V0Prefilter.h"
 
 class MFVV0Vertexer : public edm::EDFilter {
 public:
@@ -23,10 +25,18 @@ private:
   const TransientTrackBuilder* tt_builder;
   const edm::EDGetTokenT<reco::TrackCollection> tracks_token;
   const double max_chi2ndf;
+  const double prefilter_max_dca;
+  const double prefilter_mass_window;
   const bool cut;
   const bool debug;
 
-  void do_hyps(const std::vector<reco::TrackRef>, std::unique_ptr<reco::VertexCollection>&);
+  // Per event, built once per track rather than per combination.
+  std::vector<reco::TrackRef> refs;
+  std::vector<reco::TransientTrack> ttks;
+  std::vector<mfv::V0PrefilterTrack> pftks;
+
+  static bool any_hyp(size_t ntracks, int charge);
+  void do_hyps(const std::vector<size_t>&, const double x, const double y, std::unique_ptr<reco::VertexCollection>&);
 };
 
 MFVV0Vertexer::MFVV0Vertexer(const edm::ParameterSet& cfg)
@@ -34,6 +44,8 @@ MFVV0Vertexer::MFVV0Vertexer(const edm::ParameterSet& cfg)
     tt_builder(nullptr),
     tracks_token(consumes<reco::TrackCollection>(cfg.getParameter<edm::InputTag>("tracks_src"))),
     max_chi2ndf(cfg.getParameter<double>("max_chi2ndf")),
+    prefilter_max_dca(cfg.getParameter<double>("prefilter_max_dca")),
+    prefilter_mass_window(cfg.getParameter<double>("prefilter_mass_window")),
     cut(cfg.getParameter<bool>("cut")),
     debug(cfg.getUntrackedParameter<bool>("debug", false))
 {
@@ -55,14 +67,49 @@ bool MFVV0Vertexer::filter(edm::Event& event, const edm::EventSetup& setup) {
 
   if (debug) printf("# selected tracks: %lu\n", ntracks);
 
+  refs.resize(ntracks);
+  ttks.resize(ntracks);
+  pftks.resize(ntracks);
+  for (size_t itk = 0; itk < ntracks; ++itk) {
+    refs[itk] = reco::TrackRef(tracks, itk);
+    ttks[itk] = tt_builder->build(refs[itk]);
+  }
+
+  if (ntracks > 0) {
+    const double b = ttks[0].field()->inInverseGeV(GlobalPoint(0,0,0)).z();
+    for (size_t itk = 0; itk < ntracks; ++itk) {
+      const reco::Track& tk = *refs[itk];
+      pftks[itk] = mfv::V0PrefilterTrack(tk.vx(), tk.vy(), tk.px(), tk.py(), tk.pz(), tk.charge(), b);
+    }
+  }
+
+  // Before fitting, the combination's helices have to come within
+  // prefilter_max_dca of each other in the transverse plane (every pair
+  // for triplets), so a bad pair skips all the triplets it's in.
+  const bool use_dca = prefilter_max_dca > 0;
+  auto dca_ok = [&](const mfv::V0PrefilterDCA& d) { return !use_dca || d.dca < prefilter_max_dca; };
+
   for (size_t itk = 0; itk < ntracks; ++itk) {
-    reco::TrackRef tki(tracks, itk);
     for (size_t jtk = itk+1; jtk < ntracks; ++jtk) {
-      reco::TrackRef tkj(tracks, jtk);
-      do_hyps({tki, tkj}, vertices);
+      const mfv::V0PrefilterDCA dij = mfv::v0_prefilter_dca(pftks[itk], pftks[jtk]);
+      if (!dca_ok(dij)) {
+        if (debug) printf("tracks %lu %lu: transverse dca %f, skipping them and their triplets\n", itk, jtk, dij.dca);
+        continue;
+      }
+      const int qij = refs[itk]->charge() + refs[jtk]->charge();
+      if (any_hyp(2, qij))
+        do_hyps({itk, jtk}, dij.x, dij.y, vertices);
+
       for (size_t ktk = jtk+1; ktk < ntracks; ++ktk) {
-        reco::TrackRef tkk(tracks, ktk);
-        do_hyps({tki, tkj, tkk}, vertices);
+        if (!any_hyp(3, qij + refs[ktk]->charge()))
+          continue;
+        const mfv::V0PrefilterDCA dik = mfv::v0_prefilter_dca(pftks[itk], pftks[ktk]);
+        const mfv::V0PrefilterDCA djk = mfv::v0_prefilter_dca(pftks[jtk], pftks[ktk]);
+        if (!dca_ok(dik) || !dca_ok(djk)) {
+          if (debug) printf("tracks %lu %lu %lu: transverse dcas %f %f %f, skipping\n", itk, jtk, ktk, dij.dca, dik.dca, djk.dca);
+          continue;
+        }
+        do_hyps({itk, jtk, ktk}, (dij.x + dik.x + djk.x) / 3, (dij.y + dik.y + djk.y) / 3, vertices);
       }
     }
   }
@@ -84,33 +131,48 @@ bool MFVV0Vertexer::filter(edm::Event& event, const edm::EventSetup& setup) {
   return !cut || nvertices;
 }
 
-void MFVV0Vertexer::do_hyps(const std::vector<reco::TrackRef> tracks, std::unique_ptr<reco::VertexCollection>& vertices) {
-  const size_t ntracks = tracks.size();
-  const int tracks_charge = std::accumulate(tracks.begin(), tracks.end(), 0, [](const int a, const reco::TrackRef& tk) { return a + tk->charge(); });
+bool MFVV0Vertexer::any_hyp(const size_t ntracks, const int charge) {
+  for (const auto& hyp : mfv::V0_hypotheses)
+    if (hyp.ndaughters() == ntracks && abs(hyp.charge()) == abs(charge))
+      return true;
+  return false;
+}
+
+void MFVV0Vertexer::do_hyps(const std::vector<size_t>& itks, const double x, const double y, std::unique_ptr<reco::VertexCollection>& vertices) {
+  const size_t ntracks = itks.size();
+  const int tracks_charge = std::accumulate(itks.begin(), itks.end(), 0, [this](const int a, const size_t i) { return a + refs[i]->charge(); });
 
   if (debug) {
     printf("track set:\n");
-    for (size_t i = 0; i < ntracks; ++i) {
-      const reco::TrackRef& tk = tracks[i];
+    for (size_t i : itks) {
+      const reco::TrackRef& tk = refs[i];
       printf("  %4u: %s <%10.4f %10.4f %10.4f>\n", tk.key(), tk->charge() > 0 ? "+" : "-", tk->pt(), tk->eta(), tk->phi());
     }
   }
 
+  std::vector<const mfv::V0PrefilterTrack*> pf(ntracks);
+  for (size_t i = 0; i < ntracks; ++i)
+    pf[i] = &pftks[itks[i]];
+
   bool one_hyp_ok = false;
   for (const auto& hyp : mfv::V0_hypotheses) {
     if (debug) printf("hypothesis code %i = %s ndau %lu charge %i:\n", hyp.type, hyp.name, hyp.ndaughters(), hyp.charge());
     if (hyp.ndaughters() == ntracks && abs(hyp.charge()) == abs(tracks_charge)) {
       if (debug) printf("  matches #tracks %lu and charge %i\n", ntracks, tracks_charge);
+      if (prefilter_mass_window >= 0 && !mfv::v0_prefilter_mass_ok(pf, x, y, hyp, prefilter_mass_window)) {
+        if (debug) printf("  but no pre-fit mass within %f\n", prefilter_mass_window);
+        continue;
+      }
       one_hyp_ok = true;
       break;
     }
   }
 
   if (one_hyp_ok) {
-    std::vector<reco::TransientTrack> ttks(ntracks);
+    std::vector<reco::TransientTrack> fit_ttks(ntracks);
     for (size_t i = 0; i < ntracks; ++i)
-      ttks[i] = tt_builder->build(tracks[i]);
-    TransientVertex v = kv_reco->vertex(ttks);
+      fit_ttks[i] = ttks[itks[i]];
+    TransientVertex v = kv_reco->vertex(fit_ttks);
     const bool valid = v.isValid();
     const bool keep = valid && v.normalisedChiSquared() < max_chi2ndf;
     if (debug) printf("vertex valid? %i chi2/ndf %f keep? %i\n", valid, (valid ? v.normalisedChiSquared() : -1), keep);
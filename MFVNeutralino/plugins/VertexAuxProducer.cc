@@ -10,12 +10,15 @@
 #include "FWCore/Common/interface/TriggerNames.h"
 #include "FWCore/Framework/interface/EDProducer.h"
 #include "FWCore/Framework/interface/ESHandle.h"
+#include "FWCore/Framework/interface/ESWatcher.h"
 #include "FWCore/Framework/interface/Event.h"
 #include "FWCore/Framework/interface/EventSetup.h"
 #include "FWCore/Framework/interface/MakerMacros.h"
+#include "Geometry/Records/interface/GlobalTrackingGeometryRecord.h"
 #include "JMTucker/MFVNeutralinoFormats/interface/VertexAux.h"
 #include "JMTucker/MFVNeutralino/interface/JetTrackRefGetter.h"
 #include "JMTucker/MFVNeutralino/interface/VertexTools.h"
+#include "JMTucker/Tools/interface/TrackerSpaceExtent.h"
 #include "JMTucker/Tools/interface/Utilities.h"
 
 namespace {
@@ -46,8 +49,13 @@ class MFVVertexAuxProducer : public edm::EDProducer {
   edm::EDGetTokenT<mfv::JetVertexAssociation> sv_to_jets_token[mfv::NJetsByUse];
   mfv::JetTrackRefGetter jet_track_ref_getter;
   const MFVVertexAuxSorter sorter;
+  const std::string tracker_extents_cache;
+  const bool check_batch;
   const bool verbose;
   const std::string module_label;
+
+  TrackerSpaceExtents tracker_extents;
+  edm::ESWatcher<GlobalTrackingGeometryRecord> tracker_geometry_watcher;
 };
 
 MFVVertexAuxProducer::MFVVertexAuxProducer(const edm::ParameterSet& cfg)
@@ -63,6 +71,8 @@ MFVVertexAuxProducer::MFVVertexAuxProducer(const edm::ParameterSet& cfg)
                          cfg.getParameter<edm::ParameterSet>("jet_track_ref_getter"),
                          consumesCollector()),
     sorter(cfg.getParameter<std::string>("sort_by")),
+    tracker_extents_cache(cfg.getUntrackedParameter<std::string>("tracker_extents_cache", "")),
+    check_batch(cfg.getUntrackedParameter<bool>("check_batch", false)),
     verbose(cfg.getUntrackedParameter<bool>("verbose", false)),
     module_label(cfg.getParameter<std::string>("@module_label"))
 {
@@ -85,6 +95,11 @@ void MFVVertexAuxProducer::produce(edm::Event& event, const edm::EventSetup& set
   const GlobalPoint origin(bsx, bsy, bsz);
   const reco::Vertex fake_bs_vtx(beamspot->position(), beamspot->covariance3D());
 
+  // Refill whenever the geometry changes. The cache file can only be
+  // for the geometry we started with, so later refills walk it.
+  if (tracker_geometry_watcher.check(setup))
+    tracker_extents.fill(setup, GlobalPoint(0,0,0), tracker_extents.filled() ? "" : tracker_extents_cache);
+
   //////////////////////////////////////////////////////////////////////
 
   edm::Handle<reco::VertexCollection> primary_vertices;
@@ -130,6 +145,9 @@ void MFVVertexAuxProducer::produce(edm::Event& event, const edm::EventSetup& set
 
   //////////////////////////////////////////////////////////////////////
 
+  // The beamspot and PV distances of all the vertices at once.
+  const mfv::sv_distances_batch sv_distances(*secondary_vertices, *beamspot, primary_vertex);
+
   std::unique_ptr<std::vector<MFVVertexAux> > auxes(new std::vector<MFVVertexAux>(nsv));
   std::set<int> trackicity;
 
@@ -257,8 +275,9 @@ void MFVVertexAuxProducer::produce(edm::Event& event, const edm::EventSetup& set
       if (verbose) printf("    %i <%f,%f,%f,%f>\n", i, aux.pt[i], aux.eta[i], aux.phi[i], aux.mass[i]);
     }
       
-    //const double sv_r = mag(sv.position().x() - bsx, sv.position().y() - bsy);
-    //const double sv_z = fabs(sv.position().z() - bsz);
+    // The layer extents are measured from the detector origin, not the
+    // beamspot, so the vertex position is too.
+    const TrackerSpaceExtents::Behind behind = tracker_extents.behind(mag(sv.x(), sv.y()), fabs(sv.z()));
 
     auto trkb = sv.tracks_begin();
     auto trke = sv.tracks_end();
@@ -291,7 +310,7 @@ void MFVVertexAuxProducer::produce(edm::Event& event, const edm::EventSetup& set
 
       costhtkmomvtxdisps.push_back(costh3(tri->momentum(), pv2sv));
 
-      const uchar nhitsbehind = 0; //int2uchar(tracker_extents.numHitsBehind(tri->hitPattern(), sv_r, sv_z));
+      const uchar nhitsbehind = int2uchar(behind.count(tri->hitPattern()));
 
       const std::vector<std::pair<int, float> >& pv_for_track = tracks_in_pvs[trref];
       if (pv_for_track.size() > 1)
@@ -327,7 +346,13 @@ void MFVVertexAuxProducer::produce(edm::Event& event, const edm::EventSetup& set
       aux.track_phi.push_back(tri->phi());
     }
 
-    const mfv::vertex_distances vtx_distances(sv, *gen_vertices, *beamspot, primary_vertex, p4s);
+    const mfv::vertex_distances vtx_distances(sv_distances, isv, sv, *gen_vertices, *beamspot, primary_vertex, p4s);
+
+    if (check_batch) {
+      const std::string m = vtx_distances.mismatch(mfv::vertex_distances(sv, *gen_vertices, *beamspot, primary_vertex, p4s));
+      if (!m.empty())
+        throw cms::Exception("MFVVertexAuxProducer") << "batch vertex distance mismatch for vertex " << isv << ": batch vs scalar " << m;
+    }
 
     distrib_calculator costhtkmomvtxdisp(costhtkmomvtxdisps);
     aux.costhtkmomvtxdispmin(costhtkmomvtxdisp.min.back());
@@ -1,4 +1,5 @@
 #include "TH2.h"
+#include "Math/CholeskyDecomp.h"
 #include "CommonTools/UtilAlgos/interface/TFileService.h"
 #include "DataFormats/TrackReco/interface/Track.h"
 #include "DataFormats/TrackReco/interface/TrackFwd.h"
@@ -10,6 +11,8 @@
 #include "FWCore/ServiceRegistry/interface/Service.h"
 #include "RecoVertex/ConfigurableVertexReco/interface/ConfigurableVertexReconstructor.h"
 #include "RecoVertex/KalmanVertexFit/interface/KalmanVertexFitter.h"
+#include "RecoVertex/KalmanVertexFit/interface/KalmanVertexUpdator.h"
+#include "RecoVertex/VertexPrimitives/interface/VertexException.h"
 #include "TrackingTools/Records/interface/TransientTrackRecord.h"
 #include "TrackingTools/TransientTrack/interface/TransientTrack.h"
 #include "TrackingTools/TransientTrack/interface/TransientTrackBuilder.h"
@@ -21,6 +24,7 @@ public:
 
 private:
   std::unique_ptr<KalmanVertexFitter> kv_reco;
+  KalmanVertexUpdator<5> kv_updator;
 
   static const int max_n_input_vertices;
 
@@ -39,6 +43,17 @@ private:
   enum SortTracksBy { SortTracksByDxyErr, SortTracksByPt };
   SortTracksBy sort_tracks_by;
 
+  // Full: fit each subset from scratch. Downdate: fit all the tracks
+  // once and get each subset by taking the dropped tracks' contributions
+  // back out of the fitted state (the inverse Kalman update), falling
+  // back to a full fit of the subset if that doesn't leave a sane
+  // covariance matrix. The downdated vertices keep the linearization
+  // points and smoothed tracks from the full fit.
+  enum RefitMode { RefitFull, RefitDowndate };
+  RefitMode refit_mode;
+
+  bool downdate_ok(const CachingVertex<5>& full, const CachingVertex<5>& v) const;
+
 #if 0
   VertexDistanceXY vertex_dist_2d;
 
@@ -73,6 +88,14 @@ MFVVertexRefitter::MFVVertexRefitter(const edm::ParameterSet& cfg)
   else
     throw cms::Exception("MFVVertexRefitter") << "sort_tracks_by " << sort_tracks_by_str << " unrecognized";
 
+  const std::string& refit_mode_str = cfg.getParameter<std::string>("refit_mode");
+  if (refit_mode_str == "full")
+    refit_mode = RefitFull;
+  else if (refit_mode_str == "downdate")
+    refit_mode = RefitDowndate;
+  else
+    throw cms::Exception("MFVVertexRefitter") << "refit_mode " << refit_mode_str << " unrecognized";
+
   for (int i = 0; i < max_n_input_vertices; ++i)
     produces<reco::VertexCollection>(vertex_collection_name(i));
 
@@ -103,6 +126,23 @@ namespace {
   }
 }
 
+bool MFVVertexRefitter::downdate_ok(const CachingVertex<5>& full, const CachingVertex<5>& v) const {
+  if (!v.isValid())
+    return false;
+
+  // Taking information out can only make the errors bigger; if it
+  // didn't, or the result isn't positive definite, the subtraction ate
+  // the precision.
+  const AlgebraicSymMatrix33 c = v.error().matrix();
+  const AlgebraicSymMatrix33 c0 = full.error().matrix();
+  for (int i = 0; i < 3; ++i)
+    if (!(c(i,i) >= c0(i,i) * (1 - 1e-6)))
+      return false;
+
+  ROOT::Math::CholeskyDecomp<double, 3> decomp(c);
+  return decomp;
+}
+
 void MFVVertexRefitter::produce(edm::Event& event, const edm::EventSetup& setup) {
   if (verbose) {
     printf("------------------------------------------------------------------------\n");
@@ -144,19 +184,75 @@ void MFVVertexRefitter::produce(edm::Event& event, const edm::EventSetup& setup)
       else
         throw cms::Exception("MFVVertexRefitter") << "sort_tracks_by " << sort_tracks_by << " not implemented";
 
+      std::vector<reco::TransientTrack> all_ttks(n_tracks);
+      for (size_t i = 0; i < n_tracks; ++i)
+        all_ttks[i] = tt_builder->build(input_tracks[i]);
+
+      // For the downdate mode, the full fit and which of its
+      // VertexTracks is which input track.
+      CachingVertex<5> full_vertex;
+      std::vector<CachingVertex<5>::RefCountedVertexTrack> full_vertex_tracks;
+      bool use_downdate = false;
+      if (refit_mode == RefitDowndate) {
+        full_vertex = kv_reco->vertex(all_ttks);
+        if (full_vertex.isValid()) {
+          const auto vts = full_vertex.tracks();
+          full_vertex_tracks.resize(n_tracks);
+          use_downdate = true;
+          for (size_t i = 0; i < n_tracks; ++i) {
+            bool found = false;
+            for (const auto& vt : vts)
+              if (vt->linearizedTrack()->track() == all_ttks[i]) {
+                full_vertex_tracks[i] = vt;
+                found = true;
+              }
+            if (!found)
+              use_downdate = false;
+          }
+        }
+        if (verbose && !use_downdate)
+          printf("input vertex %i: full fit not usable for downdating, fitting each subset\n", iiv);
+      }
+
+      int n_fallbacks = 0;
+
       std::vector<int> drop(n_tracks, 0);
       for (size_t i = n_tracks - 1, ie = n_tracks - n_tracks_to_drop - 1; i > ie; --i)
         drop[i] = 1;
 
       do {
+        if (use_downdate) {
+          bool ok = true;
+          CachingVertex<5> v = full_vertex;
+          try {
+            for (size_t i = 0; i < n_tracks && ok; ++i)
+              if (drop[i]) {
+                v = kv_updator.remove(v, full_vertex_tracks[i]);
+                ok = downdate_ok(full_vertex, v);
+              }
+          }
+          catch (const VertexException&) {
+            ok = false;
+          }
+
+          if (ok) {
+            vertices->push_back(reco::Vertex(TransientVertex(v)));
+            continue;
+          }
+          ++n_fallbacks;
+        }
+
         std::vector<reco::TransientTrack> ttks;
         for (size_t i = 0; i < n_tracks; ++i)
           if (!drop[i])
-            ttks.push_back(tt_builder->build(input_tracks[i]));
+            ttks.push_back(all_ttks[i]);
 
         vertices->push_back(reco::Vertex(TransientVertex(kv_reco->vertex(ttks))));
       }
       while (std::next_permutation(drop.begin(), drop.end()));
+
+      if (verbose && use_downdate)
+        printf("input vertex %i: %lu subsets, %i fell back to a full fit\n", iiv, vertices->size(), n_fallbacks);
     }
 
     event.put(std::move(vertices), vertex_collection_name(iiv));
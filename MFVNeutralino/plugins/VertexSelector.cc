@@ -263,7 +263,8 @@ bool MFVVertexSelector::use_vertex(const MFVVertexAux& vtx, const MFVEvent* meve
   if (use_cluster_cuts) {
     assert(mevent);
 
-    const mfv::track_clusters clusters(vtx);
+    const mfv::track_cluster_history history(vtx);
+    const mfv::track_clusters clusters(history);
 
     const size_t nclusters = clusters.size();
     if (int(nclusters) < min_nclusters ||
@@ -13,6 +13,7 @@
 #include "FWCore/Framework/interface/MakerMacros.h"
 #include "FWCore/ServiceRegistry/interface/Service.h"
 #include "FWCore/Utilities/interface/RandomNumberGenerator.h"
+#include "JMTucker/Tools/interface/RecoTrackCuts.h"
 #include "TrackingTools/IPTools/interface/IPTools.h"
 #include "TrackingTools/Records/interface/TransientTrackRecord.h"
 #include "TrackingTools/TransientTrack/interface/TransientTrack.h"
@@ -55,6 +56,8 @@ private:
   const double max_track_dxyerr;
   const double max_track_dxyipverr;
   const double max_track_d3dipverr;
+  jmt::TrackCuts track_cuts;
+  unsigned track_cut_bits;
   const bool jumble_tracks;
   const double remove_tracks_frac;
   const bool histos;
@@ -128,6 +131,18 @@ MFVVertexTracks::MFVVertexTracks(const edm::ParameterSet& cfg)
   if (min_track_hit_r < 1 || min_track_hit_r > 4)
     throw cms::Exception("MFVVertexTracks") << "hit_r cuts may only be 1-4";
 
+  track_cuts.min_pt = min_track_pt;
+  track_cuts.max_min_r = min_track_hit_r;
+  track_cuts.min_npxlayers = min_track_npxlayers;
+  track_cuts.min_nstlayers = min_track_nstlayers;
+  track_cuts.min_nsigmadxybs = min_track_sigmadxy;
+  track_cuts.min_dxybs = min_track_dxy;
+  track_cuts.max_dxyerr = max_track_dxyerr;
+  track_cuts.min_nsigmadxypv = min_track_sigmadxypv;
+  track_cuts.min_nhits = min_track_nhits;
+  track_cuts.min_npxhits = min_track_npxhits;
+  track_cut_bits = jmt::tkcuts_seed | jmt::tkcut_dxybs | jmt::tkcut_dxyerr | jmt::tkcut_nsigmadxypv | jmt::tkcut_nhits | jmt::tkcut_npxhits;
+
   if (use_tracks + use_non_pv_tracks + use_non_pvs_tracks + use_pf_candidates + use_pf_jets + use_pat_jets != 1)
     throw cms::Exception("MFVVertexTracks") << "must enable exactly one of use_tracks/use_non_pv_tracks/use_non_pvs_tracks/pf_candidates/pf_jets/pat_jets";
 
@@ -217,30 +232,15 @@ bool MFVVertexTracks::filter(edm::Event& event, const edm::EventSetup& setup) {
         all_tracks->push_back(reco::TrackRef(tracks, i));
     }
     else if (use_non_pv_tracks || use_non_pvs_tracks) {
-      std::map<reco::TrackRef, std::vector<std::pair<int, float> > > tracks_in_pvs;
-      for (size_t i = 0, ie = primary_vertices->size(); i < ie; ++i) {
-        const reco::Vertex& pv = primary_vertices->at(i);
-        for (auto it = pv.tracks_begin(), ite = pv.tracks_end(); it != ite; ++it) {
-          float w = pv.trackWeight(*it);
-          reco::TrackRef tk = it->castTo<reco::TrackRef>();
-          tracks_in_pvs[tk].push_back(std::make_pair(i, w));
-        }
-      }
-
       edm::Handle<reco::TrackCollection> tracks;
       event.getByToken(tracks_token, tracks);
-      for (size_t i = 0, ie = tracks->size(); i < ie; ++i) {
-        reco::TrackRef tkref(tracks, i);
-        bool ok = true;
-        for (const auto& pv_use : tracks_in_pvs[tkref])
-          if (use_non_pvs_tracks || (use_non_pv_tracks && pv_use.first == 0)) {
-            ok = false;
-            break;
-          }
 
-        if (ok)
-          all_tracks->push_back(tkref);
-      }
+      std::vector<int> tracks_first_pv, tracks_npvs;
+      jmt::tracks_in_pvs(*primary_vertices, tracks, tracks_first_pv, tracks_npvs);
+
+      for (size_t i = 0, ie = tracks->size(); i < ie; ++i)
+        if (use_non_pvs_tracks ? tracks_npvs[i] == 0 : tracks_first_pv[i] != 0)
+          all_tracks->push_back(reco::TrackRef(tracks, i));
     }
     else if (use_pf_candidates) {
       edm::Handle<reco::PFCandidateCollection> pf_candidates;
@@ -300,44 +300,33 @@ bool MFVVertexTracks::filter(edm::Event& event, const edm::EventSetup& setup) {
     std::random_shuffle(all_tracks->begin(), all_tracks->end(), random_converter);
   }
 
+  // Get the cut variables of all the tracks first, then apply the cuts
+  // to them all at once.
+  jmt::TrackCutVars vars;
+  vars.reserve(all_tracks->size());
+  for (const reco::TrackRef& tk : *all_tracks)
+    vars.push_back(jmt::track_cut_values(*tk, &*beamspot, primary_vertex));
+  std::vector<unsigned> fails;
+  track_cuts.apply(vars, fails);
+
   for (size_t i = 0, ie = all_tracks->size(); i < ie; ++i) {
     const reco::TrackRef& tk = (*all_tracks)[i];
     const bool is_second_track = i >= second_tracks_start_at;
 
-    // copy/calculate cheap things, which may be used later in histos
-    const double pt = tk->pt();
-    const double dxybs = tk->dxy(*beamspot);
-    const double dxypv = primary_vertex ? tk->dxy(primary_vertex->position()) : 1e99;
-    const double dxyerr = tk->dxyError();
-    const double sigmadxybs = dxybs / dxyerr;
-    const double sigmadxypv = dxypv / dxyerr;
-    const int nhits = tk->hitPattern().numberOfValidHits();
-    const int npxhits = tk->hitPattern().numberOfValidPixelHits();
-    const int nsthits = tk->hitPattern().numberOfValidStripHits();
-    const int npxlayers = tk->hitPattern().pixelLayersWithMeasurement();
-    const int nstlayers = tk->hitPattern().stripLayersWithMeasurement();
-    int min_r = 2000000000;
-    for (int i = 1; i <= 4; ++i)
-      if (tk->hitPattern().hasValidHitInPixelLayer(PixelSubdetector::PixelBarrel,i)) {
-        min_r = i;
-        break;
-      }
+    // copy cheap things, which may be used later in histos
+    const double pt = vars.pt[i];
+    const double dxybs = vars.dxybs[i];
+    const double dxypv = vars.dxypv[i];
+    const double sigmadxybs = vars.nsigmadxybs(i);
+    const double sigmadxypv = vars.nsigmadxypv(i);
+    const int nhits = vars.nhits[i];
+    const int npxhits = vars.npxhits[i];
+    const int nsthits = vars.nsthits[i];
+    const int npxlayers = vars.npxlayers[i];
+    const int nstlayers = vars.nstlayers[i];
 
     bool use = no_track_cuts || is_second_track || [&]() {
-
-      const bool use_cheap =
-        pt > min_track_pt &&
-        fabs(dxybs) > min_track_dxy &&
-        dxyerr < max_track_dxyerr &&
-        fabs(sigmadxybs) > min_track_sigmadxy &&
-        fabs(sigmadxypv) > min_track_sigmadxypv &&
-        nhits >= min_track_nhits &&
-        npxhits >= min_track_npxhits &&
-        npxlayers >= min_track_npxlayers &&
-        nstlayers >= min_track_nstlayers &&
-        (min_track_hit_r == 999 || min_r <= min_track_hit_r);
-
-      if (!use_cheap) return false;
+      if (!jmt::tkcuts_pass(fails[i], track_cut_bits)) return false;
 
       if (primary_vertex && (max_track_dxyipverr > 0 || max_track_d3dipverr > 0)) {
         reco::TransientTrack ttk = tt_builder->build(tk);
@@ -430,17 +419,11 @@ bool MFVVertexTracks::filter(edm::Event& event, const edm::EventSetup& setup) {
       h_all_track_npxlayers->Fill(npxlayers);
       h_all_track_nstlayers->Fill(nstlayers);
 
-      const bool nm1[4] = {
-        pt > min_track_pt,
-        npxlayers >= min_track_npxlayers,
-        nstlayers >= min_track_nstlayers,
-        fabs(sigmadxybs) > min_track_sigmadxy
-      };
-
-      if (nm1[1] && nm1[2] && nm1[3]) h_seed_nm1_pt->Fill(pt);
-      if (nm1[0] && nm1[2] && nm1[3]) h_seed_nm1_npxlayers->Fill(npxlayers);
-      if (nm1[0] && nm1[1] && nm1[3]) h_seed_nm1_nstlayers->Fill(nstlayers);
-      if (nm1[0] && nm1[1] && nm1[2]) h_seed_nm1_sigmadxybs->Fill(sigmadxybs);
+      const unsigned nm1_cuts = jmt::tkcut_pt | jmt::tkcut_npxlayers | jmt::tkcut_nstlayers | jmt::tkcut_nsigmadxybs;
+      if (jmt::tkcuts_pass_nm1(fails[i], jmt::tkcut_pt,          nm1_cuts)) h_seed_nm1_pt->Fill(pt);
+      if (jmt::tkcuts_pass_nm1(fails[i], jmt::tkcut_npxlayers,   nm1_cuts)) h_seed_nm1_npxlayers->Fill(npxlayers);
+      if (jmt::tkcuts_pass_nm1(fails[i], jmt::tkcut_nstlayers,   nm1_cuts)) h_seed_nm1_nstlayers->Fill(nstlayers);
+      if (jmt::tkcuts_pass_nm1(fails[i], jmt::tkcut_nsigmadxybs, nm1_cuts)) h_seed_nm1_sigmadxybs->Fill(sigmadxybs);
 
       if (use) {
         for (int i = 0; i < 6; ++i) {
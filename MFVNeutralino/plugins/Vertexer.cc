@@ -1,5 +1,4 @@
 #include "TH2.h"
-#include "TMath.h"
 #include "CommonTools/UtilAlgos/interface/TFileService.h"
 #include "DataFormats/Math/interface/deltaPhi.h"
 #include "DataFormats/TrackReco/interface/Track.h"
@@ -18,6 +17,8 @@
 #include "TrackingTools/TransientTrack/interface/TransientTrack.h"
 #include "TrackingTools/TransientTrack/interface/TransientTrackBuilder.h"
 #include "JMTucker/MFVNeutralinoFormats/interface/VertexerPairEff.h"
+#include "JMTucker/MFVNeutralino/interface/VertexerAlgo.h"
+#include "JMTucker/MFVNeutralino/interface/VertexTools.h"
 #include "JMTucker/Tools/interface/Utilities.h"
 
 class MFVVertexer : public edm::EDProducer {
@@ -30,37 +31,6 @@ private:
 
   void finish(edm::Event&, const std::vector<reco::TransientTrack>&, std::unique_ptr<reco::VertexCollection>, std::unique_ptr<VertexerPairEffs>, const std::vector<std::pair<track_set, track_set>>&);
 
-  template <typename T>
-  void print_track_set(const T& ts) const {
-    for (auto r : ts)
-      printf(" %u", r.key());
-  }
-
-  template <typename T>
-  void print_track_set(const T& ts, const reco::Vertex& v) const {
-    for (auto r : ts)
-      printf(" %u%s", r.key(), (v.trackWeight(r) < 0.5 ? "!" : ""));
-  }
-
-  void print_track_set(const reco::Vertex& v) const {
-    for (auto r = v.tracks_begin(), re = v.tracks_end(); r != re; ++r)
-      printf(" %lu%s", r->key(), (v.trackWeight(*r) < 0.5 ? "!" : ""));
-  }
-
-  bool is_track_subset(const track_set& a, const track_set& b) const {
-    bool is_subset = true;
-    const track_set& smaller = a.size() <= b.size() ? a : b;
-    const track_set& bigger  = a.size() <= b.size() ? b : a;
-    
-    for (auto t : smaller)
-      if (bigger.count(t) < 1) {
-        is_subset = false;
-        break;
-      }
-
-    return is_subset;
-  }
-
   track_set vertex_track_set(const reco::Vertex& v, const double min_weight = 0.5) const {
     std::set<reco::TrackRef> result;
 
@@ -83,6 +53,31 @@ private:
       return vertex_dist_3d.distance(v0, v1);
   }
 
+  // vertex_dist(v[i], v[j]) for all j > i, in one batch.
+  void vertex_dists(const reco::VertexCollection& v, size_t i, std::vector<Measurement1D>& d) const {
+    mfv::vertex_soa a, b;
+    a.reserve(v.size() - i - 1);
+    for (size_t j = i+1; j < v.size(); ++j)
+      a.push_back(v[j]);
+    b.push_back(v[i]);
+    mfv::distance_batch r;
+    mfv::vertex_distances_batch(a, b, !use_2d_vertex_dist, r);
+
+    d.clear();
+    for (size_t j = 0; j < r.size(); ++j)
+      d.push_back(Measurement1D(r.val[j], r.err[j]));
+
+    if (check_batch)
+      for (size_t j = 0; j < r.size(); ++j) {
+        const Measurement1D m = vertex_dist(v[i], v[i+1+j]);
+        if (fabs(m.value() - d[j].value()) > 1e-5 + 1e-4 * fabs(m.value()) ||
+            fabs(m.error() - d[j].error()) > 1e-5 + 1e-4 * fabs(m.error()))
+          throw cms::Exception("MFVVertexer") << "batch vertex dist mismatch for vertices " << i << ", " << i+1+j
+                                              << ": scalar " << m.value() << " +- " << m.error()
+                                              << " batch " << d[j].value() << " +- " << d[j].error();
+      }
+  }
+
   std::pair<bool, Measurement1D> track_dist(const reco::TransientTrack& t, const reco::Vertex& v) const {
     if (use_2d_track_dist)
       return IPTools::absoluteTransverseImpactParameter(t, v);
@@ -90,20 +85,49 @@ private:
       return IPTools::absoluteImpactParameter3D(t, v);
   }
 
+  // What mfv::VertexerAlgo needs, for the seed tracks in this event.
+  struct Backend {
+    typedef reco::TrackRef track_t;
+    typedef reco::Vertex vertex_t;
+    typedef VertexerPairEff pair_eff_t;
+    typedef Measurement1D dist_t;
+
+    const MFVVertexer& m;
+    const std::vector<reco::TrackRef>& refs;
+    const std::vector<reco::TransientTrack>& ttks;
+    const std::map<reco::TrackRef, size_t>& index;
+
+    const reco::TransientTrack& ttk(const reco::TrackRef& tk) const { return ttks[index.find(tk)->second]; }
+
+    size_t n_seed_tracks() const { return refs.size(); }
+    track_t seed_track(size_t i) const { return refs[i]; }
+    unsigned key(const reco::TrackRef& tk) const { return tk.key(); }
+
+    bool fit(const std::vector<reco::TrackRef>& tks, reco::Vertex& v) const {
+      std::vector<reco::TransientTrack> t;
+      t.reserve(tks.size());
+      for (const auto& tk : tks)
+        t.push_back(ttk(tk));
+      TransientVertex tv = m.kv_reco->vertex(t);
+      v = reco::Vertex(tv);
+      return tv.isValid();
+    }
+
+    // Same as TransientVertex::normalisedChiSquared, which the seed cut
+    // used before, rather than reco::Vertex's 1e6*chi2 for ndof = 0.
+    double normalized_chi2(const reco::Vertex& v) const { return float(v.chi2()) / float(v.ndof()); }
+    track_set tracks(const reco::Vertex& v, double min_weight) const { return m.vertex_track_set(v, min_weight); }
+    Measurement1D vertex_dist(const reco::Vertex& v0, const reco::Vertex& v1) const { return m.vertex_dist(v0, v1); }
+    void vertex_dists(const reco::VertexCollection& v, size_t i, std::vector<Measurement1D>& d) const { m.vertex_dists(v, i, d); }
+    std::pair<bool, Measurement1D> track_dist(const reco::TrackRef& tk, const reco::Vertex& v) const { return m.track_dist(ttk(tk), v); }
+    void set_vertices(VertexerPairEff& e, const reco::Vertex& v0, const reco::Vertex& v1) const { e.set_vertices(v0, v1); }
+  };
+
   VertexDistanceXY vertex_dist_2d;
   VertexDistance3D vertex_dist_3d;
   std::unique_ptr<KalmanVertexFitter> kv_reco;
   std::unique_ptr<VertexReconstructor> av_reco;
 
-  std::vector<TransientVertex> kv_reco_dropin(std::vector<reco::TransientTrack>& ttks) {
-    if (ttks.size() < 2)
-      return std::vector<TransientVertex>();
-    std::vector<TransientVertex> v(1, kv_reco->vertex(ttks));
-    if (v[0].normalisedChiSquared() > 5)
-      return std::vector<TransientVertex>();
-    return v;
-  }
-
   const edm::EDGetTokenT<reco::BeamSpot> beamspot_token;
   const edm::EDGetTokenT<std::vector<reco::TrackRef>> seed_tracks_token;
   const int n_tracks_per_seed_vertex;
@@ -118,9 +142,11 @@ private:
   const double max_track_vertex_sig;
   const double min_track_vertex_sig_to_remove;
   const bool remove_one_track_at_a_time;
+  const bool check_batch;
   const bool histos;
   const bool verbose;
   const std::string module_label;
+  mfv::VertexerParams algo_params;
 
   TH1F* h_n_seed_vertices;
   TH1F* h_seed_vertex_track_weights;
@@ -174,6 +200,7 @@ MFVVertexer::MFVVertexer(const edm::ParameterSet& cfg)
     max_track_vertex_sig(cfg.getParameter<double>("max_track_vertex_sig")),
     min_track_vertex_sig_to_remove(cfg.getParameter<double>("min_track_vertex_sig_to_remove")),
     remove_one_track_at_a_time(cfg.getParameter<bool>("remove_one_track_at_a_time")),
+    check_batch(cfg.getUntrackedParameter<bool>("check_batch", false)),
     histos(cfg.getUntrackedParameter<bool>("histos", false)),
     verbose(cfg.getUntrackedParameter<bool>("verbose", false)),
     module_label(cfg.getParameter<std::string>("@module_label"))
@@ -181,6 +208,18 @@ MFVVertexer::MFVVertexer(const edm::ParameterSet& cfg)
   if (n_tracks_per_seed_vertex < 2 || n_tracks_per_seed_vertex > 5)
     throw cms::Exception("MFVVertexer", "n_tracks_per_seed_vertex must be one of 2,3,4,5");
 
+  algo_params.n_tracks_per_seed_vertex = n_tracks_per_seed_vertex;
+  algo_params.max_seed_vertex_chi2 = max_seed_vertex_chi2;
+  algo_params.merge_anyway_dist = merge_anyway_dist;
+  algo_params.merge_anyway_sig = merge_anyway_sig;
+  algo_params.merge_shared_dist = merge_shared_dist;
+  algo_params.merge_shared_sig = merge_shared_sig;
+  algo_params.max_track_vertex_dist = max_track_vertex_dist;
+  algo_params.max_track_vertex_sig = max_track_vertex_sig;
+  algo_params.min_track_vertex_sig_to_remove = min_track_vertex_sig_to_remove;
+  algo_params.remove_one_track_at_a_time = remove_one_track_at_a_time;
+  algo_params.verbose = verbose;
+
   produces<reco::VertexCollection>();
   produces<VertexerPairEffs>();
   produces<reco::TrackCollection>("seed"); // JMTBAD remove me
@@ -315,66 +354,39 @@ void MFVVertexer::produce(edm::Event& event, const edm::EventSetup& setup) {
     return;
   }
 
-  std::vector<size_t> itks(n_tracks_per_seed_vertex, 0);
-
-  auto try_seed_vertex = [&]() {
-    std::vector<reco::TransientTrack> ttks(n_tracks_per_seed_vertex);
-    for (int i = 0; i < n_tracks_per_seed_vertex; ++i)
-      ttks[i] = seed_tracks[itks[i]];
-
-    TransientVertex seed_vertex = kv_reco->vertex(ttks);
-    if (seed_vertex.isValid() && seed_vertex.normalisedChiSquared() < max_seed_vertex_chi2) {
-      vertices->push_back(reco::Vertex(seed_vertex));
-
-      if (verbose || histos) {
-        const reco::Vertex& v = vertices->back();
-        const double vchi2 = v.normalizedChi2();
-        const double vndof = v.ndof();
-        const double vx = v.position().x() - bsx;
-        const double vy = v.position().y() - bsy;
-        const double vz = v.position().z() - bsz;
-        const double phi = atan2(vy, vx);
-        const double rho = mag(vx, vy);
-        const double r = mag(vx, vy, vz);
-        if (verbose) {
-          printf("from tracks");
-          for (auto itk : itks)
-            printf(" %lu", itk);
-          printf(": vertex #%3lu: chi2/dof: %7.3f dof: %7.3f pos: <%7.3f, %7.3f, %7.3f>  rho: %7.3f  phi: %7.3f  r: %7.3f\n", vertices->size()-1, vchi2, vndof, vx, vy, vz, rho, phi, r);
-        }
-        if (histos) {
-          for (auto it = v.tracks_begin(), ite = v.tracks_end(); it != ite; ++it)
-            h_seed_vertex_track_weights->Fill(v.trackWeight(*it));
-          h_seed_vertex_chi2->Fill(vchi2);
-          h_seed_vertex_ndof->Fill(vndof);
-          h_seed_vertex_x->Fill(vx);
-          h_seed_vertex_y->Fill(vy);
-          h_seed_vertex_rho->Fill(rho);
-          h_seed_vertex_phi->Fill(phi);
-          h_seed_vertex_z->Fill(vz);
-          h_seed_vertex_r->Fill(r);
-        }
-      }
-    }
-  };
+  Backend backend{*this, *seed_track_refs, seed_tracks, seed_track_ref_map};
+  mfv::VertexerAlgo<Backend> algo(algo_params, backend);
 
-  // ha
-  for (size_t itk = 0; itk < ntk; ++itk) {
-    itks[0] = itk;
-    for (size_t jtk = itk+1; jtk < ntk; ++jtk) {
-      itks[1] = jtk;
-      if (n_tracks_per_seed_vertex == 2) { try_seed_vertex(); continue; }
-      for (size_t ktk = jtk+1; ktk < ntk; ++ktk) {
-        itks[2] = ktk;
-        if (n_tracks_per_seed_vertex == 3) { try_seed_vertex(); continue; }
-        for (size_t ltk = ktk+1; ltk < ntk; ++ltk) {
-          itks[3] = ltk;
-          if (n_tracks_per_seed_vertex == 4) { try_seed_vertex(); continue; }
-          for (size_t mtk = ltk+1; mtk < ntk; ++mtk) {
-            itks[4] = mtk;
-            try_seed_vertex();
-          }
-        }
+  algo.seed(*vertices);
+
+  if (verbose || histos) {
+    for (size_t iv = 0, ive = vertices->size(); iv < ive; ++iv) {
+      const reco::Vertex& v = (*vertices)[iv];
+      const double vchi2 = v.normalizedChi2();
+      const double vndof = v.ndof();
+      const double vx = v.position().x() - bsx;
+      const double vy = v.position().y() - bsy;
+      const double vz = v.position().z() - bsz;
+      const double phi = atan2(vy, vx);
+      const double rho = mag(vx, vy);
+      const double r = mag(vx, vy, vz);
+      if (verbose) {
+        printf("from tracks");
+        for (auto it = v.tracks_begin(), ite = v.tracks_end(); it != ite; ++it)
+          printf(" %lu", seed_track_ref_map.find(it->castTo<reco::TrackRef>())->second);
+        printf(": vertex #%3lu: chi2/dof: %7.3f dof: %7.3f pos: <%7.3f, %7.3f, %7.3f>  rho: %7.3f  phi: %7.3f  r: %7.3f\n", iv, vchi2, vndof, vx, vy, vz, rho, phi, r);
+      }
+      if (histos) {
+        for (auto it = v.tracks_begin(), ite = v.tracks_end(); it != ite; ++it)
+          h_seed_vertex_track_weights->Fill(v.trackWeight(*it));
+        h_seed_vertex_chi2->Fill(vchi2);
+        h_seed_vertex_ndof->Fill(vndof);
+        h_seed_vertex_x->Fill(vx);
+        h_seed_vertex_y->Fill(vy);
+        h_seed_vertex_rho->Fill(rho);
+        h_seed_vertex_phi->Fill(phi);
+        h_seed_vertex_z->Fill(vz);
+        h_seed_vertex_r->Fill(r);
       }
     }
   }
@@ -399,297 +411,11 @@ void MFVVertexer::produce(edm::Event& event, const edm::EventSetup& setup) {
   if (histos)
     h_n_seed_vertices->Fill(vertices->size());
 
-  //////////////////////////////////////////////////////////////////////
-  // Take care of track sharing. If a track is in two vertices, and
-  // the vertices are "close", refit the tracks from the two together
-  // as one vertex. If the vertices are not close, keep the track in
-  // the vertex to which it is "closer".
-  //////////////////////////////////////////////////////////////////////
-
-  if (verbose)
-    printf("fun time!\n");
-
-  track_set discarded_tracks;
-  int n_resets = 0;
-  int n_onetracks = 0;
-  std::vector<reco::Vertex>::iterator v[2];
-  size_t ivtx[2];
-  for (v[0] = vertices->begin(); v[0] != vertices->end(); ++v[0]) {
-    track_set tracks[2];
-    ivtx[0] = v[0] - vertices->begin();
-    tracks[0] = vertex_track_set(*v[0]);
-
-    if (tracks[0].size() < 2) {
-      if (verbose)
-        printf("track-sharing: vertex-0 #%lu is down to one track, junking it\n", ivtx[0]);
-      v[0] = vertices->erase(v[0]) - 1;
-      ++n_onetracks;
-      continue;
-    }
-
-    bool duplicate = false;
-    bool merge = false;
-    bool refit = false;
-    track_set tracks_to_remove_in_refit[2];
-    VertexerPairEff* vpeff = 0;
-    const size_t max_vpeffs_size = 20000; // enough for 200 vertices to share tracks
-
-    for (v[1] = v[0] + 1; v[1] != vertices->end(); ++v[1]) {
-      ivtx[1] = v[1] - vertices->begin();
-      tracks[1] = vertex_track_set(*v[1]);
-
-      if (tracks[1].size() < 2) {
-        if (verbose)
-          printf("track-sharing: vertex-1 #%lu is down to one track, junking it\n", ivtx[1]);
-        v[1] = vertices->erase(v[1]) - 1;
-        ++n_onetracks;
-        continue;
-      }
-
-      if (verbose) {
-        printf("track-sharing: # vertices = %lu. considering vertices #%lu (chi2/dof %.3f prob %.2e, track set", vertices->size(), ivtx[0], v[0]->chi2()/v[0]->ndof(), TMath::Prob(v[0]->chi2(), int(v[0]->ndof())));
-        print_track_set(tracks[0], *v[0]);
-        printf(") and #%lu (chi2/dof %.3f prob %.2e, track set", ivtx[1], v[1]->chi2()/v[1]->ndof(), TMath::Prob(v[1]->chi2(), int(v[1]->ndof())));
-        print_track_set(tracks[1], *v[1]);
-        printf("):\n");
-      }
-
-      if (is_track_subset(tracks[0], tracks[1])) {
-        if (verbose)
-          printf("   subset/duplicate vertices %lu and %lu, erasing second and starting over\n", ivtx[0], ivtx[1]);
-        duplicate = true;
-        break;
-      }
-
-      if (vpeffs->size() < max_vpeffs_size) {
-        std::pair<track_set, track_set> vpeff_tracks(tracks[0], tracks[1]);
-        auto it = std::find(vpeffs_tracks.begin(), vpeffs_tracks.end(), vpeff_tracks);
-        if (it != vpeffs_tracks.end()) {
-          vpeffs->at(it - vpeffs_tracks.begin()).inc_weight();
-          vpeff = 0;
-        }
-        else {
-          vpeffs->push_back(VertexerPairEff());
-          vpeff = &vpeffs->back();
-          vpeff->set_vertices(*v[0], *v[1]);
-          vpeffs_tracks.push_back(vpeff_tracks);
-        }
-      }
-      else
-        vpeff = 0;
-
-      reco::TrackRefVector shared_tracks;
-      for (auto tk : tracks[0])
-        if (tracks[1].count(tk) > 0)
-          shared_tracks.push_back(tk);
-
-      if (verbose) {
-        if (shared_tracks.size()) {
-          printf("   shared tracks are: ");
-          print_track_set(shared_tracks);
-          printf("\n");
-        }
-        else
-          printf("   no shared tracks\n");
-      }  
-
-      if (shared_tracks.size() > 0) {
-        if (vpeff)
-          vpeff->kind(VertexerPairEff::share);
-
-        Measurement1D v_dist = vertex_dist(*v[0], *v[1]);
-        if (verbose)
-          printf("   vertex dist (2d? %i) %7.3f  sig %7.3f\n", use_2d_vertex_dist, v_dist.value(), v_dist.significance());
+  algo.arbitrate(*vertices, *vpeffs, vpeffs_tracks);
 
-        if (v_dist.value() < merge_shared_dist || v_dist.significance() < merge_shared_sig) {
-          if (verbose) printf("          dist < %7.3f || sig < %7.3f, will try using merge result first before arbitration\n", merge_shared_dist, merge_shared_sig);
-          merge = true;
-        }
-        else
-          refit = true;
-
-        if (verbose) printf("   checking for arbitration refit:\n");
-        for (auto tk : shared_tracks) {
-          const reco::TransientTrack& ttk = seed_tracks[seed_track_ref_map[tk]];
-          std::pair<bool, Measurement1D> t_dist_0 = track_dist(ttk, *v[0]);
-          std::pair<bool, Measurement1D> t_dist_1 = track_dist(ttk, *v[1]);
-          if (verbose) {
-            printf("      track-vertex0 dist (2d? %i) calc success? %i  dist %7.3f  sig %7.3f\n", use_2d_track_dist, t_dist_0.first, t_dist_0.second.value(), t_dist_0.second.significance());
-            printf("      track-vertex1 dist (2d? %i) calc success? %i  dist %7.3f  sig %7.3f\n", use_2d_track_dist, t_dist_1.first, t_dist_1.second.value(), t_dist_1.second.significance());
-          }
-
-          t_dist_0.first = t_dist_0.first && (t_dist_0.second.value() < max_track_vertex_dist || t_dist_0.second.significance() < max_track_vertex_sig);
-          t_dist_1.first = t_dist_1.first && (t_dist_1.second.value() < max_track_vertex_dist || t_dist_1.second.significance() < max_track_vertex_sig);
-          bool remove_from_0 = !t_dist_0.first;
-          bool remove_from_1 = !t_dist_1.first;
-          if (t_dist_0.second.significance() < min_track_vertex_sig_to_remove && t_dist_1.second.significance() < min_track_vertex_sig_to_remove) {
-            if (tracks[0].size() > tracks[1].size())
-              remove_from_1 = true;
-            else
-              remove_from_0 = true;
-          }
-          else if (t_dist_0.second.significance() < t_dist_1.second.significance())
-            remove_from_1 = true;
-          else
-            remove_from_0 = true;
-
-          if (verbose) {
-            printf("   for tk %u:\n", tk.key());
-            printf("      track-vertex0 dist < %7.3f || sig < %7.3f ? %i  remove? %i\n", max_track_vertex_dist, max_track_vertex_sig, t_dist_0.first, remove_from_0);
-            printf("      track-vertex1 dist < %7.3f || sig < %7.3f ? %i  remove? %i\n", max_track_vertex_dist, max_track_vertex_sig, t_dist_1.first, remove_from_1);
-          }
-
-          if (remove_from_0) tracks_to_remove_in_refit[0].insert(tk);
-          if (remove_from_1) tracks_to_remove_in_refit[1].insert(tk);
-
-          if (remove_one_track_at_a_time) {
-            if (verbose)
-              printf("   arbitrate only one track at a time\n");
-            break;
-          }
-        }
-
-        if (verbose)
-          printf("   breaking to refit\n");
-        
-        break;
-      }
-
-      if (verbose) printf("   moving on to next vertex pair.\n");
-    }
-
-    if (duplicate) {
-      vertices->erase(v[1]);
-    }
-    else if (merge) {
-      if (verbose)
-        printf("      before merge, # total vertices = %lu\n", vertices->size());
-
-      track_set tracks_to_fit;
-      for (int i = 0; i < 2; ++i)
-        for (auto tk : tracks[i])
-          tracks_to_fit.insert(tk);
-
-      if (verbose) {
-        printf("   merging vertices %lu and %lu with these tracks:", ivtx[0], ivtx[1]);
-        print_track_set(tracks_to_fit);
-        printf("\n");
-      }
-
-      std::vector<reco::TransientTrack> ttks;
-      for (auto tk : tracks_to_fit)
-        ttks.push_back(seed_tracks[seed_track_ref_map[tk]]);
-      
-      reco::VertexCollection new_vertices;
-      for (const TransientVertex& tv : kv_reco_dropin(ttks))
-        new_vertices.push_back(reco::Vertex(tv));
-      
-      if (verbose) {
-        printf("      got %lu new vertices out of the av fit\n", new_vertices.size());
-        printf("      these (chi2/dof : prob | track sets):");
-        for (const auto& nv : new_vertices) {
-          printf(" (%.3f : %.2e | ", nv.chi2()/nv.ndof(), TMath::Prob(nv.chi2(), int(nv.ndof())));
-          print_track_set(nv);
-          printf(" ),");
-        }
-        printf("\n");
-      }
-
-      // If we got two new vertices, maybe it took A B and A C D and made a better one from B C D, and left a broken one A B! C! D!.
-      // If we get one that is truly the merger of the track lists, great. If it is just something like A B , A C -> A B C!, or we get nothing, then default to arbitration.
-      if (new_vertices.size() > 1) {
-        if (verbose)
-          printf("   jiggled again?\n");   
-        assert(new_vertices.size() == 2);
-        *v[1] = reco::Vertex(new_vertices[1]);
-        *v[0] = reco::Vertex(new_vertices[0]);
-      }
-      else if (new_vertices.size() == 1 && vertex_track_set(new_vertices[0], 0) == tracks_to_fit) {
-        if (verbose)
-          printf("   merge worked!\n");   
-
-        if (vpeff)
-          vpeff->kind(VertexerPairEff::merge);
-
-        vertices->erase(v[1]);
-        *v[0] = reco::Vertex(new_vertices[0]); // ok to use v[0] after the erase(v[1]) because v[0] is by construction before v[1]
-      }
-      else {
-        if (verbose)
-          printf("   merge didn't work, trying arbitration refits\n");   
-        refit = true;
-      }
-
-      if (verbose)
-        printf("   vertices size is now %lu\n", vertices->size());
-    }
-
-    if (refit) {
-      bool erase[2] = { false };
-      reco::Vertex vsave[2] = { *v[0], *v[1] };
-
-      for (int i = 0; i < 2; ++i) {
-        if (tracks_to_remove_in_refit[i].empty())
-          continue;
-
-        if (verbose) {
-          printf("   refit vertex%i %lu with these tracks:", i, ivtx[i]);
-          print_track_set(tracks[i]);
-          printf("   but skip these:");
-          print_track_set(tracks_to_remove_in_refit[i]);
-          printf("\n");
-        }
-
-        std::vector<reco::TransientTrack> ttks;
-        for (auto tk : tracks[i])
-          if (tracks_to_remove_in_refit[i].count(tk) == 0) 
-            ttks.push_back(seed_tracks[seed_track_ref_map[tk]]);
-
-        reco::VertexCollection new_vertices;
-        for (const TransientVertex& tv : kv_reco_dropin(ttks))
-          new_vertices.push_back(reco::Vertex(tv));
-        if (verbose) {
-          printf("      got %lu new vertices out of the av fit for v%i\n", new_vertices.size(), i);
-          printf("      these track sets:");
-          for (const auto& nv : new_vertices) {
-            printf(" (");
-            print_track_set(nv);
-            printf(" ),");
-          }
-          printf("\n");
-        }
-        if (new_vertices.size() == 1)
-          *v[i] = new_vertices[0];
-        else
-          erase[i] = true;
-      }
-
-      if (vpeff && (erase[0] || erase[1]))
-        vpeff->kind(VertexerPairEff::erase);
-
-      if (erase[1]) vertices->erase(v[1]);
-      if (erase[0]) vertices->erase(v[0]);
-
-      if (verbose)
-        printf("      vertices size is now %lu\n", vertices->size());
-    }
-
-    // If we changed the vertices at all, start loop over completely.
-    if (duplicate || merge || refit) {
-      v[0] = vertices->begin() - 1;  // -1 because about to ++sv
-      ++n_resets;
-      if (verbose) printf("   resetting from vertices %lu and %lu. # of resets: %i\n", ivtx[0], ivtx[1], n_resets);
-      
-      //if (n_resets == 3000)
-      //  throw "I'm dumb";
-    }
-  }
-
-  if (verbose)
-    printf("n_resets: %i  n_onetracks: %i  n_noshare_vertices: %lu\n", n_resets, n_onetracks, vertices->size());
   if (histos) {
-    h_n_resets->Fill(n_resets);
-    h_n_onetracks->Fill(n_onetracks);
+    h_n_resets->Fill(algo.n_resets());
+    h_n_onetracks->Fill(algo.n_onetracks());
     h_n_noshare_vertices->Fill(vertices->size());
   }
 
@@ -764,58 +490,8 @@ void MFVVertexer::produce(edm::Event& event, const edm::EventSetup& setup) {
       h_max_noshare_track_multiplicity->Fill(max_noshare_track_multiplicity);
   }
 
-  //////////////////////////////////////////////////////////////////////
-  // Merge vertices that are still "close". JMTBAD this doesn't do anything currently.
-  //////////////////////////////////////////////////////////////////////
+  algo.merge(*vertices);
 
-  if (verbose)
-    printf("fun2!\n");
-
-  for (v[0] = vertices->begin(); v[0] != vertices->end(); ++v[0]) {
-    ivtx[0] = v[0] - vertices->begin();
-
-    bool merge = false;
-    for (v[1] = v[0] + 1; v[1] != vertices->end(); ++v[1]) {
-      ivtx[1] = v[1] - vertices->begin();
-
-      if (verbose)
-        printf("close-merge: # vertices = %lu. considering vertices #%lu (ntk = %i) and #%lu (ntk = %i):", vertices->size(), ivtx[0], v[0]->nTracks(), ivtx[1], v[1]->nTracks());
-
-      Measurement1D v_dist = vertex_dist(*v[0], *v[1]);
-      if (verbose)
-        printf("   vertex dist (2d? %i) %7.3f  sig %7.3f\n", use_2d_vertex_dist, v_dist.value(), v_dist.significance());
-  
-      if (v_dist.value() < merge_anyway_dist || v_dist.significance() < merge_anyway_sig) {
-        if (verbose)
-          printf("          dist < %7.3f || sig < %7.3f, breaking to merge\n", merge_anyway_dist, merge_anyway_sig);
-        merge = true;
-        break;
-      }
-    }
-
-    if (merge) {
-      std::vector<reco::TransientTrack> ttks;
-      for (int i = 0; i < 2; ++i)
-        for (auto tk : vertex_track_set(*v[i]))
-          ttks.push_back(tt_builder->build(tk));
-      
-      reco::VertexCollection new_vertices;
-      for (const TransientVertex& tv : kv_reco_dropin(ttks))
-        new_vertices.push_back(reco::Vertex(tv));
-      
-      if (verbose) {
-        printf("      got %lu new vertices out of the av fit\n", new_vertices.size());
-        printf("      these track sets:");
-        for (const auto& nv : new_vertices) {
-          printf(" (");
-          print_track_set(nv);
-          printf(" ),");
-        }
-        printf("\n");
-      }
-    }
-  }
- 
   //////////////////////////////////////////////////////////////////////
   // Put the output.
   //////////////////////////////////////////////////////////////////////
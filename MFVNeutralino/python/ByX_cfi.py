@@ -5,6 +5,8 @@ mfvByX = cms.EDAnalyzer('MFVByX',
                         vertex_src = cms.InputTag(''),
                         by_run = cms.bool(False),
                         by_npu = cms.bool(False),
+                        runs_json = cms.string(''),
+                        by_run_2d = cms.bool(False),
                         )
 
 mfvByRun = mfvByX.clone(by_run = True)
@@ -11,6 +11,11 @@ mfvMiniTree = cms.EDAnalyzer('MFVMiniTreer',
                              vertex_src = cms.InputTag('mfvSelectedVerticesTight'),
                              weight_src = cms.InputTag('mfvWeight'),
                              save_tracks = cms.bool(True),
+                             # -1/0 = ROOT defaults; see MiniNtupleWriteSettings and test/MiniTree/iobench.cc
+                             compression = cms.untracked.int32(-1),
+                             basket_size = cms.untracked.int32(-1),
+                             track_basket_size = cms.untracked.int32(-1),
+                             auto_flush = cms.untracked.int64(0),
                              )
 
 pMiniTree = cms.Path(mfvWeight * mfvSelectedVerticesTight * mfvAnalysisCutsGE1Vtx * mfvMiniTree)
@@ -44,7 +44,7 @@ def prepare_vis(process, mode, settings, output_commands):
             ]
 
         if settings.is_mc:
-            output_commands += ['keep *_mfvGenParticles_*_*']
+            output_commands += ['keep *_mfvGenParticles_*_*', 'drop *_mfvGenParticles_decayGraph_*']
 
 def minitree_only(process, mode, settings, output_commands):
     if mode:
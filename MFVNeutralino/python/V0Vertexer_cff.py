@@ -6,6 +6,8 @@ mfvV0Vertices = cms.EDFilter('MFVV0Vertexer',
                              kvr_params = kvr_params,
                              tracks_src = cms.InputTag('mfvSkimmedTracks'),
                              max_chi2ndf = cms.double(5),
+                             prefilter_max_dca = cms.double(-1), # cm, transverse closest approach of the helices before fitting, e.g. 0.2; <= 0 to turn off
+                             prefilter_mass_window = cms.double(-1), # GeV, |pre-fit mass - hypothesis mass| under some hypothesis; < 0 to turn off
                              cut = cms.bool(False),
                              debug = cms.untracked.bool(False)
                              )
@@ -12,6 +12,7 @@ mfvVerticesAuxTmp = cms.EDProducer('MFVVertexAuxProducer',
                                    sv_to_jets_src = cms.string('dummy'),
                                    jet_track_ref_getter = mfvJetTrackRefGetter,
                                    sort_by = cms.string('ntracks_then_mass'),
+                                   tracker_extents_cache = cms.untracked.string(''),
                                    verbose = cms.untracked.bool(False),
                                    )
 
@@ -8,6 +8,7 @@ mfvVertexRefits = cms.EDProducer('MFVVertexRefitter',
                                  vertex_src = cms.InputTag('mfvSelectedVerticesTight'),
                                  n_tracks_to_drop = cms.uint32(1),
                                  sort_tracks_by = cms.string('dxyerr'),
+                                 refit_mode = cms.string('full'), # or 'downdate': fit once, remove the dropped tracks' contributions
                                  histos = cms.untracked.bool(False),
                                  verbose = cms.untracked.bool(False),
                                  )
@@ -1,3 +1,5 @@
+#include <iostream>
+#include "TBranch.h"
 #include "TFile.h"
 #include "TTree.h"
 #include "JMTucker/MFVNeutralino/interface/MiniNtuple.h"
@@ -68,6 +70,10 @@ namespace mfv {
   }
 
   void write_to_tree(TTree* tree, MiniNtuple& nt) {
+    write_to_tree(tree, nt, MiniNtupleWriteSettings());
+  }
+
+  void write_to_tree(TTree* tree, MiniNtuple& nt, const MiniNtupleWriteSettings& settings) {
     tree->Branch("run", &nt.run);
     tree->Branch("lumi", &nt.lumi);
     tree->Branch("event", &nt.event);
@@ -152,6 +158,20 @@ namespace mfv {
     tree->SetAlias("svdist",  "(nvtx >= 2) * sqrt((x0-x1)**2 + (y0-y1)**2)");
     tree->SetAlias("svdphi",  "(nvtx >= 2) * TVector2::Phi_mpi_pi(atan2(y0,x0)-atan2(y1,x1))");
     tree->SetAlias("svdz",    "(nvtx >= 2) * (z0 - z1)");
+
+    if (settings.compression >= 0) {
+      TIter next(tree->GetListOfBranches());
+      while (TBranch* b = (TBranch*)next())
+        b->SetCompressionSettings(settings.compression);
+    }
+    if (settings.basket_size > 0)
+      tree->SetBasketSize("*", settings.basket_size);
+    if (settings.track_basket_size > 0) {
+      tree->SetBasketSize("tk0_*", settings.track_basket_size);
+      tree->SetBasketSize("tk1_*", settings.track_basket_size);
+    }
+    if (settings.auto_flush != 0)
+      tree->SetAutoFlush(settings.auto_flush);
   }
 
   void read_from_tree(TTree* tree, MiniNtuple& nt) {
@@ -289,4 +309,50 @@ namespace mfv {
 
     return j;
   }
+
+  void print(std::ostream& o, const MiniNtuple& nt) {
+    // the vectors are only in the p_ ones if nt was read from a tree
+    auto v = [](const std::vector<double>* p, const std::vector<double>& x) -> const std::vector<double>& { return p ? *p : x; };
+
+    o << "run " << nt.run << " lumi " << nt.lumi << " event " << nt.event << "\n"
+      << "gen_flavor_code " << int(nt.gen_flavor_code) << " pass_hlt " << int(nt.pass_hlt)
+      << " l1_htt " << nt.l1_htt << " l1_myhtt " << nt.l1_myhtt << " l1_myhttwbug " << nt.l1_myhttwbug << " hlt_ht " << nt.hlt_ht << "\n"
+      << "bs (" << nt.bsx << ", " << nt.bsy << ", " << nt.bsz << ") dxdz " << nt.bsdxdz << " dydz " << nt.bsdydz << "\n"
+      << "npv " << int(nt.npv) << " pv (" << nt.pvx << ", " << nt.pvy << ", " << nt.pvz << ") npu " << int(nt.npu) << " weight " << nt.weight << "\n"
+      << "njets " << int(nt.njets) << " ht " << nt.ht() << "\n";
+    for (int i = 0; i < nt.njets; ++i)
+      o << "  jet " << i << ": pt " << nt.jet_pt[i] << " eta " << nt.jet_eta[i] << " phi " << nt.jet_phi[i] << " energy " << nt.jet_energy[i]
+        << " id " << int(nt.jet_id[i]) << " bdisc " << nt.jet_bdisc[i] << "\n";
+    for (int i = 0; i < 2; ++i)
+      o << "gen " << i << ": (" << nt.gen_x[i] << ", " << nt.gen_y[i] << ", " << nt.gen_z[i] << ") lsp pt " << nt.gen_lsp_pt[i]
+        << " eta " << nt.gen_lsp_eta[i] << " phi " << nt.gen_lsp_phi[i] << " mass " << nt.gen_lsp_mass[i] << "\n";
+    o << "gen_jet_ht " << nt.gen_jet_ht << " gen_jet_ht40 " << nt.gen_jet_ht40 << "\n"
+      << "nvtx " << int(nt.nvtx) << "\n";
+
+    for (int iv = 0; iv < 2 && iv < nt.nvtx; ++iv) {
+      const bool v0 = iv == 0;
+      const int ntk = v0 ? nt.ntk0 : nt.ntk1;
+      o << "vtx " << iv << ": (" << (v0 ? nt.x0 : nt.x1) << ", " << (v0 ? nt.y0 : nt.y1) << ", " << (v0 ? nt.z0 : nt.z1) << ")"
+        << " bs2derr " << (v0 ? nt.bs2derr0 : nt.bs2derr1) << " geo2ddist " << (v0 ? nt.geo2ddist0 : nt.geo2ddist1)
+        << " genmatch " << (v0 ? nt.genmatch0 : nt.genmatch1) << " ntk " << ntk << "\n";
+
+      const std::vector<double>& px = v0 ? v(nt.p_tk0_px, nt.tk0_px) : v(nt.p_tk1_px, nt.tk1_px);
+      const std::vector<double>& py = v0 ? v(nt.p_tk0_py, nt.tk0_py) : v(nt.p_tk1_py, nt.tk1_py);
+      const std::vector<double>& pz = v0 ? v(nt.p_tk0_pz, nt.tk0_pz) : v(nt.p_tk1_pz, nt.tk1_pz);
+      const std::vector<double>& vx = v0 ? v(nt.p_tk0_vx, nt.tk0_vx) : v(nt.p_tk1_vx, nt.tk1_vx);
+      const std::vector<double>& vy = v0 ? v(nt.p_tk0_vy, nt.tk0_vy) : v(nt.p_tk1_vy, nt.tk1_vy);
+      const std::vector<double>& vz = v0 ? v(nt.p_tk0_vz, nt.tk0_vz) : v(nt.p_tk1_vz, nt.tk1_vz);
+      const std::vector<double>& qchi2 = v0 ? v(nt.p_tk0_qchi2, nt.tk0_qchi2) : v(nt.p_tk1_qchi2, nt.tk1_qchi2);
+      const std::vector<double>& ndof = v0 ? v(nt.p_tk0_ndof, nt.tk0_ndof) : v(nt.p_tk1_ndof, nt.tk1_ndof);
+      const std::vector<short>* p_inpv = v0 ? nt.p_tk0_inpv : nt.p_tk1_inpv;
+      const std::vector<short>& inpv = p_inpv ? *p_inpv : v0 ? nt.tk0_inpv : nt.tk1_inpv;
+
+      for (int i = 0, ie = int(px.size()); i < ie; ++i) {
+        o << "  tk " << i << ": p (" << px[i] << ", " << py[i] << ", " << pz[i] << ") v (" << vx[i] << ", " << vy[i] << ", " << vz[i] << ")";
+        if (i < int(qchi2.size())) o << " qchi2 " << qchi2[i] << " ndof " << ndof[i];
+        if (i < int(inpv.size())) o << " inpv " << inpv[i];
+        o << "\n";
+      }
+    }
+  }
 }
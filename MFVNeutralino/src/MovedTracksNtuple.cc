@@ -1,6 +1,8 @@
 #include "JMTucker/MFVNeutralino/interface/MovedTracksNtuple.h"
 
+#include <cassert>
 #include "TTree.h"
+#include "JMTucker/Tools/interface/TrackCuts.h"
 
 namespace mfv {
   TLorentzVector MovedTracksNtuple::gen_daughter_p4(int i) const {
@@ -21,11 +23,38 @@ namespace mfv {
     return p;
   }
 
+  namespace {
+    // Append to idx the indices of the tracks within dRmax of (eta, phi),
+    // written to vectorize: no TVector3s, and the phi wrapping is a select.
+    template <typename I>
+    void tracks_in_cone(double eta, double phi, double dRmax, const float* tks_eta, const float* tks_phi, size_t ntks, std::vector<I>& idx) {
+      const double dR2max = dRmax * dRmax;
+      std::vector<unsigned char> in(ntks);
+      for (size_t j = 0; j < ntks; ++j) {
+        const double deta = tks_eta[j] - eta;
+        double dphi = std::fabs(tks_phi[j] - phi);
+        dphi = dphi > M_PI ? 2*M_PI - dphi : dphi;
+        in[j] = deta*deta + dphi*dphi < dR2max;
+      }
+      for (size_t j = 0; j < ntks; ++j)
+        if (in[j])
+          idx.push_back(I(j));
+    }
+  }
+
+  MovedTracksNtuple::track_range MovedTracksNtuple::alljets_tracks(int i) const {
+    update_track_association();
+    const std::vector<unsigned>& o = p_alljets_tks_offsets ? *p_alljets_tks_offsets : alljets_tks_offsets;
+    const std::vector<ushort>& x = p_alljets_tks_idx     ? *p_alljets_tks_idx     : alljets_tks_idx;
+    return track_range{x.data() + o[i], x.data() + o[i+1]};
+  }
+
   std::vector<int> MovedTracksNtuple::alljets_tracks(int i, double dRmax) const {
     std::vector<int> r;
-    for (size_t j = 0, je = ntks(); j < je; ++j)
-      if (tks_p(j).DeltaR(alljets_p4(i).Vect()) < dRmax)
-        r.push_back(j);
+    const std::vector<float>& eta = p_tks_eta ? *p_tks_eta : tks_eta;
+    const std::vector<float>& phi = p_tks_phi ? *p_tks_phi : tks_phi;
+    const TVector3 v = alljets_p4(i).Vect();
+    tracks_in_cone(v.Eta(), v.Phi(), dRmax, eta.data(), phi.data(), ntks(), r);
     return r;
   }
 
@@ -37,17 +66,62 @@ namespace mfv {
 
   double MovedTracksNtuple::move_tau() const { return move_vector().Mag(); }
 
-  std::vector<int> MovedTracksNtuple::vtxs_tracks(int i) const {
-    std::vector<int> r;
-    for (size_t j = 0, je = ntks(); j < je; ++j)
-      if ((p_tks_vtx ? (*p_tks_vtx)[j] : tks_vtx[j]) == i)
-        r.push_back(j);
+  MovedTracksNtuple::track_range MovedTracksNtuple::vtxs_tracks(int i) const {
+    update_track_association();
+    const std::vector<unsigned>& o = p_vtxs_tks_offsets ? *p_vtxs_tks_offsets : vtxs_tks_offsets;
+    const std::vector<ushort>& x = p_vtxs_tks_idx     ? *p_vtxs_tks_idx     : vtxs_tks_idx;
+    const track_range r{x.data() + o[i], x.data() + o[i+1]};
     assert(r.size() == (p_vtxs_ntracks ? (*p_vtxs_ntracks)[i] : vtxs_ntracks[i]));
     return r;
   }
 
+  void MovedTracksNtuple::build_track_association(std::vector<unsigned>& jets_offsets, std::vector<ushort>& jets_idx, std::vector<unsigned>& vtxs_offsets, std::vector<ushort>& vtxs_idx) const {
+    const size_t n = ntks(), nj = nalljets(), nv = nvtxs();
+    assert(n < 65536);
+    const std::vector<float>& eta = p_tks_eta ? *p_tks_eta : tks_eta;
+    const std::vector<float>& phi = p_tks_phi ? *p_tks_phi : tks_phi;
+
+    jets_offsets.assign(1, 0);
+    jets_idx.clear();
+    for (size_t i = 0; i < nj; ++i) {
+      const TVector3 v = alljets_p4(i).Vect();
+      tracks_in_cone(v.Eta(), v.Phi(), alljets_tracks_dR, eta.data(), phi.data(), n, jets_idx);
+      jets_offsets.push_back(jets_idx.size());
+    }
+
+    // Counting sort of the tracks by tks_vtx, 255 being no vertex.
+    const std::vector<uchar>& vtx = p_tks_vtx ? *p_tks_vtx : tks_vtx;
+    vtxs_offsets.assign(nv + 1, 0);
+    for (size_t j = 0; j < n; ++j)
+      if (vtx[j] < nv)
+        ++vtxs_offsets[vtx[j] + 1];
+    for (size_t i = 0; i < nv; ++i)
+      vtxs_offsets[i+1] += vtxs_offsets[i];
+    vtxs_idx.resize(vtxs_offsets[nv]);
+    std::vector<unsigned> next(vtxs_offsets.begin(), vtxs_offsets.end() - 1);
+    for (size_t j = 0; j < n; ++j)
+      if (vtx[j] < nv)
+        vtxs_idx[next[vtx[j]]++] = j;
+  }
+
+  void MovedTracksNtuple::fill_track_association() {
+    build_track_association(alljets_tks_offsets, alljets_tks_idx, vtxs_tks_offsets, vtxs_tks_idx);
+  }
+
+  void MovedTracksNtuple::update_track_association() const {
+    if (!build_association || read_tree->GetReadEntry() == association_entry)
+      return;
+    association_entry = read_tree->GetReadEntry();
+    build_track_association(built_alljets_tks_offsets, built_alljets_tks_idx, built_vtxs_tks_offsets, built_vtxs_tks_idx);
+  }
+
   bool MovedTracksNtuple::tks_sel(int i) const {
-    return tks_pt(i) > 1 && tks_npxlayers(i) >= 2 && tks_nstlayers(i) >= 6 && tks_nsigmadxy(i) > 4;
+    // The seed track selection, but for min_r which isn't stored.
+    static const jmt::TrackCuts cuts;
+    const float dxy = p_tks_dxy ? (*p_tks_dxy)[i] : tks_dxy[i];
+    const float dxyerr = p_tks_err_dxy ? (*p_tks_err_dxy)[i] : tks_err_dxy[i];
+    const unsigned fail = cuts.fail(tks_pt(i), 0.f, dxy, 0.f, dxyerr, 1, 0, 0, tks_npxlayers(i), tks_nstlayers(i));
+    return jmt::tkcuts_pass(fail, jmt::tkcuts_seed & ~jmt::tkcut_min_r);
   }
 
   MovedTracksNtuple::MovedTracksNtuple() {
@@ -57,6 +131,11 @@ namespace mfv {
     p_alljets_ntracks = p_alljets_hadronflavor = p_vtxs_ntracks = p_tks_vtx = 0;
     p_alljets_moved = p_tks_moved = 0;
     p_gen_daughter_id = 0;
+    p_alljets_tks_offsets = p_vtxs_tks_offsets = 0;
+    p_alljets_tks_idx = p_vtxs_tks_idx = 0;
+    read_tree = 0;
+    build_association = false;
+    association_entry = -1;
   }
 
   void MovedTracksNtuple::clear() {
@@ -109,6 +188,10 @@ namespace mfv {
     tks_hp_.clear();
     tks_moved.clear();
     tks_vtx.clear();
+    alljets_tks_offsets.clear();
+    alljets_tks_idx.clear();
+    vtxs_tks_offsets.clear();
+    vtxs_tks_idx.clear();
   }
 
   void MovedTracksNtuple::write_to_tree(TTree* tree) {
@@ -180,6 +263,10 @@ namespace mfv {
     tree->Branch("tks_hp_", &tks_hp_);
     tree->Branch("tks_moved", &tks_moved);
     tree->Branch("tks_vtx", &tks_vtx);
+    tree->Branch("alljets_tks_offsets", &alljets_tks_offsets);
+    tree->Branch("alljets_tks_idx", &alljets_tks_idx);
+    tree->Branch("vtxs_tks_offsets", &vtxs_tks_offsets);
+    tree->Branch("vtxs_tks_idx", &vtxs_tks_idx);
   }
 
   void MovedTracksNtuple::read_from_tree(TTree* tree) {
@@ -251,5 +338,21 @@ namespace mfv {
     tree->SetBranchAddress("tks_hp_", &p_tks_hp_);
     tree->SetBranchAddress("tks_moved", &p_tks_moved);
     tree->SetBranchAddress("tks_vtx", &p_tks_vtx);
+
+    read_tree = tree;
+    association_entry = -1;
+    build_association = !tree->GetBranch("alljets_tks_offsets");
+    if (build_association) {
+      p_alljets_tks_offsets = &built_alljets_tks_offsets;
+      p_alljets_tks_idx = &built_alljets_tks_idx;
+      p_vtxs_tks_offsets = &built_vtxs_tks_offsets;
+      p_vtxs_tks_idx = &built_vtxs_tks_idx;
+    }
+    else {
+      tree->SetBranchAddress("alljets_tks_offsets", &p_alljets_tks_offsets);
+      tree->SetBranchAddress("alljets_tks_idx", &p_alljets_tks_idx);
+      tree->SetBranchAddress("vtxs_tks_offsets", &p_vtxs_tks_offsets);
+      tree->SetBranchAddress("vtxs_tks_idx", &p_vtxs_tks_idx);
+    }
   }
 }
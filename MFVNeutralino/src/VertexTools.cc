@@ -1,3 +1,6 @@
+#include <cmath>
+#include <limits>
+#include <sstream>
 #include "TVector3.h"
 #include "DataFormats/Math/interface/deltaR.h"
 #include "DataFormats/VertexReco/interface/Vertex.h"
@@ -40,6 +43,99 @@ namespace {
   double costh3(const T& a, const T2& b) {
     return dot3(a,b) / mag(a.x(), a.y(), a.z()) / mag(b.x(), b.y(), b.z());
   }
+
+  typedef mfv::track_cluster_history::particle particle;
+  typedef mfv::track_cluster_history::merge merge;
+
+  double delta_R2(const particle& a, const particle& b) {
+    const double drap = a.rap - b.rap;
+    double dphi = fabs(a.phi - b.phi);
+    if (dphi > M_PI) dphi = 2*M_PI - dphi;
+    return drap*drap + dphi*dphi;
+  }
+
+  // Generalized-kt clustering with nearest-neighbour caching, as
+  // fastjet's N2Plain strategy. Returns the pairwise merges in order;
+  // a particle with no neighbour within R2 goes to the beam and drops
+  // out. R2 = infinity gives the exclusive sequence.
+  std::vector<merge> gen_kt_merges(std::vector<particle> p, const fastjet::JetAlgorithm algo, const double R2) {
+    const size_t n = p.size();
+    const size_t none = n;
+    std::vector<merge> merges;
+    std::vector<bool> alive(n, true);
+    std::vector<size_t> nn(n, none);
+    std::vector<double> nn_dist(n, R2);
+
+    auto rescan = [&](const size_t k) {
+      nn[k] = none;
+      nn_dist[k] = R2;
+      for (size_t l = 0; l < n; ++l) {
+        if (l == k || !alive[l]) continue;
+        const double d = delta_R2(p[k], p[l]);
+        if (d < nn_dist[k]) {
+          nn_dist[k] = d;
+          nn[k] = l;
+        }
+      }
+    };
+
+    for (size_t i = 0; i < n; ++i)
+      for (size_t j = 0; j < i; ++j) {
+        const double d = delta_R2(p[i], p[j]);
+        if (d < nn_dist[i]) { nn_dist[i] = d; nn[i] = j; }
+        if (d < nn_dist[j]) { nn_dist[j] = d; nn[j] = i; }
+      }
+
+    auto diJ = [&](const size_t k) {
+      const double mf = nn[k] == none ? p[k].mom_factor : std::min(p[k].mom_factor, p[nn[k]].mom_factor);
+      return nn_dist[k] * mf;
+    };
+
+    for (size_t nalive = n; nalive > 0; ) {
+      size_t i = none;
+      double dmin = 0;
+      for (size_t k = 0; k < n; ++k) {
+        if (!alive[k]) continue;
+        const double d = diJ(k);
+        if (i == none || d < dmin) {
+          i = k;
+          dmin = d;
+        }
+      }
+
+      const size_t j = nn[i];
+      if (j == none) {
+        // nobody points at i, since its neighbours would be its neighbours
+        alive[i] = false;
+        --nalive;
+        continue;
+      }
+
+      merges.push_back(merge{i, j, dmin});
+      p[i].set(p[i].px + p[j].px, p[i].py + p[j].py, p[i].pz + p[j].pz, p[i].E + p[j].E, algo);
+      alive[j] = false;
+      --nalive;
+
+      nn[i] = none;
+      nn_dist[i] = R2;
+      for (size_t k = 0; k < n; ++k) {
+        if (k == i || !alive[k]) continue;
+        const double d = delta_R2(p[i], p[k]);
+        if (d < nn_dist[i]) {
+          nn_dist[i] = d;
+          nn[i] = k;
+        }
+        if (nn[k] == i || nn[k] == j)
+          rescan(k);
+        else if (d < nn_dist[k]) {
+          nn_dist[k] = d;
+          nn[k] = i;
+        }
+      }
+    }
+
+    return merges;
+  }
 }
 
 namespace mfv {
@@ -119,7 +215,6 @@ namespace mfv {
     const reco::Vertex fake_bs_vtx(beamspot.position(), beamspot.covariance3D());
     bs2dcompat = compatibility(sv, fake_bs_vtx, false);
     bs2ddist = distcalc_2d.distance(sv, fake_bs_vtx);
-    const math::XYZVector bs2sv = sv.position() - beamspot.position();
 
     pv2dcompat = pv3dcompat = std::make_pair(false, -1.f);
     pv2ddist_val = pv3ddist_val = pv2ddist_err = pv3ddist_err = pv2ddist_sig = pv3ddist_sig = -1;
@@ -138,17 +233,69 @@ namespace mfv {
       pv3ddist_sig = pv3ddist.significance();
     }
 
+    set_momenta(sv, beamspot, primary_vertex, momenta, false);
+  }
+
+  vertex_distances::vertex_distances(const sv_distances_batch& b, size_t isv, const reco::Vertex& sv, const std::vector<double>& gen_vertices, const reco::BeamSpot& beamspot, const reco::Vertex* primary_vertex, const std::vector<math::XYZTLorentzVector>& momenta) {
+    gen2ddist = gen_dist(sv, gen_vertices, false);
+    gen3ddist = gen_dist(sv, gen_vertices, true);
+
+    bs2dcompat = std::make_pair(bool(b.bs2d.ok[isv]), b.bs2d.compat[isv]);
+    bs2ddist = Measurement1D(b.bs2d.val[isv], b.bs2d.err[isv]);
+
+    pv2dcompat = pv3dcompat = std::make_pair(false, -1.f);
+    pv2ddist_val = pv3ddist_val = pv2ddist_err = pv3ddist_err = pv2ddist_sig = pv3ddist_sig = -1;
+
+    if (primary_vertex != 0) {
+      pv2dcompat = std::make_pair(bool(b.pv2d.ok[isv]), b.pv2d.compat[isv]);
+      pv2ddist_val = b.pv2d.val[isv];
+      pv2ddist_err = b.pv2d.err[isv];
+      pv2ddist_sig = b.pv2d.sig[isv];
+
+      pv3dcompat = std::make_pair(bool(b.pv3d.ok[isv]), b.pv3d.compat[isv]);
+      pv3ddist_val = b.pv3d.val[isv];
+      pv3ddist_err = b.pv3d.err[isv];
+      pv3ddist_sig = b.pv3d.sig[isv];
+    }
+
+    set_momenta(sv, beamspot, primary_vertex, momenta, true);
+  }
+
+  void vertex_distances::set_momenta(const reco::Vertex& sv, const reco::BeamSpot& beamspot, const reco::Vertex* primary_vertex, const std::vector<math::XYZTLorentzVector>& momenta, bool batch) {
+    const math::XYZVector bs2sv = sv.position() - beamspot.position();
     math::XYZVector pv2sv;
     if (primary_vertex != 0)
       pv2sv = sv.position() - primary_vertex->position();
 
+    // the miss distances for the momenta that have them, all at once
+    distance_batch miss;
+    if (batch && primary_vertex != 0) {
+      vertex_soa pv_soa, sv_soa;
+      pv_soa.push_back(*primary_vertex);
+      sv_soa.push_back(sv);
+      std::vector<double> px, py, pz;
+      for (const math::XYZTLorentzVector& mom : momenta)
+        if (mom.pt() > 0) {
+          px.push_back(mom.x());
+          py.push_back(mom.y());
+          pz.push_back(mom.z());
+        }
+      miss_dist_batch(pv_soa, sv_soa, px, py, pz, miss);
+    }
+
+    size_t imiss = 0;
     for (const math::XYZTLorentzVector& mom : momenta) {
       if (mom.pt() > 0) {
         costhmombs.push_back(costh2(mom, bs2sv));
         if (primary_vertex != 0) {
           costhmompv2d.push_back(costh2(mom, pv2sv));
           costhmompv3d.push_back(costh3(mom, pv2sv));
-          missdistpv.push_back(miss_dist(*primary_vertex, sv, mom));
+          if (batch) {
+            missdistpv.push_back(Measurement1D(miss.val[imiss], miss.err[imiss]));
+            ++imiss;
+          }
+          else
+            missdistpv.push_back(miss_dist(*primary_vertex, sv, mom));
         }
         else {
           costhmompv2d.push_back(-2);
@@ -165,6 +312,206 @@ namespace mfv {
     }
   }
 
+  std::string vertex_distances::mismatch(const vertex_distances& o) const {
+    // The scalar path goes through GlobalPoint, i.e. float positions,
+    // so allow for that rather than double rounding.
+    auto close = [](double a, double b) { return std::fabs(a - b) <= 1e-5 + 1e-4 * std::fabs(a) || (std::isnan(a) && std::isnan(b)) || a == b; };
+    std::ostringstream out;
+    auto check = [&](const char* name, double a, double b) {
+      if (out.tellp() == 0 && !close(a, b))
+        out << name << ": " << a << " vs " << b;
+    };
+    auto check_compat = [&](const char* name, const std::pair<bool,float>& a, const std::pair<bool,float>& b) {
+      if (out.tellp() == 0 && (a.first != b.first || (a.first && !close(a.second, b.second))))
+        out << name << ": (" << a.first << ", " << a.second << ") vs (" << b.first << ", " << b.second << ")";
+    };
+
+    check_compat("bs2dcompat", bs2dcompat, o.bs2dcompat);
+    check_compat("pv2dcompat", pv2dcompat, o.pv2dcompat);
+    check_compat("pv3dcompat", pv3dcompat, o.pv3dcompat);
+    check("bs2ddist", bs2ddist.value(), o.bs2ddist.value());
+    check("bs2derr", bs2ddist.error(), o.bs2ddist.error());
+    check("pv2ddist", pv2ddist_val, o.pv2ddist_val);
+    check("pv2derr", pv2ddist_err, o.pv2ddist_err);
+    check("pv2dsig", pv2ddist_sig, o.pv2ddist_sig);
+    check("pv3ddist", pv3ddist_val, o.pv3ddist_val);
+    check("pv3derr", pv3ddist_err, o.pv3ddist_err);
+    check("pv3dsig", pv3ddist_sig, o.pv3ddist_sig);
+    if (out.tellp() == 0 && missdistpv.size() != o.missdistpv.size())
+      out << "missdistpv size: " << missdistpv.size() << " vs " << o.missdistpv.size();
+    for (size_t i = 0, ie = std::min(missdistpv.size(), o.missdistpv.size()); i < ie; ++i) {
+      check("missdistpv", missdistpv[i].value(), o.missdistpv[i].value());
+      check("missdistpverr", missdistpv[i].error(), o.missdistpv[i].error());
+    }
+    return out.str();
+  }
+
+  //////////////////////////////////////////////////////////////////////
+
+  void vertex_soa::clear() {
+    for (std::vector<double>* a : { &x, &y, &z, &cxx, &cxy, &cxz, &cyy, &cyz, &czz })
+      a->clear();
+  }
+
+  void vertex_soa::reserve(size_t n) {
+    for (std::vector<double>* a : { &x, &y, &z, &cxx, &cxy, &cxz, &cyy, &cyz, &czz })
+      a->reserve(n);
+  }
+
+  void vertex_soa::push_back(double x_, double y_, double z_, const double* cov) {
+    x.push_back(x_);
+    y.push_back(y_);
+    z.push_back(z_);
+    cxx.push_back(cov[0]);
+    cxy.push_back(cov[1]);
+    cxz.push_back(cov[2]);
+    cyy.push_back(cov[3]);
+    cyz.push_back(cov[4]);
+    czz.push_back(cov[5]);
+  }
+
+  void vertex_soa::push_back(const reco::Vertex& v) {
+    const double cov[6] = { v.covariance(0,0), v.covariance(0,1), v.covariance(0,2), v.covariance(1,1), v.covariance(1,2), v.covariance(2,2) };
+    push_back(v.x(), v.y(), v.z(), cov);
+  }
+
+  void vertex_soa::push_back(const MFVVertexAux& v) {
+    const double cov[6] = { v.cxx, v.cxy, v.cxz, v.cyy, v.cyz, v.czz };
+    push_back(v.x, v.y, v.z, cov);
+  }
+
+  void distance_batch::resize(size_t n) {
+    val.resize(n);
+    err.resize(n);
+    sig.resize(n);
+    compat.resize(n);
+    ok.resize(n);
+  }
+
+  void vertex_distances_batch(const vertex_soa& a, const vertex_soa& b, bool use3d, distance_batch& out) {
+    const size_t n = a.size();
+    const bool bcast = b.size() == 1;
+    if (!bcast && b.size() != n)
+      throw cms::Exception("VertexTools") << "vertex_distances_batch: size mismatch " << n << " vs " << b.size();
+
+    out.resize(n);
+
+    // Plain loops over the arrays with the broadcast index resolved up
+    // front; no SMatrix temporaries, no branches other than the
+    // zero-distance and singular-matrix guards, so the compiler can
+    // vectorize.
+    for (size_t i = 0; i < n; ++i) {
+      const size_t j = bcast ? 0 : i;
+      const double dx = a.x[i] - b.x[j];
+      const double dy = a.y[i] - b.y[j];
+      const double dz = use3d ? a.z[i] - b.z[j] : 0.;
+      const double exx = a.cxx[i] + b.cxx[j];
+      const double exy = a.cxy[i] + b.cxy[j];
+      const double eyy = a.cyy[i] + b.cyy[j];
+      const double exz = use3d ? a.cxz[i] + b.cxz[j] : 0.;
+      const double eyz = use3d ? a.cyz[i] + b.cyz[j] : 0.;
+      const double ezz = use3d ? a.czz[i] + b.czz[j] : 0.;
+
+      // distance and its error from the gradient d/|d|
+      const double d2 = dx*dx + dy*dy + dz*dz;
+      const double dist = sqrt(d2);
+      double err = 0;
+      if (dist > 0) {
+        const double err2 = (dx*dx*exx + dy*dy*eyy + dz*dz*ezz + 2*(dx*dy*exy + dx*dz*exz + dy*dz*eyz)) / d2;
+        if (err2 > 0)
+          err = sqrt(err2);
+      }
+
+      out.val[i] = dist;
+      out.err[i] = err;
+      out.sig[i] = err != 0 ? dist / err : 0;
+
+      // compatibility = d^T E^-1 d via the adjugate; same failure
+      // condition as SMatrix::Invert, i.e. zero determinant
+      double det, chi2n;
+      if (use3d) {
+        const double axx = eyy*ezz - eyz*eyz;
+        const double axy = exz*eyz - exy*ezz;
+        const double axz = exy*eyz - exz*eyy;
+        const double ayy = exx*ezz - exz*exz;
+        const double ayz = exy*exz - exx*eyz;
+        const double azz = exx*eyy - exy*exy;
+        det = exx*axx + exy*axy + exz*axz;
+        chi2n = dx*dx*axx + dy*dy*ayy + dz*dz*azz + 2*(dx*dy*axy + dx*dz*axz + dy*dz*ayz);
+      }
+      else {
+        det = exx*eyy - exy*exy;
+        chi2n = dx*dx*eyy + dy*dy*exx - 2*dx*dy*exy;
+      }
+
+      const bool ok = det != 0;
+      out.ok[i] = ok;
+      out.compat[i] = ok ? chi2n / det : 0;
+    }
+  }
+
+  sv_distances_batch::sv_distances_batch(const reco::VertexCollection& svs, const reco::BeamSpot& beamspot, const reco::Vertex* primary_vertex) {
+    vertex_soa sv_soa, bs_soa, pv_soa;
+    sv_soa.reserve(svs.size());
+    for (const reco::Vertex& sv : svs)
+      sv_soa.push_back(sv);
+
+    bs_soa.push_back(reco::Vertex(beamspot.position(), beamspot.covariance3D()));
+    vertex_distances_batch(sv_soa, bs_soa, false, bs2d);
+
+    if (primary_vertex != 0) {
+      pv_soa.push_back(*primary_vertex);
+      vertex_distances_batch(sv_soa, pv_soa, false, pv2d);
+      vertex_distances_batch(sv_soa, pv_soa, true,  pv3d);
+    }
+  }
+
+  void miss_dist_batch(const vertex_soa& v0, const vertex_soa& v1, const std::vector<double>& px, const std::vector<double>& py, const std::vector<double>& pz, distance_batch& out) {
+    const size_t n = px.size();
+    const bool bcast0 = v0.size() == 1;
+    const bool bcast1 = v1.size() == 1;
+    if (py.size() != n || pz.size() != n || (!bcast0 && v0.size() != n) || (!bcast1 && v1.size() != n))
+      throw cms::Exception("VertexTools") << "miss_dist_batch: size mismatch";
+
+    out.resize(n);
+
+    for (size_t i = 0; i < n; ++i) {
+      const size_t i0 = bcast0 ? 0 : i;
+      const size_t i1 = bcast1 ? 0 : i;
+
+      // same as miss_dist() above, written out in components
+      const double p2 = px[i]*px[i] + py[i]*py[i] + pz[i]*pz[i];
+      const double pinv = p2 > 0 ? 1/sqrt(p2) : 1.;
+      const double nx = px[i]*pinv, ny = py[i]*pinv, nz = pz[i]*pinv;
+      const double dx = v1.x[i1] - v0.x[i0];
+      const double dy = v1.y[i1] - v0.y[i0];
+      const double dz = v1.z[i1] - v0.z[i0];
+      const double n_dot_d = nx*dx + ny*dy + nz*dz;
+      const double cx = ny*dz - nz*dy;
+      const double cy = nz*dx - nx*dz;
+      const double cz = nx*dy - ny*dx;
+      const double value = sqrt(cx*cx + cy*cy + cz*cz);
+
+      const double jx = 2*dx - 2*n_dot_d*nx;
+      const double jy = 2*dy - 2*n_dot_d*ny;
+      const double jz = 2*dz - 2*n_dot_d*nz;
+      const double exx = v0.cxx[i0] + v1.cxx[i1];
+      const double exy = v0.cxy[i0] + v1.cxy[i1];
+      const double exz = v0.cxz[i0] + v1.cxz[i1];
+      const double eyy = v0.cyy[i0] + v1.cyy[i1];
+      const double eyz = v0.cyz[i0] + v1.cyz[i1];
+      const double ezz = v0.czz[i0] + v1.czz[i1];
+      const double sigma_f2 = sqrt(jx*jx*exx + jy*jy*eyy + jz*jz*ezz + 2*(jx*jy*exy + jx*jz*exz + jy*jz*eyz));
+      const double err = sigma_f2 / 2 / value;
+
+      out.val[i] = value;
+      out.err[i] = err;
+      out.sig[i] = err != 0 ? value / err : 0;
+      out.compat[i] = 0;
+      out.ok[i] = value > 0;
+    }
+  }
+
   //////////////////////////////////////////////////////////////////////
 
   reco::Vertex aux_to_reco(const MFVVertexAux& aux) {
@@ -216,6 +563,155 @@ namespace mfv {
     }
   }
 
+  track_clusters::track_clusters(const track_cluster_history& h, double R_)
+    : R(R_),
+      algo(h.algo),
+      recomb_scheme(fastjet::E_scheme),
+      track_mass(h.track_mass),
+      clusters(h.clusters(R))
+  {
+  }
+
+  void track_cluster_history::particle::set(double px_, double py_, double pz_, double E_, fastjet::JetAlgorithm a) {
+    px = px_;
+    py = py_;
+    pz = pz_;
+    E = E_;
+
+    // rapidity and phi in [0, 2pi) as fastjet::PseudoJet does them
+    const double pt2 = px*px + py*py;
+    if (pt2 == 0 && E == fabs(pz))
+      rap = pz >= 0 ? fastjet::MaxRap + fabs(pz) : -fastjet::MaxRap - fabs(pz);
+    else {
+      const double m2 = std::max(0., E*E - pt2 - pz*pz);
+      const double E_plus_pz = E + fabs(pz);
+      rap = 0.5*log((pt2 + m2)/(E_plus_pz*E_plus_pz));
+      if (pz > 0) rap = -rap;
+    }
+
+    phi = pt2 == 0 ? 0 : atan2(py, px);
+    if (phi < 0) phi += 2*M_PI;
+
+    if (a == fastjet::kt_algorithm)
+      mom_factor = pt2;
+    else if (a == fastjet::antikt_algorithm)
+      mom_factor = pt2 > 0 ? 1/pt2 : 1e300;
+    else
+      mom_factor = 1;
+  }
+
+  track_cluster_history::track_cluster_history(const MFVVertexAux& v, fastjet::JetAlgorithm algo_, double track_mass_)
+    : algo(algo_),
+      track_mass(track_mass_),
+      have_history(false)
+  {
+    if (algo != fastjet::kt_algorithm && algo != fastjet::cambridge_algorithm && algo != fastjet::antikt_algorithm)
+      throw cms::Exception("VertexTools") << "track_cluster_history only does kt, cambridge, antikt";
+
+    const size_t n = v.ntracks();
+    tracks.resize(n);
+    for (size_t i = 0; i < n; ++i)
+      tracks[i].set(v.track_px[i], v.track_py[i], v.track_pz[i], mag(v.track_px[i], v.track_py[i], v.track_pz[i], track_mass), algo);
+  }
+
+  const std::vector<track_cluster_history::merge>& track_cluster_history::history() const {
+    if (!have_history) {
+      history_ = gen_kt_merges(tracks, algo, std::numeric_limits<double>::infinity());
+      have_history = true;
+    }
+    return history_;
+  }
+
+  std::vector<track_cluster> track_cluster_history::replay(const std::vector<merge>& merges, size_t nmerges) const {
+    const size_t n = tracks.size();
+    std::vector<std::vector<size_t>> slots(n);
+    for (size_t i = 0; i < n; ++i)
+      slots[i].push_back(i);
+
+    for (size_t k = 0; k < nmerges; ++k) {
+      const merge& m = merges[k];
+      slots[m.a].insert(slots[m.a].end(), slots[m.b].begin(), slots[m.b].end());
+      slots[m.b].clear();
+    }
+
+    std::vector<track_cluster> r;
+    for (std::vector<size_t>& slot : slots) {
+      if (slot.empty())
+        continue;
+      std::sort(slot.begin(), slot.end());
+      r.push_back(track_cluster());
+      track_cluster& c = r.back();
+      for (size_t i : slot)
+        c.p4 += TLorentzVector(tracks[i].px, tracks[i].py, tracks[i].pz, tracks[i].E);
+      c.tracks.swap(slot);
+    }
+
+    std::sort(r.begin(), r.end(), [](const track_cluster& a, const track_cluster& b) { return a.p4.Perp2() > b.p4.Perp2(); });
+    return r;
+  }
+
+  std::vector<track_cluster> track_cluster_history::replay_below(double d) const {
+    const std::vector<merge>& h = history();
+    size_t k = 0;
+    while (k < h.size() && h[k].d < d)
+      ++k;
+    return replay(h, k);
+  }
+
+  std::vector<track_cluster> track_cluster_history::clusters_min_dist(double min_dist) const {
+    return replay_below(min_dist);
+  }
+
+  const std::vector<track_cluster>& track_cluster_history::clusters(double R) const {
+    auto it = cache.find(R);
+    if (it != cache.end())
+      return it->second;
+
+    std::vector<track_cluster>& c = cache[R];
+    if (algo == fastjet::cambridge_algorithm)
+      c = replay_below(R*R);
+    else {
+      const std::vector<merge> merges = gen_kt_merges(tracks, algo, R*R);
+      c = replay(merges, merges.size());
+    }
+
+    return c;
+  }
+
+  std::string check_track_cluster_history(const MFVVertexAux& v, const std::vector<double>& Rs) {
+    typedef std::vector<std::vector<size_t>> membership_t;
+    auto membership = [](const std::vector<track_cluster>& cs) {
+      membership_t m;
+      for (const track_cluster& c : cs) {
+        m.push_back(c.tracks);
+        std::sort(m.back().begin(), m.back().end());
+      }
+      std::sort(m.begin(), m.end());
+      return m;
+    };
+
+    const fastjet::JetAlgorithm algos[3] = { fastjet::kt_algorithm, fastjet::cambridge_algorithm, fastjet::antikt_algorithm };
+    const char* algo_names[3] = { "kt", "C/A", "anti-kt" };
+
+    std::ostringstream out;
+    for (int ialgo = 0; ialgo < 3; ++ialgo) {
+      const track_cluster_history h(v, algos[ialgo]);
+      for (double R : Rs) {
+        const membership_t m = membership(h.clusters(R));
+        if (m != membership(track_clusters(v, R, algos[ialgo]).clusters)) {
+          out << algo_names[ialgo] << " R = " << R << " differs from fastjet";
+          return out.str();
+        }
+        if (algos[ialgo] == fastjet::cambridge_algorithm && m != membership(h.clusters_min_dist(R*R))) {
+          out << "C/A clusters_min_dist(" << R*R << ") differs from clusters(" << R << ")";
+          return out.str();
+        }
+      }
+    }
+
+    return out.str();
+  }
+
   size_t track_clusters::nsingle() const {
     return std::count_if(clusters.begin(), clusters.end(), [](const track_cluster& c) { return c.size() == 1; });
   }
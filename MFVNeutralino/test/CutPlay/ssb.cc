@@ -409,7 +409,7 @@ struct z_calculator {
     return hs;
   }
 
-  double get_zpl(const std::string& var, const int ibin) const {
+  SigCalcPoint zpl_point(const std::string& var, const int ibin) const {
     double s = total_count(var, ibin, true, true).first;
     double n = s;
     std::vector<double> ms, taus;
@@ -430,7 +430,7 @@ struct z_calculator {
     }
 
     if (options.moreprints) printf("   s: %f  n: %f\n", s, n);
-    return getSignificance(0, n, s, ms, taus, options.syst_frac);
+    return SigCalcPoint{0, n, s, ms, taus, options.syst_frac};
   }
 
   void max_z(const std::string& var) const {
@@ -458,6 +458,11 @@ struct z_calculator {
     TH1F* h_zssbsb20 = new TH1F("h_zssbsb20", ";cut;ssbsb20", nbins, xlow, xup);
     TH1F* h_zpl = new TH1F("h_zpl", ";cut;asimov Z", nbins, xlow, xup);
 
+    std::vector<SigCalcPoint> zpl_points;
+    for (int i = 1; i <= nbins; i++)
+      zpl_points.push_back(zpl_point(var, i));
+    const std::vector<double> zpls = getSignificances(zpl_points);
+
     double cut = 0;
     double smax = 0;
     double bmax = 0;
@@ -473,7 +478,7 @@ struct z_calculator {
       const double zssb20 = s/sqrt(b + 0.04*b*b);
       const double zssbsb = s/sqrt(b + sigb*sigb);
       const double zssbsb20 = s/sqrt(b + sigb*sigb + 0.04*b*b);
-      const double zpl = get_zpl(var, i);
+      const double zpl = zpls[i-1];
 
       const double z = zssb20;
 
@@ -0,0 +1,185 @@
+// Look up single events in MiniTree, MovedTracks or TrackingTree files
+// through the sidecar indices of JMTucker/Tools/interface/EventIndex.h
+// instead of scanning the trees, e.g.
+//
+//   ./evidx.exe build mfvMiniTree/t *.root
+//   ./evidx.exe find mfvMiniTree/t 1:2345:678901,1:2345:678905 *.root
+//   ./evidx.exe find -d mfvMiniTree/t events.txt *.root
+//
+// build (re)makes the index of each file. find prints the file and
+// entry of each event found, and with -d dumps the entry: with
+// mfv::print for a MiniTree, TrackingTree::print for a TrackingTree,
+// TTree::Show otherwise. Files whose index is missing or older than the
+// file get it built and saved first (see EventIndex::sidecar_path for
+// where the ones for remote files go). The events are given as
+// run:lumi:event separated by commas, or as a file with one run lumi
+// event per line, separated by spaces, colons or commas, # starting a
+// comment.
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "TFile.h"
+#include "TTree.h"
+#include "JMTucker/MFVNeutralino/interface/MiniNtuple.h"
+#include "JMTucker/Tools/interface/EventIndex.h"
+#include "JMTucker/Tools/interface/TrackingTree.h"
+
+namespace {
+  typedef jmt::EventIndex::rle_t rle_t;
+
+  bool parse_rle(std::string s, rle_t& rle) {
+    for (char& c : s)
+      if (c == ':' || c == ',')
+        c = ' ';
+    std::istringstream iss(s);
+    unsigned run, lumi;
+    unsigned long long event;
+    std::string rest;
+    if (!(iss >> run >> lumi >> event) || (iss >> rest))
+      return false;
+    rle = rle_t(run, lumi, event);
+    return true;
+  }
+
+  std::vector<rle_t> parse_events(const std::string& arg) {
+    std::vector<rle_t> rles;
+    rle_t rle;
+
+    std::ifstream f(arg);
+    if (f) {
+      std::string line;
+      for (int iline = 1; std::getline(f, line); ++iline) {
+        line = line.substr(0, line.find('#'));
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+          continue;
+        if (!parse_rle(line, rle)) {
+          fprintf(stderr, "%s:%i: can't parse \"%s\"\n", arg.c_str(), iline, line.c_str());
+          exit(1);
+        }
+        rles.push_back(rle);
+      }
+      return rles;
+    }
+
+    std::istringstream iss(arg);
+    std::string tok;
+    while (std::getline(iss, tok, ',')) {
+      if (!parse_rle(tok, rle)) {
+        fprintf(stderr, "can't parse event \"%s\", expected run:lumi:event\n", tok.c_str());
+        exit(1);
+      }
+      rles.push_back(rle);
+    }
+    return rles;
+  }
+
+  void dump(const std::string& fn, const std::string& tree_path, const std::vector<unsigned long long>& entries) {
+    std::unique_ptr<TFile> f(TFile::Open(fn.c_str()));
+    TTree* t = f && f->IsOpen() ? (TTree*)f->Get(tree_path.c_str()) : 0;
+    if (!t) {
+      fprintf(stderr, "can't get %s from %s\n", tree_path.c_str(), fn.c_str());
+      return;
+    }
+
+    if (t->GetBranch("ntk0")) {
+      mfv::MiniNtuple nt;
+      mfv::read_from_tree(t, nt);
+      for (unsigned long long j : entries) {
+        t->GetEntry(j);
+        std::cout << "\n" << fn << " entry " << j << ":\n";
+        mfv::print(std::cout, nt);
+      }
+    }
+    else if (t->GetBranch("tk_qpt")) {
+      TrackingTree nt;
+      nt.read_from_tree(t);
+      for (unsigned long long j : entries) {
+        t->GetEntry(j);
+        std::cout << "\n" << fn << " entry " << j << ":\n";
+        nt.print(std::cout);
+      }
+    }
+    else
+      for (unsigned long long j : entries) {
+        std::cout << "\n" << fn << " entry " << j << ":\n" << std::flush;
+        t->Show(j);
+      }
+  }
+}
+
+int main(int argc, char** argv) {
+  const char* usage = "usage: %s build tree_path fn.root [fn2.root ...]\n"
+                      "       %s find [-d] tree_path run:lumi:event[,...]|events.txt fn.root [fn2.root ...]\n";
+  if (argc < 4) {
+    fprintf(stderr, usage, argv[0], argv[0]);
+    return 1;
+  }
+
+  const std::string cmd = argv[1];
+
+  if (cmd == "build") {
+    const std::string tree_path = argv[2];
+    for (int i = 3; i < argc; ++i) {
+      const std::string sc = jmt::EventIndex::sidecar_path(argv[i], tree_path);
+      std::unique_ptr<TFile> f(TFile::Open(argv[i]));
+      TTree* t = f && f->IsOpen() ? (TTree*)f->Get(tree_path.c_str()) : 0;
+      if (!t) {
+        fprintf(stderr, "can't get %s from %s\n", tree_path.c_str(), argv[i]);
+        return 1;
+      }
+      const jmt::EventIndex x = jmt::EventIndex::build(t, tree_path);
+      if (!x.write(sc)) {
+        fprintf(stderr, "can't write %s\n", sc.c_str());
+        return 1;
+      }
+      printf("%s: %zu entries -> %s\n", argv[i], x.records().size(), sc.c_str());
+    }
+  }
+  else if (cmd == "find") {
+    int iarg = 2;
+    const bool do_dump = strcmp(argv[iarg], "-d") == 0;
+    if (do_dump)
+      ++iarg;
+    if (argc - iarg < 3) {
+      fprintf(stderr, usage, argv[0], argv[0]);
+      return 1;
+    }
+
+    const std::string tree_path = argv[iarg++];
+    const std::vector<rle_t> rles = parse_events(argv[iarg++]);
+
+    jmt::EventIndexSet idx(tree_path);
+    idx.add(std::vector<std::string>(argv + iarg, argv + argc));
+
+    int nnotfound = 0;
+    std::map<size_t, std::vector<unsigned long long>> to_dump;
+    for (const rle_t& rle : rles) {
+      const std::vector<jmt::EventIndexSet::Match> ms = idx.find(rle);
+      if (ms.empty()) {
+        printf("%u:%u:%llu not found\n", std::get<0>(rle), std::get<1>(rle), std::get<2>(rle));
+        ++nnotfound;
+      }
+      for (const jmt::EventIndexSet::Match& m : ms) {
+        printf("%u:%u:%llu %s %llu\n", std::get<0>(rle), std::get<1>(rle), std::get<2>(rle), idx.fn(m.ifile).c_str(), m.entry);
+        to_dump[m.ifile].push_back(m.entry);
+      }
+    }
+
+    if (do_dump)
+      for (const auto& p : to_dump)
+        dump(idx.fn(p.first), tree_path, p.second);
+
+    return nnotfound ? 2 : 0;
+  }
+  else {
+    fprintf(stderr, usage, argv[0], argv[0]);
+    return 1;
+  }
+}
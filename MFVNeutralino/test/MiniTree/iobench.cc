@@ -0,0 +1,253 @@
+// Rewrite a MiniTree under a grid of compression/basket/auto-flush
+// settings and time reading each one back, to pick the
+// MiniNtupleWriteSettings for MFVMiniTreer, e.g.
+//
+//   ./iobench.exe minitree.root mfvMiniTree/t algorithms=1,4 levels=1,4 baskets=32000,128000 autoflush=-30000000
+//
+// For each point the file size, write time, the time to read all
+// branches, and the time to read just the typical subsets (the vertex
+// and jet quantities used by the One2Two/histogramming loops, and the
+// tk0_*/tk1_* track branches) are printed; the read times are the best
+// of nrepeat passes. The files are read back right after being written,
+// so they're in the page cache and the times are for decompression and
+// streaming, not the disk. At the end, among the settings whose size is
+// within max_size_ratio of the smallest, the one with the smallest
+// total read time is recommended, printed as the MFVMiniTreer
+// parameters.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include "TFile.h"
+#include "TTree.h"
+#include "JMTucker/MFVNeutralino/interface/MiniNtuple.h"
+
+namespace {
+  typedef std::chrono::steady_clock clock_type;
+
+  double seconds_since(clock_type::time_point t0) {
+    return std::chrono::duration<double>(clock_type::now() - t0).count();
+  }
+
+  template <typename T>
+  std::vector<T> parse_list(const char* s) {
+    std::vector<T> r;
+    std::stringstream ss(s);
+    std::string x;
+    while (std::getline(ss, x, ','))
+      r.push_back(T(atoll(x.c_str())));
+    return r;
+  }
+
+  long long file_size(const std::string& fn) {
+    struct stat st;
+    return stat(fn.c_str(), &st) == 0 ? st.st_size : -1;
+  }
+
+  const std::vector<std::string> vertex_branches = {
+    "run", "lumi", "event", "weight", "npu", "njets", "jet_pt", "jet_eta", "jet_phi", "jet_bdisc",
+    "nvtx", "ntk0", "ntk1", "x0", "y0", "z0", "x1", "y1", "z1", "bs2derr0", "bs2derr1", "genmatch0", "genmatch1"
+  };
+
+  const std::vector<std::string> track_branches = {
+    "nvtx", "ntk0", "ntk1", "x0", "y0", "z0", "x1", "y1", "z1", "tk0_*", "tk1_*"
+  };
+
+  // Best-of-n time to read every entry, with only the listed branches
+  // turned on if there is a list.
+  double read_time(const std::string& fn, const char* tree_path, const std::vector<std::string>* branches, int nrepeat) {
+    double best = -1;
+    for (int i = 0; i < nrepeat; ++i) {
+      std::unique_ptr<TFile> f(TFile::Open(fn.c_str()));
+      if (!f || f->IsZombie()) {
+        fprintf(stderr, "could not open %s\n", fn.c_str());
+        exit(1);
+      }
+      TTree* t = (TTree*)f->Get(tree_path);
+      mfv::MiniNtuple nt;
+      mfv::read_from_tree(t, nt);
+      if (branches) {
+        t->SetBranchStatus("*", 0);
+        for (const std::string& b : *branches)
+          t->SetBranchStatus(b.c_str(), 1);
+      }
+
+      const auto t0 = clock_type::now();
+      for (long long j = 0, je = t->GetEntries(); j < je; ++j)
+        t->GetEntry(j);
+      const double dt = seconds_since(t0);
+      if (best < 0 || dt < best)
+        best = dt;
+    }
+    return best;
+  }
+
+  struct Point {
+    mfv::MiniNtupleWriteSettings s;
+    long long size;
+    double t_write;
+    double t_full;
+    double t_vertex;
+    double t_tracks;
+    double t_read() const { return t_full + t_vertex + t_tracks; }
+  };
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: iobench.exe minitree.root [tree_path] [algorithms=1,2,4] [levels=1,4,7] [compressions=101,404] [baskets=32000,...] [track_baskets=-1,...] [autoflush=-30000000,...] [nrepeat=3] [max_entries=-1] [max_size_ratio=1.1] [workdir=.] [keep=0]\n");
+    return 1;
+  }
+
+  const char* in_fn = argv[1];
+  const char* tree_path = "mfvMiniTree/t";
+  std::vector<int> algorithms = {1, 2, 4};
+  std::vector<int> levels = {1, 4, 7};
+  std::vector<int> compressions;
+  std::vector<int> baskets = {32000, 128000};
+  std::vector<int> track_baskets = {-1};
+  std::vector<long long> autoflushes = {-30000000};
+  int nrepeat = 3;
+  long long max_entries = -1;
+  double max_size_ratio = 1.1;
+  std::string workdir = ".";
+  bool keep = false;
+
+  for (int i = 2; i < argc; ++i) {
+    const char* a = argv[i];
+    const char* eq = strchr(a, '=');
+    if (!eq) {
+      if (i == 2) { tree_path = a; continue; }
+      fprintf(stderr, "bad argument %s\n", a);
+      return 1;
+    }
+    const std::string k(a, eq);
+    const char* v = eq + 1;
+    if      (k == "algorithms")     algorithms = parse_list<int>(v);
+    else if (k == "levels")         levels = parse_list<int>(v);
+    else if (k == "compressions")   compressions = parse_list<int>(v);
+    else if (k == "baskets")        baskets = parse_list<int>(v);
+    else if (k == "track_baskets")  track_baskets = parse_list<int>(v);
+    else if (k == "autoflush")      autoflushes = parse_list<long long>(v);
+    else if (k == "nrepeat")        nrepeat = atoi(v);
+    else if (k == "max_entries")    max_entries = atoll(v);
+    else if (k == "max_size_ratio") max_size_ratio = atof(v);
+    else if (k == "workdir")        workdir = v;
+    else if (k == "keep")           keep = atoi(v);
+    else {
+      fprintf(stderr, "unknown option %s\n", k.c_str());
+      return 1;
+    }
+  }
+
+  if (!(max_size_ratio >= 1)) {
+    fprintf(stderr, "max_size_ratio must be >= 1, the smallest file has to qualify\n");
+    return 1;
+  }
+
+  if (compressions.empty())
+    for (int alg : algorithms)
+      for (int lvl : levels)
+        compressions.push_back(alg * 100 + lvl);
+
+  std::unique_ptr<TFile> in_f(TFile::Open(in_fn));
+  if (!in_f || in_f->IsZombie()) {
+    fprintf(stderr, "could not open %s\n", in_fn);
+    return 1;
+  }
+  TTree* in_t = (TTree*)in_f->Get(tree_path);
+  if (!in_t) {
+    fprintf(stderr, "no tree %s in %s\n", tree_path, in_fn);
+    return 1;
+  }
+  mfv::MiniNtuple in_nt;
+  mfv::read_from_tree(in_t, in_nt);
+  long long nentries = in_t->GetEntries();
+  if (max_entries >= 0 && max_entries < nentries)
+    nentries = max_entries;
+
+  const TString tp(tree_path);
+  const int slash = tp.Last('/');
+  const TString tree_dir = slash >= 0 ? TString(tp(0, slash)) : TString();
+  const TString tree_name = tp(slash + 1, tp.Length());
+
+  printf("%s:%s, %lli entries, %lli bytes\n", in_fn, tree_path, nentries, file_size(in_fn));
+  printf("input full read: %.3f s\n", read_time(in_fn, tree_path, 0, nrepeat));
+  printf("%11s %9s %9s %12s %10s %8s %9s %9s %9s\n", "compression", "basket", "tkbasket", "autoflush", "size", "write", "full", "vertex", "tracks");
+
+  std::vector<Point> points;
+
+  for (int comp : compressions)
+    for (int basket : baskets)
+      for (int tkbasket : track_baskets)
+        for (long long af : autoflushes) {
+          Point p;
+          p.s.compression = comp;
+          p.s.basket_size = basket;
+          p.s.track_basket_size = tkbasket;
+          p.s.auto_flush = af;
+
+          std::ostringstream fn;
+          fn << workdir << "/iobench_" << comp << "_" << basket << "_" << tkbasket << "_" << af << ".root";
+
+          const auto t0 = clock_type::now();
+          {
+            std::unique_ptr<TFile> f(TFile::Open(fn.str().c_str(), "recreate"));
+            f->SetCompressionSettings(comp);
+            if (tree_dir.Length())
+              f->mkdir(tree_dir)->cd();
+            TTree* t = new TTree(tree_name, "");
+            mfv::MiniNtuple out_nt;
+            mfv::write_to_tree(t, out_nt, p.s);
+            for (long long j = 0; j < nentries; ++j) {
+              in_t->GetEntry(j);
+              std::unique_ptr<mfv::MiniNtuple> c(mfv::clone(in_nt));
+              out_nt = *c;
+              t->Fill();
+            }
+            t->Write();
+            f->Close();
+          }
+          p.t_write = seconds_since(t0);
+          p.size = file_size(fn.str());
+          p.t_full = read_time(fn.str(), tree_path, 0, nrepeat);
+          p.t_vertex = read_time(fn.str(), tree_path, &vertex_branches, nrepeat);
+          p.t_tracks = read_time(fn.str(), tree_path, &track_branches, nrepeat);
+          points.push_back(p);
+
+          printf("%11i %9i %9i %12lli %10lli %8.3f %9.3f %9.3f %9.3f\n", comp, basket, tkbasket, af, p.size, p.t_write, p.t_full, p.t_vertex, p.t_tracks);
+          fflush(stdout);
+
+          if (!keep)
+            remove(fn.str().c_str());
+        }
+
+  if (points.empty())
+    return 1;
+
+  long long min_size = points[0].size;
+  for (const Point& p : points)
+    min_size = std::min(min_size, p.size);
+
+  const Point* best = 0;
+  for (const Point& p : points)
+    if (p.size <= max_size_ratio * min_size && (!best || p.t_read() < best->t_read()))
+      best = &p;
+  if (!best) {
+    fprintf(stderr, "no point within %.2f of the smallest file\n", max_size_ratio);
+    return 1;
+  }
+
+  printf("\nrecommended (smallest full+vertex+tracks read time within %.2f of the smallest file):\n", max_size_ratio);
+  printf("process.mfvMiniTree.compression = %i\n", best->s.compression);
+  printf("process.mfvMiniTree.basket_size = %i\n", best->s.basket_size);
+  printf("process.mfvMiniTree.track_basket_size = %i\n", best->s.track_basket_size);
+  printf("process.mfvMiniTree.auto_flush = %lli\n", best->s.auto_flush);
+}
@@ -38,9 +38,24 @@ EOF
  *  - In MFVNeutralino/test: python utilities.py merge_bquarks_nobquarks
  *  - Run bquark_correction.py to get the values of the b quark corrections.
  *  - Todo: update for 2017 (the current values are from 2015+2016 MC).
+ *
+ * construction
+ *  - "sample" (default): draw 20 x the number of one-vertex events (dBV0, dBV1, dphi) triples.
+ *  - "exact": integrate the dBV histograms against the dphi pdf and the efficiency with mfv::DvvcConvolution instead; no random numbers.
+ *    The h_c1v_* histograms have the contents the sampling converges to for the same number of samples, and as errors what the sampling would have.
+ *  - "validate": do both, keep the sampled histograms, write the exact ones with an _exact suffix, and print the pulls (sampled - exact) / error.
+ *  - For vary_dphi the pdf used for "exact" is dphi_alt_pdf; the bin migration printout is only for the sampling.
+ *  - To run: ./2v_from_jets.exe only_default ntracks year construction [dphi_alt_pdf]
+ *
+ * vary_dphi
+ *  - Each sampled dphi is moved to the same quantile of the alternative shape dphi_alt_pdf, a TF1 formula in x on [0, pi] that need not be
+ *    normalized (default "1", uniform), with jmt::MonotoneRemap, so the variation is correlated with the default sample event by event.
+ *  - Passing dphi_alt_pdf to only_default turns on vary_dphi.
  */
 
 #include <cstdlib>
+#include <memory>
+#include <stdexcept>
 #include <math.h>
 #include "TCanvas.h"
 #include "TF1.h"
@@ -53,7 +68,9 @@ EOF
 #include "TStyle.h"
 #include "TTree.h"
 #include "TVector2.h"
+#include "JMTucker/MFVNeutralino/interface/DvvcConvolution.h"
 #include "JMTucker/MFVNeutralino/interface/MiniNtuple.h"
+#include "JMTucker/Tools/interface/MonotoneRemap.h"
 
 int dvv_nbins = 40;
 double dvv_bin_width = 0.01;
@@ -68,11 +85,13 @@ struct ConstructDvvcParameters {
   int bquarks_;
   int btags_;
   bool vary_dphi_;
+  std::string dphi_alt_pdf_;
   bool clearing_from_eff_;
   bool vary_eff_;
   bool vary_bquarks_;
   int min_npu_;
   int max_npu_;
+  std::string construction_;
 
   ConstructDvvcParameters()
     : is_mc_(true),
@@ -84,11 +103,13 @@ struct ConstructDvvcParameters {
       bquarks_(-1),
       btags_(-1),
       vary_dphi_(false),
+      dphi_alt_pdf_("1"),
       clearing_from_eff_(true),
       vary_eff_(false),
       vary_bquarks_(false),
       min_npu_(0),
-      max_npu_(255)
+      max_npu_(255),
+      construction_("sample")
   {
   }
 
@@ -101,11 +122,13 @@ struct ConstructDvvcParameters {
   int bquarks() const { return bquarks_; }
   int btags() const { return btags_; }
   bool vary_dphi() const { return vary_dphi_; }
+  std::string dphi_alt_pdf() const { return dphi_alt_pdf_; }
   bool clearing_from_eff() const { return clearing_from_eff_; }
   bool vary_eff() const { return vary_eff_; }
   bool vary_bquarks() const { return vary_bquarks_; }
   int min_npu() const { return min_npu_; }
   int max_npu() const { return max_npu_; }
+  std::string construction() const { return construction_; }
 
   ConstructDvvcParameters is_mc(bool x)             { ConstructDvvcParameters y(*this); y.is_mc_             = x; return y; }
   ConstructDvvcParameters only_10pc(bool x)         { ConstructDvvcParameters y(*this); y.only_10pc_         = x; return y; }
@@ -116,17 +139,116 @@ struct ConstructDvvcParameters {
   ConstructDvvcParameters bquarks(int x)            { ConstructDvvcParameters y(*this); y.bquarks_           = x; return y; }
   ConstructDvvcParameters btags(int x)              { ConstructDvvcParameters y(*this); y.btags_             = x; return y; }
   ConstructDvvcParameters vary_dphi(bool x)         { ConstructDvvcParameters y(*this); y.vary_dphi_         = x; return y; }
+  ConstructDvvcParameters dphi_alt_pdf(std::string x) { ConstructDvvcParameters y(*this); y.dphi_alt_pdf_    = x; return y; }
   ConstructDvvcParameters clearing_from_eff(bool x) { ConstructDvvcParameters y(*this); y.clearing_from_eff_ = x; return y; }
   ConstructDvvcParameters vary_eff(bool x)          { ConstructDvvcParameters y(*this); y.vary_eff_          = x; return y; }
   ConstructDvvcParameters vary_bquarks(bool x)      { ConstructDvvcParameters y(*this); y.vary_bquarks_      = x; return y; }
   ConstructDvvcParameters min_npu(int x)            { ConstructDvvcParameters y(*this); y.min_npu_           = x; return y; }
   ConstructDvvcParameters max_npu(int x)            { ConstructDvvcParameters y(*this); y.max_npu_           = x; return y; }
+  ConstructDvvcParameters construction(std::string x) { ConstructDvvcParameters y(*this); y.construction_    = x; return y; }
 
   void print() const {
-    printf("is_mc = %d, only_10pc = %d, inject_signal = %d, year = %s, ntracks = %d, correct_bquarks = %d, bquarks = %d, btags = %d, vary_dphi = %d, clearing_from_eff = %d, vary_eff = %d, vary_bquarks = %d", is_mc(), only_10pc(), inject_signal(), year_.c_str(), ntracks(), correct_bquarks(), bquarks(), btags(), vary_dphi(), clearing_from_eff(), vary_eff(), vary_bquarks());
+    printf("is_mc = %d, only_10pc = %d, inject_signal = %d, year = %s, ntracks = %d, correct_bquarks = %d, bquarks = %d, btags = %d, vary_dphi = %d, dphi_alt_pdf = %s, clearing_from_eff = %d, vary_eff = %d, vary_bquarks = %d, construction = %s", is_mc(), only_10pc(), inject_signal(), year_.c_str(), ntracks(), correct_bquarks(), bquarks(), btags(), vary_dphi(), dphi_alt_pdf_.c_str(), clearing_from_eff(), vary_eff(), vary_bquarks(), construction_.c_str());
   }
 };
 
+std::vector<double> bin_edges(const TAxis* a) {
+  std::vector<double> e(a->GetNbins() + 1);
+  for (int i = 1; i <= a->GetNbins() + 1; ++i)
+    e[i-1] = a->GetBinLowEdge(i);
+  return e;
+}
+
+std::vector<double> bin_contents(const TH1* h, bool flows) {
+  std::vector<double> c;
+  for (int i = flows ? 0 : 1, ie = h->GetNbinsX() + (flows ? 1 : 0); i <= ie; ++i)
+    c.push_back(h->GetBinContent(i));
+  return c;
+}
+
+// Fill the constructed histograms with what drawing nsamples (dbv0,
+// dbv1, dphi) triples below converges to, computed by
+// mfv::DvvcConvolution, and return the sum of the efficiency weights.
+// The errors are what the sampling would give. The dBV histograms and
+// the h_c1v_dbv* ones must have the same binning.
+double construct_dvvc_exact(double nsamples, const TH1D* h_1v_dbv0, const TH1D* h_1v_dbv1, const TF1* f_dphi, const TH1F* h_eff,
+                            TH1F* h_c1v_dbv, TH1F* h_c1v_dvv, TH1F* h_c1v_absdphivv, TH1F* h_c1v_dbv0, TH1F* h_c1v_dbv1, TH2F* h_c1v_dbv1_dbv0) {
+  mfv::DvvcConvolution conv(bin_edges(h_1v_dbv0->GetXaxis()), bin_edges(h_c1v_dvv->GetXaxis()));
+  if (f_dphi)
+    conv.set_dphi_pdf([&](double x) { return f_dphi->Eval(x); });
+  conv.set_dphi_edges(bin_edges(h_c1v_absdphivv->GetXaxis()));
+  if (h_eff)
+    conv.set_eff(bin_edges(h_eff->GetXaxis()), bin_contents(h_eff, true));
+
+  std::vector<double> p0 = bin_contents(h_1v_dbv0, false), p1 = bin_contents(h_1v_dbv1, false);
+  double s0 = 0, s1 = 0;
+  for (double& x : p0) s0 += x = std::max(x, 0.);
+  for (double& x : p1) s1 += x = std::max(x, 0.);
+
+  const int ndvv = conv.ndvv(), ndphi = conv.ndphi();
+  std::vector<double> dvv(ndvv), dvv_w2(ndvv), dphi(ndphi), dphi_w2(ndphi), dbv0(conv.nrho()), dbv0_w2(conv.nrho()), dbv1(conv.nrho()), dbv1_w2(conv.nrho());
+  double sum = 0;
+
+  for (int i = 0; i < conv.nrho(); ++i) {
+    const double n0 = nsamples * p0[i] / s0;
+    h_c1v_dbv->SetBinContent(i+1, h_c1v_dbv->GetBinContent(i+1) + n0);
+    if (n0 == 0) continue;
+
+    for (int j = 0; j < conv.nrho(); ++j) {
+      const double n = n0 * p1[j] / s1;
+      if (n == 0) continue;
+
+      double w = 0, w2 = 0;
+      conv.convolve_bin_pair(i, j, [&](int kdvv, int kdphi, double p, double eff) {
+          w += p * eff;
+          w2 += p * eff * eff;
+          dvv[kdvv] += n * p * eff;
+          dvv_w2[kdvv] += n * p * eff * eff;
+          if (kdphi >= 0) {
+            dphi[kdphi] += n * p * eff;
+            dphi_w2[kdphi] += n * p * eff * eff;
+          }
+        });
+
+      h_c1v_dbv1_dbv0->SetBinContent(i+1, j+1, n * w);
+      h_c1v_dbv1_dbv0->SetBinError  (i+1, j+1, sqrt(n * w2));
+      dbv0[i] += n * w;
+      dbv0_w2[i] += n * w2;
+      dbv1[j] += n * w;
+      dbv1_w2[j] += n * w2;
+      sum += n * w;
+    }
+  }
+
+  for (int j = 0; j < conv.nrho(); ++j)
+    h_c1v_dbv->SetBinContent(j+1, h_c1v_dbv->GetBinContent(j+1) + nsamples * p1[j] / s1);
+  for (int i = 1; i <= h_c1v_dbv->GetNbinsX(); ++i)
+    h_c1v_dbv->SetBinError(i, sqrt(h_c1v_dbv->GetBinContent(i)));
+
+  for (int i = 0; i < conv.nrho(); ++i) {
+    h_c1v_dbv0->SetBinContent(i+1, dbv0[i]);
+    h_c1v_dbv0->SetBinError  (i+1, sqrt(dbv0_w2[i]));
+    h_c1v_dbv1->SetBinContent(i+1, dbv1[i]);
+    h_c1v_dbv1->SetBinError  (i+1, sqrt(dbv1_w2[i]));
+  }
+  for (int k = 0; k < ndvv; ++k) {
+    h_c1v_dvv->SetBinContent(k+1, dvv[k]);
+    h_c1v_dvv->SetBinError  (k+1, sqrt(dvv_w2[k]));
+  }
+  for (int k = 0; k < ndphi; ++k) {
+    h_c1v_absdphivv->SetBinContent(k+1, dphi[k]);
+    h_c1v_absdphivv->SetBinError  (k+1, sqrt(dphi_w2[k]));
+  }
+
+  for (TH1* h : std::initializer_list<TH1*>{h_c1v_dbv, h_c1v_dvv, h_c1v_absdphivv, h_c1v_dbv0, h_c1v_dbv1, h_c1v_dbv1_dbv0}) {
+    h->ResetStats();
+    h->SetEntries(nsamples);
+  }
+  h_c1v_dbv->SetEntries(2*nsamples);
+
+  return sum;
+}
+
 void construct_dvvc(ConstructDvvcParameters p, const char* out_fn) {
   p.print(); printf(", out_fn = %s\n", out_fn);
 
@@ -374,12 +496,20 @@ void construct_dvvc(ConstructDvvcParameters p, const char* out_fn) {
   TF1* f_dphi = new TF1("f_dphi", "(abs(x)-[0])**[1] + [2]", 0, M_PI);
   f_dphi->SetParameters(dphi_pdf_c, dphi_pdf_e, dphi_pdf_a);
 
-  TF1* i_dphi = 0;
-  TF1* i_dphi2 = 0;
+  TF1* f_dphi_alt = 0;
+  std::unique_ptr<jmt::MonotoneRemap> dphi_remap;
   if (p.vary_dphi()) {
-    i_dphi = new TF1("i_dphi", "((1/([1]+1))*(x-[0])**([1]+1) + [2]*x - (1/([1]+1))*(-[0])**([1]+1)) / ((1/([1]+1))*(3.14159-[0])**([1]+1) + [2]*3.14159 - (1/([1]+1))*(-[0])**([1]+1))", 0, M_PI);
-    i_dphi->SetParameters(dphi_pdf_c, dphi_pdf_e, dphi_pdf_a);
-    i_dphi2 = new TF1("i_dphi2", "x/3.14159", 0, M_PI);
+    f_dphi_alt = new TF1("f_dphi_alt", p.dphi_alt_pdf().c_str(), 0, M_PI);
+    if (!f_dphi_alt->IsValid()) { fprintf(stderr, "bad dphi_alt_pdf"); exit(1); }
+    try {
+      const jmt::TabulatedCdf cdf([&](double x) { return f_dphi->Eval(x); }, 0, M_PI);
+      const jmt::TabulatedCdf cdf_alt([&](double x) { return f_dphi_alt->Eval(x); }, 0, M_PI);
+      dphi_remap.reset(new jmt::MonotoneRemap(cdf, cdf_alt));
+    }
+    catch (const std::runtime_error& e) {
+      fprintf(stderr, "dphi remap: %s\n", e.what()); exit(1);
+    }
+    printf("dphi remap to %s: %i points, max error %g\n", p.dphi_alt_pdf().c_str(), dphi_remap->npoints(), dphi_remap->max_error());
   }
 
   TH1F* h_eff = 0;
@@ -400,10 +530,14 @@ void construct_dvvc(ConstructDvvcParameters p, const char* out_fn) {
   int outofbin2 = 0;
   int outofbin3 = 0;
 
+  const bool sample = p.construction() == "sample" || p.construction() == "validate";
+  const bool exact  = p.construction() == "exact"  || p.construction() == "validate";
+  if (!sample && !exact) { fprintf(stderr, "bad construction"); exit(1); }
+
   const int nsamples = 20*int(h_1v_dbv->GetEntries());
-  printf("sampling %i times (should be %i)\n", nsamples, 20*int(h_1v_dbv->Integral()));
+  printf("%s %i times (should be %i)\n", sample ? "sampling" : "integrating for", nsamples, 20*int(h_1v_dbv->Integral()));
   double events_after_eff = 0;
-  for (int ij = 0; ij < nsamples; ++ij) {
+  for (int ij = 0, ije = sample ? nsamples : 0; ij < ije; ++ij) {
     double dbv0 = h_1v_dbv0->GetRandom();
     double dbv1 = h_1v_dbv1->GetRandom();
     h_c1v_dbv->Fill(dbv0);
@@ -414,7 +548,7 @@ void construct_dvvc(ConstructDvvcParameters p, const char* out_fn) {
     double dvvc = sqrt(dbv0*dbv0 + dbv1*dbv1 - 2*dbv0*dbv1*cos(dphi));
 
     if (p.vary_dphi()) {
-      double dphi2 = i_dphi2->GetX(i_dphi->Eval(dphi), 0, M_PI);
+      double dphi2 = (*dphi_remap)(dphi);
       double dvvc2 = sqrt(dbv0*dbv0 + dbv1*dbv1 - 2*dbv0*dbv1*cos(dphi2));
       if (dvvc < 0.04) ++bin1;
       if (dvvc >= 0.04 && dvvc < 0.07) ++bin2;
@@ -443,19 +577,53 @@ void construct_dvvc(ConstructDvvcParameters p, const char* out_fn) {
 
     events_after_eff += prob;
   }
+
+  std::vector<TH1*> h_exact;
+  if (exact) {
+    const TF1* dphi_pdf = p.vary_dphi() ? f_dphi_alt : f_dphi;
+    if (!sample)
+      events_after_eff = construct_dvvc_exact(nsamples, h_1v_dbv0, h_1v_dbv1, dphi_pdf, h_eff, h_c1v_dbv, h_c1v_dvv, h_c1v_absdphivv, h_c1v_dbv0, h_c1v_dbv1, h_c1v_dbv1_dbv0);
+    else {
+      for (TH1* h : std::initializer_list<TH1*>{h_c1v_dbv, h_c1v_dvv, h_c1v_absdphivv, h_c1v_dbv0, h_c1v_dbv1, h_c1v_dbv1_dbv0}) {
+        h_exact.push_back((TH1*)h->Clone(TString::Format("%s_exact", h->GetName())));
+        h_exact.back()->Reset();
+      }
+      const double events_after_eff_exact = construct_dvvc_exact(nsamples, h_1v_dbv0, h_1v_dbv1, dphi_pdf, h_eff, (TH1F*)h_exact[0], (TH1F*)h_exact[1], (TH1F*)h_exact[2], (TH1F*)h_exact[3], (TH1F*)h_exact[4], (TH2F*)h_exact[5]);
+      printf("exact construction: events after efficiency correction = %f, sampled - exact = %f\n", events_after_eff_exact, events_after_eff - events_after_eff_exact);
+
+      for (int ih : {1, 2}) {
+        const TH1* hs = ih == 1 ? (TH1*)h_c1v_dvv : (TH1*)h_c1v_absdphivv;
+        const TH1* he = h_exact[ih];
+        printf("%s: %4s %14s %14s %14s %8s\n", hs->GetName(), "bin", "sampled", "error", "exact", "pull");
+        double chi2 = 0;
+        int ndf = 0;
+        for (int ibin = 1; ibin <= hs->GetNbinsX(); ++ibin) {
+          const double c = hs->GetBinContent(ibin), ce = hs->GetBinError(ibin), x = he->GetBinContent(ibin);
+          const double pull = ce > 0 ? (c - x) / ce : 0;
+          if (ce > 0) { chi2 += pull*pull; ++ndf; }
+          printf("%*s  %4i %14.3f %14.3f %14.3f %8.2f\n", int(strlen(hs->GetName())), "", ibin, c, ce, x, pull);
+        }
+        printf("%s: chi2/ndf = %.1f/%i\n", hs->GetName(), chi2, ndf);
+      }
+    }
+  }
+
   printf("events before efficiency correction = %d, events after efficiency correction = %f, integrated efficiency correction = %f\n", nsamples, events_after_eff, events_after_eff/nsamples);
 
-  for (int i = 1; i <= h_c1v_dvv->GetNbinsX(); ++i) {
-    if (h_c1v_dvv->GetBinLowEdge(i) < 0.04) {
-      h_c1v_dvv->SetBinContent(i, h_c1v_dvv->GetBinContent(i) * bquark_correction[0]);
-    } else if (h_c1v_dvv->GetBinLowEdge(i) < 0.07) {
-      h_c1v_dvv->SetBinContent(i, h_c1v_dvv->GetBinContent(i) * bquark_correction[1]);
-    } else {
-      h_c1v_dvv->SetBinContent(i, h_c1v_dvv->GetBinContent(i) * bquark_correction[2]);
+  for (TH1* h : std::initializer_list<TH1*>{h_c1v_dvv, h_exact.size() ? h_exact[1] : 0}) {
+    if (!h) continue;
+    for (int i = 1; i <= h->GetNbinsX(); ++i) {
+      if (h->GetBinLowEdge(i) < 0.04) {
+        h->SetBinContent(i, h->GetBinContent(i) * bquark_correction[0]);
+      } else if (h->GetBinLowEdge(i) < 0.07) {
+        h->SetBinContent(i, h->GetBinContent(i) * bquark_correction[1]);
+      } else {
+        h->SetBinContent(i, h->GetBinContent(i) * bquark_correction[2]);
+      }
     }
   }
 
-  if (p.vary_dphi()) {
+  if (p.vary_dphi() && sample) {
     printf("bin1 = %d, bin2 = %d, bin3 = %d, intobin1 = %d, intobin2 = %d, intobin3 = %d, outofbin1 = %d, outofbin2 = %d, outofbin3 = %d\n", bin1, bin2, bin3, intobin1, intobin2, intobin3, outofbin1, outofbin2, outofbin3);
     printf("uncorrelated variation / default (bin 1): %f +/- %f\n", 1 + (intobin1 - outofbin1) / (1.*bin1), sqrt(bin1 + bin1 + intobin1 - outofbin1) / bin1);
     printf("  correlated variation / default (bin 1): %f +/- %f\n", 1 + (intobin1 - outofbin1) / (1.*bin1), sqrt(intobin1 + outofbin1) / bin1);
@@ -496,6 +664,11 @@ void construct_dvvc(ConstructDvvcParameters p, const char* out_fn) {
   h_c1v_dbv0->Write();
   h_c1v_dbv1->Write();
   h_c1v_dbv1_dbv0->Write();
+  if (h_exact.size()) {
+    h_exact[1]->Scale(1./h_exact[1]->Integral());
+    for (TH1* h : h_exact)
+      h->Write();
+  }
 
   TCanvas* c_dvv = new TCanvas("c_dvv", "c_dvv", 700, 700);
   TLegend* l_dvv = new TLegend(0.35,0.75,0.85,0.85);
@@ -544,10 +717,8 @@ void construct_dvvc(ConstructDvvcParameters p, const char* out_fn) {
     h_eff->SetName("h_eff");
     h_eff->Write();
   }
-  if (p.vary_dphi()) {
-    i_dphi->Write();
-    i_dphi2->Write();
-  }
+  if (p.vary_dphi())
+    f_dphi_alt->Write();
 
   fh->Close();
 
@@ -577,6 +748,8 @@ void construct_dvvc(ConstructDvvcParameters p, const char* out_fn) {
   delete h_c1v_dbv0;
   delete h_c1v_dbv1;
   delete h_c1v_dbv1_dbv0;
+  for (TH1* h : h_exact)
+    delete h;
 }
 
 int main(int argc, const char* argv[]) {
@@ -591,8 +764,11 @@ int main(int argc, const char* argv[]) {
     const char* drawfn = "2v_from_jets.png";
     const int ntracks  = argc >= 3 ? atoi(argv[2]) : 3;
     const char* year   = argc >= 4 ? argv[3] : "2017";
+    const char* constr = argc >= 5 ? argv[4] : "sample";
 
-    ConstructDvvcParameters pars2 = pars.year(year).ntracks(ntracks);
+    ConstructDvvcParameters pars2 = pars.year(year).ntracks(ntracks).construction(constr);
+    if (argc >= 6)
+      pars2 = pars2.vary_dphi(true).dphi_alt_pdf(argv[5]);
     construct_dvvc(pars2, outfn);
     TCanvas c("c","",700,900);
     TFile* f = TFile::Open(outfn);
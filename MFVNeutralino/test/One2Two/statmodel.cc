@@ -36,12 +36,18 @@
  *  - Throw ntoys.  For each toy:
  *     - Randomly sample i1v from Poisson(n1v)
  *     - Make a histogram of dBV by randomly sampling from the dBV function i1v times
- *     - Construct dVVC
+ *     - Construct dVVC: by sampling (rho0, rho1, dphi) oversample x i1v times, or with construction=exact by integrating the toy
+ *       dBV histogram against the dphi pdf and efficiency with mfv::DvvcConvolution, so the toy-to-toy spread has no sampling noise in it.
+ *       construction=validate does both and prints the mean and rms over the toys of the pulls (sampled - exact) / error in each bin.
  *  - Calculate the RMS of the dVVC yields in each bin.
+ *    The mean and variance of each 1v and 2v bin, and the covariance between the 2v bins, are accumulated toy by toy with
+ *    jmt::StreamingMoments; the 2v covariance and correlation matrices are written to the output file as h_2v_dvvc_bins_cov/corr
+ *    along with the bin-by-bin mean/rms summaries. With cov_1v=1 the same is done for the 1v bins (995x995, and by construction
+ *    the 1v bins are independent, so it is off by default).
  *
  * These configurables can be set on the command line (e.g. env sm_ntracks=5 ./statmodel.exe):
  *   inst, seed, ntoys, out_fn, samples_index, year_index, ntracks, n1v, n2v, true_fn, true_from_file,
- *   ntrue_1v, ntrue_2v, oversample, rho_tail_norm, rho_tail_slope, phi_c, phi_e, phi_a, eff_fn, eff_path
+ *   ntrue_1v, ntrue_2v, oversample, construction, exact_nsub, cov_1v, rho_tail_norm, rho_tail_slope, phi_c, phi_e, phi_a, eff_fn, eff_path
  *
  * These should be modified in the code:
  *   nbins_1v, bins_1v, nbins_2v, bins_2v, func_rho, rho_min, rho_max, default_n1v, default_n2v
@@ -57,16 +63,17 @@ template <typename T> using uptr = std::unique_ptr<T>;
 #include "TFile.h"
 #include "TGraph.h"
 #include "TH1.h"
-#include "TLatex.h"
+#include "TH2.h"
 #include "TLine.h"
 #include "TMath.h"
 #include "TRandom3.h"
 #include "TRatioPlot.h"
 #include "TStyle.h"
 #include "TVector2.h"
+#include "JMTucker/MFVNeutralino/interface/DvvcConvolution.h"
 #include "JMTucker/Tools/interface/ConfigFromEnv.h"
-#include "JMTucker/Tools/interface/Prob.h"
 #include "JMTucker/Tools/interface/ROOTTools.h"
+#include "JMTucker/Tools/interface/StreamingMoments.h"
 #include "JMTucker/Tools/interface/Utilities.h"
 
 // Helper classes for vertices and pairs of vertices (simplified version of those used in the fitter)
@@ -228,6 +235,12 @@ int main(int, char**) {
   const long ntrue_1v = env.get_long("ntrue_1v", 10000000L);
   const long ntrue_2v = env.get_long("ntrue_2v", 1000000L);
   const double oversample = env.get_double("oversample", 20);
+  const std::string construction = env.get_string("construction", "sample");
+  const bool sample = construction == "sample" || construction == "validate";
+  const bool exact  = construction == "exact"  || construction == "validate";
+  assert(sample || exact);
+  const int exact_nsub = env.get_int("exact_nsub", 4);
+  const bool cov_1v = env.get_bool("cov_1v", false);
   const std::string rho_compare_fn = env.get_string("rho_compare_fn", "/uscms_data/d3/dquach/crab3dirs/HistosV23m/background_2018.root");
   rho_tail_norm = env.get_long_double("rho_tail_norm", 1L);
   rho_tail_slope = env.get_long_double("rho_tail_slope", 1L);
@@ -271,6 +284,24 @@ int main(int, char**) {
     eff_f->Close();
   }
 
+  // For the exact construction, the dvvc distribution for each pair of
+  // rho bins is computed once here and applied to each toy.
+  std::vector<double> bins_1v_v(bins_1v, bins_1v + nbins_1v + 1), bins_2v_v(bins_2v, bins_2v + nbins_2v + 1);
+  mfv::DvvcConvolution conv(bins_1v_v, bins_2v_v, exact_nsub);
+  mfv::DvvcConvolution::Kernel conv_kernel;
+  if (exact) {
+    conv.set_dphi_pdf([](double x) { return func_dphi(&x, 0); });
+    if (h_eff) {
+      std::vector<double> edges, values;
+      for (int ibin = 0; ibin <= h_eff->GetNbinsX()+1; ++ibin) {
+        if (ibin > 0) edges.push_back(h_eff->GetXaxis()->GetBinLowEdge(ibin));
+        values.push_back(h_eff->GetBinContent(ibin));
+      }
+      conv.set_eff(edges, values);
+    }
+    conv_kernel = conv.kernel();
+  }
+
   uptr<TCanvas> c(new TCanvas("c", "", 1972, 1000));
   TVirtualPad* pd = 0;
   TString pdf_fn = (out_fn + ".pdf").c_str();
@@ -529,38 +560,28 @@ int main(int, char**) {
 
   /////////////////////////////////////////////
 
-  // Output pg 9-XX: distribution in toys of total n1v, n1v in each
-  // dbv bin, and n2v in each dvv bin, each compared to truth from
-  // fcn.
+  // Output pg 9: distribution in toys of total n1v. The n1v in each
+  // dbv bin and n2v in each dvv bin are accumulated into the moments,
+  // compared to truth from fcn below.
 
   uptr<TH1D> h_n1v(new TH1D("h_n1v", "", 20, n1v - 5*sqrt(n1v), n1v + 5*sqrt(n1v)));
-  std::vector<uptr<TH1D>> h_1v_rho_bins;
-  std::vector<uptr<TH1D>> h_2v_dvvc_bins;
+  jmt::StreamingMoments m_1v_rho_bins(nbins_1v, cov_1v);
+  jmt::StreamingMoments m_2v_dvvc_bins(nbins_2v);
 
-  for (int ibin = 1; ibin <= nbins_1v; ++ibin) {
-    const double tru = h_true_1v_rho_norm->GetBinContent(ibin);
-    const double pb = 2.87e-7;
-    jmt::interval iv = jmt::garwood_poisson(tru, pb, pb);
-    if (iv.lower < 1) iv.lower = 0;
-    h_1v_rho_bins.emplace_back(new TH1D(TString::Format("h_1v_rho_bins_%i", ibin), TString::Format("#rho bin %i", ibin), 25, iv.lower, iv.upper));
-  }
+  // Throw the toys and fill the above.
+  // First throw the one vertex sample, then construct dvvc from it.
+  // The toy hists and bin-content buffers are booked once and reused.
 
-  for (int ibin = 1; ibin <= nbins_2v; ++ibin) {
-    const double tru = h_true_2v_dvv_norm->GetBinContent(ibin);
-    const double pb = 1.35e-3;
-    jmt::interval iv = jmt::garwood_poisson(tru, pb, pb);
-    if (iv.lower < 1) iv.lower = 0;
-    h_2v_dvvc_bins.emplace_back(new TH1D(TString::Format("h_2v_dvvc_bins_%i", ibin), TString::Format("d_{VV}^{C} bin %i", ibin), 200, iv.lower, iv.upper));
-  }
+  std::vector<double> validate_pull_sum(nbins_2v), validate_pull_sum2(nbins_2v);
 
-  // Throw the toys and fill the above hists.
-  // First throw the one vertex sample, then construct dvvc from it.
-  // The toy is saved in the h_1v/2v*bins vectors.
+  uptr<TH1D> h_1v_rho(book_1v("h_1v_rho"));
+  uptr<TH1D> h_2v_dvvc(book_2v("h_2v_dvvc"));
+  std::vector<double> c_1v(nbins_1v), c_2v(nbins_2v);
 
   printf("toys: ");
   for (int itoy = 0; itoy < ntoys; ++itoy) {
     // make the toy dataset
-    uptr<TH1D> h_1v_rho(book_1v("h_1v_rho"));
+    h_1v_rho->Reset();
     const int i1v = gRandom->Poisson(n1v);
     h_n1v->Fill(i1v);
 
@@ -570,12 +591,14 @@ int main(int, char**) {
     }
 
     for (int ibin = 1; ibin <= nbins_1v; ++ibin)
-      h_1v_rho_bins[ibin-1]->Fill(h_1v_rho->GetBinContent(ibin));
+      c_1v[ibin-1] = h_1v_rho->GetBinContent(ibin);
+    m_1v_rho_bins.add(c_1v);
 
     // The construction
-    uptr<TH1D> h_2v_dvvc(book_2v("h_2v_dvvc"));
+    h_2v_dvvc->Reset();
 
-    for (int i = 0, ie = int(i1v * oversample); i < ie; ++i) {
+    const int nsamples = int(i1v * oversample);
+    for (int i = 0, ie = sample ? nsamples : 0; i < ie; ++i) {
       const double rho0 = h_1v_rho->GetRandom();
       const double rho1 = h_1v_rho->GetRandom();
       const double dphi = throw_dphi();
@@ -585,10 +608,28 @@ int main(int, char**) {
     }
 
     jmt::deoverflow(h_2v_dvvc.get());
+
+    if (exact) {
+      const mfv::DvvcConvolution::Result r = conv_kernel.apply(c_1v, c_1v);
+      for (int ibin = 1; ibin <= nbins_2v; ++ibin) {
+        const double x = nsamples * r.dvv[ibin-1], xe = sqrt(nsamples * r.dvv_w2[ibin-1]);
+        if (!sample) {
+          h_2v_dvvc->SetBinContent(ibin, x);
+          h_2v_dvvc->SetBinError  (ibin, xe);
+        }
+        else if (h_2v_dvvc->GetBinError(ibin) > 0) {
+          const double pull = (h_2v_dvvc->GetBinContent(ibin) - x) / h_2v_dvvc->GetBinError(ibin);
+          validate_pull_sum [ibin-1] += pull;
+          validate_pull_sum2[ibin-1] += pull*pull;
+        }
+      }
+    }
+
     h_2v_dvvc->Scale(n2v/h_2v_dvvc->Integral());
     
     for (int ibin = 1; ibin <= nbins_2v; ++ibin)
-      h_2v_dvvc_bins[ibin-1]->Fill(h_2v_dvvc->GetBinContent(ibin));
+      c_2v[ibin-1] = h_2v_dvvc->GetBinContent(ibin);
+    m_2v_dvvc_bins.add(c_2v);
 
     if (ntoys > 10 && itoy % (ntoys/10) == 0) {
       printf("%i", itoy/(ntoys/10));
@@ -597,13 +638,19 @@ int main(int, char**) {
   }
   printf(" %i\n", ntoys);
 
+  if (sample && exact) {
+    printf("sampled vs exact construction, pulls over the toys:\n");
+    printf("%3s %12s %12s\n", "bin", "mean", "rms");
+    for (int ibin = 1; ibin <= nbins_2v; ++ibin) {
+      const double m = validate_pull_sum[ibin-1] / ntoys;
+      printf("%3i %12.4f %12.4f\n", ibin, m, sqrt(validate_pull_sum2[ibin-1] / ntoys - m*m));
+    }
+  }
+
   h_n1v->Draw("hist");
   p();
   c->Clear();
 
-  TLatex tl;
-  tl.SetTextFont(42);
-
   /////////////////////////////////////////////
 
   // Output pg XX: display and compare the mean and rms to the true
@@ -626,94 +673,93 @@ int main(int, char**) {
 
   printf("1v bins means:\n");
   printf("%3s %28s  %28s  %28s\n", "bin", "bin mean", "scaled true", "diff");
-  for (int i_base = 0; i_base < nbins_1v; i_base += 4) {
-    c->Divide(2,2);
-    for (int i = i_base; i < std::min(i_base + 4, nbins_1v); ++i) {
-      c->cd(i%4+1);
-      h_1v_rho_bins[i]->Draw("hist");
-      const double b  = h_1v_rho_bins[i]->GetMean();
-      const double be = h_1v_rho_bins[i]->GetMeanError();
-      const double r  = h_1v_rho_bins[i]->GetRMS();
-      const double re = h_1v_rho_bins[i]->GetRMSError();
-      const double t  = h_true_1v_rho_norm->GetBinContent(i+1);
-      const double te = h_true_1v_rho_norm->GetBinError  (i+1);
-      const double d  = b - t;
-      const double de = sqrt(be*be + te*te);
-      const bool twosig = d > 2*de;
-      if (twosig || i % (nbins_1v/10) == 0) {
-        if (twosig) printf("\x1b[31;1m");
-        printf("%3i %12.4f +- %12.4f  %12.4f +- %12.4f  %12.4f +- %12.4f\n", i+1, b, be, t, te, d, de);
-        if (twosig) printf("\x1b[0m");
-      }
-      if (twosig)
-        tl.SetTextColor(kRed);
-      else if (d > de)
-        tl.SetTextColor(kOrange+2);
-      else
-        tl.SetTextColor(kBlack);
-      tl.DrawLatexNDC(0.6, 0.4, TString::Format("#splitline{true: %.3f #pm %.3f}{diff: %.3f #pm %.3f}", t, te, d, de));
+  for (int i = 0; i < nbins_1v; ++i) {
+    const double b  = m_1v_rho_bins.mean(i);
+    const double be = m_1v_rho_bins.mean_error(i);
+    const double r  = m_1v_rho_bins.rms(i);
+    const double re = m_1v_rho_bins.rms_error(i);
+    const double t  = h_true_1v_rho_norm->GetBinContent(i+1);
+    const double te = h_true_1v_rho_norm->GetBinError  (i+1);
+    const double d  = b - t;
+    const double de = sqrt(be*be + te*te);
+    const bool twosig = d > 2*de;
+    if (twosig || i % (nbins_1v/10) == 0) {
+      if (twosig) printf("\x1b[31;1m");
+      printf("%3i %12.4f +- %12.4f  %12.4f +- %12.4f  %12.4f +- %12.4f\n", i+1, b, be, t, te, d, de);
+      if (twosig) printf("\x1b[0m");
+    }
 
-      h_1v_rho_bins_means->SetBinContent(i+1, b);
-      h_1v_rho_bins_means->SetBinError  (i+1, be);
+    h_1v_rho_bins_means->SetBinContent(i+1, b);
+    h_1v_rho_bins_means->SetBinError  (i+1, be);
 
-      h_1v_rho_bins_rmses->SetBinContent(i+1, r);
-      h_1v_rho_bins_rmses->SetBinError  (i+1, re);
+    h_1v_rho_bins_rmses->SetBinContent(i+1, r);
+    h_1v_rho_bins_rmses->SetBinError  (i+1, re);
 
-      h_1v_rho_bins_rmses_norm->SetBinContent(i+1, r/t);
-      h_1v_rho_bins_rmses_norm->SetBinError  (i+1, sqrt(re*re/r/r + te*te/t/t)); // JMTBAD
+    h_1v_rho_bins_rmses_norm->SetBinContent(i+1, r/t);
+    h_1v_rho_bins_rmses_norm->SetBinError  (i+1, sqrt(re*re/r/r + te*te/t/t)); // JMTBAD
 
-      h_1v_rho_bins_diffs->SetBinContent(i+1, d);
-      h_1v_rho_bins_diffs->SetBinError  (i+1, de);
+    h_1v_rho_bins_diffs->SetBinContent(i+1, d);
+    h_1v_rho_bins_diffs->SetBinError  (i+1, de);
 
-      h_1v_rho_bins_diffs_norm->SetBinContent(i+1, d/t);
-      h_1v_rho_bins_diffs_norm->SetBinError  (i+1, sqrt(be*be/b/b + te*te/t/t)); // JMTBAD
-    }
-    p();
-    c->Clear();
+    h_1v_rho_bins_diffs_norm->SetBinContent(i+1, d/t);
+    h_1v_rho_bins_diffs_norm->SetBinError  (i+1, sqrt(be*be/b/b + te*te/t/t)); // JMTBAD
   }
 
   printf("2v bins means:\n");
   printf("%3s %28s  %28s  %28s  %28s  %12s\n", "bin", "bin mean", "scaled true", "diff", "rms", "rms/true");
-  for (int i_base = 0; i_base < nbins_2v; i_base += 4) {
-    c->Divide(2,2);
-    for (int i = i_base; i < std::min(i_base + 4, nbins_2v); ++i) {
-      c->cd(i%4+1);
-      h_2v_dvvc_bins[i]->Draw("hist");
-      const double b  = h_2v_dvvc_bins[i]->GetMean();
-      const double be = h_2v_dvvc_bins[i]->GetMeanError();
-      const double r  = h_2v_dvvc_bins[i]->GetRMS();
-      const double re = h_2v_dvvc_bins[i]->GetRMSError();
-      const double t  = h_true_2v_dvv_norm->GetBinContent(i+1);
-      const double te = h_true_2v_dvv_norm->GetBinError  (i+1);
-      const double d  = b - t;
-      const double de = sqrt(be*be + te*te);
-      const double statuncert = r / t;
-      printf("%3i %12.4f +- %12.4f  %12.4f +- %12.4f  %12.4f +- %12.4f  %12.4f +- %12.4f  %12.4f\n", i+1, b, be, t, te, b-t, sqrt(be*be + te*te), r, re, statuncert);
-      if (d > 2*de)
-        tl.SetTextColor(kRed);
-      else if (d > de)
-        tl.SetTextColor(kOrange+2);
-      else
-        tl.SetTextColor(kBlack);
-      tl.DrawLatexNDC(0.6, 0.4, TString::Format("#splitline{true: %.3f #pm %.3f}{diff: %.3f #pm %.3f}", t, te, d, de));
-
-      h_2v_dvvc_bins_means->SetBinContent(i+1, b);
-      h_2v_dvvc_bins_means->SetBinError  (i+1, be);
-
-      h_2v_dvvc_bins_rmses->SetBinContent(i+1, r);
-      h_2v_dvvc_bins_rmses->SetBinError  (i+1, re);
-
-      h_2v_dvvc_bins_rmses_norm->SetBinContent(i+1, r/t);
-      h_2v_dvvc_bins_rmses_norm->SetBinError  (i+1, sqrt(re*re/r/r + te*te/t/t)); // JMTBAD
-
-      h_2v_dvvc_bins_diffs->SetBinContent(i+1, d);
-      h_2v_dvvc_bins_diffs->SetBinError  (i+1, de);
-
-      h_2v_dvvc_bins_diffs_norm->SetBinContent(i+1, d/t);
-      h_2v_dvvc_bins_diffs_norm->SetBinError  (i+1, sqrt(be*be/b/b + te*te/t/t)); // JMTBAD
-    }
-    p();
-    c->Clear();
+  for (int i = 0; i < nbins_2v; ++i) {
+    const double b  = m_2v_dvvc_bins.mean(i);
+    const double be = m_2v_dvvc_bins.mean_error(i);
+    const double r  = m_2v_dvvc_bins.rms(i);
+    const double re = m_2v_dvvc_bins.rms_error(i);
+    const double t  = h_true_2v_dvv_norm->GetBinContent(i+1);
+    const double te = h_true_2v_dvv_norm->GetBinError  (i+1);
+    const double statuncert = r / t;
+    const double d  = b - t;
+    const double de = sqrt(be*be + te*te);
+    printf("%3i %12.4f +- %12.4f  %12.4f +- %12.4f  %12.4f +- %12.4f  %12.4f +- %12.4f  %12.4f\n", i+1, b, be, t, te, b-t, sqrt(be*be + te*te), r, re, statuncert);
+
+    h_2v_dvvc_bins_means->SetBinContent(i+1, b);
+    h_2v_dvvc_bins_means->SetBinError  (i+1, be);
+
+    h_2v_dvvc_bins_rmses->SetBinContent(i+1, r);
+    h_2v_dvvc_bins_rmses->SetBinError  (i+1, re);
+
+    h_2v_dvvc_bins_rmses_norm->SetBinContent(i+1, r/t);
+    h_2v_dvvc_bins_rmses_norm->SetBinError  (i+1, sqrt(re*re/r/r + te*te/t/t)); // JMTBAD
+
+    h_2v_dvvc_bins_diffs->SetBinContent(i+1, d);
+    h_2v_dvvc_bins_diffs->SetBinError  (i+1, de);
+
+    h_2v_dvvc_bins_diffs_norm->SetBinContent(i+1, d/t);
+    h_2v_dvvc_bins_diffs_norm->SetBinError  (i+1, sqrt(be*be/b/b + te*te/t/t)); // JMTBAD
+  }
+
+  // The bin-to-bin covariance and correlation over the toys.
+
+  auto book_cov = [](const char* name, const char* title, const jmt::StreamingMoments& m, int nbins, const double* bins, bool corr) {
+    TH2D* h = new TH2D(name, title, nbins, bins, nbins, bins);
+    for (int i = 0; i < nbins; ++i)
+      for (int j = 0; j < nbins; ++j)
+        h->SetBinContent(i+1, j+1, corr ? m.correlation(i,j) : m.covariance(i,j));
+    h->SetEntries(m.count());
+    return h;
+  };
+
+  uptr<TH2D> h_2v_dvvc_bins_cov (book_cov("h_2v_dvvc_bins_cov",  "2v bin-to-bin covariance;d_{VV}^{C} (cm);d_{VV}^{C} (cm)",  m_2v_dvvc_bins, nbins_2v, bins_2v, false));
+  uptr<TH2D> h_2v_dvvc_bins_corr(book_cov("h_2v_dvvc_bins_corr", "2v bin-to-bin correlation;d_{VV}^{C} (cm);d_{VV}^{C} (cm)", m_2v_dvvc_bins, nbins_2v, bins_2v, true));
+  uptr<TH2D> h_1v_rho_bins_cov, h_1v_rho_bins_corr;
+  if (cov_1v) {
+    h_1v_rho_bins_cov .reset(book_cov("h_1v_rho_bins_cov",  "1v bin-to-bin covariance;#rho (cm);#rho (cm)",  m_1v_rho_bins, nbins_1v, bins_1v, false));
+    h_1v_rho_bins_corr.reset(book_cov("h_1v_rho_bins_corr", "1v bin-to-bin correlation;#rho (cm);#rho (cm)", m_1v_rho_bins, nbins_1v, bins_1v, true));
+  }
+
+  printf("2v bins correlations:\n");
+  for (int i = 0; i < nbins_2v; ++i) {
+    printf("%3i", i+1);
+    for (int j = 0; j < nbins_2v; ++j)
+      printf(" %8.4f", m_2v_dvvc_bins.correlation(i,j));
+    printf("\n");
   }
 
   TLine l1;
@@ -771,11 +817,30 @@ int main(int, char**) {
   p();
   c->Clear();
 
+  c->Divide(2,1);
+  c->cd(1);
+  h_2v_dvvc_bins_cov->SetStats(0);
+  h_2v_dvvc_bins_cov->Draw("colz text");
+  c->cd(2);
+  h_2v_dvvc_bins_corr->SetStats(0);
+  h_2v_dvvc_bins_corr->SetMinimum(-1);
+  h_2v_dvvc_bins_corr->SetMaximum(1);
+  h_2v_dvvc_bins_corr->Draw("colz text");
+  p();
+  c->Clear();
+
   c->Print(pdf_fn + "]");
 
   out_f->cd();
   for (auto* h : {h_true_1v_rho.get(), h_true_1v_phi.get(), h_true_2v_rho.get(), h_true_2v_phi.get(), h_true_2v_dvv.get(), h_true_2v_dphi.get()})
     h->Write();
+  for (auto* h : {h_n1v.get(),
+                  h_1v_rho_bins_means.get(), h_1v_rho_bins_rmses.get(), h_1v_rho_bins_rmses_norm.get(), h_1v_rho_bins_diffs.get(), h_1v_rho_bins_diffs_norm.get(),
+                  h_2v_dvvc_bins_means.get(), h_2v_dvvc_bins_rmses.get(), h_2v_dvvc_bins_rmses_norm.get(), h_2v_dvvc_bins_diffs.get(), h_2v_dvvc_bins_diffs_norm.get()})
+    h->Write();
+  for (auto* h : {h_2v_dvvc_bins_cov.get(), h_2v_dvvc_bins_corr.get(), h_1v_rho_bins_cov.get(), h_1v_rho_bins_corr.get()})
+    if (h)
+      h->Write();
 
   // making these unique_ptrs causes segfault at end?
   delete h_func_rho;
@@ -0,0 +1,96 @@
+// Check mfv::PairDistanceHist against the plain double loop on random
+// points spread like the 1-vertex (x0,y0), and time both, e.g.
+//
+//   ./pairdist_check.exe npoints=20000 nthreads=8 seed=1
+//
+// The points are a mix of a narrow gaussian core around the beamline
+// and a wide exponential tail in r, plus some exact duplicates. The
+// counts must be identical in every bin, including the under- and
+// overflow; the exit code is nonzero if they are not. brute=0 skips
+// the double loop, for timing large npoints.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include "JMTucker/MFVNeutralino/interface/PairDistanceHist.h"
+
+int main(int argc, char** argv) {
+  size_t npoints = 20000;
+  int nthreads = 0;
+  int leaf_size = 16;
+  bool brute = true;
+  int nbins = 400;
+  double xmax = 4;
+  unsigned seed = 1;
+
+  for (int i = 1; i < argc; ++i) {
+    const char* a = argv[i];
+    const char* eq = strchr(a, '=');
+    if (!eq) {
+      fprintf(stderr, "bad argument %s\n", a);
+      return 1;
+    }
+    const std::string k(a, eq);
+    const char* v = eq + 1;
+    if      (k == "npoints")  npoints = atoll(v);
+    else if (k == "nthreads") nthreads = atoi(v);
+    else if (k == "brute")    brute = atoi(v);
+    else if (k == "leaf_size") leaf_size = atoi(v);
+    else if (k == "nbins")    nbins = atoi(v);
+    else if (k == "xmax")     xmax = atof(v);
+    else if (k == "seed")     seed = atoi(v);
+    else {
+      fprintf(stderr, "unknown option %s\n", k.c_str());
+      return 1;
+    }
+  }
+
+  std::mt19937_64 g(seed);
+  std::uniform_real_distribution<double> u(0, 1);
+  std::vector<double> x, y;
+  for (size_t i = 0; i < npoints; ++i) {
+    double r;
+    if (i > 0 && u(g) < 0.01) {
+      x.push_back(x[i-1]);
+      y.push_back(y[i-1]);
+      continue;
+    }
+    else if (u(g) < 0.7)
+      r = 0.01 * std::sqrt(-2*std::log(1 - u(g)));
+    else
+      r = -0.05 * std::log(1 - u(g));
+    const double phi = 2*M_PI*u(g);
+    x.push_back(0.01 + r*std::cos(phi));
+    y.push_back(0.02 + r*std::sin(phi));
+  }
+
+  mfv::PairDistanceHist h(nbins, 0, xmax, nthreads, leaf_size);
+
+  auto t0 = std::chrono::steady_clock::now();
+  const std::vector<unsigned long long> fast = h.count(x, y);
+  const double t_fast = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  unsigned long long sum = 0;
+  for (unsigned long long c : fast)
+    sum += c;
+  printf("%lu points, %llu pairs: fast %.3f s\n", npoints, sum, t_fast);
+  if (!brute)
+    return 0;
+
+  t0 = std::chrono::steady_clock::now();
+  const std::vector<unsigned long long> slow = h.count_brute(x, y);
+  const double t_slow = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  int nbad = 0;
+  for (int i = 0; i <= nbins+1; ++i)
+    if (fast[i] != slow[i]) {
+      printf("bin %i: fast %llu brute %llu\n", i, fast[i], slow[i]);
+      ++nbad;
+    }
+  printf("brute %.3f s, %i bins differ\n", t_slow, nbad);
+  return nbad != 0;
+}
@@ -4,19 +4,13 @@
 #include "TH1.h"
 #include "TTree.h"
 #include "JMTucker/MFVNeutralino/interface/MiniNtuple.h"
-
-template <typename T> T mag (T x, T y) { return sqrt(x*x + y*y); }
+#include "JMTucker/MFVNeutralino/interface/PairDistanceHist.h"
 
 int ntracks = 3;
 const int target = 10000;
 const int nbins = 400;
 
-struct point {
-  point(double a, double b) : x(a), y(b) {};
-  double x, y;
-  double d(const point& o) const { return mag(x - o.x, y - o.y); }
-};
-std::vector<point> vs;
+std::vector<double> xs, ys;
 // P = permutations = N(N-1), C = combinations N(N-1)/2
 TH1D* h_P_dvvc = 0;
 TH1D* h_P_prescales = 0;
@@ -26,32 +20,37 @@ TH1D* h_C_prescales = 0;
 TH1D* h_C_prescaled = 0;
 
 bool analyze(long long j, long long je, const mfv::MiniNtuple& nt) {
-  if (j == 0)
-    vs.clear();
+  if (j == 0) {
+    xs.clear();
+    ys.clear();
+  }
 
   if (j % 1000 == 0)
     printf("\rtree event %lli/%lli", j, je);
 
-  if (nt.nvtx == 1 && ((ntracks == 3 || ntracks == 4) && nt.ntk0 == ntracks) || (ntracks == 5 && nt.ntk0 >= ntracks))
-    vs.push_back(point(nt.x0, nt.y0));
+  if (nt.nvtx == 1 && ((ntracks == 3 || ntracks == 4) && nt.ntk0 == ntracks) || (ntracks == 5 && nt.ntk0 >= ntracks)) {
+    xs.push_back(nt.x0);
+    ys.push_back(nt.y0);
+  }
 
   const long long maxevents = -1;
   if (j == maxevents || j == je-1) {
-    const size_t nv = vs.size();
-    printf("\rtree done with %lli entries, %lu passed. double loop on passed:", je, nv);
-    for (size_t i = 0; i < nv; ++i) {
-      if (i % 10000 == 0) { printf(" %lu", i); fflush(stdout); }
-      point a = vs[i];
-      for (size_t j = 0; j < nv; ++j) {
-        if (i == j) continue;
-        point b = vs[j];
-
-        if (i < j)
-          h_C_dvvc->Fill(a.d(b));
-        h_P_dvvc->Fill(a.d(b));
-      }
+    const size_t nv = xs.size();
+    printf("\rtree done with %lli entries, %lu passed. all pairs on passed:", je, nv);
+    fflush(stdout);
+    // Same bin contents as filling every pair i < j into C and every
+    // i != j into P.
+    const mfv::PairDistanceHist pdh(nbins, 0, 4);
+    const std::vector<unsigned long long> counts = pdh.count(xs, ys);
+    double npairs = 0;
+    for (int ibin = 0; ibin <= nbins+1; ++ibin) {
+      h_C_dvvc->SetBinContent(ibin, counts[ibin]);
+      h_P_dvvc->SetBinContent(ibin, 2*counts[ibin]);
+      npairs += counts[ibin];
     }
-    printf(" %lu done\n", nv);
+    h_C_dvvc->SetEntries(npairs);
+    h_P_dvvc->SetEntries(2*npairs);
+    printf(" done\n");
 
     for (int ibin = 1; ibin <= nbins; ++ibin) {
       const double c_P = h_P_dvvc->GetBinContent(ibin);
@@ -1,11 +1,13 @@
 # don't use this on (MINI)AOD files but rather on ntuples
 # on (MINI)AOD use e.g. dasgo "file,lumi dataset="$(samples ds qcdht1000_2017 miniaod) | grep 833,
 # run with | egrep -v '^File </tmp/tmp'
+# the first lookup in each file builds its event index (see JMTucker/Tools/python/EventIndex.py),
+# kept in $JMT_EVIDX_DIR (default the current directory), so later ones are just a binary search
 
 import sys, os
 from pprint import pprint
 from JMTucker.Tools import eos, SampleFiles
-from JMTucker.Tools.ROOTTools import ROOT, detree
+from JMTucker.Tools.EventIndex import for_file, edm_rle_expr
 
 if len(sys.argv) < 6:
     sys.exit('usage: %s dataset sample run lumi event\n  where dataset and sample are as registered in SampleFiles. sample can be "*" to mean all samples having the dataset.' % sys.argv[0])
@@ -22,13 +24,9 @@ for fn in fns:
     if not eos.exists(fn):
         raise IOError('does not exist on eos: %r' % fn)
 
-    f = ROOT.TFile.Open(eos.canon(fn))
-    t = f.Get('Events')
-    for x in sorted(detree(t, 'EventAuxiliary.id().run():EventAuxiliary.luminosityBlock():EventAuxiliary.id().event()', xform=int)):
-        if x == rle:
-            print fn
-            nfound += 1
+    for entry in for_file(eos.canon(fn), 'Events', edm_rle_expr).find(*rle):
+        print fn, entry
+        nfound += 1
 
 if nfound != 1:
     sys.exit('%i found' % nfound)
-
@@ -56,7 +56,7 @@ public:
   value_and_error efficiency(int hadronflavor, double eta, double pt) const {
     const auto jf = hadron2jetflavor(hadronflavor);
     auto h = h_btageff[jf];
-    const int bin = h->FindBin(eta, pt);
+    const int bin = h->FindFixBin(eta, pt);
     return value_and_error{h->GetBinContent(bin), h->GetBinError(bin)};
   }
 
@@ -0,0 +1,30 @@
+#include "TFile.h"
+#include "JMTucker/Tools/interface/BootstrapReplicas.h"
+
+// Make the <name>_eff histograms with bootstrap errors in a file
+// (after merging) that has the <name>_num/den and _num/den_reps ones
+// from hists.exe --bootstrap N, or SimpleTriggerEfficiency with
+// nbootstrap.
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: bootstrap_effs.exe merged.root [merged2.root ...]\n");
+    return 1;
+  }
+
+  for (int i = 1; i < argc; ++i) {
+    TFile* f = TFile::Open(argv[i], "update");
+    if (!f || !f->IsOpen()) {
+      fprintf(stderr, "could not open %s\n", argv[i]);
+      return 1;
+    }
+    const int n = jmt::make_replica_effs(f);
+    f->Close();
+    delete f;
+    if (n < 0) {
+      fprintf(stderr, "%s: replica hists don't match the nominal ones\n", argv[i]);
+      return 1;
+    }
+    printf("%s: %i efficiencies\n", argv[i], n);
+  }
+}
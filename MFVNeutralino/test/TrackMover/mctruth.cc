@@ -3,11 +3,12 @@
 #include "TTree.h"
 #include "TVector2.h"
 #include "JMTucker/MFVNeutralino/interface/MovedTracksNtuple.h"
+#include "JMTucker/Tools/interface/NtupleLoop.h"
 #include "utils.h"
 
 int main(int argc, char** argv) {
   if (argc < 4) {
-    fprintf(stderr, "usage: mctruth.exe in.root out.root min_lspdist3\n");
+    fprintf(stderr, "usage: mctruth.exe in.root out.root min_lspdist3 [nthreads] [nbootstrap]\n");
     return 1;
   }
 
@@ -16,180 +17,215 @@ int main(int argc, char** argv) {
   const char* in_fn  = argv[1];
   const char* out_fn = argv[2];
   const double min_lspdist3 = atof(argv[3]);
+  const int nthreads = argc > 4 ? atoi(argv[4]) : 1;
+  const int nbootstrap = argc > 5 ? atoi(argv[5]) : 0;
   const bool apply_weight = true;
   if (!apply_weight)
     printf("******************************\nno pileup weight applied\n******************************\n");
 
   root_setup();
 
-  file_and_tree fat(in_fn, out_fn, "mfvMovedTree/t");
-  TTree* t = fat.t;
-  mfv::MovedTracksNtuple& nt = fat.nt;
+  jmt::NtupleLoopOptions lo;
+  lo.tree_weight = apply_weight;
+  lo.nthreads = nthreads;
 
-  TH1D* h_weight = new TH1D("h_weight", ";weight;events/0.01", 200, 0, 2);
-  TH1D* h_npu = new TH1D("h_npu", ";# PU;events/1", 100, 0, 100);
+  jmt::NtupleLoop<mfv::MovedTracksNtuple> loop(in_fn, "mfvMovedTree/t", out_fn,
+                                               [](const mfv::MovedTracksNtuple& nt) { return jmt::NtupleEntryInfo{nt.run, nt.lumi, nt.npu, nt.weight}; },
+                                               lo);
 
   const int num_numdens = 3;
 
-  numdens nds[num_numdens] = {
-    numdens("nocuts"),
-    numdens("ntracks"),
-    numdens("all")
+  struct thread_sums {
+    double den = 0;
+    std::map<std::string, double> nums;
+
+    // see hists.cc
+    std::unique_ptr<jmt::BootstrapWeights> bw;
+    std::vector<numdens> nds;
   };
+  std::vector<thread_sums> sums(loop.nthreads());
 
   enum { k_lspdist2, k_lspdist3, k_lspdistz, k_movedist2, k_movedist3, k_npv, k_pvz, k_pvrho, k_pvntracks, k_pvscore, k_ht };
-  for (numdens& nd : nds) {
-    nd.book(k_lspdist2, "lspdist2", ";2-dist between gen verts;events/0.01 cm", 200, 0, 2);
-    nd.book(k_lspdist3, "lspdist3", ";3-dist between gen verts;events/0.01 cm", 200, 0, 2);
-    nd.book(k_lspdistz, "lspdistz", ";z-dist between gen verts;events/0.01 cm", 200, 0, 2);
-    nd.book(k_movedist2, "movedist2", ";movement 2-dist;events/0.01 cm", 200, 0, 2);
-    nd.book(k_movedist3, "movedist3", ";movement 3-dist;events/0.01 cm", 200, 0, 2);
-    nd.book(k_npv, "npv", ";# PV;events/1", 100, 0, 100);
-    nd.book(k_pvz, "pvz", ";PV z (cm);events/0.24 cm", 200, -24, 24);
-    nd.book(k_pvrho, "pvrho", ";PV #rho (cm);events/1 #mum", 200, 0, 0.02);
-    nd.book(k_pvntracks, "pvntracks", ";PV # tracks;events/2", 200, 0, 400);
-    nd.book(k_pvscore, "pvscore", ";PV #Sigma p_{T}^{2} (GeV^{2});events/200 GeV^{2}", 200, 0, 40000);
-    nd.book(k_ht, "ht", ";#Sigma H_{T} (GeV);events/50 GeV", 50, 0, 2500);
-  }
 
-  TH1D* h_vtxntracks[num_numdens] = {0};
-  TH1D* h_vtxbs2derr[num_numdens] = {0};
-  TH1D* h_vtxtkonlymass[num_numdens] = {0};
-  TH1D* h_vtxs_mass[num_numdens] = {0};
+  loop.run([&](int ithread) {
+    thread_sums& s = sums[ithread];
+
+    TH1D* h_weight = new TH1D("h_weight", ";weight;events/0.01", 200, 0, 2);
+    TH1D* h_npu = new TH1D("h_npu", ";# PU;events/1", 100, 0, 100);
+
+    if (nbootstrap > 0)
+      s.bw.reset(new jmt::BootstrapWeights(nbootstrap));
+
+    std::vector<numdens>& nds = s.nds;
+    nds.reserve(num_numdens);
+    for (const char* c : {"nocuts", "ntracks", "all"})
+      nds.emplace_back(c, s.bw.get());
+
+    for (numdens& nd : nds) {
+      nd.book(k_lspdist2, "lspdist2", ";2-dist between gen verts;events/0.01 cm", 200, 0, 2);
+      nd.book(k_lspdist3, "lspdist3", ";3-dist between gen verts;events/0.01 cm", 200, 0, 2);
+      nd.book(k_lspdistz, "lspdistz", ";z-dist between gen verts;events/0.01 cm", 200, 0, 2);
+      nd.book(k_movedist2, "movedist2", ";movement 2-dist;events/0.01 cm", 200, 0, 2);
+      nd.book(k_movedist3, "movedist3", ";movement 3-dist;events/0.01 cm", 200, 0, 2);
+      nd.book(k_npv, "npv", ";# PV;events/1", 100, 0, 100);
+      nd.book(k_pvz, "pvz", ";PV z (cm);events/0.24 cm", 200, -24, 24);
+      nd.book(k_pvrho, "pvrho", ";PV #rho (cm);events/1 #mum", 200, 0, 0.02);
+      nd.book(k_pvntracks, "pvntracks", ";PV # tracks;events/2", 200, 0, 400);
+      nd.book(k_pvscore, "pvscore", ";PV #Sigma p_{T}^{2} (GeV^{2});events/200 GeV^{2}", 200, 0, 40000);
+      nd.book(k_ht, "ht", ";#Sigma H_{T} (GeV);events/50 GeV", 50, 0, 2500);
+    }
 
-  for (int i = 0; i < num_numdens; ++i) {
-    h_vtxntracks[i] = new TH1D(TString::Format("h_%i_vtxntracks",      i), ";# tracks in largest vertex;events/1", 40, 0, 40);
-    h_vtxbs2derr[i] = new TH1D(TString::Format("h_%i_vtxbs2derr",      i), ";#sigma(d_{BV}) of largest vertex (cm);events/2 #mum", 50, 0, 0.01);
-    h_vtxtkonlymass[i] = new TH1D(TString::Format("h_%i_vtxtkonlymass", i), ";track-only mass of largest vertex (GeV);events/1 GeV", 500, 0, 500);
-    h_vtxs_mass[i] = new TH1D(TString::Format("h_%i_vtxs_mass", i), ";track+jets mass of largest vertex (GeV);vertices/50 GeV", 100, 0, 5000);
-  }
+    for (const numdens& nd : nds)
+      loop.add_thread_mb(nd.replicas_mb());
 
-  double den = 0;
-  std::map<std::string, double> nums;
+    TH1D* h_vtxntracks[num_numdens] = {0};
+    TH1D* h_vtxbs2derr[num_numdens] = {0};
+    TH1D* h_vtxtkonlymass[num_numdens] = {0};
+    TH1D* h_vtxs_mass[num_numdens] = {0};
 
-  for (int j = 0, je = t->GetEntries(); j < je; ++j) {
-    if (t->LoadTree(j) < 0) break;
-    if (t->GetEntry(j) <= 0) continue;
-
-    const bool pass_trig = nt.pass_hlt & 1;
-
-    if (nt.jetht < 1200 ||
-        nt.nalljets() < 4 ||
-        !pass_trig)
-      continue;
-
-    const double w = apply_weight ? nt.weight : 1.;
-    h_weight->Fill(w);
-    h_npu->Fill(nt.npu, w);
-    auto F1 = [&w](TH1* h, double v)            { h                    ->Fill(v,     w); };
-    //auto F2 = [&w](TH1* h, double v, double v2) { dynamic_cast<TH2*>(h)->Fill(v, v2, w); };
-
-    const size_t n_raw_vtx = nt.p_vtxs_x->size();
-
-    const double lspdist2 = mag(nt.gen_lsp_decay[0] - nt.gen_lsp_decay[3],
-                                nt.gen_lsp_decay[1] - nt.gen_lsp_decay[4]);
-    const double lspdist3 = mag(nt.gen_lsp_decay[0] - nt.gen_lsp_decay[3],
-                                nt.gen_lsp_decay[1] - nt.gen_lsp_decay[4],
-                                nt.gen_lsp_decay[2] - nt.gen_lsp_decay[5]);
-    const double lspdistz = fabs(nt.gen_lsp_decay[2] - nt.gen_lsp_decay[5]);
-
-    //printf("lspdist2 %f dist3 %f distz %f n_raw_vtx %lu  weight %f\n", lspdist2, lspdist3, lspdistz, n_raw_vtx, w);
-
-    if (lspdist3 < min_lspdist3 ||
-        lspdistz < 0)
-      continue;
-
-    for (int ilsp = 0; ilsp < 2; ++ilsp) {
-      const double gen_vx = nt.gen_lsp_decay[ilsp*3 + 0];
-      const double gen_vy = nt.gen_lsp_decay[ilsp*3 + 1]; 
-      const double gen_vz = nt.gen_lsp_decay[ilsp*3 + 2];
-      const double movedist2 = mag(gen_vx, gen_vy);
-      const double movedist3 = mag(gen_vx, gen_vy, gen_vz);
-
-      //printf("ilsp %i movedist2 %f dist3 %f\n", ilsp, movedist2, movedist3);
-
-      if (movedist2 < 0.03 ||
-          movedist2 > 2.0)
-        continue;
-
-      for (numdens& nd : nds) {
-        F1(nd(k_lspdist2) .den, lspdist2);
-        F1(nd(k_lspdist3) .den, lspdist3);
-        F1(nd(k_lspdistz) .den, lspdistz);
-        F1(nd(k_movedist2).den, movedist2);
-        F1(nd(k_movedist3).den, movedist3);
-        F1(nd(k_npv)      .den, nt.npv);
-        F1(nd(k_pvz)      .den, nt.pvz);
-        F1(nd(k_pvrho)    .den, mag(nt.pvx, nt.pvy));
-        F1(nd(k_pvntracks).den, nt.pvntracks);
-        F1(nd(k_pvscore)  .den, nt.pvscore);
-        F1(nd(k_ht)       .den, nt.jetht);
-      }
+    for (int i = 0; i < num_numdens; ++i) {
+      h_vtxntracks[i] = new TH1D(TString::Format("h_%i_vtxntracks",      i), ";# tracks in largest vertex;events/1", 40, 0, 40);
+      h_vtxbs2derr[i] = new TH1D(TString::Format("h_%i_vtxbs2derr",      i), ";#sigma(d_{BV}) of largest vertex (cm);events/2 #mum", 50, 0, 0.01);
+      h_vtxtkonlymass[i] = new TH1D(TString::Format("h_%i_vtxtkonlymass", i), ";track-only mass of largest vertex (GeV);events/1 GeV", 500, 0, 500);
+      h_vtxs_mass[i] = new TH1D(TString::Format("h_%i_vtxs_mass", i), ";track+jets mass of largest vertex (GeV);vertices/50 GeV", 100, 0, 5000);
+    }
+
+    return [=, &s, &nds](const mfv::MovedTracksNtuple& nt, double w) mutable {
+      const bool pass_trig = nt.pass_hlt & 1;
+
+      if (nt.jetht < 1200 ||
+          nt.nalljets() < 4 ||
+          !pass_trig)
+        return;
+
+      if (s.bw) s.bw->set_event(nt);
+
+      h_weight->Fill(w);
+      h_npu->Fill(nt.npu, w);
+
+      const size_t n_raw_vtx = nt.p_vtxs_x->size();
+
+      const double lspdist2 = mag(nt.gen_lsp_decay[0] - nt.gen_lsp_decay[3],
+                                  nt.gen_lsp_decay[1] - nt.gen_lsp_decay[4]);
+      const double lspdist3 = mag(nt.gen_lsp_decay[0] - nt.gen_lsp_decay[3],
+                                  nt.gen_lsp_decay[1] - nt.gen_lsp_decay[4],
+                                  nt.gen_lsp_decay[2] - nt.gen_lsp_decay[5]);
+      const double lspdistz = fabs(nt.gen_lsp_decay[2] - nt.gen_lsp_decay[5]);
+
+      //printf("lspdist2 %f dist3 %f distz %f n_raw_vtx %lu  weight %f\n", lspdist2, lspdist3, lspdistz, n_raw_vtx, w);
 
-      den += w;
+      if (lspdist3 < min_lspdist3 ||
+          lspdistz < 0)
+        return;
 
-      int n_pass_nocuts = 0;
-      int n_pass_ntracks = 0;
-      int n_pass_all = 0;
+      for (int ilsp = 0; ilsp < 2; ++ilsp) {
+        const double gen_vx = nt.gen_lsp_decay[ilsp*3 + 0];
+        const double gen_vy = nt.gen_lsp_decay[ilsp*3 + 1]; 
+        const double gen_vz = nt.gen_lsp_decay[ilsp*3 + 2];
+        const double movedist2 = mag(gen_vx, gen_vy);
+        const double movedist3 = mag(gen_vx, gen_vy, gen_vz);
 
-      std::vector<int> first_vtx_to_pass(num_numdens, -1);
-      auto set_it_if_first = [](int& to_set, int to_set_to) { if (to_set == -1) to_set = to_set_to; };
+        //printf("ilsp %i movedist2 %f dist3 %f\n", ilsp, movedist2, movedist3);
 
-      for (size_t ivtx = 0; ivtx < n_raw_vtx; ++ivtx) {
-        const double dist2move = mag(gen_vx - nt.p_vtxs_x->at(ivtx),
-                                     gen_vy - nt.p_vtxs_y->at(ivtx),
-                                     gen_vz - nt.p_vtxs_z->at(ivtx));
-        //printf("ivtx %lu dist2move %f\n", ivtx, dist2move);
-        if (dist2move > 0.0084)
+        if (movedist2 < 0.03 ||
+            movedist2 > 2.0)
           continue;
 
-        const bool pass_ntracks = nt.p_vtxs_ntracks->at(ivtx) >= 5;
-        const bool pass_bs2derr = nt.p_vtxs_bs2derr->at(ivtx) < 0.0025;
+        for (numdens& nd : nds) {
+          nd(k_lspdist2) .fill_den(lspdist2, w);
+          nd(k_lspdist3) .fill_den(lspdist3, w);
+          nd(k_lspdistz) .fill_den(lspdistz, w);
+          nd(k_movedist2).fill_den(movedist2, w);
+          nd(k_movedist3).fill_den(movedist3, w);
+          nd(k_npv)      .fill_den(nt.npv, w);
+          nd(k_pvz)      .fill_den(nt.pvz, w);
+          nd(k_pvrho)    .fill_den(mag(nt.pvx, nt.pvy), w);
+          nd(k_pvntracks).fill_den(nt.pvntracks, w);
+          nd(k_pvscore)  .fill_den(nt.pvscore, w);
+          nd(k_ht)       .fill_den(nt.jetht, w);
+        }
 
-        //printf("  ntracks %i pass? %i  bs2derr %f pass? %i\n", nt.p_vtxs_ntracks->at(ivtx), pass_ntracks, nt.p_vtxs_bs2derr->at(ivtx), pass_bs2derr);
+        s.den += w;
 
-        if (1)                             { set_it_if_first(first_vtx_to_pass[0], ivtx); ++n_pass_nocuts;       }
-        if (pass_ntracks)                  { set_it_if_first(first_vtx_to_pass[1], ivtx); ++n_pass_ntracks;      }
-        if (pass_ntracks && pass_bs2derr)  { set_it_if_first(first_vtx_to_pass[2], ivtx); ++n_pass_all; }
-      }
+        int n_pass_nocuts = 0;
+        int n_pass_ntracks = 0;
+        int n_pass_all = 0;
+
+        std::vector<int> first_vtx_to_pass(num_numdens, -1);
+        auto set_it_if_first = [](int& to_set, int to_set_to) { if (to_set == -1) to_set = to_set_to; };
+
+        for (size_t ivtx = 0; ivtx < n_raw_vtx; ++ivtx) {
+          const double dist2move = mag(gen_vx - nt.p_vtxs_x->at(ivtx),
+                                       gen_vy - nt.p_vtxs_y->at(ivtx),
+                                       gen_vz - nt.p_vtxs_z->at(ivtx));
+          //printf("ivtx %lu dist2move %f\n", ivtx, dist2move);
+          if (dist2move > 0.0084)
+            continue;
 
-      for (int i = 0; i < num_numdens; ++i) {
-        int ivtx = first_vtx_to_pass[i];
-        if (ivtx != -1) {
-          h_vtxntracks      [i]->Fill(nt.p_vtxs_ntracks->at(ivtx));
-          h_vtxbs2derr      [i]->Fill(nt.p_vtxs_bs2derr->at(ivtx));
-	  h_vtxtkonlymass[i]->Fill(nt.p_vtxs_tkonlymass->at(ivtx));
-	  h_vtxs_mass[i]->Fill(nt.p_vtxs_mass->at(ivtx));
+          const bool pass_ntracks = nt.p_vtxs_ntracks->at(ivtx) >= 5;
+          const bool pass_bs2derr = nt.p_vtxs_bs2derr->at(ivtx) < 0.0025;
+
+          //printf("  ntracks %i pass? %i  bs2derr %f pass? %i\n", nt.p_vtxs_ntracks->at(ivtx), pass_ntracks, nt.p_vtxs_bs2derr->at(ivtx), pass_bs2derr);
+
+          if (1)                             { set_it_if_first(first_vtx_to_pass[0], ivtx); ++n_pass_nocuts;       }
+          if (pass_ntracks)                  { set_it_if_first(first_vtx_to_pass[1], ivtx); ++n_pass_ntracks;      }
+          if (pass_ntracks && pass_bs2derr)  { set_it_if_first(first_vtx_to_pass[2], ivtx); ++n_pass_all; }
         }
-      }
 
-      if (n_pass_nocuts)  nums["nocuts"]  += w;
-      if (n_pass_ntracks) nums["ntracks"] += w;
-      if (n_pass_all)     nums["all"]     += w;
-
-      const int passes[num_numdens] = {
-        n_pass_nocuts,
-        n_pass_ntracks,
-        n_pass_all
-      };
-
-      for (int i = 0; i < num_numdens; ++i) {
-        if (passes[i]) {
-          numdens& nd = nds[i];
-          F1(nd(k_lspdist2) .num, lspdist2);
-          F1(nd(k_lspdist3) .num, lspdist3);
-          F1(nd(k_lspdistz) .num, lspdistz);
-          F1(nd(k_movedist2).num, movedist2);
-          F1(nd(k_movedist3).num, movedist3);
-          F1(nd(k_npv)      .num, nt.npv);
-          F1(nd(k_pvz)      .num, nt.pvz);
-          F1(nd(k_pvrho)    .num, mag(nt.pvx, nt.pvy));
-          F1(nd(k_pvntracks).num, nt.pvntracks);
-          F1(nd(k_pvscore)  .num, nt.pvscore);
-          F1(nd(k_ht)       .num, nt.jetht);
+        for (int i = 0; i < num_numdens; ++i) {
+          int ivtx = first_vtx_to_pass[i];
+          if (ivtx != -1) {
+            h_vtxntracks      [i]->Fill(nt.p_vtxs_ntracks->at(ivtx));
+            h_vtxbs2derr      [i]->Fill(nt.p_vtxs_bs2derr->at(ivtx));
+	    h_vtxtkonlymass[i]->Fill(nt.p_vtxs_tkonlymass->at(ivtx));
+	    h_vtxs_mass[i]->Fill(nt.p_vtxs_mass->at(ivtx));
+          }
+        }
+
+        if (n_pass_nocuts)  s.nums["nocuts"]  += w;
+        if (n_pass_ntracks) s.nums["ntracks"] += w;
+        if (n_pass_all)     s.nums["all"]     += w;
+
+        const int passes[num_numdens] = {
+          n_pass_nocuts,
+          n_pass_ntracks,
+          n_pass_all
+        };
+
+        for (int i = 0; i < num_numdens; ++i) {
+          if (passes[i]) {
+            numdens& nd = nds[i];
+            nd(k_lspdist2) .fill_num(lspdist2, w);
+            nd(k_lspdist3) .fill_num(lspdist3, w);
+            nd(k_lspdistz) .fill_num(lspdistz, w);
+            nd(k_movedist2).fill_num(movedist2, w);
+            nd(k_movedist3).fill_num(movedist3, w);
+            nd(k_npv)      .fill_num(nt.npv, w);
+            nd(k_pvz)      .fill_num(nt.pvz, w);
+            nd(k_pvrho)    .fill_num(mag(nt.pvx, nt.pvy), w);
+            nd(k_pvntracks).fill_num(nt.pvntracks, w);
+            nd(k_pvscore)  .fill_num(nt.pvscore, w);
+            nd(k_ht)       .fill_num(nt.jetht, w);
+          }
         }
       }
-    }
+    };
+  });
+
+  double den = 0;
+  std::map<std::string, double> nums;
+  for (const thread_sums& t : sums) {
+    den += t.den;
+    for (const auto& p : t.nums)
+      nums[p.first] += p.second;
+  }
+
+  if (nbootstrap > 0) {
+    for (int i = 1; i < loop.nthreads(); ++i)
+      for (int j = 0; j < num_numdens; ++j)
+        sums[0].nds[j].merge_replicas(sums[i].nds[j]);
+    for (const numdens& nd : sums[0].nds)
+      nd.write_replicas();
   }
 
   printf("%12.1f", den);
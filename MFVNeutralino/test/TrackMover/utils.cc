@@ -34,22 +34,83 @@ numden::numden(const char* name, const char* title, int nbins, double xlo, doubl
     den(new TH2D(TString::Format("%s_den", name), title, nbins, xlo, xhi, nbinsy, ylo, yhi))
 {}
 
-numdens::numdens(const char* c)
-  : common(c + std::string("_"))
+void numden::book_replicas(const jmt::BootstrapWeights& bw) {
+  num_reps.reset(new jmt::ReplicaHist(num, bw));
+  den_reps.reset(new jmt::ReplicaHist(den, bw));
+}
+
+void numden::fill_num(double x, double w) {
+  num->Fill(x, w);
+  if (num_reps) num_reps->fill(x, w);
+}
+
+void numden::fill_num(double x, double y, double w) {
+  dynamic_cast<TH2*>(num)->Fill(x, y, w);
+  if (num_reps) num_reps->fill(x, y, w);
+}
+
+void numden::fill_den(double x, double w) {
+  den->Fill(x, w);
+  if (den_reps) den_reps->fill(x, w);
+}
+
+void numden::fill_den(double x, double y, double w) {
+  dynamic_cast<TH2*>(den)->Fill(x, y, w);
+  if (den_reps) den_reps->fill(x, y, w);
+}
+
+void numden::merge_replicas(const numden& o) {
+  if (num_reps) num_reps->merge(*o.num_reps);
+  if (den_reps) den_reps->merge(*o.den_reps);
+}
+
+void numden::write_replicas() const {
+  assert(num_reps && den_reps);
+  num_reps->make_hist(TString::Format("%s_reps", num->GetName()));
+  den_reps->make_hist(TString::Format("%s_reps", den->GetName()));
+}
+
+double numden::replicas_mb() const {
+  return (num_reps ? num_reps->mb() : 0) + (den_reps ? den_reps->mb() : 0);
+}
+
+numdens::numdens(const char* c, const jmt::BootstrapWeights* bw_)
+  : common(c + std::string("_")),
+    bw(bw_)
 {}
 
 void numdens::book(int key, const char* name, const char* title, int nbins, double xlo, double xhi) {
-  m.insert(std::make_pair(key, numden((common + name).c_str(), title, nbins, xlo, xhi)));
+  numden& nd = m.insert(std::make_pair(key, numden((common + name).c_str(), title, nbins, xlo, xhi))).first->second;
+  if (bw) nd.book_replicas(*bw);
 }
 
 void numdens::book(int key, const char* name, const char* title, int nbins, double xlo, double xhi, int nbinsy, double ylo, double yhi) {
-  m.insert(std::make_pair(key, numden((common + name).c_str(), title, nbins, xlo, xhi, nbinsy, ylo, yhi)));
+  numden& nd = m.insert(std::make_pair(key, numden((common + name).c_str(), title, nbins, xlo, xhi, nbinsy, ylo, yhi))).first->second;
+  if (bw) nd.book_replicas(*bw);
 }
 
 numden& numdens::operator()(int k) {
   return m[k];
 }
 
+void numdens::merge_replicas(const numdens& o) {
+  for (auto& p : m)
+    p.second.merge_replicas(o.m.at(p.first));
+}
+
+void numdens::write_replicas() const {
+  if (bw)
+    for (const auto& p : m)
+      p.second.write_replicas();
+}
+
+double numdens::replicas_mb() const {
+  double mb = 0;
+  for (const auto& p : m)
+    mb += p.second.replicas_mb();
+  return mb;
+}
+
 void root_setup() {
   TH1::SetDefaultSumw2();
   gStyle->SetOptStat(1222222);
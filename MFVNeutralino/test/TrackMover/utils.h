@@ -3,8 +3,10 @@
 
 #include <cmath>
 #include <map>
+#include <memory>
 #include <string>
 #include "JMTucker/MFVNeutralino/interface/MovedTracksNtuple.h"
+#include "JMTucker/Tools/interface/BootstrapReplicas.h"
 
 class TH1;
 class TFile;
@@ -34,15 +36,39 @@ struct numden {
   // no ownership, the TFile owns the histos
   TH1* num;
   TH1* den;
+
+  // bootstrap replicas of num and den, if booked
+  std::shared_ptr<jmt::ReplicaHist> num_reps;
+  std::shared_ptr<jmt::ReplicaHist> den_reps;
+  void book_replicas(const jmt::BootstrapWeights& bw);
+
+  void fill_num(double x, double w);
+  void fill_num(double x, double y, double w);
+  void fill_den(double x, double w);
+  void fill_den(double x, double y, double w);
+
+  // add in o's replicas, e.g. those of the same numden from another thread
+  void merge_replicas(const numden& o);
+
+  // <num>_reps and <den>_reps in the current directory, see
+  // jmt::ReplicaHist::make_hist
+  void write_replicas() const;
+
+  // the memory the replicas take, for jmt::NtupleLoop::add_thread_mb
+  double replicas_mb() const;
 };
 
 struct numdens {
-  numdens(const char* c);
+  numdens(const char* c, const jmt::BootstrapWeights* bw=0);
   void book(int key, const char* name, const char* title, int nbins, double xlo, double xhi);
   void book(int key, const char* name, const char* title, int nbins, double xlo, double xhi, int nbinsy, double ylo, double yhi);
   numden& operator()(int);
+  void merge_replicas(const numdens& o);
+  void write_replicas() const;
+  double replicas_mb() const;
 
   std::string common;
+  const jmt::BootstrapWeights* bw;
   std::map<int, numden> m;
 };
 
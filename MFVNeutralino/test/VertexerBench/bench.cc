@@ -0,0 +1,493 @@
+// Standalone driver for mfv::VertexerAlgo on synthetic events, for
+// timing the seeding/arbitration/merging steps and for catching output
+// changes without a CMSSW job, e.g.
+//
+//   ./bench.exe nevents=200 nvertices=2 ntracks=5 npileup=40 seed=1
+//
+// Each event has nvertices displaced vertices with ntracks helices
+// each, plus npileup tracks coming from near the beamline with a
+// spread of impact parameters, as the ones that pass the seed track
+// cuts do. Tracks are helices in a 3.8 T field, measured at their point
+// of closest approach to the beamline and smeared there. The fit is a
+// plain least-squares vertex fit, linearizing each helix about the
+// current vertex position; it stands in for the Kalman fitter, so the
+// numbers are for the algorithm's own bookkeeping plus an O(1) fit
+// cost, not a prediction of the CMSSW timing.
+//
+// Everything is fixed by the seed (the random numbers don't go through
+// the std distributions, whose output varies between standard
+// libraries), so the lines not starting with "time" should not change
+// unless the algorithm does: make test diffs them against reference.txt.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include "JMTucker/MFVNeutralino/interface/VertexerAlgo.h"
+
+namespace {
+  struct Rng {
+    std::mt19937_64 g;
+    bool have;
+    double saved;
+    Rng(uint64_t seed) : g(seed), have(false), saved(0) {}
+    double uniform() { return (g() >> 11) * 0x1.0p-53; }
+    double uniform(double a, double b) { return a + (b - a) * uniform(); }
+    double exponential(double mean) { return -mean * std::log(1 - uniform()); }
+    double gauss() {
+      if (have) { have = false; return saved; }
+      const double r = std::sqrt(-2 * std::log(1 - uniform()));
+      const double p = 2 * M_PI * uniform();
+      saved = r * std::sin(p);
+      have = true;
+      return r * std::cos(p);
+    }
+  };
+
+  struct Vec {
+    double x, y, z;
+    Vec operator+(const Vec& o) const { return Vec{x+o.x, y+o.y, z+o.z}; }
+    Vec operator-(const Vec& o) const { return Vec{x-o.x, y-o.y, z-o.z}; }
+    Vec operator*(double a) const { return Vec{a*x, a*y, a*z}; }
+    double dot(const Vec& o) const { return x*o.x + y*o.y + z*o.z; }
+    double mag() const { return std::sqrt(dot(*this)); }
+    Vec cross(const Vec& o) const { return Vec{y*o.z - z*o.y, z*o.x - x*o.z, x*o.y - y*o.x}; }
+  };
+
+  // Helix parametrized by the transverse path length s from the
+  // reference point. k is the signed curvature in 1/cm.
+  struct Helix {
+    Vec ref;
+    double phi0;
+    double cot_theta;
+    double k;
+    double sigma_t; // perpendicular to the track in the transverse plane
+    double sigma_l; // the other perpendicular direction
+    int gen_vertex; // -1 for pileup
+
+    double phi(double s) const { return phi0 + k * s; }
+
+    Vec pos(double s) const {
+      if (std::fabs(k * s) < 1e-9)
+        return ref + Vec{std::cos(phi0), std::sin(phi0), cot_theta} * s;
+      const double p = phi(s);
+      return ref + Vec{(std::sin(p) - std::sin(phi0)) / k, -(std::cos(p) - std::cos(phi0)) / k, cot_theta * s};
+    }
+
+    Vec tangent(double s) const { const double p = phi(s); return Vec{std::cos(p), std::sin(p), cot_theta}; }
+
+    // Transverse path length of the point closest to x, in 3D or just
+    // in the transverse plane. Newton's method from the straight-line
+    // answer; a few steps are plenty for the mm-scale distances here.
+    double closest(const Vec& x, bool transverse=false) const {
+      const double cz = transverse ? 0 : cot_theta;
+      double s = Vec{std::cos(phi0), std::sin(phi0), cz}.dot(x - ref) / (1 + cz*cz);
+      for (int i = 0; i < 4; ++i) {
+        Vec d = pos(s) - x;
+        if (transverse) d.z = 0;
+        const double p = phi(s);
+        const Vec t{std::cos(p), std::sin(p), cz};
+        const Vec dt{-k * std::sin(p), k * std::cos(p), 0};
+        const double f = d.dot(t);
+        const double fp = t.dot(t) + d.dot(dt);
+        if (fp <= 0)
+          break;
+        s -= f / fp;
+      }
+      return s;
+    }
+
+    // Unit vectors perpendicular to the track at s: n1 in the transverse
+    // plane, n2 the other one; sigma_t and sigma_l go with them.
+    void perps(double s, Vec& n1, Vec& n2) const {
+      const double p = phi(s);
+      n1 = Vec{-std::sin(p), std::cos(p), 0};
+      const Vec t = tangent(s);
+      n2 = t.cross(n1);
+      n2 = n2 * (1 / n2.mag());
+    }
+  };
+
+  struct Sym3 {
+    double a[3][3];
+    Sym3() { std::memset(a, 0, sizeof a); }
+    void add_outer(const Vec& v, double w) {
+      const double c[3] = {v.x, v.y, v.z};
+      for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+          a[i][j] += w * c[i] * c[j];
+    }
+    double sandwich(const Vec& v) const {
+      const double c[3] = {v.x, v.y, v.z};
+      double r = 0;
+      for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+          r += c[i] * a[i][j] * c[j];
+      return r;
+    }
+    bool invert(Sym3& inv) const {
+      const double det =
+        a[0][0] * (a[1][1]*a[2][2] - a[1][2]*a[2][1]) -
+        a[0][1] * (a[1][0]*a[2][2] - a[1][2]*a[2][0]) +
+        a[0][2] * (a[1][0]*a[2][1] - a[1][1]*a[2][0]);
+      if (!(std::fabs(det) > 1e-300))
+        return false;
+      for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j) {
+          const int i1 = (j+1)%3, i2 = (j+2)%3, j1 = (i+1)%3, j2 = (i+2)%3;
+          inv.a[i][j] = (a[i1][j1]*a[i2][j2] - a[i1][j2]*a[i2][j1]) / det;
+        }
+      return true;
+    }
+    Vec operator*(const Vec& v) const {
+      return Vec{a[0][0]*v.x + a[0][1]*v.y + a[0][2]*v.z,
+                 a[1][0]*v.x + a[1][1]*v.y + a[1][2]*v.z,
+                 a[2][0]*v.x + a[2][1]*v.y + a[2][2]*v.z};
+    }
+  };
+
+  struct Vertex {
+    Vec x;
+    Sym3 cov;
+    double chi2;
+    double ndof;
+    std::vector<int> tracks;
+    Vertex() : x{0,0,0}, chi2(0), ndof(0) {}
+  };
+
+  struct Meas {
+    double v, e;
+    double value() const { return v; }
+    double error() const { return e; }
+    double significance() const { return e > 0 ? v / e : 0; }
+  };
+
+  struct PairEff {
+    unsigned weight;
+    unsigned k;
+    PairEff() : weight(1), k(0) {}
+    void inc_weight() { ++weight; }
+    void kind(unsigned x) { k |= x; }
+  };
+
+  struct Backend {
+    typedef int track_t;
+    typedef Vertex vertex_t;
+    typedef PairEff pair_eff_t;
+    typedef Meas dist_t;
+
+    std::vector<Helix> tracks_;
+    long n_fits;
+
+    Backend() : n_fits(0) {}
+
+    size_t n_seed_tracks() const { return tracks_.size(); }
+    int seed_track(size_t i) const { return int(i); }
+    unsigned key(int i) const { return unsigned(i); }
+
+    bool fit(const std::vector<int>& tks, Vertex& v) {
+      ++n_fits;
+      v = Vertex();
+      v.tracks = tks;
+      const int n = int(tks.size());
+      if (n < 2)
+        return false;
+
+      // Start from the midpoint of the closest approach of the first
+      // two tracks' tangents at their reference points.
+      const Helix& h0 = tracks_[tks[0]];
+      const Helix& h1 = tracks_[tks[1]];
+      const Vec t0 = h0.tangent(0), t1 = h1.tangent(0), w = h0.ref - h1.ref;
+      const double a = t0.dot(t0), b = t0.dot(t1), c = t1.dot(t1), d = t0.dot(w), e = t1.dot(w);
+      const double den = a*c - b*b;
+      const double s0 = den > 1e-12 ? (b*e - c*d) / den : 0;
+      const double s1 = den > 1e-12 ? (a*e - b*d) / den : 0;
+      Vec x = (h0.ref + t0 * s0 + h1.ref + t1 * s1) * 0.5;
+
+      Sym3 inv;
+      for (int iter = 0; iter < 3; ++iter) {
+        Sym3 A;
+        Vec rhs{0,0,0};
+        for (int i : tks) {
+          const Helix& h = tracks_[i];
+          const double s = h.closest(x);
+          const Vec p = h.pos(s);
+          Vec n1, n2;
+          h.perps(s, n1, n2);
+          const double w1 = 1 / (h.sigma_t * h.sigma_t), w2 = 1 / (h.sigma_l * h.sigma_l);
+          A.add_outer(n1, w1);
+          A.add_outer(n2, w2);
+          rhs = rhs + n1 * (w1 * n1.dot(p)) + n2 * (w2 * n2.dot(p));
+        }
+        if (!A.invert(inv))
+          return false;
+        x = inv * rhs;
+      }
+
+      double chi2 = 0;
+      for (int i : tks) {
+        const Helix& h = tracks_[i];
+        const Vec d = h.pos(h.closest(x)) - x;
+        Vec n1, n2;
+        h.perps(h.closest(x), n1, n2);
+        chi2 += std::pow(n1.dot(d) / h.sigma_t, 2) + std::pow(n2.dot(d) / h.sigma_l, 2);
+      }
+
+      v.x = x;
+      v.cov = inv;
+      v.chi2 = chi2;
+      v.ndof = 2*n - 3;
+      return std::hypot(x.x, x.y) < 100 && std::fabs(x.z) < 300;
+    }
+
+    double normalized_chi2(const Vertex& v) const { return v.ndof != 0 ? v.chi2 / v.ndof : v.chi2 * 1e6; }
+    std::set<int> tracks(const Vertex& v, double) const { return std::set<int>(v.tracks.begin(), v.tracks.end()); }
+
+    Meas vertex_dist(const Vertex& v0, const Vertex& v1) const {
+      const Vec d = v0.x - v1.x;
+      const double m = d.mag();
+      if (m == 0)
+        return Meas{0, 0};
+      const Vec u = d * (1 / m);
+      return Meas{m, std::sqrt(v0.cov.sandwich(u) + v1.cov.sandwich(u))};
+    }
+
+    void vertex_dists(const std::vector<Vertex>& v, size_t i, std::vector<Meas>& d) const {
+      d.clear();
+      for (size_t j = i+1; j < v.size(); ++j)
+        d.push_back(vertex_dist(v[i], v[j]));
+    }
+
+    std::pair<bool, Meas> track_dist(int tk, const Vertex& v) const {
+      const Helix& h = tracks_[tk];
+      const double s = h.closest(v.x);
+      const Vec d = h.pos(s) - v.x;
+      const double m = d.mag();
+      if (m == 0)
+        return std::make_pair(false, Meas{0, 0});
+      const Vec u = d * (1 / m);
+      Vec n1, n2;
+      h.perps(s, n1, n2);
+      const double e2 = std::pow(n1.dot(u) * h.sigma_t, 2) + std::pow(n2.dot(u) * h.sigma_l, 2) + v.cov.sandwich(u);
+      return std::make_pair(true, Meas{m, std::sqrt(e2)});
+    }
+
+    void set_vertices(PairEff&, const Vertex&, const Vertex&) const {}
+  };
+
+  struct Config {
+    long nevents = 100;
+    uint64_t seed = 12345;
+    int nvertices = 2;
+    int ntracks = 5;
+    int npileup = 40;
+    double mean_rho = 0.05;    // cm
+    double pileup_ip = 0.02;   // cm, mean of the exponential impact parameter of the pileup tracks
+    double bfield = 3.8;       // T
+    int dump = 0;
+    mfv::VertexerParams params;
+  };
+
+  Helix make_track(Rng& rng, const Config& cfg, const Vec& origin, int gen_vertex) {
+    const double pt = 1 + rng.exponential(4);
+    const double eta = rng.uniform(-2.5, 2.5);
+    const double charge = rng.uniform() < 0.5 ? -1 : 1;
+
+    Helix h;
+    h.ref = origin;
+    h.phi0 = rng.uniform(-M_PI, M_PI);
+    h.cot_theta = std::sinh(eta);
+    h.k = -charge * 0.003 * cfg.bfield / pt; // R[cm] = pt / (0.003 B)
+    h.gen_vertex = gen_vertex;
+    const double st = 0.002 + 0.003 / pt;
+    h.sigma_t = st;
+    h.sigma_l = st * std::cosh(eta) * 2;
+
+    // Move the reference to the point of closest approach to the
+    // beamline, where the track is measured, and smear it there.
+    const double s = h.closest(Vec{0,0,0}, true);
+    h.ref = h.pos(s);
+    h.phi0 = h.phi(s);
+    Vec n1, n2;
+    h.perps(0, n1, n2);
+    h.ref = h.ref + n1 * (st * rng.gauss()) + n2 * (h.sigma_l * rng.gauss());
+    h.phi0 += 0.0005 / pt * rng.gauss();
+    h.cot_theta += 0.001 * rng.gauss();
+    return h;
+  }
+
+  void generate(Rng& rng, const Config& cfg, Backend& b) {
+    b.tracks_.clear();
+    for (int iv = 0; iv < cfg.nvertices; ++iv) {
+      const double rho = rng.exponential(cfg.mean_rho);
+      const double phi = rng.uniform(-M_PI, M_PI);
+      const Vec x{rho * std::cos(phi), rho * std::sin(phi), 4 * rng.gauss()};
+      for (int it = 0; it < cfg.ntracks; ++it)
+        b.tracks_.push_back(make_track(rng, cfg, x, iv));
+    }
+
+    for (int it = 0; it < cfg.npileup; ++it) {
+      const double ip = rng.exponential(cfg.pileup_ip);
+      const double phi = rng.uniform(-M_PI, M_PI);
+      const Vec x{ip * std::cos(phi), ip * std::sin(phi), 4 * rng.gauss()};
+      b.tracks_.push_back(make_track(rng, cfg, x, -1));
+    }
+
+    // The real seed tracks don't come grouped by vertex.
+    for (size_t i = b.tracks_.size(); i > 1; --i)
+      std::swap(b.tracks_[i-1], b.tracks_[size_t(rng.uniform() * i)]);
+  }
+
+  struct Hash {
+    uint64_t h = 1469598103934665603ULL;
+    void add(int64_t x) {
+      for (int i = 0; i < 8; ++i) {
+        h ^= uint64_t(x >> (8*i)) & 0xff;
+        h *= 1099511628211ULL;
+      }
+    }
+  };
+
+  bool parse(Config& cfg, const char* arg) {
+    const char* eq = strchr(arg, '=');
+    if (!eq)
+      return false;
+    const std::string k(arg, eq);
+    const char* v = eq + 1;
+    mfv::VertexerParams& p = cfg.params;
+    if      (k == "nevents")   cfg.nevents = atol(v);
+    else if (k == "seed")      cfg.seed = strtoull(v, 0, 0);
+    else if (k == "nvertices") cfg.nvertices = atoi(v);
+    else if (k == "ntracks")   cfg.ntracks = atoi(v);
+    else if (k == "npileup")   cfg.npileup = atoi(v);
+    else if (k == "mean_rho")  cfg.mean_rho = atof(v);
+    else if (k == "pileup_ip") cfg.pileup_ip = atof(v);
+    else if (k == "bfield")    cfg.bfield = atof(v);
+    else if (k == "dump")      cfg.dump = atoi(v);
+    else if (k == "verbose")   p.verbose = atoi(v);
+    else if (k == "n_tracks_per_seed_vertex")       p.n_tracks_per_seed_vertex = atoi(v);
+    else if (k == "max_seed_vertex_chi2")           p.max_seed_vertex_chi2 = atof(v);
+    else if (k == "merge_anyway_dist")              p.merge_anyway_dist = atof(v);
+    else if (k == "merge_anyway_sig")               p.merge_anyway_sig = atof(v);
+    else if (k == "merge_shared_dist")              p.merge_shared_dist = atof(v);
+    else if (k == "merge_shared_sig")               p.merge_shared_sig = atof(v);
+    else if (k == "max_track_vertex_dist")          p.max_track_vertex_dist = atof(v);
+    else if (k == "max_track_vertex_sig")           p.max_track_vertex_sig = atof(v);
+    else if (k == "min_track_vertex_sig_to_remove") p.min_track_vertex_sig_to_remove = atof(v);
+    else if (k == "remove_one_track_at_a_time")     p.remove_one_track_at_a_time = atoi(v);
+    else
+      return false;
+    return true;
+  }
+}
+
+int main(int argc, char** argv) {
+  Config cfg;
+  for (int i = 1; i < argc; ++i)
+    if (!parse(cfg, argv[i])) {
+      fprintf(stderr, "usage: bench.exe [key=value ...]; keys are nevents seed nvertices ntracks npileup mean_rho pileup_ip bfield dump verbose, and the VertexerParams members\n");
+      return 1;
+    }
+
+  if (cfg.params.n_tracks_per_seed_vertex < 2 || cfg.params.n_tracks_per_seed_vertex > 5) {
+    fprintf(stderr, "n_tracks_per_seed_vertex must be one of 2,3,4,5\n");
+    return 1;
+  }
+
+  printf("nevents %li seed %llu nvertices %i ntracks %i npileup %i mean_rho %g pileup_ip %g n_tracks_per_seed_vertex %i\n",
+         cfg.nevents, (unsigned long long)cfg.seed, cfg.nvertices, cfg.ntracks, cfg.npileup, cfg.mean_rho, cfg.pileup_ip, cfg.params.n_tracks_per_seed_vertex);
+
+  typedef std::chrono::steady_clock clock;
+  double t_seed = 0, t_arbitrate = 0, t_merge = 0;
+  long n_seed_tracks = 0, n_seed_vertices = 0, n_output_vertices = 0, n_output_vertices_3trk = 0, n_pairs = 0;
+  long n_resets = 0, max_resets = 0, n_onetracks = 0, n_gen_found = 0, n_fits = 0;
+  Hash hash;
+
+  Rng rng(cfg.seed);
+  Backend b;
+
+  for (long ievent = 0; ievent < cfg.nevents; ++ievent) {
+    generate(rng, cfg, b);
+    n_seed_tracks += b.tracks_.size();
+    b.n_fits = 0;
+
+    mfv::VertexerAlgo<Backend> algo(cfg.params, b);
+    std::vector<Vertex> vertices;
+    std::vector<PairEff> vpeffs;
+    mfv::VertexerAlgo<Backend>::pair_tracks_t vpeffs_tracks;
+
+    const auto t0 = clock::now();
+    algo.seed(vertices);
+    const auto t1 = clock::now();
+    n_seed_vertices += vertices.size();
+    algo.arbitrate(vertices, vpeffs, vpeffs_tracks);
+    const auto t2 = clock::now();
+    algo.merge(vertices);
+    const auto t3 = clock::now();
+
+    t_seed      += std::chrono::duration<double>(t1 - t0).count();
+    t_arbitrate += std::chrono::duration<double>(t2 - t1).count();
+    t_merge     += std::chrono::duration<double>(t3 - t2).count();
+
+    n_resets += algo.n_resets();
+    max_resets = std::max(max_resets, long(algo.n_resets()));
+    n_onetracks += algo.n_onetracks();
+    n_output_vertices += vertices.size();
+    n_pairs += vpeffs.size();
+    n_fits += b.n_fits;
+
+    hash.add(ievent);
+    hash.add(algo.n_resets());
+    hash.add(vertices.size());
+
+    std::map<int, int> best; // gen vertex -> most of its tracks in one output vertex
+    for (const Vertex& v : vertices) {
+      std::set<int> tks(v.tracks.begin(), v.tracks.end());
+      if (tks.size() >= 3)
+        ++n_output_vertices_3trk;
+
+      std::map<int, int> count;
+      for (int i : tks)
+        if (b.tracks_[i].gen_vertex >= 0)
+          ++count[b.tracks_[i].gen_vertex];
+      for (auto p : count)
+        best[p.first] = std::max(best[p.first], p.second);
+
+      hash.add(tks.size());
+      for (int i : tks)
+        hash.add(i);
+      hash.add(std::llround(v.x.x * 1e4));
+      hash.add(std::llround(v.x.y * 1e4));
+      hash.add(std::llround(v.x.z * 1e4));
+
+      if (cfg.dump) {
+        printf("event %li vertex ntracks %lu pos <%9.4f, %9.4f, %9.4f> chi2/dof %7.3f tracks", ievent, tks.size(), v.x.x, v.x.y, v.x.z, b.normalized_chi2(v));
+        for (int i : tks)
+          printf(" %i(%i)", i, b.tracks_[i].gen_vertex);
+        printf("\n");
+      }
+    }
+
+    for (auto p : best)
+      if (p.second >= 3)
+        ++n_gen_found;
+  }
+
+  const double ne = cfg.nevents > 0 ? cfg.nevents : 1;
+  printf("seed tracks: %li (%.2f/event)\n", n_seed_tracks, n_seed_tracks / ne);
+  printf("fits: %li (%.1f/event)\n", n_fits, n_fits / ne);
+  printf("seed vertices: %li (%.2f/event)\n", n_seed_vertices, n_seed_vertices / ne);
+  printf("vertex pairs recorded: %li\n", n_pairs);
+  printf("n_resets: %li (%.2f/event, max %li)  n_onetracks: %li\n", n_resets, n_resets / ne, max_resets, n_onetracks);
+  printf("output vertices: %li (%.2f/event), %li with >= 3 tracks\n", n_output_vertices, n_output_vertices / ne, n_output_vertices_3trk);
+  printf("gen vertices with >= 3 tracks in one output vertex: %li / %li\n", n_gen_found, cfg.nevents * cfg.nvertices);
+  printf("checksum: %016llx\n", (unsigned long long)hash.h);
+  printf("time per event (us): seeding %10.1f  arbitration %10.1f  merging %10.1f  total %10.1f\n",
+         1e6 * t_seed / ne, 1e6 * t_arbitrate / ne, 1e6 * t_merge / ne, 1e6 * (t_seed + t_arbitrate + t_merge) / ne);
+}
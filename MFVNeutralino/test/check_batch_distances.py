@@ -0,0 +1,24 @@
+#!/usr/bin/env python
+
+# Run the ntuple with every batch distance computation (the vertexer's
+# close-merge distances, the aux producer's beamspot/PV/miss distances,
+# and the jet-vertex miss distances) also done pair by pair through
+# VertexDistanceXY/3D and mfv::miss_dist; the job throws at the first
+# value that doesn't agree, so it finishing is the test.
+
+from JMTucker.MFVNeutralino.NtupleCommon import *
+
+settings = NtupleSettings()
+settings.is_mc = True
+settings.is_miniaod = True
+settings.event_filter = 'jets only'
+
+process = ntuple_process(settings)
+max_events(process, 1000)
+report_every(process, 100)
+sample_files(process, 'qcdht2000_2017', 'miniaod', 1)
+file_event_from_argv(process)
+
+for name in 'mfvVertices', 'mfvVerticesToJets', 'mfvVerticesAuxTmp', 'mfvVerticesAuxPresel':
+    if hasattr(process, name):
+        getattr(process, name).check_batch = cms.untracked.bool(True)
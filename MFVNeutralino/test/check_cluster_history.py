@@ -0,0 +1,25 @@
+import sys
+from JMTucker.Tools.BasicAnalyzer_cfg import *
+
+# Compare the clusters from mfv::track_cluster_history with fastjet's,
+# by track membership, for kt, C/A and anti-kt at each of the radii
+# below, for every vertex in the ntuple (no selection, so the big
+# track-count tails are in too). The job throws at the first vertex
+# that differs, so it finishing is the test.
+
+process.source.fileNames = ['/store/user/tucker/QCD_HT2000toInf_TuneCUETP8M1_13TeV-madgraphMLM-pythia8/ntuplev9/161019_211934/0000/ntuple_1.root']
+process.TFileService.fileName = 'check_cluster_history.root'
+process.maxEvents.input = 2000
+file_event_from_argv(process)
+
+process.load('JMTucker.MFVNeutralino.WeightProducer_cfi')
+
+process.mfvClusterTracksCheck = cms.EDAnalyzer('MFVClusterTracksHistos',
+                                               event_src = cms.InputTag('mfvEvent'),
+                                               vertex_src = cms.InputTag('mfvVerticesAux'),
+                                               weight_src = cms.InputTag('mfvWeight'),
+                                               min_dbv = cms.double(0.),
+                                               check_history_Rs = cms.untracked.vdouble(0.1, 0.2, 0.4, 0.6, 0.8, 1.0, 1.5, 3.),
+                                               )
+
+process.p = cms.Path(process.mfvWeight * process.mfvClusterTracksCheck)
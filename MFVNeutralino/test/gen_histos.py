@@ -17,6 +17,7 @@ process.mfvGenHistos = cms.EDAnalyzer('MFVGenHistos',
                                       gen_jet_src = cms.InputTag('ak4GenJetsNoNu'),
                                       gen_vertex_src = cms.InputTag('mfvGenParticles', 'genVertex'),
                                       mci_src = cms.InputTag('mfvGenParticles'),
+                                      gen_decay_graph_src = cms.InputTag('mfvGenParticles', 'decayGraph'),
                                       )
 
 #process.p = cms.Path(process.mfvGenParticles * process.mfvGenParticleFilter * process.mfvGenHistos)
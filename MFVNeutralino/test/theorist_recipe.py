@@ -19,6 +19,7 @@ mfvTheoristRecipe = cms.EDAnalyzer('MFVTheoristRecipe',
                                    gen_jets_src = cms.InputTag('ak4GenJetsNoNu'),
                                    gen_vertex_src = cms.InputTag('mfvGenParticles', 'genVertex'),
                                    mci_src = cms.InputTag('mfvGenParticles'),
+                                   gen_decay_graph_src = cms.InputTag('mfvGenParticles', 'decayGraph'),
                                    mevent_src = cms.InputTag('mfvEvent'),
                                    vertex_src = cms.InputTag('mfvSelectedVertices'),
                                    max_dist = cms.double(0.0084),
@@ -0,0 +1,24 @@
+#ifndef JMTucker_Tools_AllocHook_h
+#define JMTucker_Tools_AllocHook_h
+
+// Optional per-thread counts of operator new calls and bytes. Nothing
+// in the normal build defines jmt_alloc_counts; it comes from the shim
+// in Tools/test/AllocHook, run as
+//   LD_PRELOAD=$CMSSW_BASE/src/JMTucker/Tools/test/AllocHook/libjmtallochook.so cmsRun ...
+// Without it the weak reference is null and alloc_counts() returns 0.
+
+namespace jmt {
+  struct AllocCounts {
+    unsigned long long n;
+    unsigned long long bytes;
+  };
+}
+
+extern "C" jmt::AllocCounts* jmt_alloc_counts() __attribute__((weak));
+
+namespace jmt {
+  inline bool alloc_hook_loaded() { return jmt_alloc_counts != nullptr; }
+  inline AllocCounts* alloc_counts() { return jmt_alloc_counts ? jmt_alloc_counts() : nullptr; }
+}
+
+#endif
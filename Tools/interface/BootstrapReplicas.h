@@ -0,0 +1,245 @@
+#ifndef JMTucker_Tools_BootstrapReplicas_h
+#define JMTucker_Tools_BootstrapReplicas_h
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+#include "TDirectory.h"
+#include "TH2.h"
+#include "TKey.h"
+
+namespace jmt {
+  // Poisson(1) bootstrap weights for n replicas of a dataset. Each event
+  // gets n integer weights drawn from a hash of (run, lumi, event), so
+  // an event gets the same weights in every program that uses the same
+  // n and salt, and samples can be processed separately and the
+  // replicas combined afterwards. The draws are all integer arithmetic
+  // (splitmix64, and inversion against the Poisson(1) CDF scaled to
+  // 2^64), so they don't depend on the platform either.
+  class BootstrapWeights {
+  public:
+    explicit BootstrapWeights(int n, unsigned long long salt=0) : salt_(salt), k_(n, 1) {}
+
+    int n() const { return int(k_.size()); }
+    int operator[](int i) const { return k_[i]; }
+    const unsigned char* data() const { return k_.data(); }
+
+    void set_event(unsigned run, unsigned lumi, unsigned long long event) {
+      unsigned long long s = mix(mix(mix(salt_ ^ event) ^ lumi) ^ (unsigned long long)(run) << 32);
+      for (unsigned char& k : k_)
+        k = poisson1(mix(s += 0x9e3779b97f4a7c15ULL));
+    }
+
+    template <typename NT>
+    void set_event(const NT& nt) { set_event(nt.run, nt.lumi, nt.event); }
+
+  private:
+    static unsigned long long mix(unsigned long long z) {
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      return z ^ (z >> 31);
+    }
+
+    static unsigned char poisson1(unsigned long long u) {
+      // floor(2^64 * P(X <= k)) for X ~ Poisson(1), k = 0..15
+      static const unsigned long long cdf[16] = {
+        0x5e2d58d8b3bcdf1aULL, 0xbc5ab1b16779be35ULL, 0xeb715e1dc1582dc2ULL, 0xfb23979734a252f1ULL,
+        0xff1025f59174dc3dULL, 0xffd90f3ba4055e19ULL, 0xfffa8b71fc72c913ULL, 0xffff540c0914b3c9ULL,
+        0xffffed1f4aa8f120ULL, 0xfffffe216e641462ULL, 0xffffffd4d85d3183ULL, 0xfffffffc6da262b4ULL,
+        0xffffffffba12d178ULL, 0xfffffffffb07c64cULL, 0xffffffffffab8ea5ULL, 0xfffffffffffabe22ULL
+      };
+      unsigned char k = 0;
+      while (k < 16 && u >= cdf[k])
+        ++k;
+      return k;
+    }
+
+    unsigned long long salt_;
+    std::vector<unsigned char> k_;
+  };
+
+  // Replica sums of weights: w times each replica's weight for the
+  // current event.
+  class ReplicaSum {
+  public:
+    explicit ReplicaSum(const BootstrapWeights& bw) : bw_(bw), s_(bw.n(), 0.) {}
+
+    void add(double w) {
+      const unsigned char* k = bw_.data();
+      for (int r = 0, n = bw_.n(); r < n; ++r)
+        s_[r] += w * k[r];
+    }
+
+    int n() const { return bw_.n(); }
+    double operator[](int r) const { return s_[r]; }
+
+    // Add in o, e.g. the same sum kept by another thread.
+    void merge(const ReplicaSum& o) {
+      for (int r = 0, n = bw_.n(); r < n; ++r)
+        s_[r] += o.s_[r];
+    }
+
+  private:
+    const BootstrapWeights& bw_;
+    std::vector<double> s_;
+  };
+
+  // The replicas of a histogram: what h would have been filled with in
+  // each replica, kept as one block of (number of bins including under
+  // and overflow) x n doubles, replicas fastest, so that a fill updates
+  // one contiguous stretch. h isn't owned or filled here, only used for
+  // its binning. make_hist() copies the block into a TH2D of global bin
+  // x replica to be written next to h; those add up under hadd like h
+  // does, and replica_efficiency below works from them.
+  class ReplicaHist {
+  public:
+    ReplicaHist(TH1* h, const BootstrapWeights& bw)
+      : h_(h), bw_(bw), ncells_(h->GetNcells()), s_(size_t(ncells_) * bw.n(), 0.) {}
+
+    const TH1* hist() const { return h_; }
+    int n() const { return bw_.n(); }
+
+    void fill(double x, double w) { add(h_->FindBin(x), w); }
+    void fill(double x, double y, double w) { add(h_->FindBin(x, y), w); }
+
+    void add(int bin, double w) {
+      if (bin < 0 || bin >= ncells_)
+        return;
+      double* s = &s_[size_t(bin) * bw_.n()];
+      const unsigned char* k = bw_.data();
+      for (int r = 0, n = bw_.n(); r < n; ++r)
+        s[r] += w * k[r];
+    }
+
+    // Content of global bin in replica r.
+    double content(int bin, int r) const { return s_[size_t(bin) * bw_.n() + r]; }
+
+    // Add in o, which must have the same binning and number of replicas.
+    void merge(const ReplicaHist& o) {
+      for (size_t i = 0, ie = s_.size(); i < ie; ++i)
+        s_[i] += o.s_[i];
+    }
+
+    // In the current directory.
+    TH2D* make_hist(const char* name) const {
+      TH2D* h = new TH2D(name, ";global bin;replica", ncells_, 0, ncells_, bw_.n(), 0, bw_.n());
+      fill_hist(h);
+      return h;
+    }
+
+    // h booked elsewhere (e.g. by TFileService) with make_hist's binning.
+    void fill_hist(TH2* h) const {
+      for (int bin = 0; bin < ncells_; ++bin)
+        for (int r = 0; r < bw_.n(); ++r)
+          h->SetBinContent(bin+1, r+1, content(bin, r));
+    }
+
+    int ncells() const { return ncells_; }
+
+    // The memory the replicas take.
+    double mb() const { return s_.size() * sizeof(double) / 1048576.; }
+
+  private:
+    TH1* h_;
+    const BootstrapWeights& bw_;
+    const int ncells_;
+    std::vector<double> s_;
+  };
+
+  // The spread of num/den over the replicas, over the ones with nonzero
+  // den.
+  inline double replica_ratio_rms(const ReplicaSum& num, const ReplicaSum& den) {
+    double s = 0, s2 = 0;
+    int m = 0;
+    for (int r = 0; r < num.n(); ++r)
+      if (den[r] != 0) {
+        const double e = num[r] / den[r];
+        s += e;
+        s2 += e*e;
+        ++m;
+      }
+    if (m < 2)
+      return 0;
+    const double mean = s / m;
+    return std::sqrt(std::max(s2 / m - mean*mean, 0.));
+  }
+
+  // Fill eff, a histogram with the binning of num and den (e.g. a clone
+  // of num), with the nominal efficiency num/den and, as errors, its
+  // rms over the replicas in num_reps and den_reps, as made by
+  // ReplicaHist::make_hist. False if the binnings don't match.
+  inline bool replica_efficiency(const TH1* num, const TH1* den, const TH2* num_reps, const TH2* den_reps, TH1* eff) {
+    const int ncells = num->GetNcells();
+    const int n = num_reps->GetNbinsY();
+    if (den->GetNcells() != ncells || eff->GetNcells() != ncells ||
+        num_reps->GetNbinsX() != ncells || den_reps->GetNbinsX() != ncells || den_reps->GetNbinsY() != n)
+      return false;
+
+    for (int bin = 0; bin < ncells; ++bin) {
+      const double d = den->GetBinContent(bin);
+      double s = 0, s2 = 0;
+      int m = 0;
+      for (int r = 0; r < n; ++r) {
+        const double dr = den_reps->GetBinContent(bin+1, r+1);
+        if (dr != 0) {
+          const double e = num_reps->GetBinContent(bin+1, r+1) / dr;
+          s += e;
+          s2 += e*e;
+          ++m;
+        }
+      }
+      const double mean = m ? s / m : 0;
+      eff->SetBinContent(bin, d != 0 ? num->GetBinContent(bin) / d : 0);
+      eff->SetBinError(bin, m > 1 ? std::sqrt(std::max(s2 / m - mean*mean, 0.)) : 0);
+    }
+    eff->SetEntries(num->GetEntries());
+    return true;
+  }
+
+  // For every X_num in dir and its subdirectories that has X_den,
+  // X_num_reps and X_den_reps next to it, write X_eff from
+  // replica_efficiency into the same directory. Meant for after the
+  // jobs' outputs are merged, since the efficiencies can't be added.
+  // Returns the number made, or -1 if some binning didn't match.
+  inline int make_replica_effs(TDirectory* dir) {
+    int nmade = 0;
+    std::vector<std::string> nums;
+    std::vector<TDirectory*> subdirs;
+    TIter next(dir->GetListOfKeys());
+    while (TKey* key = static_cast<TKey*>(next())) {
+      const std::string name = key->GetName();
+      if (key->IsFolder())
+        subdirs.push_back(dir->GetDirectory(name.c_str()));
+      else if (name.size() > 4 && name.compare(name.size() - 4, 4, "_num") == 0)
+        nums.push_back(name.substr(0, name.size() - 4));
+    }
+
+    for (const std::string& x : nums) {
+      TH1* num = dynamic_cast<TH1*>(dir->Get((x + "_num").c_str()));
+      TH1* den = dynamic_cast<TH1*>(dir->Get((x + "_den").c_str()));
+      TH2* num_reps = dynamic_cast<TH2*>(dir->Get((x + "_num_reps").c_str()));
+      TH2* den_reps = dynamic_cast<TH2*>(dir->Get((x + "_den_reps").c_str()));
+      if (!num || !den || !num_reps || !den_reps)
+        continue;
+      TDirectory::TContext ctx(dir);
+      TH1* eff = static_cast<TH1*>(num->Clone((x + "_eff").c_str()));
+      if (!replica_efficiency(num, den, num_reps, den_reps, eff))
+        return -1;
+      eff->Write(0, TObject::kOverwrite);
+      ++nmade;
+    }
+
+    for (TDirectory* d : subdirs) {
+      if (!d) continue;
+      const int n = make_replica_effs(d);
+      if (n < 0)
+        return -1;
+      nmade += n;
+    }
+
+    return nmade;
+  }
+}
+
+#endif
@@ -1,14 +1,32 @@
 #ifndef JMTucker_Tools_ByRunTH1_h
 #define JMTucker_Tools_ByRunTH1_h
 
+#include <algorithm>
 #include <map>
+#include <vector>
+#include "TH2.h"
 #include "CommonTools/UtilAlgos/interface/TFileService.h"
 #include "FWCore/ServiceRegistry/interface/Service.h"
 
+template <typename T> struct ByRunTH1Backing {};
+template <> struct ByRunTH1Backing<TH1F> { typedef TH2F type; };
+template <> struct ByRunTH1Backing<TH1D> { typedef TH2D type; };
+template <> struct ByRunTH1Backing<TH1I> { typedef TH2I type; };
+
+// One histogram per run, named name_run%u. By default they're booked
+// the first time a run is seen. If the run list is known up front
+// (e.g. LumiList::runs()), prebook() books them all at once into a
+// dense array, and fills find the run with a one-entry cache and a
+// binary search. With backing_2d, instead of one TH1 per run there is
+// a single TH2 name_byrun with the run index on x, the run numbers as
+// the x bin labels, and the quantity on y; mergeByRunTH1.py splits or
+// merges it afterward. In that mode use fill() rather than operator[].
 template <typename T>
 class ByRunTH1 {
  public:
-   ByRunTH1() : fs_(nullptr) {}
+  typedef typename ByRunTH1Backing<T>::type T2;
+
+  ByRunTH1() : fs_(nullptr), h2_(nullptr), last_run_(0), last_index_(-1) {}
 
   void set(edm::Service<TFileService>* fs, const char* name, const char* title, const int nbins, const double xmin, const double xmax) {
     fs_ = fs;
@@ -19,32 +37,92 @@ class ByRunTH1 {
     xmax_ = xmax;
   }
 
+  void prebook(std::vector<unsigned> runs, const bool backing_2d=false) {
+    if (fs_ == nullptr) throw cms::Exception("NotInitialized", "ByRunTH1 instance used without call to set");
+    if (!runs_.empty() || !hist_map_.empty()) throw cms::Exception("AlreadyBooked", "ByRunTH1::prebook called after histograms were booked");
+    std::sort(runs.begin(), runs.end());
+    runs.erase(std::unique(runs.begin(), runs.end()), runs.end());
+    if (runs.empty()) throw cms::Exception("BadConfig", "ByRunTH1::prebook called with no runs");
+    runs_ = runs;
+
+    if (backing_2d) {
+      const int n = int(runs_.size());
+      h2_ = (*fs_)->make<T2>(TString::Format("%s_byrun", name_.Data()),
+                             TString::Format("%s (by run)", title_.Data()),
+                             n, 0, n,
+                             nbins_, xmin_, xmax_);
+      for (int i = 0; i < n; ++i)
+        h2_->GetXaxis()->SetBinLabel(i+1, TString::Format("%u", runs_[i]));
+    }
+    else {
+      hists_.reserve(runs_.size());
+      for (unsigned run : runs_)
+        hists_.push_back(make(run));
+    }
+  }
+
+  bool prebooked() const { return !runs_.empty(); }
+
   T* operator[](unsigned run) {
     if (fs_ == nullptr) throw cms::Exception("NotInitialized", "ByRunTH1 instance used without call to set");
-    if (hist_map_.find(run) == hist_map_.end())
-      book(run); 
-    return hist_map_[run];
+    if (prebooked()) {
+      if (h2_) throw cms::Exception("BadUse", "ByRunTH1 with a 2D backing histogram has no per-run TH1s, use fill()");
+      return hists_[index(run)];
+    }
+    T*& h = hist_map_[run];
+    if (h == nullptr)
+      h = make(run);
+    return h;
+  }
+
+  void fill(unsigned run, double x, double w=1) {
+    if (h2_)
+      h2_->Fill(index(run), x, w);
+    else
+      (*this)[run]->Fill(x, w);
   }
 
   void book(unsigned run) {
-    if (fs_ == nullptr) throw cms::Exception("NotInitialized", "ByRunTH1 instance used without call to set");
-    if (hist_map_.find(run) == hist_map_.end())
-      hist_map_[run] = (*fs_)->make<T>(TString::Format("%s_run%u", name_.Data(), run), 
-                                       TString::Format("%s (run %u)", title_.Data(), run), 
-                                       nbins_,
-                                       xmin_,
-                                       xmax_);
+    if (prebooked())
+      index(run);
+    else
+      (*this)[run];
   }
 
  private:
+  T* make(unsigned run) {
+    return (*fs_)->make<T>(TString::Format("%s_run%u", name_.Data(), run),
+                           TString::Format("%s (run %u)", title_.Data(), run),
+                           nbins_,
+                           xmin_,
+                           xmax_);
+  }
+
+  int index(unsigned run) {
+    if (run != last_run_ || last_index_ < 0) {
+      auto it = std::lower_bound(runs_.begin(), runs_.end(), run);
+      if (it == runs_.end() || *it != run)
+        throw cms::Exception("BadRun") << "run " << run << " not in the list ByRunTH1 " << name_ << " was prebooked with";
+      last_run_ = run;
+      last_index_ = int(it - runs_.begin());
+    }
+    return last_index_;
+  }
+
   edm::Service<TFileService>* fs_;
   std::map<unsigned, T*> hist_map_;
 
+  std::vector<unsigned> runs_;
+  std::vector<T*> hists_;
+  T2* h2_;
+  unsigned last_run_;
+  int last_index_;
+
   TString name_;
   TString title_;
   int nbins_;
   double xmin_;
-  double xmax_;    
+  double xmax_;
 };
 
 #endif
@@ -0,0 +1,301 @@
+#ifndef JMTucker_Tools_CompiledCut_h
+#define JMTucker_Tools_CompiledCut_h
+
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include "CommonTools/Utils/interface/StringCutObjectSelector.h"
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
+#include "FWCore/Utilities/interface/Exception.h"
+
+namespace jmt {
+  // Per-type table of the methods a compiled cut may use, keyed by the
+  // accessor chain as written in the cut string, e.g.
+  // "innerTrack.hitPattern.numberOfValidPixelHits" or
+  // "gsfTrack.hitPattern.numberOfAllHits(\"MISSING_INNER_HITS\")".
+  // Specialize for each object type, see PatCompiledCuts.h.
+  template <typename T>
+  struct CutAccessors {
+    typedef std::function<double(const T&)> fcn_t;
+    typedef std::map<std::string, fcn_t> map_t;
+    static const map_t& get() { static const map_t m; return m; }
+  };
+
+  // Compiles the subset of the StringCutObjectSelector grammar that we
+  // use -- numbers, accessors from CutAccessors<T>, abs(), + - * /,
+  // the six comparisons, && || ! and parentheses -- into a tree of
+  // closures at construction. Everything is evaluated in double with
+  // the same association and short-circuiting as the interpreter, so
+  // the results are identical. If the expression uses anything else,
+  // ok() is false and why() says what.
+  template <typename T>
+  class CompiledCut {
+  public:
+    typedef std::function<double(const T&)> fcn_t;
+
+    CompiledCut(const std::string& expr) : s_(expr), pos_(0) {
+      try {
+        f_ = parse_or();
+        skip();
+        if (pos_ != s_.size())
+          fail("unexpected trailing characters");
+      }
+      catch (const std::runtime_error& e) {
+        f_ = nullptr;
+        why_ = e.what();
+      }
+    }
+
+    bool ok() const { return bool(f_); }
+    const std::string& why() const { return why_; }
+    bool operator()(const T& t) const { return f_(t) != 0; }
+
+  private:
+    std::string s_;
+    size_t pos_;
+    fcn_t f_;
+    std::string why_;
+
+    void fail(const std::string& msg) const {
+      throw std::runtime_error(msg + " at position " + std::to_string(pos_) + " in \"" + s_ + "\"");
+    }
+
+    void skip() {
+      while (pos_ < s_.size() && isspace(s_[pos_]))
+        ++pos_;
+    }
+
+    bool peek(const char* tok) {
+      skip();
+      return s_.compare(pos_, strlen(tok), tok) == 0;
+    }
+
+    bool match(const char* tok) {
+      if (!peek(tok))
+        return false;
+      pos_ += strlen(tok);
+      return true;
+    }
+
+    fcn_t parse_or() {
+      fcn_t l = parse_and();
+      while (match("||")) {
+        fcn_t r = parse_and();
+        l = [l,r](const T& t) -> double { return l(t) != 0 || r(t) != 0; };
+      }
+      return l;
+    }
+
+    fcn_t parse_and() {
+      fcn_t l = parse_not();
+      while (match("&&")) {
+        fcn_t r = parse_not();
+        l = [l,r](const T& t) -> double { return l(t) != 0 && r(t) != 0; };
+      }
+      return l;
+    }
+
+    fcn_t parse_not() {
+      if (peek("!") && !peek("!=")) {
+        ++pos_;
+        fcn_t x = parse_not();
+        return [x](const T& t) -> double { return x(t) == 0; };
+      }
+      return parse_cmp();
+    }
+
+    fcn_t parse_cmp() {
+      fcn_t l = parse_sum();
+      fcn_t c;
+      if      (match("<=")) { fcn_t r = parse_sum(); c = [l,r](const T& t) -> double { return l(t) <= r(t); }; }
+      else if (match(">=")) { fcn_t r = parse_sum(); c = [l,r](const T& t) -> double { return l(t) >= r(t); }; }
+      else if (match("==")) { fcn_t r = parse_sum(); c = [l,r](const T& t) -> double { return l(t) == r(t); }; }
+      else if (match("!=")) { fcn_t r = parse_sum(); c = [l,r](const T& t) -> double { return l(t) != r(t); }; }
+      else if (match("<"))  { fcn_t r = parse_sum(); c = [l,r](const T& t) -> double { return l(t) <  r(t); }; }
+      else if (match(">"))  { fcn_t r = parse_sum(); c = [l,r](const T& t) -> double { return l(t) >  r(t); }; }
+      else
+        return l;
+
+      if (peek("<") || peek(">") || peek("==") || (peek("!=")))
+        fail("chained comparison not supported");
+      return c;
+    }
+
+    fcn_t parse_sum() {
+      fcn_t l = parse_prod();
+      while (1) {
+        if (match("+"))      { fcn_t r = parse_prod(); l = [l,r](const T& t) { return l(t) + r(t); }; }
+        else if (match("-")) { fcn_t r = parse_prod(); l = [l,r](const T& t) { return l(t) - r(t); }; }
+        else
+          return l;
+      }
+    }
+
+    fcn_t parse_prod() {
+      fcn_t l = parse_unary();
+      while (1) {
+        if (match("*"))      { fcn_t r = parse_unary(); l = [l,r](const T& t) { return l(t) * r(t); }; }
+        else if (match("/")) { fcn_t r = parse_unary(); l = [l,r](const T& t) { return l(t) / r(t); }; }
+        else
+          return l;
+      }
+    }
+
+    fcn_t parse_unary() {
+      if (match("-")) {
+        fcn_t x = parse_unary();
+        return [x](const T& t) { return -x(t); };
+      }
+      if (match("+"))
+        return parse_unary();
+      return parse_primary();
+    }
+
+    std::string identifier() {
+      skip();
+      const size_t b = pos_;
+      if (pos_ < s_.size() && (isalpha(s_[pos_]) || s_[pos_] == '_'))
+        while (pos_ < s_.size() && (isalnum(s_[pos_]) || s_[pos_] == '_'))
+          ++pos_;
+      if (pos_ == b)
+        fail("expected identifier");
+      return s_.substr(b, pos_ - b);
+    }
+
+    fcn_t parse_primary() {
+      skip();
+      if (pos_ == s_.size())
+        fail("unexpected end of expression");
+
+      if (match("(")) {
+        fcn_t x = parse_or();
+        if (!match(")"))
+          fail("expected )");
+        return x;
+      }
+
+      const char c = s_[pos_];
+      if (isdigit(c) || c == '.') {
+        const char* b = s_.c_str() + pos_;
+        char* e = 0;
+        const double v = strtod(b, &e);
+        if (e == b)
+          fail("bad number");
+        pos_ += e - b;
+        return [v](const T&) { return v; };
+      }
+
+      // accessor chain, or abs()
+      std::string key = identifier();
+      if (key == "abs" && match("(")) {
+        fcn_t x = parse_or();
+        if (!match(")"))
+          fail("expected )");
+        return [x](const T& t) { return std::abs(x(t)); };
+      }
+
+      while (1) {
+        if (match("(")) {
+          if (match(")"))
+            ; // pt() is the same as pt
+          else if (peek("\"")) {
+            const size_t b = ++pos_;
+            const size_t e = s_.find('"', b);
+            if (e == std::string::npos)
+              fail("unterminated string");
+            key += "(\"" + s_.substr(b, e - b) + "\")";
+            pos_ = e + 1;
+            if (!match(")"))
+              fail("expected )");
+          }
+          else
+            fail("only string arguments to methods are supported");
+        }
+
+        if (!match("."))
+          break;
+        key += "." + identifier();
+      }
+
+      const typename CutAccessors<T>::map_t& accessors = CutAccessors<T>::get();
+      auto it = accessors.find(key);
+      if (it == accessors.end())
+        fail("no compiled accessor for " + key);
+      return it->second;
+    }
+  };
+
+  // Selector that uses the CompiledCut when it can and falls back to
+  // StringCutObjectSelector otherwise. With check set, every call
+  // evaluates both, throws on a disagreement, and times each for
+  // report().
+  template <typename T>
+  class CutSelector {
+  public:
+    CutSelector(const std::string& expr, bool check=false)
+      : expr_(expr),
+        compiled_(expr),
+        check_(check),
+        n_(0),
+        t_compiled_(0),
+        t_interp_(0)
+    {
+      if (!compiled_.ok() || check_)
+        interp_.reset(new StringCutObjectSelector<T>(expr));
+      if (!compiled_.ok())
+        edm::LogWarning("CutSelector") << "\"" << expr_ << "\" falls back to StringCutObjectSelector: " << compiled_.why();
+    }
+
+    const std::string& expr() const { return expr_; }
+    bool compiled() const { return compiled_.ok(); }
+    const std::string& why() const { return compiled_.why(); }
+
+    bool operator()(const T& t) const {
+      if (!check_)
+        return compiled_.ok() ? compiled_(t) : (*interp_)(t);
+
+      typedef std::chrono::steady_clock clock;
+      const clock::time_point t0 = clock::now();
+      const bool ri = (*interp_)(t);
+      const clock::time_point t1 = clock::now();
+      const bool rc = compiled_.ok() ? compiled_(t) : ri;
+      const clock::time_point t2 = clock::now();
+
+      ++n_;
+      t_interp_ += std::chrono::duration<double>(t1 - t0).count();
+      t_compiled_ += std::chrono::duration<double>(t2 - t1).count();
+
+      if (rc != ri)
+        throw cms::Exception("CutSelector") << "compiled and interpreted results differ (" << rc << " vs " << ri << ") for \"" << expr_ << "\"";
+      return ri;
+    }
+
+    void report(std::ostream& out) const {
+      out << (compiled() ? "compiled   " : "interpreted") << " \"" << expr_ << "\"";
+      if (!compiled())
+        out << " (" << why() << ")";
+      if (n_)
+        out << ": " << n_ << " calls, interpreted " << t_interp_ / n_ * 1e9 << " ns/call, compiled " << t_compiled_ / n_ * 1e9 << " ns/call";
+      out << "\n";
+    }
+
+  private:
+    std::string expr_;
+    CompiledCut<T> compiled_;
+    std::shared_ptr<StringCutObjectSelector<T>> interp_;
+    bool check_;
+    mutable unsigned long n_;
+    mutable double t_compiled_;
+    mutable double t_interp_;
+  };
+}
+
+#endif
@@ -0,0 +1,294 @@
+#ifndef JMTucker_Tools_EventIndex_h
+#define JMTucker_Tools_EventIndex_h
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "TBranch.h"
+#include "TFile.h"
+#include "TTree.h"
+
+namespace jmt {
+  // Sorted (run, lumi, event) -> entry table for one tree in one file,
+  // so finding an event is a binary search instead of a scan of the
+  // whole tree. The tree must have run, lumi (unsigned) and event
+  // (unsigned long long) branches, as the MiniTree, MovedTracks and
+  // TrackingTree trees do.
+  //
+  // It is kept in a sidecar file made once per (file, tree), see
+  // sidecar_path, laid out little-endian as
+  //
+  //   char[8]  "JMTEVIX1"
+  //   uint32   version
+  //   uint32   length of the tree path
+  //   uint64   number of entries in the tree
+  //   uint64   number of records
+  //   char[]   tree path, not null-terminated
+  //   records: uint32 run, uint32 lumi, uint64 event, uint64 entry
+  //
+  // with the records sorted by (run, lumi, event, entry). The same
+  // format is read and written by JMTucker/Tools/python/EventIndex.py.
+  class EventIndex {
+  public:
+    typedef std::tuple<unsigned, unsigned, unsigned long long> rle_t;
+
+    struct Record {
+      uint32_t run;
+      uint32_t lumi;
+      uint64_t event;
+      uint64_t entry;
+
+      rle_t rle() const { return rle_t(run, lumi, event); }
+      bool operator<(const Record& o) const { return std::tie(run, lumi, event, entry) < std::tie(o.run, o.lumi, o.event, o.entry); }
+    };
+    static_assert(sizeof(Record) == 24, "EventIndex::Record must be packed");
+
+    static constexpr uint32_t version = 1;
+
+    EventIndex() : nentries_tree_(0) {}
+
+    const std::string& tree_path() const { return tree_path_; }
+    unsigned long long nentries_tree() const { return nentries_tree_; }
+    const std::vector<Record>& records() const { return r_; }
+
+    // Index t by reading only its run, lumi and event branches. t's
+    // branch addresses are reset afterwards.
+    static EventIndex build(TTree* t, const std::string& tree_path) {
+      TBranch* b_run = 0;
+      TBranch* b_lumi = 0;
+      TBranch* b_event = 0;
+      unsigned run, lumi;
+      unsigned long long event;
+      if (t->SetBranchAddress("run", &run, &b_run) < 0 || t->SetBranchAddress("lumi", &lumi, &b_lumi) < 0 || t->SetBranchAddress("event", &event, &b_event) < 0)
+        throw std::runtime_error("jmt::EventIndex: tree " + tree_path + " doesn't have run, lumi and event branches");
+
+      EventIndex x;
+      x.tree_path_ = tree_path;
+      x.nentries_tree_ = t->GetEntries();
+      x.r_.reserve(x.nentries_tree_);
+
+      for (unsigned long long j = 0; j < x.nentries_tree_; ++j) {
+        const long long jl = t->LoadTree(j);
+        if (jl < 0)
+          throw std::runtime_error("jmt::EventIndex: can't load entry " + std::to_string(j) + " of " + tree_path);
+        b_run->GetEntry(jl);
+        b_lumi->GetEntry(jl);
+        b_event->GetEntry(jl);
+        x.r_.push_back({run, lumi, event, j});
+      }
+
+      t->ResetBranchAddresses();
+      std::sort(x.r_.begin(), x.r_.end());
+      return x;
+    }
+
+    // Entries for (run, lumi, event), normally zero or one of them.
+    std::pair<std::vector<Record>::const_iterator, std::vector<Record>::const_iterator> equal_range(const rle_t& rle) const {
+      return std::equal_range(r_.begin(), r_.end(), rle, rle_less());
+    }
+
+    std::vector<unsigned long long> find(unsigned run, unsigned lumi, unsigned long long event) const {
+      std::vector<unsigned long long> entries;
+      const auto er = equal_range(rle_t(run, lumi, event));
+      for (auto it = er.first; it != er.second; ++it)
+        entries.push_back(it->entry);
+      return entries;
+    }
+
+    // False if fn can't be opened, throws if it isn't an index.
+    bool read(const std::string& fn) {
+      std::unique_ptr<FILE, int(*)(FILE*)> f(fopen(fn.c_str(), "rb"), fclose);
+      if (!f)
+        return false;
+
+      char magic[8];
+      uint32_t v, n_path;
+      uint64_t nentries, nrecords;
+      if (fread(magic, 1, 8, f.get()) != 8 || memcmp(magic, "JMTEVIX1", 8) != 0 ||
+          fread(&v, 4, 1, f.get()) != 1 || fread(&n_path, 4, 1, f.get()) != 1 ||
+          fread(&nentries, 8, 1, f.get()) != 1 || fread(&nrecords, 8, 1, f.get()) != 1)
+        throw std::runtime_error("jmt::EventIndex: " + fn + " isn't an event index");
+      if (v != version)
+        throw std::runtime_error("jmt::EventIndex: " + fn + " has version " + std::to_string(v) + ", expected " + std::to_string(version));
+
+      std::string path(n_path, '\0');
+      std::vector<Record> r(nrecords);
+      if (fread(&path[0], 1, n_path, f.get()) != n_path || fread(r.data(), sizeof(Record), nrecords, f.get()) != nrecords)
+        throw std::runtime_error("jmt::EventIndex: " + fn + " is truncated");
+
+      tree_path_ = path;
+      nentries_tree_ = nentries;
+      r_.swap(r);
+      return true;
+    }
+
+    // False if fn can't be written. It goes to a temporary file first so
+    // that a reader never sees half of one.
+    bool write(const std::string& fn) const {
+      const std::string tmp_fn = fn + ".tmp" + std::to_string(getpid());
+      FILE* f = fopen(tmp_fn.c_str(), "wb");
+      if (!f)
+        return false;
+
+      const uint32_t v = version, n_path = tree_path_.size();
+      const uint64_t nentries = nentries_tree_, nrecords = r_.size();
+      bool ok =
+        fwrite("JMTEVIX1", 1, 8, f) == 8 &&
+        fwrite(&v, 4, 1, f) == 1 && fwrite(&n_path, 4, 1, f) == 1 &&
+        fwrite(&nentries, 8, 1, f) == 1 && fwrite(&nrecords, 8, 1, f) == 1 &&
+        fwrite(tree_path_.data(), 1, n_path, f) == n_path &&
+        fwrite(r_.data(), sizeof(Record), nrecords, f) == nrecords;
+      ok = fclose(f) == 0 && ok;
+      if (!ok || rename(tmp_fn.c_str(), fn.c_str()) != 0) {
+        remove(tmp_fn.c_str());
+        return false;
+      }
+      return true;
+    }
+
+    // Where the index for tree_path in fn lives: next to a local file,
+    // and for remote ones (xrootd urls and /store paths) in
+    // $JMT_EVIDX_DIR, default the current directory, under the full
+    // name with the slashes replaced.
+    static std::string sidecar_path(const std::string& fn, const std::string& tree_path) {
+      const std::string suffix = "." + sanitize(tree_path) + ".evidx";
+      if (!is_remote(fn))
+        return fn + suffix;
+      const char* dir = getenv("JMT_EVIDX_DIR");
+      return std::string(dir && *dir ? dir : ".") + "/" + sanitize(fn) + suffix;
+    }
+
+    // The index for tree_path in fn from its sidecar, or if there is
+    // none or (for a local file) it is older than fn, built from the
+    // tree and saved to the sidecar if possible.
+    static EventIndex for_file(const std::string& fn, const std::string& tree_path, bool save=true) {
+      const std::string sc = sidecar_path(fn, tree_path);
+      EventIndex x;
+      if (!is_stale(fn, sc) && x.read(sc) && x.tree_path_ == tree_path)
+        return x;
+
+      std::unique_ptr<TFile> f(TFile::Open(fn.c_str()));
+      if (!f || !f->IsOpen())
+        throw std::runtime_error("jmt::EventIndex: can't open " + fn);
+      TTree* t = (TTree*)f->Get(tree_path.c_str());
+      if (!t)
+        throw std::runtime_error("jmt::EventIndex: no tree " + tree_path + " in " + fn);
+
+      x = build(t, tree_path);
+      if (save && !x.write(sc))
+        fprintf(stderr, "jmt::EventIndex: warning: couldn't write %s\n", sc.c_str());
+      return x;
+    }
+
+  private:
+    struct rle_less {
+      bool operator()(const Record& r, const rle_t& k) const { return r.rle() < k; }
+      bool operator()(const rle_t& k, const Record& r) const { return k < r.rle(); }
+    };
+
+    static bool is_remote(const std::string& fn) {
+      return fn.find("://") != std::string::npos || fn.compare(0, 7, "/store/") == 0;
+    }
+
+    static std::string sanitize(std::string s) {
+      for (char& c : s)
+        if (c == '/' || c == ':')
+          c = '_';
+      return s;
+    }
+
+    static bool is_stale(const std::string& fn, const std::string& sc) {
+      struct stat st_fn, st_sc;
+      if (is_remote(fn) || stat(fn.c_str(), &st_fn) != 0 || stat(sc.c_str(), &st_sc) != 0)
+        return false;
+      return st_sc.st_mtime < st_fn.st_mtime;
+    }
+
+    std::string tree_path_;
+    unsigned long long nentries_tree_;
+    std::vector<Record> r_;
+  };
+
+  // The indices of the same tree in many files, merged into one table
+  // so that each lookup is one binary search over all of them.
+  class EventIndexSet {
+  public:
+    struct Match {
+      EventIndex::rle_t rle;
+      size_t ifile;
+      unsigned long long entry;
+    };
+
+    explicit EventIndexSet(const std::string& tree_path) : tree_path_(tree_path) {}
+
+    const std::string& tree_path() const { return tree_path_; }
+    size_t nfiles() const { return fns_.size(); }
+    const std::string& fn(size_t i) const { return fns_[i]; }
+    size_t size() const { return r_.size(); }
+
+    void add(const std::string& fn, bool save=true) {
+      const EventIndex x = EventIndex::for_file(fn, tree_path_, save);
+      const size_t ifile = fns_.size();
+      fns_.push_back(fn);
+      const size_t n0 = r_.size();
+      for (const EventIndex::Record& r : x.records())
+        r_.push_back({r, ifile});
+      std::inplace_merge(r_.begin(), r_.begin() + n0, r_.end());
+    }
+
+    void add(const std::vector<std::string>& fns, bool save=true) {
+      for (const std::string& fn : fns) {
+        const EventIndex x = EventIndex::for_file(fn, tree_path_, save);
+        const size_t ifile = fns_.size();
+        fns_.push_back(fn);
+        for (const EventIndex::Record& r : x.records())
+          r_.push_back({r, ifile});
+      }
+      std::sort(r_.begin(), r_.end());
+    }
+
+    std::vector<Match> find(const EventIndex::rle_t& rle) const {
+      std::vector<Match> m;
+      const auto er = std::equal_range(r_.begin(), r_.end(), rle, rle_less());
+      for (auto it = er.first; it != er.second; ++it)
+        m.push_back({rle, it->ifile, it->r.entry});
+      return m;
+    }
+
+    std::vector<Match> find(const std::vector<EventIndex::rle_t>& rles) const {
+      std::vector<Match> m;
+      for (const EventIndex::rle_t& rle : rles) {
+        const std::vector<Match> mi = find(rle);
+        m.insert(m.end(), mi.begin(), mi.end());
+      }
+      return m;
+    }
+
+  private:
+    struct FileRecord {
+      EventIndex::Record r;
+      size_t ifile;
+      bool operator<(const FileRecord& o) const { return std::tie(r.run, r.lumi, r.event, ifile, r.entry) < std::tie(o.r.run, o.r.lumi, o.r.event, o.ifile, o.r.entry); }
+    };
+
+    struct rle_less {
+      bool operator()(const FileRecord& r, const EventIndex::rle_t& k) const { return r.r.rle() < k; }
+      bool operator()(const EventIndex::rle_t& k, const FileRecord& r) const { return k < r.r.rle(); }
+    };
+
+    const std::string tree_path_;
+    std::vector<std::string> fns_;
+    std::vector<FileRecord> r_;
+  };
+}
+
+#endif
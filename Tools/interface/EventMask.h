@@ -0,0 +1,428 @@
+#ifndef JMTucker_Tools_EventMask_h
+#define JMTucker_Tools_EventMask_h
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <regex>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <zlib.h>
+
+namespace jmt {
+  // The contents of fn, gunzipped in-process if it is gzipped (zlib
+  // passes plain files through as they are).
+  inline std::string read_maybe_gzipped(const std::string& fn) {
+    gzFile f = gzopen(fn.c_str(), "rb");
+    if (!f)
+      throw std::runtime_error("jmt::read_maybe_gzipped: can't open " + fn);
+    gzbuffer(f, 1 << 17);
+    std::string s;
+    char buf[1 << 16];
+    int n;
+    while ((n = gzread(f, buf, sizeof(buf))) > 0)
+      s.append(buf, n);
+    const bool ok = n == 0;
+    gzclose(f);
+    if (!ok)
+      throw std::runtime_error("jmt::read_maybe_gzipped: error reading " + fn);
+    return s;
+  }
+
+  // A lumi mask (as from a JSON) and/or a list of events to veto or
+  // accept, compiled into sorted arrays indexed by run: the runs, and
+  // for each run a block of merged lumi ranges and a block of (lumi,
+  // event) pairs. A query is a binary search in the runs and one in the
+  // run's block, done as branch-free as possible (the comparisons turn
+  // into conditional moves, and the number of steps only depends on the
+  // block size), so there are no tree walks or pointer chasing per
+  // event as with std::set or LumiList.
+  //
+  // Events can also be listed without their run (as EventIdVeto does
+  // for MC with use_run = False); they are then kept under run 0 and
+  // match in any run.
+  //
+  // Made by EventMaskBuilder, or read from the binary file it writes
+  // (Tools/test/EventIds/event_mask.exe compiles one), laid out
+  // little-endian as
+  //
+  //   char[8]  "JMTEVMK1"
+  //   uint32   version
+  //   uint32   flags: event mode (bits 0-1), has lumis (bit 2), events without runs (bit 3)
+  //   uint64   number of runs, of lumi ranges, of events
+  //   uint32   runs[nruns]
+  //   uint32   range_begin[nruns+1]
+  //   uint64   event_begin[nruns+1]
+  //   uint32   range_lo[nranges], range_hi[nranges]
+  //   uint32   event_lumi[nevents]
+  //   uint64   event_event[nevents]
+  //
+  // The file can be gzipped.
+  class EventMask {
+  public:
+    enum event_mode_t { events_none = 0, events_veto = 1, events_accept = 2 };
+    static constexpr uint32_t version = 1;
+
+    EventMask() : mode_(events_none), has_lumis_(false), events_any_run_(false), range_begin_(1, 0), event_begin_(1, 0) {}
+
+    event_mode_t event_mode() const { return mode_; }
+    bool has_lumis() const { return has_lumis_; }
+    bool has_events() const { return mode_ != events_none; }
+    bool events_any_run() const { return events_any_run_; }
+    size_t nruns() const { return runs_.size(); }
+    size_t nranges() const { return range_lo_.size(); }
+    size_t nevents() const { return event_lumi_.size(); }
+
+    // Whether (run, lumi) is in the lumi mask.
+    bool contains_lumi(unsigned run, unsigned lumi) const {
+      const size_t ir = find_run(run);
+      if (ir == size_t(-1))
+        return false;
+      const uint32_t b = range_begin_[ir], n = range_begin_[ir+1] - b;
+      if (n == 0)
+        return false;
+      const size_t k = count_le(range_lo_.data() + b, n, uint32_t(lumi));
+      return (k > 0) & (lumi <= range_hi_[b + k - (k > 0)]);
+    }
+
+    // Whether the event is in the event list.
+    bool contains_event(unsigned run, unsigned lumi, unsigned long long event) const {
+      const size_t ir = find_run(events_any_run_ ? 0 : run);
+      if (ir == size_t(-1))
+        return false;
+      const uint64_t b = event_begin_[ir], n = event_begin_[ir+1] - b;
+      if (n == 0)
+        return false;
+      const uint32_t* L = event_lumi_.data() + b;
+      const uint64_t* E = event_event_.data() + b;
+      size_t i = 0;
+      for (size_t m = n; m > 1; ) {
+        const size_t half = m / 2;
+        const size_t j = i + half;
+        i = (L[j] < lumi) | ((L[j] == lumi) & (E[j] <= event)) ? j : i;
+        m -= half;
+      }
+      return (L[i] == lumi) & (E[i] == event);
+    }
+
+    template <typename T>
+    bool contains_lumi(const T& t) const { return contains_lumi(t.run, t.lumi); }
+
+    // Whether to keep the event: in the lumi mask if there is one, and
+    // not vetoed or accepted, by the event list if there is one.
+    bool accept(unsigned run, unsigned lumi, unsigned long long event) const {
+      if (has_lumis_ && !contains_lumi(run, lumi))
+        return false;
+      switch (mode_) {
+      case events_veto:   return !contains_event(run, lumi, event);
+      case events_accept: return  contains_event(run, lumi, event);
+      default:            return true;
+      }
+    }
+
+    static bool is_compiled(const std::string& s) { return s.size() >= 8 && memcmp(s.data(), "JMTEVMK1", 8) == 0; }
+
+    // From the contents of a file written by write().
+    void read_buffer(const std::string& s, const std::string& fn) {
+      size_t pos = 0;
+      auto get = [&](void* p, size_t n) {
+        if (s.size() - pos < n)
+          throw std::runtime_error("jmt::EventMask: " + fn + " is truncated");
+        memcpy(p, s.data() + pos, n);
+        pos += n;
+      };
+      auto get_vector = [&](auto& v, size_t n) {
+        v.resize(n);
+        get(v.data(), n * sizeof(v[0]));
+      };
+
+      if (!is_compiled(s))
+        throw std::runtime_error("jmt::EventMask: " + fn + " isn't a compiled event mask");
+      pos = 8;
+      uint32_t v, flags;
+      uint64_t nruns, nranges, nevents;
+      get(&v, 4);
+      if (v != version)
+        throw std::runtime_error("jmt::EventMask: " + fn + " has version " + std::to_string(v) + ", expected " + std::to_string(version));
+      get(&flags, 4);
+      get(&nruns, 8);
+      get(&nranges, 8);
+      get(&nevents, 8);
+
+      mode_ = event_mode_t(flags & 3);
+      has_lumis_ = flags & 4;
+      events_any_run_ = flags & 8;
+      get_vector(runs_, nruns);
+      get_vector(range_begin_, nruns + 1);
+      get_vector(event_begin_, nruns + 1);
+      get_vector(range_lo_, nranges);
+      get_vector(range_hi_, nranges);
+      get_vector(event_lumi_, nevents);
+      get_vector(event_event_, nevents);
+      if (pos != s.size())
+        throw std::runtime_error("jmt::EventMask: " + fn + " has trailing junk");
+    }
+
+    void read(const std::string& fn) { read_buffer(read_maybe_gzipped(fn), fn); }
+
+    // Write the compiled mask to fn, gzipped if fn ends in .gz.
+    void write(const std::string& fn) const {
+      const bool gz = fn.size() > 3 && fn.compare(fn.size() - 3, 3, ".gz") == 0;
+      gzFile f = gzopen(fn.c_str(), gz ? "wb6" : "wbT");
+      if (!f)
+        throw std::runtime_error("jmt::EventMask: can't write " + fn);
+      bool ok = true;
+      auto put = [&](const void* p, size_t n) { if (n) ok = ok && gzwrite(f, p, unsigned(n)) == int(n); };
+      auto put_vector = [&](const auto& v) { put(v.data(), v.size() * sizeof(v[0])); };
+
+      const uint32_t v = version, flags = uint32_t(mode_) | (has_lumis_ ? 4 : 0) | (events_any_run_ ? 8 : 0);
+      const uint64_t n[3] = { runs_.size(), range_lo_.size(), event_lumi_.size() };
+      put("JMTEVMK1", 8);
+      put(&v, 4);
+      put(&flags, 4);
+      put(n, sizeof(n));
+      put_vector(runs_);
+      put_vector(range_begin_);
+      put_vector(event_begin_);
+      put_vector(range_lo_);
+      put_vector(range_hi_);
+      put_vector(event_lumi_);
+      put_vector(event_event_);
+      ok = gzclose(f) == Z_OK && ok;
+      if (!ok)
+        throw std::runtime_error("jmt::EventMask: error writing " + fn);
+    }
+
+    // A compiled mask, a lumi JSON, or an event list (see
+    // EventMaskBuilder::add_events) to be used as mode says, any of them
+    // possibly gzipped.
+    static EventMask from_file(const std::string& fn, event_mode_t mode=events_veto, bool use_run=true);
+
+  private:
+    friend class EventMaskBuilder;
+
+    // Number of elements of the sorted a[0..n) that are <= x.
+    template <typename T>
+    static size_t count_le(const T* a, size_t n, T x) {
+      if (n == 0)
+        return 0;
+      const T* base = a;
+      while (n > 1) {
+        const size_t half = n / 2;
+        base = base[half] <= x ? base + half : base;
+        n -= half;
+      }
+      return (base - a) + (*base <= x);
+    }
+
+    size_t find_run(unsigned run) const {
+      const size_t k = count_le(runs_.data(), runs_.size(), uint32_t(run));
+      return k > 0 && runs_[k-1] == run ? k - 1 : size_t(-1);
+    }
+
+    event_mode_t mode_;
+    bool has_lumis_;
+    bool events_any_run_;
+    std::vector<uint32_t> runs_;
+    std::vector<uint32_t> range_begin_;
+    std::vector<uint64_t> event_begin_;
+    std::vector<uint32_t> range_lo_;
+    std::vector<uint32_t> range_hi_;
+    std::vector<uint32_t> event_lumi_;
+    std::vector<uint64_t> event_event_;
+  };
+
+  // Collects lumi ranges and events and compiles them into an EventMask.
+  class EventMaskBuilder {
+  public:
+    EventMaskBuilder() : events_any_run_(-1), nskipped_(0) {}
+
+    void add_lumis(unsigned run, unsigned first, unsigned last) {
+      if (last < first)
+        throw std::runtime_error("jmt::EventMaskBuilder: bad lumi range " + std::to_string(first) + "-" + std::to_string(last) + " in run " + std::to_string(run));
+      lumis_[run].push_back(std::make_pair(first, last));
+    }
+
+    // A lumi JSON as used by crab and LumiList, {"run": [[first, last], ...], ...}.
+    void add_json_buffer(const std::string& s, const std::string& fn) {
+      static const std::regex run_re("\\s*(\\d+)\\s*");
+      static const std::regex range_re("\\[\\s*(\\d+)\\s*,\\s*(\\d+)\\s*\\]");
+      std::smatch m;
+      long long run = -1;
+      size_t b = 0;
+      for (size_t e; b < s.size(); b = e + 1) {
+        e = s.find('"', b);
+        if (e == std::string::npos)
+          e = s.size();
+        const std::string tok = s.substr(b, e - b);
+        if (std::regex_match(tok, m, run_re))
+          run = std::stoll(m[1]);
+        else
+          for (auto it = std::sregex_iterator(tok.begin(), tok.end(), range_re), ite = std::sregex_iterator(); it != ite; ++it) {
+            if (run < 0)
+              throw std::runtime_error("jmt::EventMaskBuilder: lumi range before any run in " + fn);
+            add_lumis(unsigned(run), std::stoul((*it)[1]), std::stoul((*it)[2]));
+          }
+      }
+    }
+
+    void add_json(const std::string& fn) { add_json_buffer(read_maybe_gzipped(fn), fn); }
+
+    void add_event(unsigned run, unsigned lumi, unsigned long long event) {
+      set_any_run(false);
+      events_.push_back(std::make_tuple(run, lumi, event));
+    }
+
+    void add_event(unsigned lumi, unsigned long long event) {
+      set_any_run(true);
+      events_.push_back(std::make_tuple(0U, lumi, event));
+    }
+
+    // An event list with one event per line, as (run,lumi,event), if
+    // use_run, or (lumi,event): lines starting with a number or "(" give
+    // their first three or two numbers, and anything after those (e.g.
+    // a trailing comment) is ignored, as with the old sscanf reader.
+    // Other non-blank lines, and ones with too few numbers, are skipped
+    // and counted in nskipped(). Returns the number of events read.
+    size_t add_events_buffer(const std::string& s, bool use_run) {
+      const size_t n0 = events_.size();
+      const int nwant = use_run ? 3 : 2;
+      const char* p = s.data();
+      const char* const pe = p + s.size();
+      while (p < pe) {
+        const char* const eol = std::find(p, pe, '\n');
+        while (p < eol && (*p == ' ' || *p == '\t' || *p == '\r'))
+          ++p;
+
+        if (p < eol) {
+          unsigned long long x[3];
+          int nx = 0;
+          if (*p == '(' || (*p >= '0' && *p <= '9')) {
+            while (p < eol && nx < nwant)
+              if (*p >= '0' && *p <= '9') {
+                unsigned long long y = 0;
+                for (; p < eol && *p >= '0' && *p <= '9'; ++p)
+                  y = y * 10 + (*p - '0');
+                x[nx++] = y;
+              }
+              else
+                ++p;
+          }
+
+          if (nx < nwant)
+            ++nskipped_;
+          else if (use_run)
+            add_event(unsigned(x[0]), unsigned(x[1]), x[2]);
+          else
+            add_event(unsigned(x[0]), x[1]);
+        }
+
+        p = eol < pe ? eol + 1 : pe;
+      }
+      return events_.size() - n0;
+    }
+
+    size_t add_events(const std::string& fn, bool use_run) { return add_events_buffer(read_maybe_gzipped(fn), use_run); }
+
+    size_t nevents() const { return events_.size(); }
+    size_t nskipped() const { return nskipped_; }
+
+    EventMask compile(EventMask::event_mode_t mode) const {
+      if (mode != EventMask::events_none && events_.empty())
+        throw std::runtime_error("jmt::EventMaskBuilder: event mode given but no events");
+
+      // Merge the overlapping and adjacent lumi ranges of each run.
+      std::map<unsigned, std::vector<std::pair<unsigned, unsigned>>> lumis;
+      for (const auto& p : lumis_) {
+        std::vector<std::pair<unsigned, unsigned>> v = p.second;
+        std::sort(v.begin(), v.end());
+        std::vector<std::pair<unsigned, unsigned>>& merged = lumis[p.first];
+        for (const auto& r : v)
+          if (!merged.empty() && (unsigned long long)(r.first) <= (unsigned long long)(merged.back().second) + 1)
+            merged.back().second = std::max(merged.back().second, r.second);
+          else
+            merged.push_back(r);
+      }
+
+      std::vector<std::tuple<unsigned, unsigned, unsigned long long>> events;
+      if (mode != EventMask::events_none) {
+        events = events_;
+        std::sort(events.begin(), events.end());
+        events.erase(std::unique(events.begin(), events.end()), events.end());
+      }
+
+      std::vector<unsigned> runs;
+      for (const auto& p : lumis)
+        runs.push_back(p.first);
+      for (const auto& e : events)
+        runs.push_back(std::get<0>(e));
+      std::sort(runs.begin(), runs.end());
+      runs.erase(std::unique(runs.begin(), runs.end()), runs.end());
+
+      EventMask x;
+      x.mode_ = mode;
+      x.has_lumis_ = !lumis_.empty();
+      x.events_any_run_ = mode != EventMask::events_none && events_any_run_ == 1;
+      x.runs_.assign(runs.begin(), runs.end());
+      x.range_begin_.assign(1, 0);
+      x.event_begin_.assign(1, 0);
+
+      size_t ie = 0;
+      for (unsigned run : runs) {
+        auto it = lumis.find(run);
+        if (it != lumis.end())
+          for (const auto& r : it->second) {
+            x.range_lo_.push_back(r.first);
+            x.range_hi_.push_back(r.second);
+          }
+        for (; ie < events.size() && std::get<0>(events[ie]) == run; ++ie) {
+          x.event_lumi_.push_back(std::get<1>(events[ie]));
+          x.event_event_.push_back(std::get<2>(events[ie]));
+        }
+        x.range_begin_.push_back(x.range_lo_.size());
+        x.event_begin_.push_back(x.event_lumi_.size());
+      }
+
+      return x;
+    }
+
+  private:
+    void set_any_run(bool any) {
+      if (events_any_run_ == -1)
+        events_any_run_ = any;
+      else if (events_any_run_ != int(any))
+        throw std::runtime_error("jmt::EventMaskBuilder: can't mix events with and without runs");
+    }
+
+    std::map<unsigned, std::vector<std::pair<unsigned, unsigned>>> lumis_;
+    std::vector<std::tuple<unsigned, unsigned, unsigned long long>> events_;
+    int events_any_run_;
+    size_t nskipped_;
+  };
+
+  inline EventMask EventMask::from_file(const std::string& fn, event_mode_t mode, bool use_run) {
+    const std::string s = read_maybe_gzipped(fn);
+    EventMask x;
+    if (is_compiled(s))
+      x.read_buffer(s, fn);
+    else {
+      EventMaskBuilder b;
+      const size_t i = s.find_first_not_of(" \t\r\n");
+      if (i != std::string::npos && s[i] == '{') {
+        b.add_json_buffer(s, fn);
+        x = b.compile(events_none);
+      }
+      else {
+        b.add_events_buffer(s, use_run);
+        x = b.compile(b.nevents() ? mode : events_none);
+      }
+    }
+    return x;
+  }
+}
+
+#endif
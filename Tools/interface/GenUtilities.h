@@ -5,6 +5,7 @@
 #include "DataFormats/HepMCCandidate/interface/GenParticleFwd.h"
 #include "DataFormats/JetReco/interface/GenJet.h"
 #include "FWCore/Framework/interface/Frameworkfwd.h"
+#include "JMTucker/Formats/interface/GenDecayGraph.h"
 
 double track_qoverp(const reco::Candidate* c);
 double track_lambda(const reco::Candidate* c);
@@ -27,6 +28,7 @@ bool is_bhadron(const int id);
 bool is_bhadron(const reco::Candidate* c);
 int original_index(const reco::Candidate* c, const reco::GenParticleCollection& gens);
 reco::GenParticleRef gen_ref(const reco::Candidate* c, const edm::Handle<reco::GenParticleCollection>& gens);
+reco::GenParticleRef gen_ref(int i, const edm::Handle<reco::GenParticleCollection>& gens);
 bool is_ancestor_of(const reco::Candidate* c, const reco::Candidate* possible_ancestor);
 bool is_ancestor_of(const reco::Candidate* c, const std::vector<const reco::Candidate*>& possible_ancestors);
 bool has_any_ancestor_such_that(const reco::Candidate* c, std::function<bool(const reco::Candidate*)> such_that);
@@ -50,6 +52,7 @@ const reco::Candidate* final_candidate(const reco::GenParticleRef& c, int allowe
 void print_gen_and_daus(const reco::Candidate* c, const char* name, const reco::GenParticleCollection& gens, const bool print_daus=true, const bool print_vtx=false);
 void print_gen_and_daus(const reco::GenParticleRef c, const char* name, const reco::GenParticleCollection& gens, const bool print_daus=true, const bool print_vtx=false);
 int gen_jet_id(const reco::GenJet& jet);
+int gen_jet_id(const reco::GenJet& jet, const jmt::GenDecayGraph& graph, const reco::GenParticleCollection& gens, const jmt::GenDecayGraph::mask_t& bhadrons, const jmt::GenDecayGraph::mask_t& chadrons);
 
 template <typename T>
 std::vector<const reco::GenParticle*> constituents_from_ancestors(const reco::GenJet& gen_jet, const T& ancestors) {
@@ -0,0 +1,66 @@
+#ifndef JMTucker_Tools_L1ECALPrefiringMap_h
+#define JMTucker_Tools_L1ECALPrefiringMap_h
+
+#include <algorithm>
+
+namespace jmt {
+  // An axis as TAxis::FindBin sees it: bins 1..n, with 0 and n+1 for
+  // under/overflow. With edges null it's a fixed-width axis and uses
+  // the same arithmetic as TAxis; otherwise it's a search of the n+1
+  // edges like TMath::BinarySearch.
+  struct BinnedAxis {
+    int n;
+    double lo;
+    double hi;
+    const double* edges;
+
+    int find(double x) const {
+      if (x < lo)
+        return 0;
+      if (!(x < hi))
+        return n+1;
+      if (!edges)
+        return 1 + int(n * (x - lo) / (hi - lo));
+      return int(std::upper_bound(edges, edges + n + 1, x) - edges);
+    }
+  };
+
+  // Table version of one of the L1 prefiring TH2Fs, eta on x and pt on
+  // y. content and error are indexed by the TH2 global bin, (n_x+2)*iy
+  // + ix, flows included, so the data can be written straight out of
+  // the histogram, cf. Tools/plugins/L1ECALPrefiringWeightTables.h.
+  struct L1ECALPrefiringMap {
+    struct rate_t {
+      double central;
+      double up;
+      double down;
+      double operator[](int i) const { return i == 0 ? central : i == 1 ? up : down; }
+    };
+
+    BinnedAxis x;
+    BinnedAxis y;
+    const float* content;
+    const double* error;
+
+    int find_bin(double eta, double pt) const {
+      return (x.n + 2) * y.find(pt) + x.find(eta);
+    }
+
+    // Same as the producer's old GetPrefiringRate for each of the three
+    // fluctuations: pt above the map is taken from the last bin, and up
+    // and down are the bin error or the flat systematic on the rate,
+    // whichever is bigger, kept inside [0,1].
+    rate_t rate(double eta, double pt, double syst) const {
+      if (pt >= y.hi)
+        pt = y.hi - 0.01;
+      const int bin = find_bin(eta, pt);
+      const double p = content[bin];
+      const double e = error[bin];
+      return rate_t{p,
+                    std::min(std::max(p + e, (1 + syst) * p), 1.),
+                    std::max(std::min(p - e, (1 - syst) * p), 0.)};
+    }
+  };
+}
+
+#endif
@@ -2,8 +2,11 @@
 #define JMTucker_Tools_LumiList_h
 
 #include <fstream>
+#include <iostream>
+#include <map>
 #include <regex>
 #include <string>
+#include <vector>
 
 namespace jmt {
   class LumiList {
@@ -48,6 +51,13 @@ namespace jmt {
       return false;
     }
 
+    std::vector<unsigned> runs() const {
+      std::vector<unsigned> r;
+      for (const auto& p : _map)
+        r.push_back(p.first);
+      return r;
+    }
+
     template <typename T>
     bool contains(const T& t) const {
       return contains(int(t.run), int(t.lumi));
@@ -0,0 +1,154 @@
+#ifndef JMTucker_Tools_MonotoneRemap_h
+#define JMTucker_Tools_MonotoneRemap_h
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+namespace jmt {
+  // A CDF tabulated from a pdf on [xmin, xmax], normalized to go from 0
+  // to 1, by Simpson's rule on n intervals (n even), and evaluated
+  // with the quadratic through each pair of intervals.
+  class TabulatedCdf {
+  public:
+    template <typename F>
+    TabulatedCdf(F pdf, double xmin, double xmax, int n=10000)
+      : xmin_(xmin), xmax_(xmax), n_(std::max(2, n + n % 2)), h_((xmax - xmin) / n_), p_(n_+1), c_(n_/2+1, 0.)
+    {
+      for (int i = 0; i <= n_; ++i)
+        p_[i] = pdf(xmin_ + i * h_);
+      for (int k = 1; k <= n_/2; ++k)
+        c_[k] = c_[k-1] + h_ / 3 * (p_[2*k-2] + 4 * p_[2*k-1] + p_[2*k]);
+      const double norm = c_.back();
+      if (!(norm > 0))
+        throw std::runtime_error("jmt::TabulatedCdf: pdf does not integrate to a positive number");
+      for (double& c : c_) c /= norm;
+      for (double& p : p_) p /= norm;
+    }
+
+    double xmin() const { return xmin_; }
+    double xmax() const { return xmax_; }
+
+    double operator()(double x) const {
+      if (x <= xmin_) return 0;
+      if (x >= xmax_) return 1;
+      const int k = std::min(int((x - xmin_) / (2 * h_)), n_/2 - 1);
+      // integral from the start of the pair of intervals of the quadratic through p0, p1, p2
+      const double t = (x - xmin_ - 2 * k * h_) / h_;
+      const double p0 = p_[2*k], p1 = p_[2*k+1], p2 = p_[2*k+2];
+      const double a = p0, b = (-3*p0 + 4*p1 - p2) / 2, c = (p0 - 2*p1 + p2) / 2;
+      return std::min(1., c_[k] + h_ * t * (a + t * (b / 2 + t * c / 3)));
+    }
+
+  private:
+    double xmin_, xmax_;
+    int n_;
+    double h_;
+    std::vector<double> p_, c_;
+  };
+
+  // The map x -> G^-1(F(x)) taking a variable distributed with CDF F on
+  // [xmin, xmax] to one distributed with CDF G on [ymin, ymax], e.g. to
+  // vary the shape of a distribution being sampled without changing the
+  // sampling. F and G must be non-decreasing and go from 0 to 1 over
+  // their ranges.
+  //
+  // The map is tabulated at npoints evenly spaced x, with G^-1 found by
+  // bisection, and interpolated with a monotone (Fritsch-Carlson) cubic,
+  // so it costs a few multiplications per call. At construction it is
+  // compared to the exact map halfway between the grid points; the grid
+  // is doubled until the largest difference is below tolerance * (ymax
+  // - ymin), and if that takes more than max_npoints an exception is
+  // thrown (e.g. if G has a flat stretch, where G^-1 jumps).
+  class MonotoneRemap {
+  public:
+    template <typename F, typename G>
+    MonotoneRemap(F cdf_from, double xmin, double xmax, G cdf_to, double ymin, double ymax,
+                  double tolerance=1e-6, int npoints=1025, int max_npoints=(1<<20)+1)
+      : xmin_(xmin), xmax_(xmax), max_error_(0)
+    {
+      auto exact = [&](double x) {
+        const double u = cdf_from(x);
+        double lo = ymin, hi = ymax;
+        for (int i = 0; i < 100 && hi - lo > 1e-15 * (ymax - ymin); ++i) {
+          const double mid = (lo + hi) / 2;
+          if (cdf_to(mid) < u) lo = mid;
+          else hi = mid;
+        }
+        return (lo + hi) / 2;
+      };
+
+      const double tol = tolerance * (ymax - ymin);
+      for (int n = std::max(npoints, 3); ; n = 2*n - 1) {
+        build(exact, n);
+        max_error_ = 0;
+        for (int i = 0; i+1 < n; ++i) {
+          const double x = xmin_ + (i + 0.5) * h_;
+          max_error_ = std::max(max_error_, std::fabs((*this)(x) - exact(x)));
+        }
+        if (max_error_ <= tol)
+          break;
+        if (2*n - 1 > max_npoints) {
+          char msg[256];
+          snprintf(msg, sizeof msg, "jmt::MonotoneRemap: max error %g with %i points, tolerance %g", max_error_, n, tol);
+          throw std::runtime_error(msg);
+        }
+      }
+    }
+
+    // Convenience for two TabulatedCdfs.
+    MonotoneRemap(const TabulatedCdf& from, const TabulatedCdf& to, double tolerance=1e-6)
+      : MonotoneRemap(from, from.xmin(), from.xmax(), to, to.xmin(), to.xmax(), tolerance) {}
+
+    int npoints() const { return int(y_.size()); }
+    double max_error() const { return max_error_; }
+
+    double operator()(double x) const {
+      if (x <= xmin_) return y_.front();
+      if (x >= xmax_) return y_.back();
+      const int i = std::min(int((x - xmin_) / h_), int(y_.size()) - 2);
+      const double t = (x - xmin_) / h_ - i;
+      const double t2 = t*t, t3 = t2*t;
+      return (2*t3 - 3*t2 + 1) * y_[i] + (t3 - 2*t2 + t) * h_ * m_[i] + (-2*t3 + 3*t2) * y_[i+1] + (t3 - t2) * h_ * m_[i+1];
+    }
+
+  private:
+    template <typename E>
+    void build(E& exact, int n) {
+      h_ = (xmax_ - xmin_) / (n - 1);
+      y_.resize(n);
+      m_.assign(n, 0.);
+      for (int i = 0; i < n; ++i)
+        y_[i] = exact(xmin_ + i * h_);
+
+      std::vector<double> d(n-1);
+      for (int i = 0; i+1 < n; ++i)
+        d[i] = (y_[i+1] - y_[i]) / h_;
+      m_[0] = d[0];
+      m_[n-1] = d[n-2];
+      for (int i = 1; i+1 < n; ++i)
+        m_[i] = d[i-1] * d[i] <= 0 ? 0 : (d[i-1] + d[i]) / 2;
+      for (int i = 0; i+1 < n; ++i) {
+        if (d[i] == 0) {
+          m_[i] = m_[i+1] = 0;
+          continue;
+        }
+        const double a = m_[i] / d[i], b = m_[i+1] / d[i];
+        const double s = a*a + b*b;
+        if (s > 9) {
+          const double tau = 3 / std::sqrt(s);
+          m_[i] = tau * a * d[i];
+          m_[i+1] = tau * b * d[i];
+        }
+      }
+    }
+
+    double xmin_, xmax_, h_;
+    std::vector<double> y_, m_;
+    double max_error_;
+  };
+}
+
+#endif
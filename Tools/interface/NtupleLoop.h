@@ -0,0 +1,309 @@
+#ifndef JMTucker_Tools_NtupleLoop_h
+#define JMTucker_Tools_NtupleLoop_h
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "TArrayC.h"
+#include "TArrayD.h"
+#include "TArrayS.h"
+#include "TDirectory.h"
+#include "TFile.h"
+#include "TH1.h"
+#include "TList.h"
+#include "TROOT.h"
+#include "TString.h"
+#include "TTree.h"
+#include "JMTucker/Tools/interface/EventMask.h"
+#include "JMTucker/Tools/interface/PileupWeights.h"
+
+namespace jmt {
+  // What the loop needs to know about each entry of the ntuple.
+  struct NtupleEntryInfo {
+    unsigned run;
+    unsigned lumi;
+    int npu;
+    double weight; // the weight stored in the tree, if any
+  };
+
+  struct NtupleLoopOptions {
+    std::string json;         // lumi mask, for data: JSON or compiled EventMask, maybe gzipped
+    float nevents_frac = 1;   // only run on this fraction of the entries
+    std::string pu_weights;   // PileupWeights key or fn.root:hist, for MC
+    bool tree_weight = false; // multiply in NtupleEntryInfo::weight, for MC
+    int nthreads = 1;         // 0 for one per core, as many as fit in max_hists_mb
+    double max_hists_mb = 2000; // what all the threads' copies of the histograms may take
+    unsigned long long progress_every = 25000;
+  };
+
+  // The event loop of the standalone ntuple histogramming programs.
+  //
+  // It opens the input and the output (skipped if out_fn starts with
+  // "n/a"), copies mcStat/h_sums into mfvWeight/ with h_norm next to
+  // it, and in run() loops over the entries, skipping those not in the
+  // lumi mask and computing the tree and pileup weights, and reports
+  // progress. The entries are split into chunks handed out to nthreads
+  // threads, each with its own copy of the input file, tree and
+  // ntuple.
+  //
+  // The program supplies book(ithread), which is called once per
+  // thread with gDirectory set to a directory private to that thread.
+  // It books the histograms there and returns the fill function for
+  // them, called for each entry with the ntuple and the weight. The
+  // histograms of all threads are added up by name into the output
+  // file at the end; anything else kept per thread (sums, counters) is
+  // up to the program, e.g. in a vector indexed by ithread.
+  //
+  // So the histograms take nthreads times the memory, e.g. 256 MB per
+  // thread for one 4000x4000 TH2D with sumw2. Thread 0 books first,
+  // and with nthreads = 0 the number of threads is cut down to what
+  // fits in max_hists_mb; an explicit nthreads is kept but warned
+  // about if it doesn't fit. Check nthreads() after run() if it
+  // matters. Only the TH1s in the thread's directory are seen, so
+  // book() should report anything else big it keeps per thread (e.g.
+  // the ReplicaHists of --bootstrap) with add_thread_mb().
+  template <typename Ntuple>
+  class NtupleLoop {
+  public:
+    typedef std::function<NtupleEntryInfo(const Ntuple&)> info_t;
+    typedef std::function<void(const Ntuple&, double)> fill_t;
+    typedef std::function<fill_t(int)> book_t;
+
+    NtupleLoop(const std::string& in_fn, const std::string& tree_path, const std::string& out_fn, info_t info, const NtupleLoopOptions& o)
+      : in_fn_(in_fn), tree_path_(tree_path), info_(info), o_(o),
+        nthreads_(o.nthreads > 0 ? o.nthreads : std::max(1U, std::thread::hardware_concurrency())),
+        f_out_(0),
+        booking_first_(false),
+        extra_mb_(0)
+    {
+      if (nthreads_ > 1)
+        ROOT::EnableThreadSafety();
+
+      open();
+      if (trees_[0]->GetEntry(0) <= 0)
+        throw std::runtime_error("jmt::NtupleLoop: can't read first entry of " + tree_path + " in " + in_fn);
+      is_mc_ = info_(*nts_[0]).run == 1;
+
+      nentries_tree_ = trees_[0]->GetEntries();
+      nentries_ = o.nevents_frac < 1 ? o.nevents_frac * nentries_tree_ : nentries_tree_;
+
+      if (!is_mc_ && o.json != "") {
+        lumi_mask_.reset(new EventMask(EventMask::from_file(o.json)));
+        if (lumi_mask_->has_events() || !lumi_mask_->has_lumis())
+          throw std::runtime_error("jmt::NtupleLoop: " + o.json + " isn't a lumi mask");
+      }
+      if (is_mc_ && o.pu_weights != "")
+        pu_.set_key(o.pu_weights);
+
+      if (strncmp(out_fn.c_str(), "n/a", 3) != 0) {
+        f_out_ = new TFile(out_fn.c_str(), "recreate");
+        if (!f_out_->IsOpen())
+          throw std::runtime_error("jmt::NtupleLoop: can't create " + out_fn);
+
+        if (TH1* h = (TH1*)files_[0]->Get("mcStat/h_sums")) {
+          f_out_->mkdir("mfvWeight")->cd();
+          TH1* h_sums = (TH1*)h->Clone("h_sums");
+          if (is_mc_ && o.nevents_frac < 1) {
+            h_sums->SetBinContent(1, h_sums->GetBinContent(1) * o.nevents_frac);
+            for (int i = 2, ie = h_sums->GetNbinsX(); i <= ie; ++i) // invalidate other entries since we can't just assume equal weights in them
+              h_sums->SetBinContent(i, -1e9);
+          }
+          f_out_->cd();
+          TH1D* h_norm = new TH1D("h_norm", "", 1, 0, 1);
+          if (is_mc_)
+            h_norm->Fill(0.5, h_sums->GetBinContent(1));
+        }
+
+        f_out_->cd();
+      }
+    }
+
+    ~NtupleLoop() {
+      if (f_out_) {
+        f_out_->Write();
+        f_out_->Close();
+        delete f_out_;
+      }
+      for (TFile* f : files_) {
+        f->Close();
+        delete f;
+      }
+    }
+
+    bool is_mc() const { return is_mc_; }
+    int nthreads() const { return nthreads_; }
+    unsigned long long nentries() const { return nentries_; }
+    unsigned long long nentries_tree() const { return nentries_tree_; }
+    const PileupWeights& pu_weights() const { return pu_; }
+    TFile* f_in() const { return files_[0]; }
+    TFile* f_out() const { return f_out_; }
+
+    // From book(), memory kept per thread outside of its histograms,
+    // counted with them when sizing nthreads.
+    void add_thread_mb(double mb) { if (booking_first_) extra_mb_ += mb; }
+
+    void run(book_t book) {
+      std::vector<TDirectory*> dirs;
+      std::vector<fill_t> fills;
+      {
+        TDirectory::TContext ctx;
+        auto book_thread = [&](int i) {
+          dirs.push_back(gROOT->mkdir(TString::Format("jmt_NtupleLoop_%p_%i", (void*)this, i)));
+          dirs.back()->cd();
+          fills.push_back(book(i));
+        };
+
+        booking_first_ = true;
+        extra_mb_ = 0;
+        book_thread(0);
+        booking_first_ = false;
+        const double mb = hists_mb(dirs[0]) + extra_mb_;
+        const int fit = mb > 0 ? std::max(1, int(o_.max_hists_mb / mb)) : nthreads_;
+        if (nthreads_ > fit) {
+          if (o_.nthreads <= 0) {
+            printf("jmt::NtupleLoop: histograms take %.0f MB per thread, using %i threads instead of %i\n", mb, fit, nthreads_);
+            nthreads_ = fit;
+          }
+          else
+            printf("jmt::NtupleLoop: warning: histograms take %.0f MB per thread, %.0f MB for %i threads\n", mb, mb * nthreads_, nthreads_);
+        }
+
+        for (int i = int(files_.size()); i < nthreads_; ++i)
+          open();
+        for (int i = 1; i < nthreads_; ++i)
+          book_thread(i);
+      }
+
+      const unsigned long long chunk = 1000;
+      std::atomic<unsigned long long> next(0), done(0);
+      std::atomic<bool> stop(false);
+
+      auto work = [&](int ithread) {
+        TTree* t = trees_[ithread];
+        const Ntuple& nt = *nts_[ithread];
+        const fill_t& fill = fills[ithread];
+
+        for (unsigned long long jj0; !stop && (jj0 = next.fetch_add(chunk)) < nentries_; ) {
+          const unsigned long long jj1 = std::min(jj0 + chunk, nentries_);
+          for (unsigned long long jj = jj0; jj < jj1; ++jj) {
+            if (t->LoadTree(jj) < 0) {
+              stop = true;
+              break;
+            }
+            if (t->GetEntry(jj) <= 0) continue;
+
+            const NtupleEntryInfo info = info_(nt);
+            if (lumi_mask_ && !lumi_mask_->contains_lumi(info.run, info.lumi))
+              continue;
+
+            double w = 1;
+            if (is_mc_) {
+              if (o_.tree_weight)
+                w *= info.weight;
+              if (pu_.valid())
+                w *= pu_.w(info.npu);
+            }
+
+            fill(nt, w);
+          }
+
+          const unsigned long long n0 = done.fetch_add(jj1 - jj0);
+          if (o_.progress_every && n0 / o_.progress_every != (n0 + jj1 - jj0) / o_.progress_every) {
+            if (nentries_ != nentries_tree_) printf("\r%llu/%llu(/%llu)", n0 + jj1 - jj0, nentries_, nentries_tree_);
+            else                             printf("\r%llu/%llu",        n0 + jj1 - jj0, nentries_);
+            fflush(stdout);
+          }
+        }
+      };
+
+      if (nthreads_ == 1)
+        work(0);
+      else {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < nthreads_; ++i)
+          threads.emplace_back(work, i);
+        for (std::thread& th : threads)
+          th.join();
+      }
+
+      if (nentries_ != nentries_tree_) printf("\rdone with %llu events (out of %llu)\n", nentries_, nentries_tree_);
+      else                             printf("\rdone with %llu events\n",               nentries_);
+
+      fills.clear();
+
+      // Add up the other threads' histograms into the first's, and move
+      // those to the output file (or detach them if there is none, the
+      // program still owns the pointers).
+      std::vector<TH1*> hs;
+      for (TObject* obj : *dirs[0]->GetList())
+        if (TH1* h = dynamic_cast<TH1*>(obj))
+          hs.push_back(h);
+
+      for (TH1* h : hs) {
+        for (int i = 1; i < nthreads_; ++i)
+          if (TH1* hi = dynamic_cast<TH1*>(dirs[i]->FindObject(h->GetName())))
+            h->Add(hi);
+        h->SetDirectory(f_out_);
+      }
+
+      for (TDirectory* d : dirs)
+        delete d;
+
+      if (f_out_)
+        f_out_->cd();
+    }
+
+  private:
+    static double hists_mb(TDirectory* d) {
+      double b = 0;
+      for (TObject* obj : *d->GetList())
+        if (const TH1* h = dynamic_cast<const TH1*>(obj)) {
+          const int w = dynamic_cast<const TArrayD*>(h) ? 8 : dynamic_cast<const TArrayS*>(h) ? 2 : dynamic_cast<const TArrayC*>(h) ? 1 : 4;
+          b += double(h->GetNcells()) * w + double(h->GetSumw2N()) * 8;
+        }
+      return b / 1048576;
+    }
+
+    void open() {
+      TFile* f = TFile::Open(in_fn_.c_str());
+      if (!f || !f->IsOpen())
+        throw std::runtime_error("jmt::NtupleLoop: can't open " + in_fn_);
+      TTree* t = (TTree*)f->Get(tree_path_.c_str());
+      if (!t)
+        throw std::runtime_error("jmt::NtupleLoop: no tree " + tree_path_ + " in " + in_fn_);
+      Ntuple* nt = new Ntuple;
+      nt->read_from_tree(t);
+      files_.push_back(f);
+      trees_.push_back(t);
+      nts_.emplace_back(nt);
+    }
+
+    const std::string in_fn_;
+    const std::string tree_path_;
+    info_t info_;
+    const NtupleLoopOptions o_;
+    int nthreads_;
+
+    std::vector<TFile*> files_;
+    std::vector<TTree*> trees_;
+    std::vector<std::unique_ptr<Ntuple>> nts_;
+
+    bool is_mc_;
+    unsigned long long nentries_tree_;
+    unsigned long long nentries_;
+    std::unique_ptr<EventMask> lumi_mask_;
+    PileupWeights pu_;
+    TFile* f_out_;
+    bool booking_first_;
+    double extra_mb_;
+  };
+}
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef JMTucker_Tools_PatCompiledCuts_h
+#define JMTucker_Tools_PatCompiledCuts_h
+
+#include "DataFormats/PatCandidates/interface/Electron.h"
+#include "DataFormats/PatCandidates/interface/Jet.h"
+#include "DataFormats/PatCandidates/interface/Muon.h"
+#include "JMTucker/Tools/interface/CompiledCut.h"
+
+// The accessors used by the cuts in PATTupleSelection_cfi.py. Cuts
+// using anything not here fall back to StringCutObjectSelector.
+
+namespace jmt {
+  template <>
+  struct CutAccessors<pat::Muon> {
+    typedef pat::Muon T;
+    typedef std::function<double(const T&)> fcn_t;
+    typedef std::map<std::string, fcn_t> map_t;
+    static const map_t& get() {
+      static const map_t m = {
+        { "pt",                                                [](const T& x) -> double { return x.pt(); } },
+        { "eta",                                               [](const T& x) -> double { return x.eta(); } },
+        { "isPFMuon",                                          [](const T& x) -> double { return x.isPFMuon(); } },
+        { "isGlobalMuon",                                      [](const T& x) -> double { return x.isGlobalMuon(); } },
+        { "isTrackerMuon",                                     [](const T& x) -> double { return x.isTrackerMuon(); } },
+        { "numberOfMatchedStations",                           [](const T& x) -> double { return x.numberOfMatchedStations(); } },
+        { "globalTrack.normalizedChi2",                        [](const T& x) -> double { return x.globalTrack()->normalizedChi2(); } },
+        { "globalTrack.hitPattern.numberOfValidMuonHits",      [](const T& x) -> double { return x.globalTrack()->hitPattern().numberOfValidMuonHits(); } },
+        { "innerTrack.hitPattern.trackerLayersWithMeasurement",[](const T& x) -> double { return x.innerTrack()->hitPattern().trackerLayersWithMeasurement(); } },
+        { "innerTrack.hitPattern.numberOfValidPixelHits",      [](const T& x) -> double { return x.innerTrack()->hitPattern().numberOfValidPixelHits(); } },
+      };
+      return m;
+    }
+  };
+
+  template <>
+  struct CutAccessors<pat::Electron> {
+    typedef pat::Electron T;
+    typedef std::function<double(const T&)> fcn_t;
+    typedef std::map<std::string, fcn_t> map_t;
+    static const map_t& get() {
+      static const map_t m = {
+        { "pt",                                                  [](const T& x) -> double { return x.pt(); } },
+        { "eta",                                                 [](const T& x) -> double { return x.eta(); } },
+        { "isEB",                                                [](const T& x) -> double { return x.isEB(); } },
+        { "isEE",                                                [](const T& x) -> double { return x.isEE(); } },
+        { "full5x5_sigmaIetaIeta",                               [](const T& x) -> double { return x.full5x5_sigmaIetaIeta(); } },
+        { "deltaEtaSuperClusterTrackAtVtx",                      [](const T& x) -> double { return x.deltaEtaSuperClusterTrackAtVtx(); } },
+        { "deltaPhiSuperClusterTrackAtVtx",                      [](const T& x) -> double { return x.deltaPhiSuperClusterTrackAtVtx(); } },
+        { "hadronicOverEm",                                      [](const T& x) -> double { return x.hadronicOverEm(); } },
+        { "ecalEnergy",                                          [](const T& x) -> double { return x.ecalEnergy(); } },
+        { "eSuperClusterOverP",                                  [](const T& x) -> double { return x.eSuperClusterOverP(); } },
+        { "superCluster.eta",                                    [](const T& x) -> double { return x.superCluster()->eta(); } },
+        { "superCluster.energy",                                 [](const T& x) -> double { return x.superCluster()->energy(); } },
+        { "superCluster.seed.eta",                               [](const T& x) -> double { return x.superCluster()->seed()->eta(); } },
+        { "gsfTrack.hitPattern.numberOfAllHits(\"MISSING_INNER_HITS\")", [](const T& x) -> double { return x.gsfTrack()->hitPattern().numberOfAllHits(reco::HitPattern::MISSING_INNER_HITS); } },
+      };
+      return m;
+    }
+  };
+
+  template <>
+  struct CutAccessors<pat::Jet> {
+    typedef pat::Jet T;
+    typedef std::function<double(const T&)> fcn_t;
+    typedef std::map<std::string, fcn_t> map_t;
+    static const map_t& get() {
+      static const map_t m = {
+        { "pt",                          [](const T& x) -> double { return x.pt(); } },
+        { "eta",                         [](const T& x) -> double { return x.eta(); } },
+        { "numberOfDaughters",           [](const T& x) -> double { return x.numberOfDaughters(); } },
+        { "neutralHadronEnergyFraction", [](const T& x) -> double { return x.neutralHadronEnergyFraction(); } },
+        { "neutralEmEnergyFraction",     [](const T& x) -> double { return x.neutralEmEnergyFraction(); } },
+        { "muonEnergyFraction",          [](const T& x) -> double { return x.muonEnergyFraction(); } },
+        { "chargedEmEnergyFraction",     [](const T& x) -> double { return x.chargedEmEnergyFraction(); } },
+        { "chargedHadronEnergyFraction", [](const T& x) -> double { return x.chargedHadronEnergyFraction(); } },
+        { "chargedMultiplicity",         [](const T& x) -> double { return x.chargedMultiplicity(); } },
+      };
+      return m;
+    }
+  };
+}
+
+#endif
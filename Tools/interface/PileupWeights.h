@@ -1,44 +1,105 @@
 #ifndef JMTucker_Tools_interface_PileupWeights_h
 #define JMTucker_Tools_interface_PileupWeights_h
 
+#include <cmath>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <string>
+#include <vector>
+#include "TFile.h"
+#include "TH1.h"
 
 namespace jmt {
-  class PileupWeights {
+  // One copy per process of every pileup weight table, built the first
+  // time anyone asks. Tables are never changed or removed once added,
+  // so a handle (its position) or a reference to its weights stays good
+  // for the life of the job. Besides the built-in ones below, tables can
+  // be added at runtime, e.g. from a histogram in a ROOT file made by
+  // PileupWeights.py.
+  class PileupWeightsRegistry {
   public:
-    PileupWeights() : v_(nullptr) { setup_(); };
-    PileupWeights(const std::string& k) : v_(nullptr) { setup_(); set_key(k); }
+    typedef int handle_t;
+    typedef std::vector<double> weights_t;
 
-    bool valid() const { return v_ != nullptr; }
+    static PileupWeightsRegistry& instance() {
+      static PileupWeightsRegistry r;
+      return r;
+    }
 
-    void set_key(const std::string& k) {
-      if (!k.size())
-        v_ = nullptr;
-      else {
-        map_t::const_iterator it = w_.find(k);
-        if (it == w_.end())
-          throw std::invalid_argument("jmt::PileupWeights: bad key");
-        v_ = &it->second;
-      }
+    // -1 if there's no such key.
+    handle_t find(const std::string& k) const {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = keys_.find(k);
+      return it == keys_.end() ? -1 : it->second;
     }
 
-    double w(int i) const {
-      if (!valid() || i < 0 || i >= int(v_->size()))
-        return 0;
-      return (*v_)[i];
+    handle_t handle(const std::string& k) const {
+      const handle_t h = find(k);
+      if (h < 0)
+        throw std::invalid_argument("jmt::PileupWeights: bad key " + k);
+      return h;
     }
 
-    double w(const std::string& k, int i) {
-      set_key(k);
-      return w(i);
+    const weights_t& weights(handle_t h) const {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (h < 0 || h >= handle_t(tables_.size()))
+        throw std::out_of_range("jmt::PileupWeights: bad handle");
+      return tables_[h];
+    }
+
+    // Adding the same weights under an existing key again is a no-op;
+    // different ones are an error.
+    handle_t add(const std::string& k, const weights_t& w) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = keys_.find(k);
+      if (it != keys_.end()) {
+        if (tables_[it->second] != w)
+          throw std::invalid_argument("jmt::PileupWeights: key " + k + " already registered with different weights");
+        return it->second;
+      }
+      tables_.push_back(w);
+      return keys_[k] = handle_t(tables_.size() - 1);
+    }
+
+    // Bin i of the histogram is the weight for npu = i-1, same as the
+    // lists PileupWeights.py prints. The key defaults to "fn:path".
+    handle_t add_from_file(const std::string& fn, const std::string& path, std::string k="") {
+      if (k.empty())
+        k = fn + ":" + path;
+      const handle_t h = find(k);
+      if (h >= 0)
+        return h;
+
+      std::unique_ptr<TFile> f(TFile::Open(fn.c_str()));
+      if (!f || !f->IsOpen())
+        throw std::invalid_argument("jmt::PileupWeights: can't open " + fn);
+      TH1* hist = dynamic_cast<TH1*>(f->Get(path.c_str()));
+      if (!hist)
+        throw std::invalid_argument("jmt::PileupWeights: no TH1 " + path + " in " + fn);
+      weights_t w(hist->GetNbinsX());
+      for (int i = 0, ie = int(w.size()); i < ie; ++i)
+        w[i] = hist->GetBinContent(i+1);
+      return add(k, w);
     }
 
   private:
-    typedef std::map<std::string, std::vector<double>> map_t;
-    map_t w_;
-    const std::vector<double>* v_;
+    typedef std::map<std::string, weights_t> map_t;
+
+    mutable std::mutex mutex_;
+    std::deque<weights_t> tables_; // deque so references survive adds
+    std::map<std::string, handle_t> keys_;
 
-    void setup_() { // these lines will be parsed in PileupWeights.py, don't break it
+    PileupWeightsRegistry() {
+      map_t w_;
+      builtin_(w_);
+      for (const auto& p : w_)
+        add(p.first, p.second);
+    }
+
+    static void builtin_(map_t& w_) { // these lines will be parsed in PileupWeights.py, don't break it
       w_["2017"] = std::vector<double>({0.184739, 3.87862, 3.43873, 2.55711, 1.66222, 1.50921, 1.28595, 1.25693, 0.615431, 1.45522, 1.4954, 1.48321, 1.33156, 1.16429, 1.07819, 1.05333, 1.08185, 1.1281, 1.16611, 1.18882, 1.2123, 1.23819, 1.26049, 1.27054, 1.27151, 1.27133, 1.27212, 1.26675, 1.27518, 1.25199, 1.22257, 1.16871, 1.10992, 1.03781, 0.968667, 0.911656, 0.867131, 0.834894, 0.787916, 0.750576, 0.758612, 0.79302, 0.859323, 0.959067, 1.09514, 1.25685, 1.41972, 1.49691, 1.52938, 1.46324, 1.33617, 1.15483, 0.950685, 0.749146, 0.569927, 0.411027, 0.28984, 0.198626, 0.13758, 0.0964932, 0.0693175, 0.0508504, 0.038385, 0.0299888, 0.0240799, 0.0170695, 0.0124844, 0.0107651, 0.00962124, 0.00879133, 0.00826726, 0.00803058, 0.00783523, 0.00781574, 0.00631688, 0.00535918, 0.00553274, 0.00551791, 0.00589565, 0.00594138, 0.00625883, 0.00628165, 0.00635429, 0.00491238, 0.00435898, 0.00445464, 0.00438023, 0.00456194, 0.00393917, 0.00424369, 0.00310455, 0.00284123, 0.00176242, 0.00148484, 0.00316881, 0.00199287});
       w_["2018"] = std::vector<double>({0, 11.5, 54.0978, 19.7888, 11.885, 9.25087, 6.26469, 4.80745, 3.49009, 2.64713, 2.15361, 1.82647, 1.63217, 1.50981, 1.44394, 1.40782, 1.39506, 1.40397, 1.42026, 1.42592, 1.43044, 1.41223, 1.38412, 1.3443, 1.29754, 1.24851, 1.20549, 1.16808, 1.13849, 1.11615, 1.09923, 1.09091, 1.08221, 1.07757, 1.07385, 1.06817, 1.0623, 1.05207, 1.03581, 1.01343, 0.982392, 0.940151, 0.892928, 0.837689, 0.773924, 0.707478, 0.639465, 0.570935, 0.504203, 0.442841, 0.385688, 0.333489, 0.288532, 0.249292, 0.215335, 0.187414, 0.162552, 0.142601, 0.1254, 0.110664, 0.0981898, 0.0867282, 0.0774977, 0.0687965, 0.060932, 0.05364, 0.0470512, 0.0413551, 0.0361235, 0.0315523, 0.027532, 0.0240214, 0.0210999, 0.0181469, 0.0153926, 0.013164, 0.0108045, 0.00947701, 0.0078069, 0.00700868, 0.00572437, 0.00443263, 0.0044066, 0.00291622, 0.0024858, 0.00209414, 0.00224626, 0.000990174, 0.000590135, 0.000335204, 0.000293124, 0.0004019, 0.00013152, 0.000127091, 9.06419e-05, 1.41345e-05, 1.95143e-05, 8.83322e-06, 1.96614e-06, 1.72141e-06});
       w_["mfv_signals"] = std::vector<double>({0.172534, 3.13262, 2.68262, 2.33918, 1.49582, 1.75664, 1.45234, 1.27364, 0.585358, 1.49517, 1.45961, 1.44424, 1.30702, 1.18514, 1.07074, 1.03629, 1.09412, 1.10414, 1.16949, 1.20394, 1.21806, 1.23341, 1.25095, 1.27037, 1.29025, 1.25948, 1.27016, 1.25865, 1.27388, 1.24479, 1.23516, 1.16681, 1.09766, 1.04073, 0.973876, 0.917616, 0.869108, 0.840266, 0.782769, 0.745708, 0.755959, 0.788542, 0.849645, 0.941173, 1.08525, 1.24145, 1.44664, 1.4887, 1.51809, 1.48096, 1.33463, 1.17911, 0.96439, 0.752935, 0.578032, 0.4134, 0.289109, 0.200918, 0.137729, 0.0965137, 0.0699985, 0.0523641, 0.0376583, 0.0297392, 0.0241064, 0.0175732, 0.0125353, 0.0112112, 0.00906686, 0.00889159, 0.0083708, 0.00838739, 0.00782759, 0.00836096, 0.00607675, 0.00541676, 0.005148, 0.00664222, 0.00790963, 0.010092, 0.00668878, 0.00330788, 0.00693948, 0.00565068, 0, 0, 0.000997499, 0.00378327});
@@ -74,6 +135,71 @@ namespace jmt {
       w_["cross_2017to2017F"] = std::vector<double>({2.4833468, 2.6360407, 2.5645514, 2.1137221, 1.1835377, 1.1878864, 1.0399782, 0.77191649, 1.0696764, 1.8995203, 2.0064063, 1.8962723, 1.573658, 1.1462522, 0.81393075, 0.62116051, 0.52347923, 0.46955146, 0.44148151, 0.42942329, 0.44145179, 0.48388373, 0.53460718, 0.56359186, 0.56503055, 0.55275578, 0.53781326, 0.52513282, 0.51893537, 0.52341552, 0.54174321, 0.57520086, 0.62275569, 0.68295738, 0.75603587, 0.84266982, 0.94074713, 1.0449602, 1.1507166, 1.2582124, 1.3725462, 1.4994704, 1.6399305, 1.7875185, 1.9310225, 2.0596332, 2.1664765, 2.2493871, 2.309243, 2.3482477, 2.3686731, 2.3724877, 2.3609923, 2.3349788, 2.2949255, 2.2411837, 2.1740409, 2.0939001, 2.0012938, 1.8968798, 1.7814116, 1.6556389, 1.5204377, 1.3769741, 1.2270026, 1.0732242, 0.91939541, 0.77024087, 0.63083761, 0.50578354, 0.39834238, 0.30990539, 0.23998274, 0.18662596, 0.14706833, 0.11833079, 0.097651254, 0.082711751, 0.071708293, 0.06331896, 0.056623682, 0.051013826, 0.046106017, 0.041672672, 0.037587004, 0.033785446, 0.030239736, 0.026940293, 0.023884905, 0.021073358, 0.018503873, 0.016171869, 0.014069575, 0.012186768, 0.01051098, 0.0090281855});
     }
   };
+
+  // Lightweight view of one table in the registry. Constructing one is
+  // a key lookup; after that w() is just a bounds-checked index.
+  class PileupWeights {
+  public:
+    typedef PileupWeightsRegistry::handle_t handle_t;
+
+    PileupWeights() : h_(-1), v_(nullptr) {}
+    PileupWeights(const std::string& k) : PileupWeights() { set_key(k); }
+    PileupWeights(handle_t h) : PileupWeights() { set_handle(h); }
+
+    bool valid() const { return v_ != nullptr; }
+    handle_t handle() const { return h_; }
+
+    // A key of the form fn.root:path registers the histogram from that
+    // file if it isn't already.
+    void set_key(const std::string& k) {
+      if (!k.size())
+        set_handle(-1);
+      else {
+        PileupWeightsRegistry& r = PileupWeightsRegistry::instance();
+        const size_t colon = k.find(".root:");
+        handle_t h = r.find(k);
+        if (h < 0 && colon != std::string::npos)
+          h = r.add_from_file(k.substr(0, colon+5), k.substr(colon+6), k);
+        if (h < 0)
+          h = r.handle(k); // throws
+        set_handle(h);
+      }
+    }
+
+    void set_handle(handle_t h) {
+      h_ = h;
+      v_ = h < 0 ? nullptr : &PileupWeightsRegistry::instance().weights(h);
+    }
+
+    double w(int i) const {
+      if (!valid() || i < 0 || i >= int(v_->size()))
+        return 0;
+      return (*v_)[i];
+    }
+
+    // Linear interpolation between the integer npu values, e.g. for
+    // weighting by the true mean number of interactions. Outside the
+    // table the weight is 0, as for w(int).
+    double w_interp(double npu) const {
+      if (!valid() || !(npu >= 0))
+        return 0;
+      const double f = std::floor(npu);
+      if (f >= double(v_->size()))
+        return 0;
+      const int i = int(f);
+      const double t = npu - f;
+      return t == 0 ? w(i) : (1 - t) * w(i) + t * w(i+1);
+    }
+
+    double w(const std::string& k, int i) {
+      set_key(k);
+      return w(i);
+    }
+
+  private:
+    handle_t h_;
+    const std::vector<double>* v_;
+  };
 }
 
 #endif
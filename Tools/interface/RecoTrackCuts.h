@@ -0,0 +1,24 @@
+#ifndef JMTucker_Tools_RecoTrackCuts_h
+#define JMTucker_Tools_RecoTrackCuts_h
+
+#include <vector>
+#include "DataFormats/Common/interface/Handle.h"
+#include "DataFormats/TrackReco/interface/TrackFwd.h"
+#include "DataFormats/VertexReco/interface/VertexFwd.h"
+#include "JMTucker/Tools/interface/TrackCuts.h"
+
+namespace reco {
+  class BeamSpot;
+}
+
+namespace jmt {
+  // The TrackCutValues of tk, from one pass over its hits, with dxybs
+  // wrt bs (the origin if null) and dxypv wrt pv (infinite if null).
+  TrackCutValues track_cut_values(const reco::Track& tk, const reco::BeamSpot* bs, const reco::Vertex* pv);
+
+  // For each track in tracks, the index of the first of pvs that uses
+  // it, or -1, and how many of them do.
+  void tracks_in_pvs(const reco::VertexCollection& pvs, const edm::Handle<reco::TrackCollection>& tracks, std::vector<int>& first, std::vector<int>& n);
+}
+
+#endif
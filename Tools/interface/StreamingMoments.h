@@ -0,0 +1,107 @@
+#ifndef JMTucker_Tools_StreamingMoments_h
+#define JMTucker_Tools_StreamingMoments_h
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+namespace jmt {
+  // Mean and variance of each of n quantities, and optionally the full
+  // n x n covariance, accumulated one sample (e.g. the bin contents of
+  // one toy) at a time with Welford's update, so nothing is kept per
+  // sample. The covariance is stored as the packed upper triangle. Two
+  // accumulators over different samples can be merged (Chan et al.), so
+  // they can be filled separately, e.g. one per thread.
+  class StreamingMoments {
+  public:
+    explicit StreamingMoments(int n, bool full_covariance=true)
+      : n_(n), full_(full_covariance), count_(0), mean_(n, 0.), dx_(n, 0.),
+        m2_(full_ ? size_t(n) * (n + 1) / 2 : size_t(n), 0.) {}
+
+    int size() const { return n_; }
+    bool full_covariance() const { return full_; }
+    long count() const { return count_; }
+
+    // x has the n values for one sample.
+    void add(const double* x) {
+      ++count_;
+      for (int i = 0; i < n_; ++i) {
+        dx_[i] = x[i] - mean_[i];
+        mean_[i] += dx_[i] / count_;
+      }
+      if (full_) {
+        double* m2 = m2_.data();
+        for (int i = 0; i < n_; ++i) {
+          const double d = dx_[i];
+          for (int j = i; j < n_; ++j)
+            *m2++ += d * (x[j] - mean_[j]);
+        }
+      }
+      else
+        for (int i = 0; i < n_; ++i)
+          m2_[i] += dx_[i] * (x[i] - mean_[i]);
+    }
+
+    void add(const std::vector<double>& x) {
+      assert(int(x.size()) == n_);
+      add(x.data());
+    }
+
+    void merge(const StreamingMoments& o) {
+      assert(o.n_ == n_ && o.full_ == full_);
+      if (o.count_ == 0)
+        return;
+      const long n = count_ + o.count_;
+      const double f = double(count_) * o.count_ / n;
+      for (int i = 0; i < n_; ++i)
+        dx_[i] = o.mean_[i] - mean_[i];
+      for (size_t k = 0; k < m2_.size(); ++k)
+        m2_[k] += o.m2_[k];
+      if (full_) {
+        double* m2 = m2_.data();
+        for (int i = 0; i < n_; ++i)
+          for (int j = i; j < n_; ++j)
+            *m2++ += f * dx_[i] * dx_[j];
+      }
+      else
+        for (int i = 0; i < n_; ++i)
+          m2_[i] += f * dx_[i] * dx_[i];
+      for (int i = 0; i < n_; ++i)
+        mean_[i] += dx_[i] * o.count_ / n;
+      count_ = n;
+    }
+
+    double mean(int i) const { return mean_[i]; }
+
+    // The population (1/N) variance and standard deviation, as TH1::GetRMS.
+    double variance(int i) const { return count_ > 0 ? m2_[full_ ? index(i,i) : i] / count_ : 0.; }
+    double rms(int i) const { return std::sqrt(variance(i)); }
+
+    // Errors on the mean and rms as TH1::GetMeanError and GetRMSError
+    // give them for unweighted entries.
+    double mean_error(int i) const { return count_ > 0 ? rms(i) / std::sqrt(double(count_)) : 0.; }
+    double rms_error(int i) const { return count_ > 0 ? rms(i) / std::sqrt(2. * count_) : 0.; }
+
+    double covariance(int i, int j) const {
+      if (!full_)
+        return i == j ? variance(i) : 0.;
+      return count_ > 0 ? m2_[i <= j ? index(i,j) : index(j,i)] / count_ : 0.;
+    }
+
+    double correlation(int i, int j) const {
+      const double d = std::sqrt(variance(i) * variance(j));
+      return d > 0 ? covariance(i,j) / d : 0.;
+    }
+
+  private:
+    // Position of (i,j), i <= j, in the packed upper triangle.
+    size_t index(int i, int j) const { return size_t(i) * (2*n_ - i + 1) / 2 + (j - i); }
+
+    int n_;
+    bool full_;
+    long count_;
+    std::vector<double> mean_, dx_, m2_;
+  };
+}
+
+#endif
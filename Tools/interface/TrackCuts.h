@@ -0,0 +1,154 @@
+#ifndef JMTucker_Tools_TrackCuts_h
+#define JMTucker_Tools_TrackCuts_h
+
+#include <cmath>
+#include <vector>
+
+namespace jmt {
+  // The quantities the track selections cut on, for one track.
+  // min_r is the innermost barrel pixel layer with a hit, 1-4, or
+  // no_min_r if there is none. dxypv is infinite if there is no PV.
+  struct TrackCutValues {
+    static constexpr int no_min_r = 99;
+
+    float pt;
+    float eta;
+    float dxybs;
+    float dxypv;
+    float dxyerr;
+    int min_r;
+    int nhits;
+    int npxhits;
+    int nsthits;
+    int npxlayers;
+    int nstlayers;
+
+    float nsigmadxybs() const { return dxybs / dxyerr; }
+    float nsigmadxypv() const { return dxypv / dxyerr; }
+  };
+
+  // The same for a whole collection of tracks, one array per quantity,
+  // so TrackCuts::apply can run over them all in one branch-free loop.
+  // gcc only vectorizes that at -O3, not at the usual -O2.
+  struct TrackCutVars {
+    std::vector<float> pt, eta, dxybs, dxypv, dxyerr;
+    std::vector<unsigned char> min_r, nhits, npxhits, nsthits, npxlayers, nstlayers;
+
+    size_t size() const { return pt.size(); }
+
+    void clear() {
+      for (auto* v : { &pt, &eta, &dxybs, &dxypv, &dxyerr }) v->clear();
+      for (auto* v : { &min_r, &nhits, &npxhits, &nsthits, &npxlayers, &nstlayers }) v->clear();
+    }
+
+    void reserve(size_t n) {
+      for (auto* v : { &pt, &eta, &dxybs, &dxypv, &dxyerr }) v->reserve(n);
+      for (auto* v : { &min_r, &nhits, &npxhits, &nsthits, &npxlayers, &nstlayers }) v->reserve(n);
+    }
+
+    void push_back(const TrackCutValues& t) {
+      pt.push_back(t.pt);
+      eta.push_back(t.eta);
+      dxybs.push_back(t.dxybs);
+      dxypv.push_back(t.dxypv);
+      dxyerr.push_back(t.dxyerr);
+      min_r.push_back(t.min_r);
+      nhits.push_back(t.nhits);
+      npxhits.push_back(t.npxhits);
+      nsthits.push_back(t.nsthits);
+      npxlayers.push_back(t.npxlayers);
+      nstlayers.push_back(t.nstlayers);
+    }
+
+    TrackCutValues operator[](size_t i) const {
+      return { pt[i], eta[i], dxybs[i], dxypv[i], dxyerr[i], min_r[i], nhits[i], npxhits[i], nsthits[i], npxlayers[i], nstlayers[i] };
+    }
+
+    float nsigmadxybs(size_t i) const { return dxybs[i] / dxyerr[i]; }
+    float nsigmadxypv(size_t i) const { return dxypv[i] / dxyerr[i]; }
+  };
+
+  // One bit per cut, set in TrackCuts::fail's result if the track fails
+  // it.
+  enum TrackCutBit : unsigned {
+    tkcut_finite      = 1 << 0,  // pt not inf and eta not nan
+    tkcut_pt          = 1 << 1,
+    tkcut_min_r       = 1 << 2,
+    tkcut_npxlayers   = 1 << 3,
+    tkcut_nstlayers   = 1 << 4,
+    tkcut_nsigmadxybs = 1 << 5,
+    tkcut_dxybs       = 1 << 6,
+    tkcut_dxyerr      = 1 << 7,
+    tkcut_nsigmadxypv = 1 << 8,
+    tkcut_nhits       = 1 << 9,
+    tkcut_npxhits     = 1 << 10,
+
+    // The seed tracks of the vertexer, and those before the
+    // significance cut ("selected" tracks in the TrackMover and
+    // TrackingTreer histograms).
+    tkcuts_seed = tkcut_pt | tkcut_min_r | tkcut_npxlayers | tkcut_nstlayers | tkcut_nsigmadxybs,
+    tkcuts_sel = tkcuts_seed & ~tkcut_nsigmadxybs,
+  };
+
+  // Whether a track with failed cut bits fail passes all the cuts in
+  // cuts, or all of them but but (for the n-1 plots).
+  inline bool tkcuts_pass(unsigned fail, unsigned cuts=tkcuts_seed) { return (fail & cuts) == 0; }
+  inline bool tkcuts_pass_nm1(unsigned fail, unsigned but, unsigned cuts=tkcuts_seed) { return (fail & cuts & ~but) == 0; }
+
+  // The thresholds, by default those of the seed track selection (the
+  // ones not in tkcuts_seed being loose). Which cuts a module actually
+  // applies is up to the mask it passes to tkcuts_pass.
+  struct TrackCuts {
+    float min_pt = 1;
+    int max_min_r = 1;
+    int min_npxlayers = 2;
+    int min_nstlayers = 6;
+    float min_nsigmadxybs = 4;
+    float min_dxybs = 0;
+    float max_dxyerr = 1e9;
+    float min_nsigmadxypv = 0;
+    int min_nhits = 0;
+    int min_npxhits = 0;
+
+    template <typename F, typename I>
+    unsigned fail(F pt, F eta, F dxybs, F dxypv, F dxyerr, I min_r, I nhits, I npxhits, I npxlayers, I nstlayers) const {
+      return
+        (unsigned(std::isinf(pt) | std::isnan(eta)) * tkcut_finite) |
+        (unsigned(!(pt > min_pt)) * tkcut_pt) |
+        (unsigned(!(min_r <= max_min_r)) * tkcut_min_r) |
+        (unsigned(!(npxlayers >= min_npxlayers)) * tkcut_npxlayers) |
+        (unsigned(!(nstlayers >= min_nstlayers)) * tkcut_nstlayers) |
+        (unsigned(!(std::fabs(dxybs) > min_nsigmadxybs * dxyerr)) * tkcut_nsigmadxybs) |
+        (unsigned(!(std::fabs(dxybs) > min_dxybs)) * tkcut_dxybs) |
+        (unsigned(!(dxyerr < max_dxyerr)) * tkcut_dxyerr) |
+        (unsigned(!(std::fabs(dxypv) > min_nsigmadxypv * dxyerr)) * tkcut_nsigmadxypv) |
+        (unsigned(!(nhits >= min_nhits)) * tkcut_nhits) |
+        (unsigned(!(npxhits >= min_npxhits)) * tkcut_npxhits);
+    }
+
+    unsigned fail(const TrackCutValues& t) const {
+      return fail(t.pt, t.eta, t.dxybs, t.dxypv, t.dxyerr, t.min_r, t.nhits, t.npxhits, t.npxlayers, t.nstlayers);
+    }
+
+    // The failed cuts of all the tracks in v, into fails.
+    void apply(const TrackCutVars& v, std::vector<unsigned>& fails) const {
+      const size_t n = v.size();
+      fails.resize(n);
+      const float* pt = v.pt.data();
+      const float* eta = v.eta.data();
+      const float* dxybs = v.dxybs.data();
+      const float* dxypv = v.dxypv.data();
+      const float* dxyerr = v.dxyerr.data();
+      const unsigned char* min_r = v.min_r.data();
+      const unsigned char* nhits = v.nhits.data();
+      const unsigned char* npxhits = v.npxhits.data();
+      const unsigned char* npxlayers = v.npxlayers.data();
+      const unsigned char* nstlayers = v.nstlayers.data();
+      unsigned* f = fails.data();
+      for (size_t i = 0; i < n; ++i)
+        f[i] = fail(pt[i], eta[i], dxybs[i], dxypv[i], dxyerr[i], int(min_r[i]), int(nhits[i]), int(npxhits[i]), int(npxlayers[i]), int(nstlayers[i]));
+    }
+  };
+}
+
+#endif
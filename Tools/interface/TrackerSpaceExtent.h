@@ -2,6 +2,7 @@
 #define JMTucker_Tools_TrackerSpaceExtent_h
 
 #include <map>
+#include <string>
 #include "Geometry/CommonDetUnit/interface/GeomDet.h"
 #include "Geometry/TrackerGeometryBuilder/interface/TrackerGeometry.h"
 
@@ -70,20 +71,58 @@ typedef Extents<int> NumExtents;
 
 class TrackerSpaceExtents {
 public:
-  TrackerSpaceExtents() : filled_(false) {}
+  // The HitPattern packs the substructure in 3 bits and the
+  // subsubstructure (layer/disk/wheel) in 4, so a flat table of this
+  // size covers everything it can refer to.
+  enum { max_sub = 8, max_subsub = 16, table_size = max_sub * max_subsub };
+
+  TrackerSpaceExtents() : filled_(false) { make_table(); }
   bool filled() const { return filled_; }
   typedef std::map<std::pair<int, int>, TrackerSpaceExtent> map_t;
   map_t map;
 
-  void fill(const edm::EventSetup&, const GlobalPoint& origin);
+  // If cache_fn is given and the file exists and was made with the same
+  // geometry (see geometry_key) and origin, the extents are read from
+  // it instead of walking the geometry; otherwise they're remade and
+  // written to it. Users that keep the extents across events should
+  // refill them when GlobalTrackingGeometryRecord changes
+  // (edm::ESWatcher).
+  void fill(const edm::EventSetup&, const GlobalPoint& origin, const std::string& cache_fn="");
   void print() const;
   enum { AllowAll, PixelOnly, StripOnly };
   NumExtents numExtentInRAndZ(const reco::HitPattern&, int code) const;
   SpatialExtents extentInRAndZ(const reco::HitPattern&, int code) const;
   int numHitsBehind(const reco::HitPattern&, const double r, const double z) const;
 
+  // null if there are no dets for this sub, subsub
+  const TrackerSpaceExtent* extent(int sub, int subsub) const {
+    const int k = sub * max_subsub + subsub;
+    return sub >= 0 && sub < max_sub && subsub >= 0 && subsub < max_subsub && known_[k] ? &table_[k] : 0;
+  }
+
+  // Which layers are entirely inside r (barrel) or |z| (endcap): all
+  // the comparisons are done at once in behind(), e.g. once per vertex,
+  // and then counting a track's hits behind it is one table lookup
+  // per hit.
+  struct Behind {
+    unsigned char behind[table_size];
+    unsigned char known[table_size];
+    int count(const reco::HitPattern&) const;
+  };
+  Behind behind(const double r, const double z) const;
+
 private:
   bool filled_;
+  TrackerSpaceExtent table_[table_size];
+  unsigned char known_[table_size];
+  unsigned char barrel_[table_size];
+  double max_r_[table_size];
+  double max_z_[table_size];
+
+  static unsigned long long geometry_key(const TrackerGeometry&);
+  bool read_cache(const std::string& fn, unsigned long long key, const GlobalPoint& origin);
+  void write_cache(const std::string& fn, unsigned long long key, const GlobalPoint& origin) const;
+  void make_table();
 
   template <typename Id, typename SubFunc>
   void fill_subdet(map_t& extents, const TrackingGeometry::DetContainer& dets, SubFunc substructure, const GlobalPoint& origin) {
@@ -2,6 +2,7 @@
 #define JMTucker_Tools_TrackingTree_h
 
 #include <cassert>
+#include <iosfwd>
 #include <vector>
 #include "TVector3.h"
 #include "TLorentzVector.h"
@@ -167,6 +168,7 @@ class TrackingTree {
   void clear();
   void write_to_tree(TTree* tree);
   void read_from_tree(TTree* tree);
+  void print(std::ostream& o) const;
 
  private:
   unsigned run_;
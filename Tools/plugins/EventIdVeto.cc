@@ -2,6 +2,7 @@
 #include "FWCore/Framework/interface/Event.h"
 #include "FWCore/Framework/interface/Frameworkfwd.h"
 #include "FWCore/Framework/interface/MakerMacros.h"
+#include "JMTucker/Tools/interface/EventMask.h"
 
 class EventIdVeto : public edm::EDFilter {
 public:
@@ -10,84 +11,60 @@ public:
 private:
   virtual bool filter(edm::Event&, const edm::EventSetup&);
 
-  typedef std::pair<unsigned, unsigned long long> LE;
-  typedef std::tuple<unsigned, unsigned, unsigned long long> RLE;
-  std::set<LE> mle;
-  std::set<RLE> mrle;
-
-  const bool use_run;
+  jmt::EventMask mask;
   const bool debug;
 };
 
 EventIdVeto::EventIdVeto(const edm::ParameterSet& cfg) 
-  : use_run(cfg.getParameter<bool>("use_run")),
-    debug(cfg.getUntrackedParameter<bool>("debug", false))
+  : debug(cfg.getUntrackedParameter<bool>("debug", false))
 {
-  std::string fn(cfg.getParameter<std::string>("list_fn"));
+  const bool use_run = cfg.getParameter<bool>("use_run");
+  const std::string fn(cfg.getParameter<std::string>("list_fn"));
 
-  if (fn.size()) {
-    printf("EventIdVeto: fn is %s\n", fn.c_str());
-    if (fn.length() > 3 && fn.compare(fn.length() - 3, 3, ".gz") == 0) {
-      printf("EventIdVeto: gunzipping\n");
-      if (system(("gunzip " + fn).c_str()) != 0)
-        throw cms::Exception("EventIdVeto") << "could not unzip file " << fn;
-      fn.erase(fn.length() - 3, 3);
+  // list_fn can be a list of (run,lumi,event), or (lumi,event) if
+  // !use_run, one per line, or an EventMask compiled by
+  // Tools/test/EventIds/event_mask.exe (whose lumi mask then applies
+  // too, and whose own event mode and use of runs win), gzipped or not.
+  try {
+    if (fn.size()) {
+      printf("EventIdVeto: fn is %s\n", fn.c_str());
+      mask = jmt::EventMask::from_file(fn, jmt::EventMask::events_veto, use_run);
     }
+    else {
+      const std::vector<unsigned> lumis = cfg.getParameter<std::vector<unsigned>>("lumis");
+      const size_t n = lumis.size();
+      const std::vector<unsigned long long> events = cfg.getParameter<std::vector<unsigned long long>>("events");
+      const std::vector<unsigned> runs = use_run ? cfg.getParameter<std::vector<unsigned>>("runs") : std::vector<unsigned>();
 
-    FILE* f = fopen(fn.c_str(), "rt");
-    if (!f)
-      throw cms::Exception("EventIdVeto") << "could not read file " << fn;
+      if ((use_run && runs.size() != n) || events.size() != n)
+        throw cms::Exception("EventIdVeto", "mismatched sizes");
 
-    char line[1024];
-    while (fgets(line, 1024, f) != 0) {
-      if (debug) printf("EventIdVeto debug: file line read: %s", line);
-      unsigned r,l;
-      unsigned long long e;
-      int res;
-      if (use_run)
-        res = sscanf(line, "(%u,%u,%llu),", &r, &l, &e);
-      else
-        res = sscanf(line, "(%u,%llu),", &l, &e);
-      if (debug) printf("    sscanf returned %i, r,l,e = %u, %u, %llu\n", res, r,l,e);
-      if (res != (use_run ? 3 : 2))
-        continue;
-      if (use_run)
-        mrle.insert(RLE(r,l,e));
-      else
-        mle.insert(LE(l,e));
+      jmt::EventMaskBuilder b;
+      for (size_t i = 0; i < n; ++i)
+        if (use_run)
+          b.add_event(runs[i], lumis[i], events[i]);
+        else
+          b.add_event(lumis[i], events[i]);
+      if (n)
+        mask = b.compile(jmt::EventMask::events_veto);
     }
-    fclose(f);
   }
-  else {
-    const std::vector<unsigned> lumis = cfg.getParameter<std::vector<unsigned>>("lumis");
-    const size_t n = lumis.size();
-    const std::vector<unsigned long long> events = cfg.getParameter<std::vector<unsigned long long>>("events");
-    const std::vector<unsigned> runs = use_run ? cfg.getParameter<std::vector<unsigned>>("runs") : std::vector<unsigned>();
-
-    if ((use_run && runs.size() != n) || events.size() != n)
-      throw cms::Exception("EventIdVeto", "mismatched sizes");
-
-    for (size_t i = 0; i < n; ++i)
-      if (use_run)
-        mrle.insert(RLE(runs[i], lumis[i], events[i]));
-      else
-        mle.insert(LE(lumis[i], events[i]));
+  catch (const std::runtime_error& e) {
+    throw cms::Exception("EventIdVeto") << e.what();
   }
 
-  const size_t nveto = use_run ? mrle.size() : mle.size();
-  if (nveto == 0)
+  if (!mask.has_events() && !mask.has_lumis())
     throw cms::Exception("EventIdVeto") << "found zero events to veto in file " << fn;
-  printf("EventIdVeto: vetoing %lu events\n", nveto);
+  if (mask.has_events())
+    printf("EventIdVeto: %s %lu events%s\n", mask.event_mode() == jmt::EventMask::events_veto ? "vetoing" : "accepting only", mask.nevents(), mask.events_any_run() ? " (in any run)" : "");
+  if (mask.has_lumis())
+    printf("EventIdVeto: lumi mask of %lu ranges in %lu runs\n", mask.nranges(), mask.nruns());
 }
 
 bool EventIdVeto::filter(edm::Event& event, const edm::EventSetup&) {
-  if (use_run)
-    return mrle.find(RLE(event.id().run(),
-                         event.luminosityBlock(),
-                         event.id().event())) == mrle.end();
-  else
-    return mle.find(LE(event.luminosityBlock(),
-                       event.id().event())) == mle.end();
+  const bool pass = mask.accept(event.id().run(), event.luminosityBlock(), event.id().event());
+  if (debug) printf("EventIdVeto debug: (%u, %u, %llu) pass %i\n", event.id().run(), event.luminosityBlock(), event.id().event(), pass);
+  return pass;
 }
 
 DEFINE_FWK_MODULE(EventIdVeto);
@@ -1,29 +1,43 @@
 // https://twiki.cern.ch/twiki/bin/viewauth/CMS/L1ECALPrefiringWeightRecipe
 // from git cms-merge-topic lathomas:L1Prefiring_9_4_9 at 18-12-18 9:35:19
-// convert root file to included chunk with this script:
+// convert root file to compiled tables with this script (the TH2F
+// macro chunk that used to be included is in
+// test/L1ECALPrefiring for checking against):
 /*
 import os
 from JMTucker.Tools.ROOTTools import *
-z = []
-for _,_,f in tdirectory_walk(ROOT.TFile.Open('L1PrefiringMaps_new.root')):
-    for x in f:
-        fn = x.GetName() + '.C'
-        assert not os.path.exists(fn)
-        z.append((x.GetName(), fn))
-        x.SaveAs(fn)
-newfn = os.environ['CMSSW_BASE'] + '/src/JMTucker/Tools/plugins/L1ECALPrefiringWeightMaps.h'
+newfn = os.environ['CMSSW_BASE'] + '/src/JMTucker/Tools/plugins/L1ECALPrefiringWeightTables.h'
 f = open(newfn, 'wt')
-for hn,fn in z:
-   f.write('std::unique_ptr<TH2F> %s;\n' % hn)
-f.write('\n')
-for i, (hn, fn) in enumerate(z):
-    c = open(fn).read()
-    assert ('TH2F *%s__%i = new TH2F' % (hn, i+1))  in c
-    a,b =c.rsplit('}',1)
-    f.write(a + '\n')
-    f.write('%s.reset(%s__%i);\n' % (hn, hn, i+1))
-    f.write('}\n' + b + '\n')
-    os.remove(fn)
+f.write('''#ifndef JMTucker_Tools_L1ECALPrefiringWeightTables_h
+#define JMTucker_Tools_L1ECALPrefiringWeightTables_h
+
+// Generated from L1PrefiringMaps_new.root, see the script at the top of
+// L1ECALPrefiringWeightProducer.cc. Contents are float as TH2F
+// stores them, errors double as in TH2F's sumw2, and both are indexed
+// by TH2 global bin.
+
+#include "JMTucker/Tools/interface/L1ECALPrefiringMap.h"
+
+namespace L1ECALPrefiringWeightTables {
+''')
+fmt = lambda v: '0' if v == 0 else repr(v)
+for _,_,d in tdirectory_walk(ROOT.TFile.Open('L1PrefiringMaps_new.root')):
+    for h in d:
+        hn = h.GetName()
+        xa, ya = h.GetXaxis(), h.GetYaxis()
+        nx, ny = xa.GetNbins(), ya.GetNbins()
+        f.write('\n')
+        edges = {}
+        for c, a, n in ('x', xa, nx), ('y', ya, ny):
+            edges[c] = 'nullptr' # fixed-width axis
+            if a.IsVariableBinSize():
+                edges[c] = '%s_%s' % (hn, c)
+                f.write('  constexpr double %s[%i] = {%s};\n' % (edges[c], n+1, ', '.join(fmt(a.GetBinLowEdge(i)) for i in xrange(1, n+2))))
+        for what, typ in ('content', 'float'), ('error', 'double'):
+            rows = [', '.join(fmt(getattr(h, 'GetBin' + what.capitalize())(h.GetBin(ix,iy))) for ix in xrange(nx+2)) for iy in xrange(ny+2)]
+            f.write('  constexpr %s %s_%s[%i*%i] = {\n    %s\n  };\n' % (typ, hn, what, ny+2, nx+2, ',\n    '.join(rows)))
+        f.write('  constexpr jmt::L1ECALPrefiringMap %s = {\n    {%i, %s, %s, %s}, {%i, %s, %s, %s},\n    %s_content, %s_error\n  };\n' % (hn, nx, fmt(xa.GetXmin()), fmt(xa.GetXmax()), edges['x'], ny, fmt(ya.GetXmin()), fmt(ya.GetXmax()), edges['y'], hn, hn))
+f.write('}\n\n#endif\n')
 */
 
 
@@ -60,7 +74,8 @@ for i, (hn, fn) in enumerate(z):
 
 #include "DataFormats/PatCandidates/interface/Jet.h"
 #include "DataFormats/PatCandidates/interface/Photon.h"
-#include "TH2.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include "L1ECALPrefiringWeightTables.h"
 
 #include <iostream>
 enum fluctuations{central=0, up, down};
@@ -78,7 +93,6 @@ private:
   //  virtual void beginJob();
   //virtual void endJob(void);
   virtual void endStream() override;
-  virtual double GetPrefiringRate( double eta, double pt, TH2F * h_prefmap,/*std::string object, std::string dataera, */ int fluctuation);
   
   edm::InputTag srcPhotons_;
   edm::EDGetTokenT<std::vector< pat::Photon> >  photons_token_; 
@@ -87,8 +101,8 @@ private:
   edm::EDGetTokenT<std::vector< pat::Jet> > jets_token_;
   
 
-  std::unique_ptr<TH2F> h_prefmap_photon; 
-  std::unique_ptr<TH2F> h_prefmap_jet;
+  const jmt::L1ECALPrefiringMap* prefmap_photon_;
+  const jmt::L1ECALPrefiringMap* prefmap_jet_;
   std::string dataera_;
   bool useEMpt_;
   double prefiringRateSystUnc_;
@@ -114,16 +128,17 @@ L1ECALPrefiringWeightProducer::L1ECALPrefiringWeightProducer(const edm::Paramete
   //h_prefmap_jet =(TH2F*) file_prefiringmaps_->Get(mapjetfullname);
   //file_prefiringmaps_->Close();
 
-#include "L1ECALPrefiringWeightMaps.h"
-  assert(dataera_ == "2017BtoF" or dataera_ == "2016BtoH");
+  using namespace L1ECALPrefiringWeightTables;
   if (dataera_ == "2017BtoF") {
-    h_prefmap_jet.reset(useEMpt_ ? L1prefiring_jetemptvseta_2017BtoF.release() : L1prefiring_jetptvseta_2017BtoF.release());
-    h_prefmap_photon.reset(L1prefiring_photonptvseta_2017BtoF.release());
+    prefmap_jet_ = useEMpt_ ? &L1prefiring_jetemptvseta_2017BtoF : &L1prefiring_jetptvseta_2017BtoF;
+    prefmap_photon_ = &L1prefiring_photonptvseta_2017BtoF;
   }
-  else {
-    h_prefmap_jet.reset(useEMpt_ ? L1prefiring_jetemptvseta_2016BtoH.release() : L1prefiring_jetptvseta_2016BtoH.release());
-    h_prefmap_photon.reset(L1prefiring_photonptvseta_2016BtoH.release());
+  else if (dataera_ == "2016BtoH") {
+    prefmap_jet_ = useEMpt_ ? &L1prefiring_jetemptvseta_2016BtoH : &L1prefiring_jetptvseta_2016BtoH;
+    prefmap_photon_ = &L1prefiring_photonptvseta_2016BtoH;
   }
+  else
+    throw cms::Exception("Configuration") << "no prefiring maps for DataEra " << dataera_;
 
   produces<double>( "NonPrefiringProb" ).setBranchAlias( "NonPrefiringProb");
   produces<double>( "NonPrefiringProbUp" ).setBranchAlias( "NonPrefiringProbUp");
@@ -156,60 +171,56 @@ L1ECALPrefiringWeightProducer::produce(edm::Event& iEvent, const edm::EventSetup
    //Probability for the event NOT to prefire, computed with the prefiring maps per object. 
    //Up and down values correspond to the resulting value when shifting up/down all prefiring rates in prefiring maps. 
    double NonPrefiringProba[3]={1.,1.,1.};//0: central, 1: up, 2: down
+   //All three come out of one lookup per object, and the photon ones are kept for the jet overlap below.
+   typedef jmt::L1ECALPrefiringMap::rate_t rate_t;
    
-   for(int fluct = 0; fluct<3;fluct++) {
-     //Start by applying the prefiring maps to photons in the affected regions. 
-     std::vector < pat::Photon > affectedphotons; 
-     for( std::vector<pat::Photon>::const_iterator photon = (*thePhotons).begin(); photon != (*thePhotons).end(); photon++ ) {
-       double pt_gam= (&*photon)->pt();
-       double eta_gam=  (&*photon)->eta();
-       if( pt_gam < 20.) continue;
-       if( fabs(eta_gam) <2.) continue;
-       if( fabs(eta_gam) >3.) continue;
-       affectedphotons.push_back((*photon));
-       double prefiringprob_gam=  GetPrefiringRate( eta_gam, pt_gam, h_prefmap_photon.get(), fluct);  
-       NonPrefiringProba[fluct] *= (1.-prefiringprob_gam);
-     }
+   //Start by applying the prefiring maps to photons in the affected regions. 
+   std::vector<std::pair<const pat::Photon*, rate_t> > affectedphotons;
+   for( const pat::Photon& photon : *thePhotons ) {
+     double pt_gam= photon.pt();
+     double eta_gam= photon.eta();
+     if( pt_gam < 20.) continue;
+     if( fabs(eta_gam) <2.) continue;
+     if( fabs(eta_gam) >3.) continue;
+     const rate_t prefiringprob_gam = prefmap_photon_->rate(eta_gam, pt_gam, prefiringRateSystUnc_);
+     affectedphotons.push_back(std::make_pair(&photon, prefiringprob_gam));
+     for(int fluct = 0; fluct<3;fluct++)
+       NonPrefiringProba[fluct] *= (1.-prefiringprob_gam[fluct]);
+   }
      
-     //Now applying the prefiring maps to jets in the affected regions. 
-     for( std::vector<pat::Jet>::const_iterator jet = (*theJets).begin(); jet != (*theJets).end(); jet++ ) {
-       
-       double pt_jet= (&*jet)->pt();
-       double eta_jet=  (&*jet)->eta();
-       double phi_jet=  (&*jet)->phi();
-       if( pt_jet < 20.) continue;
-       if( fabs(eta_jet) <2.) continue;
-       if( fabs(eta_jet) >3.) continue;
-
-       //Loop over photons to remove overlap
-       double nonprefiringprobfromoverlappingphotons =1.;
-       for( std::vector<pat::Photon>::const_iterator photon = affectedphotons.begin(); photon != affectedphotons.end(); photon++ ) {
-	 double pt_gam= (&*photon)->pt();
-	 double eta_gam=  (&*photon)->eta();
-	 double phi_gam=  (&*photon)->phi();
-	 double dR = reco::deltaR( eta_jet,phi_jet,eta_gam,phi_gam );
-	 if(dR>0.4)continue;
-	 double prefiringprob_gam =  GetPrefiringRate( eta_gam, pt_gam, h_prefmap_photon.get() , fluct);
-	 nonprefiringprobfromoverlappingphotons  *= (1.-prefiringprob_gam) ;
-       }
-       
-       
-       double ptem_jet =  pt_jet*(jet->neutralEmEnergyFraction()+jet->chargedEmEnergyFraction());
-       double prefiringprob_jet = (useEMpt_) ? GetPrefiringRate( eta_jet, ptem_jet, h_prefmap_jet.get() , fluct) : GetPrefiringRate( eta_jet, pt_jet , h_prefmap_jet.get() , fluct);
-       //useEMpt =true if one wants to use maps parametrized vs Jet EM pt instead of pt.
-       double nonprefiringprobfromoverlappingjet =(1.-prefiringprob_jet);
+   //Now applying the prefiring maps to jets in the affected regions. 
+   for( const pat::Jet& jet : *theJets ) {
+     double pt_jet= jet.pt();
+     double eta_jet= jet.eta();
+     double phi_jet= jet.phi();
+     if( pt_jet < 20.) continue;
+     if( fabs(eta_jet) <2.) continue;
+     if( fabs(eta_jet) >3.) continue;
+
+     //Loop over photons to remove overlap
+     double nonprefiringprobfromoverlappingphotons[3] = {1.,1.,1.};
+     for( const auto& p : affectedphotons ) {
+       double dR = reco::deltaR( eta_jet,phi_jet,p.first->eta(),p.first->phi() );
+       if(dR>0.4)continue;
+       for(int fluct = 0; fluct<3;fluct++)
+         nonprefiringprobfromoverlappingphotons[fluct] *= (1.-p.second[fluct]);
+     }
+
+     double ptem_jet =  pt_jet*(jet.neutralEmEnergyFraction()+jet.chargedEmEnergyFraction());
+     //useEMpt =true if one wants to use maps parametrized vs Jet EM pt instead of pt.
+     const rate_t prefiringprob_jet = prefmap_jet_->rate(eta_jet, useEMpt_ ? ptem_jet : pt_jet, prefiringRateSystUnc_);
+
+     for(int fluct = 0; fluct<3;fluct++) {
+       double nonprefiringprobfromoverlappingjet =(1.-prefiringprob_jet[fluct]);
        //If there are no overlapping photons, just multiply by the jet non prefiring rate
-       if(nonprefiringprobfromoverlappingphotons ==1.)    NonPrefiringProba[fluct]*= (1.-prefiringprob_jet);
+       if(nonprefiringprobfromoverlappingphotons[fluct] ==1.)    NonPrefiringProba[fluct]*= (1.-prefiringprob_jet[fluct]);
        //If overlapping photons have a non prefiring rate larger than the jet, then replace these weights by the jet one
-       else if(nonprefiringprobfromoverlappingphotons > nonprefiringprobfromoverlappingjet ) {
-	 if(nonprefiringprobfromoverlappingphotons !=0.)NonPrefiringProba[fluct]*= nonprefiringprobfromoverlappingjet /nonprefiringprobfromoverlappingphotons;
-	 else NonPrefiringProba[fluct]=0.;
-	 
-	 
+       else if(nonprefiringprobfromoverlappingphotons[fluct] > nonprefiringprobfromoverlappingjet ) {
+         if(nonprefiringprobfromoverlappingphotons[fluct] !=0.)NonPrefiringProba[fluct]*= nonprefiringprobfromoverlappingjet /nonprefiringprobfromoverlappingphotons[fluct];
+         else NonPrefiringProba[fluct]=0.;
        }
        //If overlapping photons have a non prefiring rate smaller than the jet, don't consider the jet in the event weight
-       else if(nonprefiringprobfromoverlappingphotons < nonprefiringprobfromoverlappingjet ) NonPrefiringProba[fluct]*=1.;
-     
+       else if(nonprefiringprobfromoverlappingphotons[fluct] < nonprefiringprobfromoverlappingjet ) NonPrefiringProba[fluct]*=1.;
      }
    }
    
@@ -224,26 +235,6 @@ L1ECALPrefiringWeightProducer::produce(edm::Event& iEvent, const edm::EventSetup
 }
 
 
-double L1ECALPrefiringWeightProducer::GetPrefiringRate( double eta, double pt, TH2F * h_prefmap /*std::string object, std::string dataera*/ , int fluctuation){
-
-  if(h_prefmap==0) return 0.;
-  //Check pt is not above map overflow
-  int nbinsy = h_prefmap->GetNbinsY();
-  double maxy= h_prefmap->GetYaxis()->GetBinLowEdge(nbinsy+1);
-  if(pt>=maxy) pt = maxy-0.01;
-  int thebin= h_prefmap->FindBin(eta,pt);
-  
-  double prefrate =  h_prefmap->GetBinContent(thebin);
-  
-  if(fluctuation == up) prefrate = TMath::Min(TMath::Max(prefrate +  h_prefmap->GetBinError(thebin), (1.+prefiringRateSystUnc_)*prefrate),1.);
-  if(fluctuation == down) prefrate = TMath::Max(TMath::Min(prefrate -  h_prefmap->GetBinError(thebin), (1.-prefiringRateSystUnc_)*prefrate),0.);    
-  
-  return prefrate;
-  
-  
-}
-
-
 // ------------ method called once each stream before processing any runs, lumis or events  ------------
 void
 L1ECALPrefiringWeightProducer::beginStream(edm::StreamID)
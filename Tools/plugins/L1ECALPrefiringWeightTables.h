@@ -0,0 +1,244 @@
+#ifndef JMTucker_Tools_L1ECALPrefiringWeightTables_h
+#define JMTucker_Tools_L1ECALPrefiringWeightTables_h
+
+// Generated from L1PrefiringMaps_new.root, see the script at the top of
+// L1ECALPrefiringWeightProducer.cc. Contents are float as TH2F
+// stores them, errors double as in TH2F's sumw2, and both are indexed
+// by TH2 global bin.
+
+#include "JMTucker/Tools/interface/L1ECALPrefiringMap.h"
+
+namespace L1ECALPrefiringWeightTables {
+
+  constexpr double L1prefiring_jetemptvseta_2017BtoF_x[33] = {-5, -4, -3.5, -3.1, -3, -2.75, -2.5, -2.25, -2, -1.75, -1.5, -1.25, -1, -0.75, -0.5, -0.25, 0, 0.25, 0.5, 0.75, 1, 1.25, 1.5, 1.75, 2, 2.25, 2.5, 2.75, 3, 3.1, 3.5, 4, 5};
+  constexpr double L1prefiring_jetemptvseta_2017BtoF_y[14] = {10, 15, 20, 25, 30, 35, 40, 50, 70, 100, 150, 200, 300, 500};
+  constexpr float L1prefiring_jetemptvseta_2017BtoF_content[15*34] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.00763359, 0.00565523, 0.00936884, 0.0107527, 1e-06, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00621762, 0.0303279, 0.00733407, 1e-06, 0.00763359, 0, 0, 0, 0,
+    0, 0, 0, 0, 1e-06, 0.00786517, 0.00886525, 0.0202312, 0.0113852, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0141414, 0.043758, 0.0119435, 0.00574713, 1e-06, 0, 0, 0, 0,
+    0, 0, 0, 0, 1e-06, 0.00702106, 0.0163666, 0.0192837, 0.0138889, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0192926, 0.0512821, 0.0102459, 0.00517539, 1e-06, 0, 0, 0, 0,
+    0, 0, 0, 0, 1e-06, 1e-06, 0.0405797, 0.0298507, 0.0246914, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0388889, 0.0833333, 0.043573, 0.0182648, 1e-06, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.125, 0.0302115, 0.0521472, 0.0651163, 0.025, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0162162, 0.103175, 0.0334728, 0.0225873, 1e-06, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.4, 0.148362, 0.112426, 0.130584, 0.0326923, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0459082, 0.180585, 0.101874, 0.162409, 0.111111, 0, 0, 0, 0,
+    0, 0, 0, 0, 1e-06, 0.406154, 0.287856, 0.152844, 0.040796, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.077167, 0.285528, 0.306729, 0.440895, 1e-06, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.333333, 0.686099, 0.484746, 0.231429, 0.0529158, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.103763, 0.382514, 0.552268, 0.668182, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.786517, 0.644269, 0.290761, 0.0617284, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.146199, 0.458333, 0.684874, 0.844156, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.916667, 0.728916, 0.346939, 0.0820513, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.191489, 0.454545, 0.809756, 0.952381, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 1, 0.75, 0.328571, 0.0629921, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.230769, 0.528571, 0.811321, 1, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+  };
+  constexpr double L1prefiring_jetemptvseta_2017BtoF_error[15*34] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.00447781, 0.000357338, 0.00146453, 0.00226387, 0.00217154, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00112261, 0.0044983, 0.000924074, 0.000779017, 0.00447781, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.0194147, 0.00103442, 0.00184754, 0.00465566, 0.00346969, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0042777, 0.00692447, 0.00193478, 0.000406231, 0.019799, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.048734, 0.00142234, 0.00428857, 0.00622793, 0.00553081, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00673053, 0.0106386, 0.00231229, 0.00031755, 0.0644061, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.216506, 0.0041585, 0.00997298, 0.0109801, 0.010916, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0134867, 0.0182824, 0.00898863, 0.00446343, 0.104757, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.114891, 0.00861669, 0.011739, 0.0162112, 0.0098995, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00774262, 0.0187439, 0.00760727, 0.00595637, 0.152145, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.218621, 0.0153827, 0.0106524, 0.0112155, 0.00508821, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00625751, 0.0122923, 0.0101216, 0.0155572, 0.10266, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.353553, 0.0271876, 0.0174391, 0.0122177, 0.00586029, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00841315, 0.0162217, 0.0181581, 0.0280284, 0.216506, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.271128, 0.0312091, 0.0205678, 0.0158186, 0.00701894, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0100743, 0.0179174, 0.0221063, 0.0318642, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.0438009, 0.0301907, 0.0235505, 0.010493, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0153746, 0.0262373, 0.0302403, 0.0418677, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.04096, 0.0346985, 0.0276652, 0.0135035, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0189382, 0.0278517, 0.027685, 0.0344516, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.0235112, 0.0629111, 0.0559174, 0.0207401, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0366687, 0.059695, 0.0542822, 0.0188509, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+  };
+  constexpr jmt::L1ECALPrefiringMap L1prefiring_jetemptvseta_2017BtoF = {
+    {32, -5, 5, L1prefiring_jetemptvseta_2017BtoF_x}, {13, 10, 500, L1prefiring_jetemptvseta_2017BtoF_y},
+    L1prefiring_jetemptvseta_2017BtoF_content, L1prefiring_jetemptvseta_2017BtoF_error
+  };
+
+  constexpr double L1prefiring_jetptvseta_2017BtoF_x[33] = {-5, -4, -3.5, -3.1, -3, -2.75, -2.5, -2.25, -2, -1.75, -1.5, -1.25, -1, -0.75, -0.5, -0.25, 0, 0.25, 0.5, 0.75, 1, 1.25, 1.5, 1.75, 2, 2.25, 2.5, 2.75, 3, 3.1, 3.5, 4, 5};
+  constexpr double L1prefiring_jetptvseta_2017BtoF_y[14] = {10, 15, 20, 25, 30, 35, 40, 50, 70, 100, 150, 200, 300, 500};
+  constexpr float L1prefiring_jetptvseta_2017BtoF_content[15*34] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.025, 1e-06, 0.00826446, 1e-06, 0.00537634, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1e-06, 0.0163399, 0.00787402, 1e-06, 1e-06, 0, 0, 0, 0,
+    0, 0, 0, 0, 1e-06, 0.00724055, 1e-06, 0.00668896, 0.0106952, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1e-06, 0.00775194, 0.00745712, 1e-06, 0.0357143, 0, 0, 0, 0,
+    0, 0, 0, 0, 1e-06, 0.00619915, 0.00921273, 0.0105042, 0.008, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00515464, 0.016, 0.00838457, 0.00601251, 1e-06, 0, 0, 0, 0,
+    0, 0, 0, 0, 1e-06, 0.00666223, 0.0170455, 0.0117493, 1e-06, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.015544, 0.0440806, 0.0189791, 0.00970874, 1e-06, 0, 0, 0, 0,
+    0, 0, 0, 0, 1e-06, 0.0440252, 0.0501285, 0.0558292, 0.0152091, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0189036, 0.105769, 0.0428922, 0.0489914, 1e-06, 0, 0, 0, 0,
+    0, 0, 0, 0, 1e-06, 0.221505, 0.150579, 0.105581, 0.0259542, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0402685, 0.189959, 0.139798, 0.254202, 1e-06, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.25, 0.450758, 0.300901, 0.149109, 0.0281924, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0494418, 0.222997, 0.325956, 0.459144, 1e-06, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.666667, 0.593525, 0.442073, 0.188063, 0.0455408, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0866463, 0.307334, 0.506645, 0.66087, 0.333333, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.333333, 0.813725, 0.616302, 0.274823, 0.0609189, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.138567, 0.435498, 0.741453, 0.854167, 1e-06, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+  };
+  constexpr double L1prefiring_jetptvseta_2017BtoF_error[15*34] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.0221359, 0.00147314, 0.00231909, 0.00485975, 0.00142218, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00496273, 0.00605295, 0.00158342, 0.00105552, 0.0281603, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.0253102, 0.000948286, 0.00282084, 0.00237469, 0.00550292, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00617543, 0.00266296, 0.00135196, 0.000980951, 0.0326075, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.0229838, 0.000681211, 0.0018744, 0.00339114, 0.00282418, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.000631263, 0.0041721, 0.00137313, 0.000493215, 0.0224675, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.0219739, 0.00105146, 0.00310796, 0.00295833, 0.00315776, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00424485, 0.00687723, 0.00300345, 0.0015475, 0.0170921, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.033883, 0.00767891, 0.00744232, 0.00890062, 0.00438302, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00509091, 0.0120506, 0.00668408, 0.00778457, 0.028976, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.0539903, 0.0190997, 0.0126525, 0.011681, 0.0055965, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00755568, 0.0143019, 0.0121197, 0.0198259, 0.0539903, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.215044, 0.0305913, 0.0193751, 0.0141388, 0.00612941, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00822982, 0.0172335, 0.0209408, 0.0310577, 0.353553, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.273169, 0.0295143, 0.0193665, 0.0129774, 0.0060749, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00874256, 0.0156701, 0.0203784, 0.0313261, 0.271128, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.271128, 0.038943, 0.0217345, 0.013216, 0.00522059, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00780852, 0.0145694, 0.0203647, 0.0365266, 0.353553, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+  };
+  constexpr jmt::L1ECALPrefiringMap L1prefiring_jetptvseta_2017BtoF = {
+    {32, -5, 5, L1prefiring_jetptvseta_2017BtoF_x}, {13, 10, 500, L1prefiring_jetptvseta_2017BtoF_y},
+    L1prefiring_jetptvseta_2017BtoF_content, L1prefiring_jetptvseta_2017BtoF_error
+  };
+
+  constexpr double L1prefiring_photonptvseta_2017BtoF_x[33] = {-5, -4, -3.5, -3.1, -3, -2.75, -2.5, -2.25, -2, -1.75, -1.5, -1.25, -1, -0.75, -0.5, -0.25, 0, 0.25, 0.5, 0.75, 1, 1.25, 1.5, 1.75, 2, 2.25, 2.5, 2.75, 3, 3.1, 3.5, 4, 5};
+  constexpr double L1prefiring_photonptvseta_2017BtoF_y[10] = {20, 25, 30, 35, 40, 50, 70, 100, 200, 500};
+  constexpr float L1prefiring_photonptvseta_2017BtoF_content[11*34] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.0133333, 0.0176991, 0.039823, 1e-06, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0102041, 0.0330882, 0.0152091, 0.018018, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.0186335, 0.038835, 0.0593607, 0.030303, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0247934, 0.132159, 0.05, 0.0318471, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.0322581, 0.0436893, 0.112782, 0.0298013, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.035503, 0.22179, 0.078534, 0.0487805, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.15534, 0.0571429, 0.124224, 0.025, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0582524, 0.24918, 0.0764331, 0.128205, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.255682, 0.14121, 0.141573, 0.0349418, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0711974, 0.271574, 0.155989, 0.243094, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.441397, 0.272124, 0.139881, 0.0180587, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0776699, 0.239011, 0.318761, 0.417553, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.575, 0.437276, 0.217949, 0.0328947, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0976431, 0.322727, 0.527273, 0.600791, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.789668, 0.551181, 0.212209, 0.0354167, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.104839, 0.383378, 0.697624, 0.744604, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.867925, 0.705607, 0.312977, 0.0492228, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.13449, 0.505791, 0.796491, 0.761589, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 1, 0.8, 0.6, 0.105263, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.264706, 0.5, 0.923077, 1, 0, 0, 0, 0, 0
+  };
+  constexpr double L1prefiring_photonptvseta_2017BtoF_error[11*34] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.0060604, 0.0074483, 0.012195, 0.00356505, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00419629, 0.0100182, 0.00619852, 0.00760765, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.00913925, 0.0125972, 0.0153209, 0.00966538, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00895388, 0.022112, 0.0146586, 0.0129, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.014623, 0.0134367, 0.0190137, 0.00894912, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00935375, 0.0257035, 0.0188861, 0.0184487, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.0352161, 0.0153412, 0.0180587, 0.00667424, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0110621, 0.0245988, 0.0205545, 0.0303858, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.0326692, 0.0184138, 0.0162785, 0.00695185, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0100012, 0.0222761, 0.0188965, 0.0316582, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.024766, 0.0208115, 0.0186356, 0.00539378, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0127893, 0.0221911, 0.0198039, 0.0253881, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.031957, 0.0296584, 0.0267628, 0.00944454, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0168235, 0.0313903, 0.0274968, 0.0308525, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.0249697, 0.0255063, 0.0218527, 0.00783841, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0134607, 0.0251114, 0.0214434, 0.0263205, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.0272752, 0.0313077, 0.0285213, 0.0104642, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0156371, 0.0310684, 0.0240637, 0.034923, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 1, 0.894427, 0.774597, 0.324443, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.514496, 0.707107, 0.960769, 1, 0, 0, 0, 0, 0
+  };
+  constexpr jmt::L1ECALPrefiringMap L1prefiring_photonptvseta_2017BtoF = {
+    {32, -5, 5, L1prefiring_photonptvseta_2017BtoF_x}, {9, 20, 500, L1prefiring_photonptvseta_2017BtoF_y},
+    L1prefiring_photonptvseta_2017BtoF_content, L1prefiring_photonptvseta_2017BtoF_error
+  };
+
+  constexpr double L1prefiring_jetptvseta_2016BtoH_x[33] = {-5, -4, -3.5, -3.1, -3, -2.75, -2.5, -2.25, -2, -1.75, -1.5, -1.25, -1, -0.75, -0.5, -0.25, 0, 0.25, 0.5, 0.75, 1, 1.25, 1.5, 1.75, 2, 2.25, 2.5, 2.75, 3, 3.1, 3.5, 4, 5};
+  constexpr double L1prefiring_jetptvseta_2016BtoH_y[14] = {10, 15, 20, 25, 30, 35, 40, 50, 70, 100, 150, 200, 300, 500};
+  constexpr float L1prefiring_jetptvseta_2016BtoH_content[15*34] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 1e-06, 0.0133229, 0.0179007, 0.00826446, 0.0164835, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0115473, 0.00834327, 0.00720367, 0.0139721, 1e-06, 0, 0, 0, 0,
+    0, 0, 0, 0, 1e-06, 0.012766, 0.0164084, 0.0147493, 0.0190217, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1e-06, 0.0182529, 0.0107391, 0.00643777, 1e-06, 0, 0, 0, 0,
+    0, 0, 0, 0, 1e-06, 0.0175084, 0.0120898, 0.0160075, 0.0109546, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0142248, 0.0135478, 0.016147, 0.00891795, 1e-06, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.0294118, 0.0108243, 0.015894, 0.0196749, 0.0109409, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0169323, 0.017611, 0.0163657, 0.00856698, 1e-06, 0, 0, 0, 0,
+    0, 0, 0, 0, 1e-06, 0.0230769, 0.0232816, 0.026764, 0.0127298, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0190996, 0.0436893, 0.0268156, 0.0244755, 1e-06, 0, 0, 0, 0,
+    0, 0, 0, 0, 1e-06, 0.0802752, 0.0717762, 0.0369427, 0.0122283, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0279627, 0.0792541, 0.0661157, 0.0859729, 0.0909091, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.25, 0.265873, 0.174342, 0.0703364, 0.0159744, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0220264, 0.146305, 0.14311, 0.219178, 1e-06, 0, 0, 0, 0,
+    0, 0, 0, 0, 1e-06, 0.396761, 0.264402, 0.0987167, 0.0222222, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0358598, 0.203441, 0.289174, 0.348837, 1e-06, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.537879, 0.480926, 0.134449, 0.0253637, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0566901, 0.262042, 0.443672, 0.517544, 1e-06, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+  };
+  constexpr double L1prefiring_jetptvseta_2016BtoH_error[15*34] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.033883, 0.00254329, 0.00321893, 0.00211703, 0.00558443, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00387581, 0.00199286, 0.00119998, 0.00243226, 0.028976, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.0444095, 0.00256086, 0.0032064, 0.00377349, 0.0061293, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00346618, 0.00412916, 0.00189859, 0.00101339, 0.0350707, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.033883, 0.00288406, 0.00201313, 0.00320169, 0.00304354, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00360568, 0.00267879, 0.00247737, 0.00152323, 0.0259672, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.0264663, 0.00219575, 0.00267133, 0.00351699, 0.00254191, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00342679, 0.00308779, 0.00251816, 0.00166376, 0.0246855, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.0688303, 0.00584251, 0.00446064, 0.00508927, 0.00329375, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0043548, 0.00671837, 0.00488296, 0.00577798, 0.0377146, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.104757, 0.0126354, 0.00870698, 0.00627627, 0.0031225, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00546572, 0.00895081, 0.00823077, 0.0129755, 0.0844925, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.215044, 0.0276614, 0.0152104, 0.0096631, 0.00416397, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00495746, 0.0135282, 0.0145021, 0.0277222, 0.13226, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.272166, 0.0310598, 0.0168455, 0.00915663, 0.00366511, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00493705, 0.0126884, 0.0170227, 0.0295714, 0.216506, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.0434252, 0.0184339, 0.00835592, 0.0027278, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00415451, 0.0110749, 0.0185061, 0.0468146, 0.353553, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+  };
+  constexpr jmt::L1ECALPrefiringMap L1prefiring_jetptvseta_2016BtoH = {
+    {32, -5, 5, L1prefiring_jetptvseta_2016BtoH_x}, {13, 10, 500, L1prefiring_jetptvseta_2016BtoH_y},
+    L1prefiring_jetptvseta_2016BtoH_content, L1prefiring_jetptvseta_2016BtoH_error
+  };
+
+  constexpr double L1prefiring_jetemptvseta_2016BtoH_x[33] = {-5, -4, -3.5, -3.1, -3, -2.75, -2.5, -2.25, -2, -1.75, -1.5, -1.25, -1, -0.75, -0.5, -0.25, 0, 0.25, 0.5, 0.75, 1, 1.25, 1.5, 1.75, 2, 2.25, 2.5, 2.75, 3, 3.1, 3.5, 4, 5};
+  constexpr double L1prefiring_jetemptvseta_2016BtoH_y[14] = {10, 15, 20, 25, 30, 35, 40, 50, 70, 100, 150, 200, 300, 500};
+  constexpr float L1prefiring_jetemptvseta_2016BtoH_content[15*34] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.0138889, 0.0120482, 0.0151707, 0.0145005, 0.0101966, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0149837, 0.0139373, 0.0120653, 0.0104397, 1e-06, 0, 0, 0, 0,
+    0, 0, 0, 0, 1e-06, 0.0181137, 0.0126304, 0.0186047, 0.0134529, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00984683, 0.0146306, 0.0106729, 0.00940266, 1e-06, 0, 0, 0, 0,
+    0, 0, 0, 0, 1e-06, 0.0142653, 0.0169811, 0.0226929, 0.0204082, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0121951, 0.023407, 0.0167364, 0.012285, 0.0454545, 0, 0, 0, 0,
+    0, 0, 0, 0, 1e-06, 0.00746269, 0.0278261, 0.0114286, 0.0164609, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0277778, 0.0283688, 0.0322108, 0.0116959, 1e-06, 0, 0, 0, 0,
+    0, 0, 0, 0, 1e-06, 0.0343348, 0.00636943, 0.0175439, 0.00816326, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0197628, 0.0681818, 0.0222222, 0.0246479, 1e-06, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.111111, 0.0541667, 0.0614634, 0.0510597, 0.0127986, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0263753, 0.0916096, 0.0368574, 0.0564854, 1e-06, 0, 0, 0, 0,
+    0, 0, 0, 0, 1e-06, 0.22082, 0.169492, 0.0897436, 0.0235492, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0328305, 0.152151, 0.156915, 0.189003, 1e-06, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.507317, 0.307018, 0.100742, 0.0231214, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0527638, 0.200908, 0.327744, 0.464865, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.654545, 0.535461, 0.136719, 0.0253521, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0568032, 0.324111, 0.451505, 0.623188, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.815789, 0.579439, 0.155462, 0.0353846, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.068314, 0.292056, 0.544248, 0.567568, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 1, 0.659091, 0.159292, 0.00591716, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0588235, 0.393701, 0.557692, 0.666667, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+  };
+  constexpr double L1prefiring_jetemptvseta_2016BtoH_error[15*34] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.0110616, 0.0015748, 0.00205971, 0.00224808, 0.00194042, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00253754, 0.00209973, 0.00157781, 0.00130825, 0.0110492, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.0273893, 0.00284315, 0.00203918, 0.00322533, 0.00306533, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00229721, 0.00264144, 0.00161786, 0.00155704, 0.0215015, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.0605154, 0.00361868, 0.00334179, 0.0051277, 0.00586522, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00381038, 0.00484724, 0.00311544, 0.00298068, 0.0420054, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.216506, 0.00302762, 0.00622827, 0.00427192, 0.00682815, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00879136, 0.00734536, 0.00622544, 0.00440994, 0.0948683, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.152145, 0.0110547, 0.00170397, 0.00601813, 0.00358754, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0075822, 0.0129674, 0.00559855, 0.0082355, 0.104757, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.10266, 0.00986886, 0.00720943, 0.00650613, 0.00256948, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00397035, 0.00822981, 0.00546947, 0.0101076, 0.13226, 0, 0, 0, 0,
+    0, 0, 0, 0, 0.5, 0.023106, 0.013386, 0.00910305, 0.00391296, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0048997, 0.0114755, 0.0130891, 0.0227149, 0.152145, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.0349211, 0.0175554, 0.00958169, 0.00383312, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00617191, 0.0133718, 0.0182538, 0.0366421, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.0643338, 0.0297193, 0.0149458, 0.0052992, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00805526, 0.0207221, 0.0287498, 0.0584871, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.0635382, 0.0337984, 0.0163871, 0.0067324, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00928437, 0.021867, 0.0331569, 0.0815534, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.0352668, 0.071709, 0.0339815, 0.00232852, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0158, 0.0432546, 0.0689514, 0.273169, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+  };
+  constexpr jmt::L1ECALPrefiringMap L1prefiring_jetemptvseta_2016BtoH = {
+    {32, -5, 5, L1prefiring_jetemptvseta_2016BtoH_x}, {13, 10, 500, L1prefiring_jetemptvseta_2016BtoH_y},
+    L1prefiring_jetemptvseta_2016BtoH_content, L1prefiring_jetemptvseta_2016BtoH_error
+  };
+
+  constexpr double L1prefiring_photonptvseta_2016BtoH_x[33] = {-5, -4, -3.5, -3.1, -3, -2.75, -2.5, -2.25, -2, -1.75, -1.5, -1.25, -1, -0.75, -0.5, -0.25, 0, 0.25, 0.5, 0.75, 1, 1.25, 1.5, 1.75, 2, 2.25, 2.5, 2.75, 3, 3.1, 3.5, 4, 5};
+  constexpr double L1prefiring_photonptvseta_2016BtoH_y[10] = {20, 25, 30, 35, 40, 50, 70, 100, 200, 500};
+  constexpr float L1prefiring_photonptvseta_2016BtoH_content[11*34] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.0115385, 0.00990099, 0.0159744, 0.00940439, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0111732, 0.0200669, 1e-06, 1e-06, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.0327869, 0.0201342, 0.0342679, 1e-06, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1e-06, 0.0511182, 0.0388693, 0.00540541, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.013245, 0.0301003, 0.0418719, 0.00952381, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0245902, 0.103261, 0.019544, 0.0118343, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.0218579, 0.0438871, 0.058427, 0.0155642, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0342205, 0.101737, 0.0459016, 0.0314465, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.0968992, 0.0634573, 0.0654545, 0.011065, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0342146, 0.163339, 0.0734177, 0.0692042, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.153614, 0.189066, 0.09375, 0.0117371, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0455531, 0.161017, 0.170782, 0.1875, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.357542, 0.251029, 0.0782609, 0.0257353, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0630372, 0.203846, 0.306931, 0.30303, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.655, 0.453297, 0.156915, 0.0232558, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0484653, 0.248, 0.489691, 0.514852, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.73494, 0.568627, 0.174468, 0.0387931, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0648536, 0.307393, 0.683938, 0.546667, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.444444, 0.666667, 1, 0, 0, 0, 0, 0
+  };
+  constexpr double L1prefiring_photonptvseta_2016BtoH_error[11*34] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.00499835, 0.00401193, 0.00588875, 0.00370757, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0041397, 0.00704498, 0.00382216, 0.00577215, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.01215, 0.0070723, 0.00940791, 0.00369243, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00335915, 0.0118553, 0.0107529, 0.00148003, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.00735885, 0.00904657, 0.00935248, 0.00327448, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00627354, 0.015517, 0.00683268, 0.00633746, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.00951666, 0.0108242, 0.0106605, 0.00450952, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00734364, 0.0147248, 0.011341, 0.0127252, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.0179851, 0.0109744, 0.0101623, 0.00288752, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00664135, 0.015552, 0.0127027, 0.0144186, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.019522, 0.0184962, 0.0145123, 0.00396336, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00918697, 0.0192864, 0.016869, 0.020135, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.0357096, 0.0276291, 0.0171811, 0.00864014, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0125158, 0.0247531, 0.0263743, 0.0325055, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.0337268, 0.0260666, 0.0185108, 0.00545634, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.00819551, 0.022148, 0.0253718, 0.035173, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0.0487343, 0.040094, 0.0244731, 0.00838861, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.01085, 0.02865, 0.0336071, 0.0575342, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0.666667, 0.816497, 1, 0, 0, 0, 0, 0
+  };
+  constexpr jmt::L1ECALPrefiringMap L1prefiring_photonptvseta_2016BtoH = {
+    {32, -5, 5, L1prefiring_photonptvseta_2016BtoH_x}, {9, 20, 500, L1prefiring_photonptvseta_2016BtoH_y},
+    L1prefiring_photonptvseta_2016BtoH_content, L1prefiring_photonptvseta_2016BtoH_error
+  };
+}
+
+#endif
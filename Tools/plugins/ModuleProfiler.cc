@@ -0,0 +1,392 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <vector>
+#include <time.h>
+#include "TDirectory.h"
+#include "TFile.h"
+#include "TH1.h"
+#include "TTree.h"
+#include "CommonTools/UtilAlgos/interface/TFileService.h"
+#include "DataFormats/Provenance/interface/ModuleDescription.h"
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/ServiceRegistry/interface/ActivityRegistry.h"
+#include "FWCore/ServiceRegistry/interface/ModuleCallingContext.h"
+#include "FWCore/ServiceRegistry/interface/Service.h"
+#include "FWCore/ServiceRegistry/interface/ServiceMaker.h"
+#include "FWCore/ServiceRegistry/interface/StreamContext.h"
+#include "FWCore/ServiceRegistry/interface/SystemBounds.h"
+#include "JMTucker/Tools/interface/AllocHook.h"
+
+// Per-module wall and CPU time, and allocations if the AllocHook shim
+// is preloaded, for every module's event calls, written into a
+// directory of the TFileService output. The summary histograms have
+// one bin per module with the totals; with per_module_histos, each
+// module also gets its per-call distributions in log10. The tail tree
+// gets run/lumi/event and totals for every event that was among the
+// max_tail_events slowest so far when it finished, so the true
+// slowest ones are the top of that tree sorted by wall, ready for
+// replay_event.
+//
+// Per-module times are inclusive of anything a module runs inside its
+// own call, e.g. unscheduled producers it gets products from. The
+// per-event CPU and allocation totals subtract those nested calls so
+// they are only counted once. CPU is the thread clock, so it's right
+// as long as a module doesn't hop threads mid-call, which event calls
+// don't.
+
+class JMTModuleProfiler {
+public:
+  JMTModuleProfiler(const edm::ParameterSet&, edm::ActivityRegistry&);
+
+private:
+  typedef std::chrono::steady_clock clock;
+
+  struct Snapshot {
+    clock::time_point wall;
+    double cpu;
+    unsigned long long nalloc;
+    unsigned long long bytes;
+
+    static double thread_cpu() {
+      timespec ts;
+      clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+      return ts.tv_sec + ts.tv_nsec * 1e-9;
+    }
+
+    // Clocks innermost, so reading the others isn't counted.
+    void start() {
+      const jmt::AllocCounts* a = jmt::alloc_counts();
+      nalloc = a ? a->n : 0;
+      bytes = a ? a->bytes : 0;
+      cpu = thread_cpu();
+      wall = clock::now();
+    }
+
+    void stop() {
+      wall = clock::now();
+      cpu = thread_cpu();
+      const jmt::AllocCounts* a = jmt::alloc_counts();
+      nalloc = a ? a->n : 0;
+      bytes = a ? a->bytes : 0;
+    }
+  };
+
+  // What the calls nested inside one module call on this thread
+  // used, to be taken out of its per-event contribution.
+  struct Nested {
+    double cpu;
+    unsigned long long nalloc;
+    unsigned long long bytes;
+  };
+
+  static std::vector<Nested>& nesting() {
+    static thread_local std::vector<Nested> v;
+    return v;
+  }
+
+  struct Module {
+    std::string label;
+    int bin; // in the summary histograms, 0 if not a module
+    unsigned long long ncalls;
+    double wall;
+    double cpu;
+    unsigned long long nalloc;
+    unsigned long long bytes;
+    TH1F* h_wall;
+    TH1F* h_cpu;
+    TH1F* h_nalloc;
+    TH1F* h_bytes;
+  };
+
+  struct StreamState {
+    std::vector<Snapshot> module_start; // by module id
+    clock::time_point event_start;
+    double cpu;
+    unsigned long long nalloc;
+    unsigned long long bytes;
+    int slowest;
+    double slowest_wall;
+  };
+
+  struct Tail {
+    unsigned run;
+    unsigned lumi;
+    unsigned long long event;
+    unsigned stream;
+    double wall;
+    double cpu;
+    unsigned long long nalloc;
+    unsigned long long bytes;
+    int slowest;
+    double slowest_wall;
+  };
+
+  void preallocate(const edm::service::SystemBounds&);
+  void preModuleBeginJob(const edm::ModuleDescription&);
+  void postBeginJob();
+  void preEvent(const edm::StreamContext&);
+  void postEvent(const edm::StreamContext&);
+  void preModuleEvent(const edm::StreamContext&, const edm::ModuleCallingContext&);
+  void postModuleEvent(const edm::StreamContext&, const edm::ModuleCallingContext&);
+  void postEndJob();
+
+  static double safe_log10(double x) { return x > 0 ? log10(x) : -10; }
+  bool profiled(unsigned id) const { return id < modules.size() && modules[id].bin != 0; }
+
+  const unsigned max_tail_events;
+  const bool per_module_histos;
+  const std::string dir_name;
+  const bool have_alloc_hook;
+
+  std::mutex mutex;
+  std::vector<Module> modules; // by module id
+  std::vector<StreamState> streams;
+  std::priority_queue<double, std::vector<double>, std::greater<double>> tail_walls;
+
+  TH1D* h_ncalls;
+  TH1D* h_wall_total;
+  TH1D* h_cpu_total;
+  TH1D* h_nalloc_total;
+  TH1D* h_bytes_total;
+  TH1F* h_event_wall;
+  TH1F* h_event_cpu;
+  TH1F* h_event_nalloc;
+  TH1F* h_event_bytes;
+  TTree* t_tail;
+  Tail tail;
+};
+
+JMTModuleProfiler::JMTModuleProfiler(const edm::ParameterSet& cfg, edm::ActivityRegistry& reg)
+  : max_tail_events(cfg.getUntrackedParameter<unsigned>("max_tail_events", 20)),
+    per_module_histos(cfg.getUntrackedParameter<bool>("per_module_histos", true)),
+    dir_name(cfg.getUntrackedParameter<std::string>("dir_name", "ModuleProfiler")),
+    have_alloc_hook(jmt::alloc_hook_loaded()),
+    h_ncalls(nullptr),
+    t_tail(nullptr)
+{
+  // Touching TFileService here makes sure it's constructed first,
+  // so that its file is open when we book in postBeginJob.
+  edm::Service<TFileService> fs;
+  if (!fs.isAvailable())
+    throw cms::Exception("Configuration", "JMTModuleProfiler needs the TFileService");
+
+  if (!have_alloc_hook)
+    edm::LogInfo("JMTModuleProfiler") << "allocation hook not preloaded, allocation counts will be zero";
+
+  reg.watchPreallocate(this, &JMTModuleProfiler::preallocate);
+  reg.watchPreModuleBeginJob(this, &JMTModuleProfiler::preModuleBeginJob);
+  reg.watchPostBeginJob(this, &JMTModuleProfiler::postBeginJob);
+  reg.watchPreEvent(this, &JMTModuleProfiler::preEvent);
+  reg.watchPostEvent(this, &JMTModuleProfiler::postEvent);
+  reg.watchPreModuleEvent(this, &JMTModuleProfiler::preModuleEvent);
+  reg.watchPostModuleEvent(this, &JMTModuleProfiler::postModuleEvent);
+  reg.watchPostEndJob(this, &JMTModuleProfiler::postEndJob);
+}
+
+void JMTModuleProfiler::preallocate(const edm::service::SystemBounds& b) {
+  streams.resize(b.maxNumberOfStreams());
+}
+
+void JMTModuleProfiler::preModuleBeginJob(const edm::ModuleDescription& md) {
+  const unsigned id = md.id();
+  if (id >= modules.size())
+    modules.resize(id+1);
+  modules[id].label = md.moduleLabel();
+}
+
+void JMTModuleProfiler::postBeginJob() {
+  for (StreamState& s : streams)
+    s.module_start.resize(modules.size());
+
+  std::vector<unsigned> ids;
+  for (unsigned id = 0; id < modules.size(); ++id)
+    if (!modules[id].label.empty())
+      ids.push_back(id);
+  const int n = int(ids.size());
+
+  edm::Service<TFileService> fs;
+  TDirectory::TContext ctx;
+  TDirectory* dir = fs->file().mkdir(dir_name.c_str());
+  dir->cd();
+
+  auto summary = [&](const char* name, const char* title) {
+    TH1D* h = new TH1D(name, title, n, 0, n);
+    for (int i = 0; i < n; ++i)
+      h->GetXaxis()->SetBinLabel(i+1, modules[ids[i]].label.c_str());
+    return h;
+  };
+  h_ncalls       = summary("h_ncalls",       ";module;calls");
+  h_wall_total   = summary("h_wall_total",   ";module;total wall time (s)");
+  h_cpu_total    = summary("h_cpu_total",    ";module;total CPU time (s)");
+  h_nalloc_total = summary("h_nalloc_total", ";module;total allocations");
+  h_bytes_total  = summary("h_bytes_total",  ";module;total bytes allocated");
+
+  h_event_wall   = new TH1F("h_event_wall",   ";log_{10}(event wall time/s);events", 180, -7, 2);
+  h_event_cpu    = new TH1F("h_event_cpu",    ";log_{10}(event CPU time/s);events", 180, -7, 2);
+  h_event_nalloc = new TH1F("h_event_nalloc", ";log_{10}(event allocations);events", 160, 0, 8);
+  h_event_bytes  = new TH1F("h_event_bytes",  ";log_{10}(event bytes allocated);events", 200, 0, 10);
+
+  t_tail = new TTree("t_tail", "");
+  t_tail->Branch("run", &tail.run);
+  t_tail->Branch("lumi", &tail.lumi);
+  t_tail->Branch("event", &tail.event);
+  t_tail->Branch("stream", &tail.stream);
+  t_tail->Branch("wall", &tail.wall);
+  t_tail->Branch("cpu", &tail.cpu);
+  t_tail->Branch("nalloc", &tail.nalloc);
+  t_tail->Branch("bytes", &tail.bytes);
+  t_tail->Branch("slowest", &tail.slowest); // bin-1 of the summary histograms
+  t_tail->Branch("slowest_wall", &tail.slowest_wall);
+
+  for (int i = 0; i < n; ++i) {
+    Module& m = modules[ids[i]];
+    m.bin = i+1;
+    m.ncalls = m.nalloc = m.bytes = 0;
+    m.wall = m.cpu = 0;
+    m.h_wall = m.h_cpu = m.h_nalloc = m.h_bytes = nullptr;
+    if (per_module_histos) {
+      TDirectory* mdir = dir->mkdir(m.label.c_str());
+      mdir->cd();
+      m.h_wall   = new TH1F("h_wall",   ";log_{10}(wall time/s);calls",     180, -7, 2);
+      m.h_cpu    = new TH1F("h_cpu",    ";log_{10}(CPU time/s);calls",      180, -7, 2);
+      m.h_nalloc = new TH1F("h_nalloc", ";log_{10}(allocations);calls",     160, 0, 8);
+      m.h_bytes  = new TH1F("h_bytes",  ";log_{10}(bytes allocated);calls", 200, 0, 10);
+    }
+  }
+}
+
+void JMTModuleProfiler::preEvent(const edm::StreamContext& sc) {
+  StreamState& s = streams[sc.streamID().value()];
+  s.cpu = 0;
+  s.nalloc = s.bytes = 0;
+  s.slowest = -1;
+  s.slowest_wall = 0;
+  s.event_start = clock::now();
+}
+
+void JMTModuleProfiler::preModuleEvent(const edm::StreamContext& sc, const edm::ModuleCallingContext& mcc) {
+  const unsigned id = mcc.moduleDescription()->id();
+  if (!profiled(id))
+    return;
+  nesting().push_back(Nested{0, 0, 0});
+  streams[sc.streamID().value()].module_start[id].start();
+}
+
+void JMTModuleProfiler::postModuleEvent(const edm::StreamContext& sc, const edm::ModuleCallingContext& mcc) {
+  Snapshot end;
+  end.stop();
+
+  const unsigned id = mcc.moduleDescription()->id();
+  if (!profiled(id))
+    return;
+
+  StreamState& s = streams[sc.streamID().value()];
+  const Snapshot& start = s.module_start[id];
+  const double wall = std::chrono::duration<double>(end.wall - start.wall).count();
+  const double cpu = end.cpu - start.cpu;
+  const unsigned long long nalloc = end.nalloc - start.nalloc;
+  const unsigned long long bytes = end.bytes - start.bytes;
+
+  std::vector<Nested>& nest = nesting();
+  const Nested inner = nest.back();
+  nest.pop_back();
+  if (!nest.empty()) {
+    nest.back().cpu += cpu;
+    nest.back().nalloc += nalloc;
+    nest.back().bytes += bytes;
+  }
+
+  // Modules on the same stream can run concurrently, so the stream's
+  // totals are under the lock too.
+  std::lock_guard<std::mutex> lock(mutex);
+  s.cpu += cpu - inner.cpu;
+  s.nalloc += nalloc - inner.nalloc;
+  s.bytes += bytes - inner.bytes;
+  if (wall > s.slowest_wall) {
+    s.slowest = modules[id].bin - 1;
+    s.slowest_wall = wall;
+  }
+
+  Module& m = modules[id];
+  ++m.ncalls;
+  m.wall += wall;
+  m.cpu += cpu;
+  m.nalloc += nalloc;
+  m.bytes += bytes;
+
+  h_ncalls->Fill(m.bin - 1);
+  h_wall_total->Fill(m.bin - 1, wall);
+  h_cpu_total->Fill(m.bin - 1, cpu);
+  h_nalloc_total->Fill(m.bin - 1, nalloc);
+  h_bytes_total->Fill(m.bin - 1, bytes);
+
+  if (per_module_histos) {
+    m.h_wall->Fill(safe_log10(wall));
+    m.h_cpu->Fill(safe_log10(cpu));
+    if (have_alloc_hook) {
+      m.h_nalloc->Fill(safe_log10(nalloc));
+      m.h_bytes->Fill(safe_log10(bytes));
+    }
+  }
+}
+
+void JMTModuleProfiler::postEvent(const edm::StreamContext& sc) {
+  const unsigned stream = sc.streamID().value();
+  StreamState& s = streams[stream];
+  const double wall = std::chrono::duration<double>(clock::now() - s.event_start).count();
+
+  std::lock_guard<std::mutex> lock(mutex);
+  h_event_wall->Fill(safe_log10(wall));
+  h_event_cpu->Fill(safe_log10(s.cpu));
+  if (have_alloc_hook) {
+    h_event_nalloc->Fill(safe_log10(s.nalloc));
+    h_event_bytes->Fill(safe_log10(s.bytes));
+  }
+
+  if (max_tail_events == 0 || (tail_walls.size() == max_tail_events && wall <= tail_walls.top()))
+    return;
+
+  tail_walls.push(wall);
+  if (tail_walls.size() > max_tail_events)
+    tail_walls.pop();
+
+  const edm::EventID& id = sc.eventID();
+  tail.run = id.run();
+  tail.lumi = id.luminosityBlock();
+  tail.event = id.event();
+  tail.stream = stream;
+  tail.wall = wall;
+  tail.cpu = s.cpu;
+  tail.nalloc = s.nalloc;
+  tail.bytes = s.bytes;
+  tail.slowest = s.slowest;
+  tail.slowest_wall = s.slowest_wall;
+  t_tail->Fill();
+}
+
+void JMTModuleProfiler::postEndJob() {
+  std::vector<const Module*> ms;
+  for (const Module& m : modules)
+    if (m.bin)
+      ms.push_back(&m);
+  std::sort(ms.begin(), ms.end(), [](const Module* a, const Module* b) { return a->wall > b->wall; });
+
+  edm::LogInfo log("JMTModuleProfiler");
+  log << "modules by total wall time:\n";
+  char buf[1024];
+  snprintf(buf, sizeof buf, "%-40s %10s %12s %12s %14s %16s\n", "module", "calls", "wall (s)", "cpu (s)", "allocs", "bytes");
+  log << buf;
+  for (const Module* m : ms) {
+    snprintf(buf, sizeof buf, "%-40s %10llu %12.3f %12.3f %14llu %16llu\n", m->label.c_str(), m->ncalls, m->wall, m->cpu, m->nalloc, m->bytes);
+    log << buf;
+  }
+  if (!tail_walls.empty())
+    log << "slowest " << tail_walls.size() << " events start at " << tail_walls.top() << " s, see " << dir_name << "/t_tail\n";
+}
+
+DEFINE_FWK_SERVICE(JMTModuleProfiler);
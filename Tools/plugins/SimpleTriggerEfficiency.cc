@@ -1,3 +1,4 @@
+#include <memory>
 #include "TH1F.h"
 #include "TH2F.h"
 #include "CLHEP/Random/RandFlat.h"
@@ -10,6 +11,7 @@
 #include "FWCore/Framework/interface/MakerMacros.h"
 #include "FWCore/ServiceRegistry/interface/Service.h"
 #include "FWCore/Utilities/interface/RandomNumberGenerator.h"
+#include "JMTucker/Tools/interface/BootstrapReplicas.h"
 
 class SimpleTriggerEfficiency : public edm::EDAnalyzer {
 public:
@@ -17,6 +19,7 @@ public:
 
 private:
   virtual void analyze(const edm::Event&, const edm::EventSetup&);
+  virtual void endJob();
 
   const edm::EDGetTokenT<edm::TriggerResults> trigger_results_token;
   const edm::EDGetTokenT<double> weight_token;
@@ -29,6 +32,15 @@ private:
   TH1F* triggers_pass_den;
   TH2F* triggers2d_pass_num;
   TH2F* triggers2d_pass_den;
+
+  // Poisson bootstrap replicas of triggers_pass_num/den, written as
+  // triggers_pass_num/den_reps for jmt::make_replica_effs after
+  // merging. Not done for the 2d ones, which would be npaths^2 x
+  // nbootstrap.
+  const int nbootstrap;
+  std::unique_ptr<jmt::BootstrapWeights> bw;
+  std::unique_ptr<jmt::ReplicaHist> triggers_pass_num_reps;
+  std::unique_ptr<jmt::ReplicaHist> triggers_pass_den_reps;
 };
 
 SimpleTriggerEfficiency::SimpleTriggerEfficiency(const edm::ParameterSet& cfg) 
@@ -38,7 +50,9 @@ SimpleTriggerEfficiency::SimpleTriggerEfficiency(const edm::ParameterSet& cfg)
     triggers_pass_num(0),
     triggers_pass_den(0),
     triggers2d_pass_num(0),
-    triggers2d_pass_den(0)
+    triggers2d_pass_den(0),
+    nbootstrap(cfg.getUntrackedParameter<int>("nbootstrap", 0)),
+    bw(nbootstrap > 0 ? new jmt::BootstrapWeights(nbootstrap) : 0)
 {
   edm::Service<edm::RandomNumberGenerator> rng;
   if (!rng.isAvailable())
@@ -92,6 +106,11 @@ void SimpleTriggerEfficiency::analyze(const edm::Event& event, const edm::EventS
     triggers2d_pass_num = fs->make<TH2F>("triggers2d_pass_num", "", npaths, 0, npaths, npaths, 0, npaths);
     triggers2d_pass_den = fs->make<TH2F>("triggers2d_pass_den", "", npaths, 0, npaths, npaths, 0, npaths);
     
+    if (bw) {
+      triggers_pass_num_reps.reset(new jmt::ReplicaHist(triggers_pass_num, *bw));
+      triggers_pass_den_reps.reset(new jmt::ReplicaHist(triggers_pass_den, *bw));
+    }
+
     TH1F* hists[2] = { triggers_pass_num, triggers_pass_den };
     TH2F* hists2d[2] = { triggers2d_pass_num, triggers2d_pass_den };
     for (size_t ipath = 0; ipath < npaths; ++ipath) {
@@ -130,11 +149,17 @@ void SimpleTriggerEfficiency::analyze(const edm::Event& event, const edm::EventS
   for (size_t ipath = 0; ipath < npaths; ++ipath)
     acc[ipath] = trigger_results->accept(ipath) && pass_prescale(trigger_names.triggerName(ipath), rng_engine.flat());
   
+  if (bw)
+    bw->set_event(event.id().run(), event.luminosityBlock(), event.id().event());
+
   for (size_t ipath = 0; ipath < npaths; ++ipath) {
     triggers_pass_den->Fill(ipath, weight);
+    if (bw) triggers_pass_den_reps->fill(ipath, weight);
     const bool iacc = acc[ipath];
-    if (iacc)
+    if (iacc) {
       triggers_pass_num->Fill(ipath, weight);
+      if (bw) triggers_pass_num_reps->fill(ipath, weight);
+    }
 
     for (size_t jpath = 0; jpath < ipath; ++jpath) {
       triggers2d_pass_den->Fill(ipath, jpath, weight);
@@ -145,4 +170,14 @@ void SimpleTriggerEfficiency::analyze(const edm::Event& event, const edm::EventS
   }
 }
 
+void SimpleTriggerEfficiency::endJob() {
+  if (!triggers_pass_num_reps)
+    return;
+
+  edm::Service<TFileService> fs;
+  const int nc = triggers_pass_num_reps->ncells();
+  for (const jmt::ReplicaHist* r : { triggers_pass_num_reps.get(), triggers_pass_den_reps.get() })
+    r->fill_hist(fs->make<TH2D>(TString::Format("%s_reps", r->hist()->GetName()), ";global bin;replica", nc, 0, nc, nbootstrap, 0, nbootstrap));
+}
+
 DEFINE_FWK_MODULE(SimpleTriggerEfficiency);
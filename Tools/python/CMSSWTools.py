@@ -324,6 +324,19 @@ def max_events(process, n):
     else:
         process.maxEvents.input = n
 
+def module_profiler(process, max_tail_events=20, per_module_histos=True):
+    '''Per-module time and allocation histograms plus a tree of the
+    slowest events, in the ModuleProfiler directory of the TFileService
+    file. For allocation counts, run cmsRun with
+    LD_PRELOAD=$CMSSW_BASE/src/JMTucker/Tools/test/AllocHook/libjmtallochook.so
+    (make it there first).'''
+    if not hasattr(process, 'TFileService'):
+        tfileservice(process)
+    process.JMTModuleProfiler = cms.Service('JMTModuleProfiler',
+                                            max_tail_events = cms.untracked.uint32(max_tail_events),
+                                            per_module_histos = cms.untracked.bool(per_module_histos),
+                                            )
+
 def no_event_sort(process):
     process.source.noEventSort = cms.untracked.bool(True)
 
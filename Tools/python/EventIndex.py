@@ -0,0 +1,108 @@
+#!/usr/bin/env python
+
+# Python side of JMTucker/Tools/interface/EventIndex.h: reads and writes
+# the same sidecar files (see there for the layout), and can also build
+# them for EDM files, where run/lumi/event come from EventAuxiliary.
+
+import os, struct
+from bisect import bisect_left
+
+magic = 'JMTEVIX1'
+version = 1
+header = struct.Struct('<8sIIQQ')
+record = struct.Struct('<IIQQ')
+
+ntuple_rle_expr = 'run:lumi:event'
+edm_rle_expr = 'EventAuxiliary.id().run():EventAuxiliary.luminosityBlock():EventAuxiliary.id().event()'
+
+def _is_remote(fn):
+    return '://' in fn or fn.startswith('/store/')
+
+def _sanitize(s):
+    return s.replace('/', '_').replace(':', '_')
+
+def sidecar_path(fn, tree_path):
+    suffix = '.%s.evidx' % _sanitize(tree_path)
+    if not _is_remote(fn):
+        return fn + suffix
+    return os.path.join(os.environ.get('JMT_EVIDX_DIR') or '.', _sanitize(fn) + suffix)
+
+class EventIndex(object):
+    def __init__(self, tree_path, nentries_tree, records):
+        self.tree_path = tree_path
+        self.nentries_tree = nentries_tree
+        self.records = sorted(records) # (run, lumi, event, entry)
+
+    @classmethod
+    def build(cls, tree, tree_path, rle_expr=ntuple_rle_expr):
+        from JMTucker.Tools.ROOTTools import detree
+        return cls(tree_path, tree.GetEntries(), detree(tree, rle_expr + ':Entry$', xform=int))
+
+    @classmethod
+    def read(cls, fn):
+        with open(fn, 'rb') as f:
+            m, v, n_path, nentries, nrecords = header.unpack(f.read(header.size))
+            if m != magic:
+                raise ValueError('%s is not an event index' % fn)
+            if v != version:
+                raise ValueError('%s has version %i, expected %i' % (fn, v, version))
+            tree_path = f.read(n_path)
+            data = f.read(nrecords * record.size)
+            if len(tree_path) != n_path or len(data) != nrecords * record.size:
+                raise ValueError('%s is truncated' % fn)
+        return cls(tree_path, nentries, [record.unpack_from(data, i*record.size) for i in xrange(nrecords)])
+
+    def write(self, fn):
+        tmp_fn = '%s.tmp%i' % (fn, os.getpid())
+        with open(tmp_fn, 'wb') as f:
+            f.write(header.pack(magic, version, len(self.tree_path), self.nentries_tree, len(self.records)))
+            f.write(self.tree_path)
+            for r in self.records:
+                f.write(record.pack(*r))
+        os.rename(tmp_fn, fn)
+
+    def find(self, run, lumi, event):
+        '''The entries for (run, lumi, event), normally zero or one.'''
+        key = (run, lumi, event)
+        i = bisect_left(self.records, key)
+        entries = []
+        while i < len(self.records) and self.records[i][:3] == key:
+            entries.append(self.records[i][3])
+            i += 1
+        return entries
+
+def for_file(fn, tree_path, rle_expr=ntuple_rle_expr, save=True):
+    '''The index for tree_path in fn from its sidecar, or built from the
+    tree (and saved to the sidecar if possible) if there is none or,
+    for a local file, it is older than fn.'''
+
+    sc = sidecar_path(fn, tree_path)
+    if os.path.isfile(sc) and (_is_remote(fn) or os.path.getmtime(sc) >= os.path.getmtime(fn)):
+        x = EventIndex.read(sc)
+        if x.tree_path == tree_path:
+            return x
+
+    from JMTucker.Tools.ROOTTools import ROOT
+    f = ROOT.TFile.Open(fn)
+    if not f or not f.IsOpen():
+        raise IOError('could not open %s' % fn)
+    t = f.Get(tree_path)
+    if not t:
+        raise IOError('no tree %s in %s' % (tree_path, fn))
+    x = EventIndex.build(t, tree_path, rle_expr)
+    f.Close()
+
+    if save:
+        try:
+            x.write(sc)
+        except (IOError, OSError):
+            print 'EventIndex: warning: could not write', sc
+    return x
+
+__all__ = [
+    'EventIndex',
+    'edm_rle_expr',
+    'for_file',
+    'ntuple_rle_expr',
+    'sidecar_path',
+    ]
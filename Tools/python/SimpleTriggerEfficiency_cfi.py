@@ -5,8 +5,10 @@ SimpleTriggerEfficiency = cms.EDAnalyzer('SimpleTriggerEfficiency',
                                          weight_src = cms.InputTag(''),
                                          )
 
-def setup_endpath(process, weight_src = ''):
+def setup_endpath(process, weight_src = '', nbootstrap = 0):
     process.SimpleTriggerEfficiency = SimpleTriggerEfficiency.clone(weight_src = weight_src)
+    if nbootstrap > 0:
+        process.SimpleTriggerEfficiency.nbootstrap = cms.untracked.int32(nbootstrap)
     process.SimpleTriggerEfficiency.trigger_results_src = cms.InputTag('TriggerResults', '', process.name_())
     process.RandomNumberGeneratorService = cms.Service('RandomNumberGeneratorService')
     process.RandomNumberGeneratorService.SimpleTriggerEfficiency = cms.PSet(initialSeed = cms.untracked.uint32(1220))
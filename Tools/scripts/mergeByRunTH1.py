@@ -8,10 +8,13 @@ from JMTucker.Tools.ROOTTools import *
 from JMTucker.Tools.general import bool_from_argv
 
 if len(sys.argv) < 5:
-    print 'usage: mergeByRunTH1.py in_fn out_fn min_run max_run [glob_pattern_1 ...]'
+    print 'usage: mergeByRunTH1.py in_fn out_fn min_run max_run [glob_pattern_1 ...] [yes] [split]'
+    print '  name_run%i TH1s, and the name_byrun TH2s from ByRunTH1::prebook(runs, true), are merged over runs in [min_run, max_run];'
+    print '  with split, the TH2s are also written out as one name_run%i TH1 per run.'
     sys.exit(1)
 
 yes = bool_from_argv('yes')
+split = bool_from_argv('split')
 in_fn = sys.argv[1]
 out_fn = sys.argv[2]
 min_run = int(sys.argv[3])
@@ -33,22 +36,35 @@ shutil.copy2(in_fn, out_fn)
 f = ROOT.TFile(out_fn, 'update')
 run_re = re.compile(r'(.*)_run(\d+)$')
 title_re = re.compile(r'(.*) \(run \d+\)$')
+byrun_re = re.compile(r'(.*)_byrun$')
+byrun_title_re = re.compile(r'(.*) \(by run\)$')
 groups = defaultdict(list)
+byruns = []
 
 for path in flatten_directory(f):
     if use(path):
         mo = run_re.search(path)
         if mo:
             path_norun, run = mo.groups()
+            if not min_run <= int(run) <= max_run:
+                continue
             groups[path_norun].append(path)
             o = f.Get(path)
             if not issubclass(type(o), ROOT.TH1):
                 raise ValueError("object %r isn't a TH1" % o)
+        elif byrun_re.search(path):
+            o = f.Get(path)
+            if not issubclass(type(o), ROOT.TH2):
+                raise ValueError("object %r isn't a TH2" % o)
+            byruns.append(path)
 
 groups = dict(groups)
 
 print 'will add these groups:'
 pprint(groups)
+if byruns:
+    print 'and project these by-run TH2s%s:' % (' and split them' if split else '')
+    pprint(byruns)
 if not yes:
     raw_input('<hit enter if ok>')
 
@@ -66,4 +82,30 @@ for path in sorted(groups.keys()):
     d.cd()
     new_o.Write()
 
+for path in byruns:
+    dn, bn = os.path.split(path)
+    bn = byrun_re.search(bn).group(1)
+    d = f.Get(dn)
+    h = f.Get(path)
+    mo = byrun_title_re.search(h.GetTitle())
+    assert mo is not None
+    title = mo.group(1)
+    xax = h.GetXaxis()
+    runs = [(ibin, int(xax.GetBinLabel(ibin))) for ibin in xrange(1, h.GetNbinsX()+1)]
+    runs = [(ibin, run) for ibin, run in runs if min_run <= run <= max_run]
+    d.cd()
+    new_o = None
+    for ibin, run in runs:
+        p = h.ProjectionY('%s_run%i' % (bn, run), ibin, ibin, 'e')
+        p.SetTitle('%s (run %i)' % (title, run))
+        if split:
+            p.Write()
+        if new_o is None:
+            new_o = p.Clone(bn)
+            new_o.SetTitle(title)
+        else:
+            new_o.Add(p)
+    if new_o is not None:
+        new_o.Write()
+
 f.Close()
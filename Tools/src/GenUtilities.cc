@@ -69,15 +69,14 @@ bool is_bhadron(const reco::Candidate* c) {
 }
 
 int original_index(const reco::Candidate* c, const reco::GenParticleCollection& gens) {
-  if (c != 0)
-    for (int i = 0, ie = int(gens.size()); i < ie; ++i)
-      if (&gens[i] == c)
-	return i;
-  return -1;
+  return jmt::GenDecayGraph::index(c, gens);
 }
 
 reco::GenParticleRef gen_ref(const reco::Candidate* c, const edm::Handle<reco::GenParticleCollection>& gens) {
-  int i = original_index(c, *gens);
+  return gen_ref(original_index(c, *gens), gens);
+}
+
+reco::GenParticleRef gen_ref(int i, const edm::Handle<reco::GenParticleCollection>& gens) {
   if (i >= 0)
     return reco::GenParticleRef(gens, i);
   else
@@ -328,3 +327,26 @@ int gen_jet_id(const reco::GenJet& jet) {
   }
   return id;
 }
+
+// Same as above but with the ancestry from the decay graph. The masks
+// are e.g. graph.mask([&](int i) { return is_bhadron(graph.pdgId(i)); }),
+// made once per event.
+int gen_jet_id(const reco::GenJet& jet, const jmt::GenDecayGraph& graph, const reco::GenParticleCollection& gens, const jmt::GenDecayGraph::mask_t& bhadrons, const jmt::GenDecayGraph::mask_t& chadrons) {
+  int id = 0;
+  for (const reco::GenParticle* g : jet.getGenConstituents()) {
+    if (id == 0) {
+      const int i = graph.index(g, gens);
+      if (i < 0) { // e.g. packed constituents not in the pruned collection
+        if (has_any_ancestor_such_that(g, [](const reco::Candidate* c) { return is_bhadron(c); }))
+          id = 5;
+        else if (has_any_ancestor_such_that(g, [](const reco::Candidate* c) { return is_chadron(c); }))
+          id = 4;
+      }
+      else if (graph.has_any_ancestor_in(i, bhadrons))
+        id = 5;
+      else if (graph.has_any_ancestor_in(i, chadrons))
+        id = 4;
+    }
+  }
+  return id;
+}
@@ -0,0 +1,64 @@
+#include <limits>
+#include "DataFormats/BeamSpot/interface/BeamSpot.h"
+#include "DataFormats/SiPixelDetId/interface/PixelSubdetector.h"
+#include "DataFormats/SiStripDetId/interface/StripSubdetector.h"
+#include "DataFormats/TrackReco/interface/Track.h"
+#include "DataFormats/VertexReco/interface/Vertex.h"
+#include "JMTucker/Tools/interface/RecoTrackCuts.h"
+
+namespace jmt {
+  TrackCutValues track_cut_values(const reco::Track& tk, const reco::BeamSpot* bs, const reco::Vertex* pv) {
+    const reco::HitPattern& hp = tk.hitPattern();
+
+    TrackCutValues t;
+    t.pt = tk.pt();
+    t.eta = tk.eta();
+    t.dxybs = bs ? tk.dxy(*bs) : tk.dxy();
+    t.dxypv = pv ? tk.dxy(pv->position()) : std::numeric_limits<float>::infinity();
+    t.dxyerr = tk.dxyError();
+    // One pass over the hits rather than the HitPattern accessors, which
+    // walk them again each (the layer counts once per substructure).
+    // layers[sub] has bit n set if there is a valid hit in layer n.
+    unsigned layers[8] = {0};
+    t.min_r = TrackCutValues::no_min_r;
+    t.nhits = t.npxhits = t.nsthits = 0;
+    for (int ihit = 0, ie = hp.numberOfAllHits(reco::HitPattern::TRACK_HITS); ihit < ie; ++ihit) {
+      const uint16_t hit = hp.getHitPattern(reco::HitPattern::TRACK_HITS, ihit);
+      if (!reco::HitPattern::validHitFilter(hit))
+        continue;
+
+      ++t.nhits;
+      if (!reco::HitPattern::trackerHitFilter(hit))
+        continue;
+
+      const uint32_t sub = reco::HitPattern::getSubStructure(hit);
+      const uint32_t layer = reco::HitPattern::getLayer(hit);
+      layers[sub & 7] |= 1U << layer;
+      if (reco::HitPattern::pixelHitFilter(hit))
+        ++t.npxhits;
+      else
+        ++t.nsthits;
+      if (sub == PixelSubdetector::PixelBarrel && int(layer) < t.min_r)
+        t.min_r = layer;
+    }
+
+    t.npxlayers = __builtin_popcount(layers[PixelSubdetector::PixelBarrel]) + __builtin_popcount(layers[PixelSubdetector::PixelEndcap]);
+    t.nstlayers = 0;
+    for (uint32_t sub : { StripSubdetector::TIB, StripSubdetector::TID, StripSubdetector::TOB, StripSubdetector::TEC })
+      t.nstlayers += __builtin_popcount(layers[sub]);
+    return t;
+  }
+
+  void tracks_in_pvs(const reco::VertexCollection& pvs, const edm::Handle<reco::TrackCollection>& tracks, std::vector<int>& first, std::vector<int>& n) {
+    first.assign(tracks->size(), -1);
+    n.assign(tracks->size(), 0);
+    for (int i = 0, ie = int(pvs.size()); i < ie; ++i)
+      for (auto it = pvs[i].tracks_begin(), ite = pvs[i].tracks_end(); it != ite; ++it)
+        if (it->id() == tracks.id()) {
+          const size_t k = it->key();
+          if (first[k] == -1)
+            first[k] = i;
+          ++n[k];
+        }
+  }
+}
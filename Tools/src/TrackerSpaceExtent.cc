@@ -1,5 +1,8 @@
 #include "JMTucker/Tools/interface/TrackerSpaceExtent.h"
 
+#include <cstdio>
+#include <cstring>
+#include <limits>
 #include "DataFormats/SiPixelDetId/interface/PXBDetId.h"
 #include "DataFormats/SiPixelDetId/interface/PXFDetId.h"
 #include "DataFormats/SiStripDetId/interface/SiStripDetId.h"
@@ -7,14 +10,12 @@
 #include "DataFormats/TrackerCommon/interface/TrackerTopology.h"
 #include "FWCore/Framework/interface/ESHandle.h"
 #include "FWCore/Framework/interface/EventSetup.h"
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
 #include "Geometry/CommonDetUnit/interface/GlobalTrackingGeometry.h"
 #include "Geometry/Records/interface/GlobalTrackingGeometryRecord.h"
 #include "Geometry/Records/interface/TrackerTopologyRcd.h"
 
-void TrackerSpaceExtents::fill(const edm::EventSetup& setup, const GlobalPoint& origin) {
-  edm::ESHandle<TrackerTopology> topology;
-  setup.get<TrackerTopologyRcd>().get(topology);
-
+void TrackerSpaceExtents::fill(const edm::EventSetup& setup, const GlobalPoint& origin, const std::string& cache_fn) {
   edm::ESHandle<GlobalTrackingGeometry> geometry;
   setup.get<GlobalTrackingGeometryRecord>().get(geometry);
   const TrackingGeometry* tg = geometry->slaveGeometry(PXBDetId(1, 1, 1));
@@ -24,6 +25,18 @@ void TrackerSpaceExtents::fill(const edm::EventSetup& setup, const GlobalPoint&
   if (tktg == 0)
     throw cms::Exception("TrackerSpaceExtents") << "couldn't cast tg to tktg";
 
+  const unsigned long long key = cache_fn != "" ? geometry_key(*tktg) : 0;
+  if (cache_fn != "" && read_cache(cache_fn, key, origin)) {
+    make_table();
+    filled_ = true;
+    return;
+  }
+
+  map.clear();
+
+  edm::ESHandle<TrackerTopology> topology;
+  setup.get<TrackerTopologyRcd>().get(topology);
+
   // JMTBAD when do PXB/FDetId go away? ttps://twiki.cern.ch/twiki/bin/view/CMS/SiStripLocalReco_notesSiStripSubDetIdToTrackerTopologyMigration#Remaining_PXBDetId_and_PXFDetId
   fill_subdet<PXBDetId>(map, tktg->detsPXB(), [](const PXBDetId& id) { return id.layer(); }, origin);
   fill_subdet<PXFDetId>(map, tktg->detsPXF(), [](const PXFDetId& id) { return id.disk (); }, origin); 
@@ -31,7 +44,103 @@ void TrackerSpaceExtents::fill(const edm::EventSetup& setup, const GlobalPoint&
   fill_subdet<SiStripDetId>(map, tktg->detsTOB(), [&](const SiStripDetId& id) { return topology->tobLayer(id); }, origin);
   fill_subdet<SiStripDetId>(map, tktg->detsTID(), [&](const SiStripDetId& id) { return topology->tidWheel(id); }, origin);
   fill_subdet<SiStripDetId>(map, tktg->detsTEC(), [&](const SiStripDetId& id) { return topology->tecWheel(id); }, origin);
+  make_table();
   filled_ = true;
+
+  if (cache_fn != "")
+    write_cache(cache_fn, key, origin);
+}
+
+// Hash of the ids and positions of all the tracker dets, so a cache
+// made with another geometry isn't used. Much cheaper than the walk in
+// fill(): no topology lookups or map inserts.
+unsigned long long TrackerSpaceExtents::geometry_key(const TrackerGeometry& tktg) {
+  unsigned long long h = 0xcbf29ce484222325ULL;
+  auto add = [&h](uint32_t x) {
+    h = (h ^ x) * 0x100000001b3ULL;
+    h ^= h >> 29;
+  };
+
+  for (const GeomDet* geom : tktg.dets()) {
+    const GlobalPoint pos = geom->position();
+    const float xyz[3] = { pos.x(), pos.y(), pos.z() };
+    uint32_t bits[3];
+    memcpy(bits, xyz, sizeof bits);
+    add(geom->geographicalId().rawId());
+    for (uint32_t b : bits)
+      add(b);
+  }
+  add(uint32_t(tktg.dets().size()));
+  return h;
+}
+
+void TrackerSpaceExtents::make_table() {
+  for (int k = 0; k < table_size; ++k) {
+    table_[k] = TrackerSpaceExtent();
+    known_[k] = barrel_[k] = 0;
+    max_r_[k] = max_z_[k] = std::numeric_limits<double>::max(); // never behind
+  }
+
+  for (const auto& e : map) {
+    const int sub = e.first.first, subsub = e.first.second;
+    if (sub < 0 || sub >= max_sub || subsub < 0 || subsub >= max_subsub)
+      throw cms::Exception("TrackerSpaceExtents") << "sub " << sub << " subsub " << subsub << " doesn't fit in the table";
+    const int k = sub * max_subsub + subsub;
+    table_[k] = e.second;
+    known_[k] = 1;
+    barrel_[k] = sub == PixelSubdetector::PixelBarrel || sub == StripSubdetector::TIB || sub == StripSubdetector::TOB;
+    if (barrel_[k])
+      max_r_[k] = e.second.max_r;
+    else
+      max_z_[k] = e.second.max_z;
+  }
+}
+
+// The cache is a text file with the geometry_key and the origin on the
+// first line and then one line per sub, subsub. Floats are written in
+// hex so they come back bit-for-bit.
+
+bool TrackerSpaceExtents::read_cache(const std::string& fn, unsigned long long key, const GlobalPoint& origin) {
+  FILE* f = fopen(fn.c_str(), "r");
+  if (!f)
+    return false;
+
+  map_t m;
+  unsigned long long k;
+  double ox, oy, oz;
+  bool ok = fscanf(f, "TrackerSpaceExtents v2 geometry %llx origin %la %la %la", &k, &ox, &oy, &oz) == 4 && k == key && ox == origin.x() && oy == origin.y() && oz == origin.z();
+  while (ok) {
+    int sub, subsub;
+    TrackerSpaceExtent e;
+    const int n = fscanf(f, "%i %i %la %la %la %i %la %la %la %i", &sub, &subsub, &e.min_r, &e.max_r, &e.avg_r, &e.nr, &e.min_z, &e.max_z, &e.avg_z, &e.nz);
+    if (n == EOF)
+      break;
+    if (n != 10)
+      ok = false;
+    else
+      m[std::make_pair(sub, subsub)] = e;
+  }
+
+  fclose(f);
+  if (ok && !m.empty()) {
+    map.swap(m);
+    return true;
+  }
+
+  edm::LogInfo("TrackerSpaceExtents") << "cache file " << fn << " doesn't match the geometry or origin, remaking it";
+  return false;
+}
+
+void TrackerSpaceExtents::write_cache(const std::string& fn, unsigned long long key, const GlobalPoint& origin) const {
+  FILE* f = fopen(fn.c_str(), "w");
+  if (!f)
+    throw cms::Exception("TrackerSpaceExtents") << "could not write cache file " << fn;
+  fprintf(f, "TrackerSpaceExtents v2 geometry %llx origin %a %a %a\n", key, double(origin.x()), double(origin.y()), double(origin.z()));
+  for (const auto& e : map) {
+    const TrackerSpaceExtent& x = e.second;
+    fprintf(f, "%i %i %a %a %a %i %a %a %a %i\n", e.first.first, e.first.second, x.min_r, x.max_r, x.avg_r, x.nr, x.min_z, x.max_z, x.avg_z, x.nz);
+  }
+  fclose(f);
 }
 
 void TrackerSpaceExtents::print() const {
@@ -103,12 +212,12 @@ SpatialExtents TrackerSpaceExtents::extentInRAndZ(const reco::HitPattern& hp, in
     uint32_t sub    = reco::HitPattern::getSubStructure   (hit);
     uint32_t subsub = reco::HitPattern::getSubSubStructure(hit);
         
-    map_t::const_iterator it = map.find(std::make_pair(int(sub), int(subsub)));
-    if (it == map.end()) {
+    const TrackerSpaceExtent* e = this->extent(sub, subsub);
+    if (e == 0) {
       printf("hit %x sub %x subsub %x not found!\n", hit, sub, subsub);
       assert(0);
     }
-    const TrackerSpaceExtent& extent = it->second;
+    const TrackerSpaceExtent& extent = *e;
     if ((code != StripOnly && sub == PixelSubdetector::PixelBarrel) || (code != PixelOnly && (sub == StripSubdetector::TIB || sub == StripSubdetector::TOB)))
       ret.update_r(extent.avg_r);
     else if ((code != StripOnly && sub == PixelSubdetector::PixelEndcap) || (code != PixelOnly && (sub == StripSubdetector::TID || sub == StripSubdetector::TEC)))
@@ -120,7 +229,23 @@ SpatialExtents TrackerSpaceExtents::extentInRAndZ(const reco::HitPattern& hp, in
 
 int TrackerSpaceExtents::numHitsBehind(const reco::HitPattern& hp, const double r, const double z) const {
   if (!filled_) throw cms::Exception("CantEven", "must set up map with fill() before calling numHitsBehind");
+  return behind(r, z).count(hp);
+}
+
+TrackerSpaceExtents::Behind TrackerSpaceExtents::behind(const double r, const double z) const {
+  if (!filled_) throw cms::Exception("CantEven", "must set up map with fill() before calling behind");
 
+  // Branch-free over the flat arrays so the compiler can vectorize it;
+  // unknown entries have max_r = max_z = DBL_MAX and so are never behind.
+  Behind b;
+  for (int k = 0; k < table_size; ++k) {
+    b.behind[k] = barrel_[k] ? max_r_[k] < r : max_z_[k] < z;
+    b.known[k] = known_[k];
+  }
+  return b;
+}
+
+int TrackerSpaceExtents::Behind::count(const reco::HitPattern& hp) const {
   int nhitsbehind = 0;
 
   for (int ihit = 0, ie = hp.numberOfAllHits(reco::HitPattern::TRACK_HITS); ihit < ie; ++ihit) {
@@ -136,18 +261,9 @@ int TrackerSpaceExtents::numHitsBehind(const reco::HitPattern& hp, const double
 
     uint32_t sub    = reco::HitPattern::getSubStructure   (hit);
     uint32_t subsub = reco::HitPattern::getSubSubStructure(hit);
-        
-    map_t::const_iterator it = map.find(std::make_pair(int(sub), int(subsub)));
-    assert(it != map.end());
-    const TrackerSpaceExtent& extent = it->second;
-    if (sub == PixelSubdetector::PixelBarrel || sub == StripSubdetector::TIB || sub == StripSubdetector::TOB) {
-      if (extent.max_r < r)
-        ++nhitsbehind;
-    }
-    else if (sub == PixelSubdetector::PixelEndcap || sub == StripSubdetector::TID || sub == StripSubdetector::TEC) {
-      if (extent.max_z < z)
-        ++nhitsbehind;
-    }
+    const int k = sub * max_subsub + subsub;
+    assert(sub < max_sub && subsub < max_subsub && known[k]);
+    nhitsbehind += behind[k];
   }
 
   return nhitsbehind;
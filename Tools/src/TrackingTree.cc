@@ -1,5 +1,6 @@
 #include "JMTucker/Tools/interface/TrackingTree.h"
 #include <cassert>
+#include <iostream>
 #include "TTree.h"
 
 TrackingTree::TrackingTree() {
@@ -209,3 +210,18 @@ void TrackingTree::read_from_tree(TTree* t) {
   t->SetBranchAddress("tk_maxhit", &p_tk_maxhit_);
   t->SetBranchAddress("tk_maxpxhit", &p_tk_maxpxhit_);
 }
+
+void TrackingTree::print(std::ostream& o) const {
+  o << "run " << run() << " lumi " << lumi() << " event " << event() << " npu " << npu() << "\n"
+    << "bs (" << bs_x() << ", " << bs_y() << ", " << bs_z() << ") sigmaz " << bs_sigmaz() << " dxdz " << bs_dxdz() << " dydz " << bs_dydz() << " width " << bs_width() << "\n"
+    << "npvs " << npvs() << "\n";
+  for (int i = 0; i < npvs(); ++i)
+    o << "  pv " << i << ": (" << pv_x(i) << ", " << pv_y(i) << ", " << pv_z(i) << ") chi2dof " << pv_chi2dof(i) << " ndof " << pv_ndof(i) << " score " << pv_score(i) << "\n";
+  o << "ntks " << ntks() << "\n";
+  for (int i = 0; i < ntks(); ++i)
+    o << "  tk " << i << ": q " << tk_q(i) << " pt " << tk_pt(i) << " +- " << tk_err_pt(i) << " eta " << tk_eta(i) << " phi " << tk_phi(i)
+      << " dxybs " << tk_dxybs(i) << " +- " << tk_err_dxy(i) << " dxypv " << tk_dxypv(i) << " dzpv " << tk_dzpv(i) << " +- " << tk_err_dz(i)
+      << " v (" << tk_vx(i) << ", " << tk_vy(i) << ", " << tk_vz(i) << ") chi2dof " << tk_chi2dof(i)
+      << " npx " << tk_npxhits(i) << "/" << tk_npxlayers(i) << " nst " << tk_nsthits(i) << "/" << tk_nstlayers(i)
+      << " min_r " << tk_min_r(i) << " maxpx_r " << tk_maxpx_r(i) << "\n";
+}
@@ -0,0 +1,42 @@
+// Counts operator new calls and bytes per thread for
+// JMTModuleProfiler, see Tools/interface/AllocHook.h. Build with make,
+// then LD_PRELOAD the .so. Only the C++ operators are replaced, so
+// malloc calls from C code (and ROOT's own pools) aren't counted.
+
+#include <cstdlib>
+#include <new>
+#include "JMTucker/Tools/interface/AllocHook.h"
+
+namespace {
+  thread_local jmt::AllocCounts counts;
+
+  inline void* counted_malloc(std::size_t n) {
+    ++counts.n;
+    counts.bytes += n;
+    return std::malloc(n ? n : 1);
+  }
+}
+
+extern "C" jmt::AllocCounts* jmt_alloc_counts() { return &counts; }
+
+void* operator new(std::size_t n) {
+  void* p = counted_malloc(n);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+void* operator new[](std::size_t n) {
+  void* p = counted_malloc(n);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept { return counted_malloc(n); }
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept { return counted_malloc(n); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
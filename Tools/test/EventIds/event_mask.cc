@@ -0,0 +1,67 @@
+// Compile lumi JSONs and an event veto or accept list into one
+// EventMask file (see JMTucker/Tools/interface/EventMask.h), e.g.
+//
+//   ./event_mask.exe mask.evmask.gz -j Cert_294927-306462_13TeV_EOY2017ReReco_Collisions17_JSON.txt -v vetolist.JetHT2017B.gz
+//
+// for EventIdVeto's list_fn or NtupleLoop's json. -j can be given more
+// than once, the lumi masks are or-ed; -v/-a can be too, with lists of
+// (run,lumi,event), or with -n of (lumi,event) to match in any run. The
+// inputs can be gzipped, and so is the output if its name ends in .gz.
+
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include "JMTucker/Tools/interface/EventMask.h"
+
+int main(int argc, char** argv) {
+  if (argc < 4) {
+    fprintf(stderr, "usage: %s out.evmask[.gz] [-j lumis.json ...] [-n] [-v veto_events.txt ... | -a accept_events.txt ...]\n", argv[0]);
+    return 1;
+  }
+
+  jmt::EventMaskBuilder b;
+  jmt::EventMask::event_mode_t mode = jmt::EventMask::events_none;
+  bool use_run = true;
+
+  try {
+    for (int i = 2; i < argc; ++i) {
+      const std::string a = argv[i];
+      if (a == "-n") {
+        use_run = false;
+        continue;
+      }
+      if ((a != "-j" && a != "-v" && a != "-a") || i + 1 == argc) {
+        fprintf(stderr, "bad argument %s\n", a.c_str());
+        return 1;
+      }
+      const char* fn = argv[++i];
+      if (a == "-j") {
+        b.add_json(fn);
+        continue;
+      }
+
+      const jmt::EventMask::event_mode_t m = a == "-v" ? jmt::EventMask::events_veto : jmt::EventMask::events_accept;
+      if (mode != jmt::EventMask::events_none && mode != m) {
+        fprintf(stderr, "can't both veto and accept events\n");
+        return 1;
+      }
+      mode = m;
+      const size_t nskipped0 = b.nskipped();
+      const size_t n = b.add_events(fn, use_run);
+      printf("%s: %zu events\n", fn, n);
+      if (b.nskipped() != nskipped0)
+        fprintf(stderr, "warning: skipped %zu lines in %s without a %s\n", b.nskipped() - nskipped0, fn, use_run ? "(run,lumi,event)" : "(lumi,event)");
+      if (n == 0)
+        fprintf(stderr, "warning: no events in %s, expected one %s per line\n", fn, use_run ? "(run,lumi,event)" : "(lumi,event)");
+    }
+
+    const jmt::EventMask mask = b.compile(mode);
+    mask.write(argv[1]);
+    printf("%s: %zu runs, %zu lumi ranges, %zu events%s\n", argv[1], mask.nruns(), mask.nranges(), mask.nevents(),
+           mode == jmt::EventMask::events_veto ? " to veto" : mode == jmt::EventMask::events_accept ? " to accept" : "");
+  }
+  catch (const std::runtime_error& e) {
+    fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+}
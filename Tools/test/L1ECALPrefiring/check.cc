@@ -0,0 +1,104 @@
+// Regression check of the compiled prefiring tables against the TH2Fs
+// they were made from: make test. L1ECALPrefiringWeightMaps.h is the
+// old macro chunk that the producer used to include, kept here only
+// for this.
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <vector>
+#include "TH2.h"
+#include "TMath.h"
+#include "TROOT.h"
+#include "L1ECALPrefiringWeightTables.h"
+
+int nbad = 0;
+
+void compare(const char* name, double a, double b, const char* what, double x=0, double y=0) {
+  if (a != b && !(std::isnan(a) && std::isnan(b))) {
+    if (++nbad < 50)
+      printf("%s: %s differs at (%.17g, %.17g): table %.17g hist %.17g\n", name, what, x, y, a, b);
+  }
+}
+
+// What GetPrefiringRate did.
+double hist_rate(double eta, double pt, TH2F* h, double syst, int fluct) {
+  double maxy = h->GetYaxis()->GetBinLowEdge(h->GetNbinsY()+1);
+  if (pt >= maxy) pt = maxy - 0.01;
+  const int bin = h->FindBin(eta, pt);
+  double p = h->GetBinContent(bin);
+  if (fluct == 1) p = TMath::Min(TMath::Max(p + h->GetBinError(bin), (1.+syst)*p), 1.);
+  if (fluct == 2) p = TMath::Max(TMath::Min(p - h->GetBinError(bin), (1.-syst)*p), 0.);
+  return p;
+}
+
+std::vector<double> probes(const TAxis* a) {
+  const double inf = std::numeric_limits<double>::infinity();
+  std::vector<double> v = { -inf, inf, std::numeric_limits<double>::quiet_NaN(), -1e9, 1e9, 0 };
+  for (int i = 1, ie = a->GetNbins()+1; i <= ie; ++i) {
+    const double e = a->GetBinLowEdge(i);
+    v.push_back(e);
+    v.push_back(std::nextafter(e, -inf));
+    v.push_back(std::nextafter(e, inf));
+    v.push_back(e - 0.01);
+    if (i < ie)
+      v.push_back(a->GetBinCenter(i));
+  }
+  return v;
+}
+
+void check(const char* name, const jmt::L1ECALPrefiringMap& m, TH2F* h) {
+  const TAxis* ax = h->GetXaxis();
+  const TAxis* ay = h->GetYaxis();
+  compare(name, m.x.n, ax->GetNbins(), "nbinsx");
+  compare(name, m.y.n, ay->GetNbins(), "nbinsy");
+  if (m.x.n != ax->GetNbins() || m.y.n != ay->GetNbins())
+    return;
+  compare(name, m.x.lo, ax->GetXmin(), "xmin");
+  compare(name, m.x.hi, ax->GetXmax(), "xmax");
+  compare(name, m.y.lo, ay->GetXmin(), "ymin");
+  compare(name, m.y.hi, ay->GetXmax(), "ymax");
+  compare(name, m.x.edges != 0, ax->IsVariableBinSize(), "x variable");
+  compare(name, m.y.edges != 0, ay->IsVariableBinSize(), "y variable");
+  if (m.x.edges) for (int i = 1; i <= m.x.n+1; ++i) compare(name, m.x.edges[i-1], ax->GetBinLowEdge(i), "x edge");
+  if (m.y.edges) for (int i = 1; i <= m.y.n+1; ++i) compare(name, m.y.edges[i-1], ay->GetBinLowEdge(i), "y edge");
+
+  for (int ibin = 0, nbins = (m.x.n+2)*(m.y.n+2); ibin < nbins; ++ibin) {
+    compare(name, m.content[ibin], h->GetBinContent(ibin), "content", ibin);
+    compare(name, m.error[ibin], h->GetBinError(ibin), "error", ibin);
+  }
+
+  for (double x : probes(ax))
+    for (double y : probes(ay)) {
+      compare(name, m.find_bin(x, y), h->FindBin(x, y), "bin", x, y);
+      for (double syst : {0., 0.2, 0.5}) {
+        const jmt::L1ECALPrefiringMap::rate_t r = m.rate(x, y, syst);
+        compare(name, r.central, hist_rate(x, y, h, syst, 0), "central", x, y);
+        compare(name, r.up,      hist_rate(x, y, h, syst, 1), "up", x, y);
+        compare(name, r.down,    hist_rate(x, y, h, syst, 2), "down", x, y);
+      }
+    }
+}
+
+int main() {
+  gROOT->SetBatch();
+  TH1::AddDirectory(0);
+
+#include "L1ECALPrefiringWeightMaps.h"
+
+  namespace T = L1ECALPrefiringWeightTables;
+  check("jetemptvseta_2017BtoF", T::L1prefiring_jetemptvseta_2017BtoF, L1prefiring_jetemptvseta_2017BtoF.get());
+  check("jetptvseta_2017BtoF", T::L1prefiring_jetptvseta_2017BtoF, L1prefiring_jetptvseta_2017BtoF.get());
+  check("photonptvseta_2017BtoF", T::L1prefiring_photonptvseta_2017BtoF, L1prefiring_photonptvseta_2017BtoF.get());
+  check("jetptvseta_2016BtoH", T::L1prefiring_jetptvseta_2016BtoH, L1prefiring_jetptvseta_2016BtoH.get());
+  check("jetemptvseta_2016BtoH", T::L1prefiring_jetemptvseta_2016BtoH, L1prefiring_jetemptvseta_2016BtoH.get());
+  check("photonptvseta_2016BtoH", T::L1prefiring_photonptvseta_2016BtoH, L1prefiring_photonptvseta_2016BtoH.get());
+
+  if (nbad) {
+    printf("%i differences\n", nbad);
+    return 1;
+  }
+  printf("tables agree with the histograms\n");
+  return 0;
+}
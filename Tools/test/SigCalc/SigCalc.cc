@@ -1,11 +1,16 @@
 // Modified version of SigCalc from Glen Cowan, RHUL Physics
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <stdio.h>
+#include <thread>
 #include "SigCalc.h"
 #include "fitPar.h"
+#include "newtonFit.h"
 
 int SigCalc::debugLevel = -1;
+bool SigCalc::useMinuit = false;
 
 SigCalc::SigCalc(double n, double s, const std::vector<double>& m, const std::vector<double>& tau) {
   m_n = n;
@@ -23,6 +28,10 @@ SigCalc::SigCalc(double n, double s, const std::vector<double>& m, const std::ve
 // estimates based on MC or sidebands.
 
 double SigCalc::lnL(double mu, const std::vector<double>& b, const std::vector<double>& a) const {
+  return lnL(mu, b.data(), useSystFrac() ? a.data() : 0);
+}
+
+double SigCalc::lnL(double mu, const double* b, const double* a) const {
   double btot = 0;
   for (int i = 0; i < numBck(); ++i) {
     if (useSystFrac())
@@ -46,6 +55,93 @@ double SigCalc::lnL(double mu, const std::vector<double>& b, const std::vector<d
   return logL;
 }
 
+// With nu0 = mu*s + sum_i b_i*a_j(i) and nu_i = tau_i*b_i*a_j(i), -lnL
+// = sum over k = 0..numBck of nu_k - n_k*log(nu_k), plus the a
+// constraint terms. For each term, d/dnu = 1 - n/nu and d2/dnu2 =
+// n/nu^2; the rest is the chain rule, nu0 and nu_i being linear in each
+// of mu, b, a separately. The nu are kept above psi's epsilon, below
+// which psi is constant.
+
+double SigCalc::nlnL(const std::vector<double>& par, std::vector<double>& g, std::vector<double>& H) const {
+  const int nb = numBck();
+  const int np = npar();
+  const double mu = par[0];
+  const double* b = &par[1];
+  const double* a = useSystFrac() ? &par[1+nb] : 0;
+  auto A  = [&](int i) { return a ? a[bitoaj(i)] : 1.; };
+  auto ka = [&](int i) { return 1 + nb + bitoaj(i); };
+
+  g.assign(np, 0.);
+  H.assign(np*np, 0.);
+
+  std::vector<double> dnu0(np, 0.);
+  double nu0 = mu * s();
+  dnu0[0] = s();
+  for (int i = 0; i < nb; ++i) {
+    nu0 += b[i] * A(i);
+    dnu0[1+i] = A(i);
+    if (a) dnu0[ka(i)] += b[i];
+  }
+
+  nu0 = std::max(nu0, psiEpsilon);
+  const double r0 = 1 - n() / nu0;
+  const double h0 = n() / (nu0 * nu0);
+  for (int k = 0; k < np; ++k) {
+    g[k] += r0 * dnu0[k];
+    for (int l = 0; l < np; ++l)
+      H[k*np+l] += h0 * dnu0[k] * dnu0[l];
+  }
+
+  for (int i = 0; i < nb; ++i) {
+    const int kb = 1+i;
+    const double nui = std::max(tau(i) * b[i] * A(i), psiEpsilon);
+    const double ri = 1 - m(i) / nui;
+    const double hi = m(i) / (nui * nui);
+    const double db = tau(i) * A(i);
+    g[kb] += ri * db;
+    H[kb*np+kb] += hi * db * db;
+
+    if (a) {
+      const int k = ka(i);
+      const double da = tau(i) * b[i];
+      const double hba = hi * db * da + ri * tau(i) + r0; // the last two from d2nu/dbda
+      g[k] += ri * da;
+      H[k*np+k] += hi * da * da;
+      H[kb*np+k] += hba;
+      H[k*np+kb] += hba;
+    }
+  }
+
+  // The constraint on a_j is in lnL once per b_i using it.
+  if (a) {
+    for (int i = 0; i < nb; ++i) {
+      const int j = bitoaj(i);
+      const int k = ka(i);
+      const double la = log(a[j]);
+      const double s2 = systFrac(j) * systFrac(j);
+      g[k] += (1 + la / s2) / a[j];
+      H[k*np+k] += ((1 - la) / s2 - 1) / (a[j] * a[j]);
+    }
+  }
+
+  return -lnL(mu, b, a);
+}
+
+int SigCalc::fit(const std::vector<bool>& freePar, std::vector<double>& parVec) const {
+  if (!useMinuit) {
+    std::vector<double> p(parVec);
+    const int status = newtonFit(this, freePar, p);
+    if (status == 0) {
+      parVec = p;
+      return 0;
+    }
+    if (debugLevel >= 0)
+      printf("SigCalc::fit: Newton fit did not converge, falling back to Minuit\n");
+  }
+
+  return fitPar(this, freePar, parVec);
+}
+
 // Returns qmu = - 2 ln lambda(mu), where lambda = profile likelihood
 // ratio.
 double SigCalc::qmu(double mu, double& muHat, std::vector<double>& bHat, std::vector<double>& bHatHat) const {
@@ -68,7 +164,7 @@ double SigCalc::qmu(double mu, double& muHat, std::vector<double>& bHat, std::ve
     }
   }
 
-  int status = fitPar(this, freePar, parVec);
+  int status = fit(freePar, parVec);
 
   std::vector<double> aHatHat, aHat;
 
@@ -114,8 +210,8 @@ double SigCalc::qmu(double mu, double& muHat, std::vector<double>& bHat, std::ve
     }
   }
 
-  status = fitPar(this, freePar, parVec);
-  
+  status = fit(freePar, parVec);
+
   muHat = parVec[0];
   bHat.clear();
   for (int i = 0; i < numBck(); ++i)
@@ -176,3 +272,30 @@ double getSignificance(double mu, double n, double s, const std::vector<double>&
   delete sc;
   return Z;
 }
+
+std::vector<double> getSignificances(const std::vector<SigCalcPoint>& points, int nthreads) {
+  std::vector<double> Z(points.size());
+  if (nthreads <= 0)
+    nthreads = std::max(1U, std::thread::hardware_concurrency());
+  nthreads = std::min(nthreads, int(points.size()));
+
+  std::atomic<size_t> next(0);
+  auto work = [&]() {
+    for (size_t i; (i = next++) < points.size(); ) {
+      const SigCalcPoint& p = points[i];
+      Z[i] = getSignificance(p.mu, p.n, p.s, p.m, p.tau, p.systFrac);
+    }
+  };
+
+  if (nthreads <= 1)
+    work();
+  else {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < nthreads; ++i)
+      threads.emplace_back(work);
+    for (std::thread& th : threads)
+      th.join();
+  }
+
+  return Z;
+}
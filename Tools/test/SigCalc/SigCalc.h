@@ -22,7 +22,16 @@ public:
   void systFrac(const std::vector<double>& sf) { m_useSystFrac = true; m_systFrac = sf; }
   void bitoaj(const std::vector<int>& x) { m_bitoaj = x; }
 
+  // Number of fit parameters: mu, then the b, then the a if using systFrac.
+  int npar() const { return 1 + numBck() + (useSystFrac() ? numa() : 0); }
+
   double lnL(double mu, const std::vector<double>& b, const std::vector<double>& a) const;
+  double lnL(double mu, const double* b, const double* a) const;
+
+  // -lnL at par = (mu, b, a) along with its gradient and its Hessian
+  // (npar x npar, row-major).
+  double nlnL(const std::vector<double>& par, std::vector<double>& grad, std::vector<double>& hess) const;
+
   double qmu(double mu, double& muHat, std::vector<double>& bHat, std::vector<double>& bHatHat) const;
   double qmu(double mu) const {
     double muHat;
@@ -31,8 +40,13 @@ public:
   }
 
   static int debugLevel;
+  static bool useMinuit; // always fit with Minuit instead of Newton, e.g. to compare
 
 private:
+  // Fit the free parameters starting from parVec, with Newton's method
+  // and falling back to Minuit if that doesn't converge.
+  int fit(const std::vector<bool>& freePar, std::vector<double>& parVec) const;
+
   int m_numBck;
   double m_n;
   double m_s;
@@ -46,4 +60,18 @@ private:
 
 double getSignificance(double mu, double n, double s, const std::vector<double>& m, const std::vector<double>& tau, double systFrac);
 
+// For evaluating many getSignificance calls at once, e.g. for all the
+// cuts in a scan.
+struct SigCalcPoint {
+  double mu;
+  double n;
+  double s;
+  std::vector<double> m;
+  std::vector<double> tau;
+  double systFrac;
+};
+
+// Z for each point, computed by nthreads threads (0 for one per core).
+std::vector<double> getSignificances(const std::vector<SigCalcPoint>& points, int nthreads=0);
+
 #endif
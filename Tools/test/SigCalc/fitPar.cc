@@ -1,16 +1,21 @@
 // Modified version of SigCalc from Glen Cowan, RHUL Physics
 
 // Uses Minuit to fit the MLEs muHat, bHat and conditional MLEs bHatHat
-// used in profile likelihood ratio.
+// used in profile likelihood ratio. This is now only the fallback for
+// when the Newton fit in newtonFit.cc doesn't converge.
 
 #include <cmath>
+#include <mutex>
 #include <string>
 #include "TMinuit.h"
 #include "fitPar.h"
 
 const SigCalc* scGlobal; // needs to be global to communicate with fcn (below)
+std::mutex scGlobalMutex; // which, along with TMinuit itself, means one fit at a time
 
 int fitPar(const SigCalc* sc, const std::vector<bool>& freePar, std::vector<double>& pars) {
+  std::lock_guard<std::mutex> lock(scGlobalMutex);
+
   // Set up start values, step sizes, etc. for fit.
 
   scGlobal = sc; // communicate to fcn via global
@@ -72,15 +77,9 @@ int fitPar(const SigCalc* sc, const std::vector<bool>& freePar, std::vector<doub
 
 // fcn must be non-member function, uses global SigCalc object scGlobal.
 void fcn(int& npar, double* deriv, double& f, double par[], int flag) {
-  double mu = par[0];
-  std::vector<double> b, a;
-  for (int i = 0; i < scGlobal->numBck(); ++i)
-    b.push_back(par[i+1]);
-  if (scGlobal->useSystFrac())
-    for (int j = 0; j < scGlobal->numa(); ++j)
-      a.push_back(par[scGlobal->numBck()+1+j]);
-
-  f = -2.*scGlobal->lnL(mu, b, a);
+  const double* b = par + 1;
+  const double* a = scGlobal->useSystFrac() ? b + scGlobal->numBck() : 0;
+  f = -2.*scGlobal->lnL(par[0], b, a);
 
   //  if ( SigCalc::debugLevel >= 3 ) {
   //    for (int i=0; i<npar; i++) {
@@ -96,7 +95,7 @@ void fcn(int& npar, double* deriv, double& f, double par[], int flag) {
 // returns zero. The function avoids evaluating log(nu) for nu <=
 // epsilon.
 double psi(double n, double nu) {
-  static const double epsilon = 1e-6;
+  static const double epsilon = psiEpsilon;
   static const double logeps = log(epsilon);
   if (n <= epsilon && nu <= epsilon)
     return 0;
@@ -9,5 +9,6 @@
 int fitPar(const SigCalc* sc, const std::vector<bool>& freePar, std::vector<double>& parVec);
 void fcn(int& n, double* d, double& f, double par[], int flag);
 double psi(double n, double nu);
+const double psiEpsilon = 1e-6;
 
 #endif
@@ -0,0 +1,270 @@
+// Newton minimization of -lnL for SigCalc.
+//
+// lnL depends on b_i and a_j only through c_i = b_i*a_j(i) in the
+// Poisson terms, plus the constraint on each a_j. So if a_j is free
+// along with the b_i using it, its constraint term alone fixes it,
+// at log a_j = -systFrac_j^2, and the rest is a fit of mu and the c
+// with the a held at 1, in which -lnL is convex.
+//
+// When all the b are free, as in SigCalc::qmu, the minimum in mu and
+// the c comes from one equation in one variable, see profileStart
+// below. That is then the starting point for projected Newton, which
+// mostly just confirms it's the minimum, and otherwise moves it there:
+// the parameters are bounded below by 0 like in
+// fitPar, a parameter at the bound whose gradient points out of the
+// allowed region is held there for that iteration, and steps are cut
+// at the bound. If the Hessian over the rest isn't positive definite,
+// e.g. for mu when s = 0, it is damped until it is. Each step is
+// backtracked until -lnL goes down.
+
+#include <algorithm>
+#include <cmath>
+#include <stdio.h>
+#include "newtonFit.h"
+
+namespace {
+  // Solves (H + lambda*1) x = -g in place of g by Cholesky, returning
+  // false if the matrix isn't positive definite. H is n x n row-major
+  // and is overwritten.
+  bool cholesky_solve(int n, std::vector<double>& H, double lambda, std::vector<double>& g) {
+    for (int i = 0; i < n; ++i)
+      H[i*n+i] += lambda;
+
+    for (int j = 0; j < n; ++j) {
+      double d = H[j*n+j];
+      for (int k = 0; k < j; ++k)
+        d -= H[j*n+k] * H[j*n+k];
+      if (!(d > 0))
+        return false;
+      d = sqrt(d);
+      H[j*n+j] = d;
+      for (int i = j+1; i < n; ++i) {
+        double x = H[i*n+j];
+        for (int k = 0; k < j; ++k)
+          x -= H[i*n+k] * H[j*n+k];
+        H[i*n+j] = x / d;
+      }
+    }
+
+    for (int i = 0; i < n; ++i) {
+      double x = -g[i];
+      for (int k = 0; k < i; ++k)
+        x -= H[i*n+k] * g[k];
+      g[i] = x / H[i*n+i];
+    }
+    for (int i = n-1; i >= 0; --i) {
+      double x = g[i];
+      for (int k = i+1; k < n; ++k)
+        x -= H[k*n+i] * g[k];
+      g[i] = x / H[i*n+i];
+    }
+
+    return true;
+  }
+}
+
+namespace {
+  // With nu0 = mu*s + sum c_i and t = n/nu0, -lnL is stationary in each
+  // c_i > 0 when 1 - t + tau_i - m_i/c_i = 0, i.e. c_i = m_i/(1+tau_i-t).
+  // A c_i with m_i = 0 is zero unless t reaches 1+tau_i, which it can't
+  // go above. Then t*nu0 = n is an increasing function of t, solved by
+  // Newton's method kept inside a bracket. If mu is free and s > 0, it
+  // is either 0 or at t = 1.
+  void profileStart(const SigCalc* sc, bool muFree, std::vector<double>& p) {
+    const int nb = sc->numBck();
+    const double n = sc->n();
+    double& mu = p[0];
+    double* c = &p[1];
+
+    if (muFree && sc->s() > 0) {
+      double ctot = 0;
+      for (int i = 0; i < nb; ++i)
+        ctot += c[i] = sc->m(i) / sc->tau(i);
+      mu = std::max(n - ctot, 0.) / sc->s();
+      if (mu > 0)
+        return;
+    }
+
+    const double A = mu * sc->s();
+    double tmax = HUGE_VAL; // first pole of the sum
+    double tcap = HUGE_VAL; // where a c_i with m_i = 0 takes over
+    for (int i = 0; i < nb; ++i) {
+      double& x = sc->m(i) > 0 ? tmax : tcap;
+      x = std::min(x, 1 + sc->tau(i));
+    }
+
+    auto G = [&](double t, double& dG) {
+      double S = A, dS = 0;
+      for (int i = 0; i < nb; ++i)
+        if (sc->m(i) > 0) {
+          const double d = 1 + sc->tau(i) - t;
+          S += sc->m(i) / d;
+          dS += sc->m(i) / (d*d);
+        }
+      dG = S + t * dS;
+      return t * S - n;
+    };
+
+    double t = 0, dG;
+    int iz = -1;
+    if (n > 0) {
+      if (tcap < tmax && G(tcap, dG) <= 0) {
+        t = tcap;
+        for (int i = 0; i < nb; ++i)
+          if (sc->m(i) == 0 && 1 + sc->tau(i) == tcap) {
+            iz = i;
+            break;
+          }
+      }
+      else {
+        double lo = 0, hi = std::min(tmax, tcap);
+        t = hi < HUGE_VAL ? hi / 2 : 1;
+        for (int iter = 0; iter < 200; ++iter) {
+          const double g = G(t, dG);
+          if (g < 0) lo = t;
+          else hi = t;
+          double tn = t - g / dG;
+          if (!(tn > lo && tn < hi))
+            tn = hi < HUGE_VAL ? (lo + hi) / 2 : 2 * t;
+          if (std::abs(tn - t) <= 1e-15 * t)
+            break;
+          t = tn;
+        }
+      }
+    }
+
+    double ctot = 0;
+    for (int i = 0; i < nb; ++i)
+      ctot += c[i] = sc->m(i) > 0 ? sc->m(i) / (1 + sc->tau(i) - t) : 0;
+    if (iz >= 0)
+      c[iz] = std::max(n / t - A - ctot, 0.);
+  }
+
+  int newton(const SigCalc* sc, const std::vector<bool>& freePar, std::vector<double>& par) {
+    const int maxIter = 100;
+    const int np = sc->npar();
+
+    std::vector<double> g, H, gf, Hf, step(np), trial(np);
+    std::vector<int> act; // the free parameters not held at their bound this iteration
+
+    double f = sc->nlnL(par, g, H);
+    if (!std::isfinite(f))
+      return 1;
+
+    for (int iter = 0; iter < maxIter; ++iter) {
+      act.clear();
+      double gmax = 0;
+      for (int k = 0; k < np; ++k) {
+        if (!freePar[k] || (par[k] <= 0 && g[k] >= 0))
+          continue;
+        act.push_back(k);
+        gmax = std::max(gmax, std::abs(g[k]) * std::max(std::abs(par[k]), 1.));
+      }
+
+      if (SigCalc::debugLevel >= 3) {
+        printf("newtonFit iter %i: f = %.12e  max |g*x| = %e  nact = %i  par:", iter, f, gmax, int(act.size()));
+        for (int k = 0; k < np; ++k)
+          printf(" %e", par[k]);
+        printf("\n");
+      }
+
+      const double gtol = 1e-8 * std::max(std::abs(f), 1.);
+      if (gmax < gtol)
+        return 0;
+
+      const int n = act.size();
+      double lambda = 0;
+      for (int tries = 0; ; ++tries) {
+        Hf.resize(n*n);
+        gf.resize(n);
+        double dmax = 0;
+        for (int i = 0; i < n; ++i) {
+          gf[i] = g[act[i]];
+          for (int j = 0; j < n; ++j)
+            Hf[i*n+j] = H[act[i]*np+act[j]];
+          dmax = std::max(dmax, std::abs(Hf[i*n+i]));
+        }
+        if (cholesky_solve(n, Hf, lambda, gf))
+          break;
+        if (tries == 30)
+          return 2;
+        lambda = lambda == 0 ? 1e-10 * std::max(dmax, 1.) : lambda * 10;
+      }
+
+      std::fill(step.begin(), step.end(), 0.);
+      for (int i = 0; i < n; ++i)
+        step[act[i]] = gf[i];
+
+      double t = 1;
+      double ftrial = 0;
+      bool decreased = false;
+      for (int tries = 0; tries < 50; ++tries, t /= 2) {
+        for (int k = 0; k < np; ++k)
+          trial[k] = std::max(par[k] + t * step[k], 0.);
+        ftrial = sc->nlnL(trial, g, H);
+        if (std::isfinite(ftrial) && ftrial <= f) {
+          decreased = true;
+          break;
+        }
+      }
+
+      if (!decreased) {
+        // No decrease even for a tiny step: fine if we're at the minimum
+        // to within roundoff, otherwise give up.
+        sc->nlnL(par, g, H);
+        return gmax < 1000 * gtol ? 0 : 3;
+      }
+
+      const double df = f - ftrial;
+      par.swap(trial);
+      f = ftrial;
+
+      // Stalled at roundoff level close to the minimum.
+      if (df <= 1e-15 * std::max(std::abs(f), 1.) && gmax < 1000 * gtol)
+        return 0;
+    }
+
+    return 4;
+  }
+}
+
+int newtonFit(const SigCalc* sc, const std::vector<bool>& freePar, std::vector<double>& parVec) {
+  const int nb = sc->numBck();
+  const bool allBFree = std::count(freePar.begin() + 1, freePar.begin() + 1 + nb, true) == nb;
+
+  if (!sc->useSystFrac()) {
+    if (allBFree)
+      profileStart(sc, freePar[0], parVec);
+    return newton(sc, freePar, parVec);
+  }
+
+  const int na0 = 1 + nb;
+  std::vector<double> p(parVec);
+  std::vector<bool> freeC(freePar);
+  std::vector<double> aHat(sc->numa());
+
+  for (int j = 0; j < sc->numa(); ++j) {
+    aHat[j] = freePar[na0+j] ? exp(-sc->systFrac(j) * sc->systFrac(j)) : parVec[na0+j];
+    p[na0+j] = 1;
+    freeC[na0+j] = false;
+  }
+
+  for (int i = 0; i < nb; ++i) {
+    const int j = sc->bitoaj(i);
+    if (freePar[na0+j] && !freePar[1+i])
+      return 5; // a free but b fixed, the a isn't decoupled
+    p[1+i] = parVec[1+i] * parVec[na0+j];
+  }
+
+  if (allBFree)
+    profileStart(sc, freePar[0], p);
+  const int status = newton(sc, freeC, p);
+
+  parVec[0] = p[0];
+  for (int i = 0; i < nb; ++i)
+    parVec[1+i] = p[1+i] / aHat[sc->bitoaj(i)];
+  for (int j = 0; j < sc->numa(); ++j)
+    parVec[na0+j] = aHat[j];
+
+  return status;
+}
@@ -0,0 +1,13 @@
+#ifndef SigCalc_newtonFit_h
+#define SigCalc_newtonFit_h
+
+#include <vector>
+#include "SigCalc.h"
+
+// Minimizes -lnL over the free parameters with Newton's method, using
+// the analytic gradient and Hessian from SigCalc::nlnL. Same interface
+// as fitPar; returns 0 if it converged, nonzero if not, in which case
+// parVec is left wherever it got to.
+int newtonFit(const SigCalc* sc, const std::vector<bool>& freePar, std::vector<double>& parVec);
+
+#endif